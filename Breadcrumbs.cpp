@@ -0,0 +1,154 @@
+/**
+ * @file      Breadcrumbs.cpp
+ * @brief     Watchdog-stall forensics implementation
+ */
+
+#include "Breadcrumbs.h"
+#include "EventLog.h"
+#include <esp_system.h>
+
+#define CRUMB_MAGIC 0x57435242UL    // "WCRB"
+
+// Not cleared by the startup code, so it still holds the previous boot's
+// breadcrumbs after a panic or watchdog reset
+static RTC_NOINIT_ATTR Breadcrumbs::Record s_rec;
+
+Breadcrumbs Crumbs;
+
+static const char* const STAGE_NAMES[STAGE_COUNT] = {
+    "none", "setup", "loop-top", "ds3231-sqw", "es100-irq", "touch", "wifi",
+    "ntp", "ptp", "status-http", "portal", "time-save", "log-ship",
+    "mqtt", "es100-init", "tick", "display", "sync-sched", "ntp-client",
+    "usb-ref"
+};
+
+static const char* const EVENT_NAMES[] = {
+    "?", "boot", "es100-start", "es100-stop", "es100-irq", "i2c-error",
+    "i2c-recover", "rtc-write", "nvs-save", "wifi-state", "ntp-query",
+    "ntp-reply", "slow-pass"
+};
+
+Breadcrumbs::Breadcrumbs() : _rec(&s_rec) {
+}
+
+void Breadcrumbs::begin() {
+    esp_reset_reason_t reason = esp_reset_reason();
+    bool valid = s_rec.magic == CRUMB_MAGIC &&
+                 s_rec.head < STALL_TRACE_SIZE && s_rec.count <= STALL_TRACE_SIZE;
+
+    if (!valid || reason == ESP_RST_POWERON || reason == ESP_RST_BROWNOUT) {
+        memset(&s_rec, 0, sizeof(s_rec));
+        s_rec.magic = CRUMB_MAGIC;
+    } else if (reason == ESP_RST_TASK_WDT || reason == ESP_RST_INT_WDT ||
+               reason == ESP_RST_WDT || reason == ESP_RST_PANIC) {
+        memcpy(&_last, &s_rec, sizeof(_last));
+        _haveLast = true;
+        if (reason == ESP_RST_PANIC) s_rec.panicResets++;
+        else                         s_rec.wdtResets++;
+    }
+
+    // Start this boot's trace; counters carry over until power is lost
+    s_rec.bootCount++;
+    s_rec.resetReason = (uint8_t)reason;
+    s_rec.loopCount = 0;
+    s_rec.loopTopMs = 0;
+    s_rec.stage = STAGE_SETUP;
+    s_rec.i2cBus = 0xFF;
+    s_rec.head = 0;
+    s_rec.count = 0;
+    trace(CRUMB_BOOT, (uint16_t)reason);
+
+    if (_haveLast) {
+        char i2c[32] = "none";
+        if (_last.i2cBus != 0xFF) {
+            snprintf(i2c, sizeof(i2c), "Wire%s 0x%02X reg 0x%02X",
+                     _last.i2cBus ? "1" : "", _last.i2cAddr, _last.i2cReg);
+        }
+        Log.event(LOG_SEV_ERR, "[STALL] Reset by %s in stage %s (pass %lu, I2C %s)",
+                  resetReasonName(reason), stageName(_last.stage),
+                  (unsigned long)_last.loopCount, i2c);
+    }
+}
+
+void Breadcrumbs::trace(CrumbEvent event, uint16_t arg) {
+    Entry& e = _rec->ring[_rec->head];
+    e.ms    = millis();
+    e.event = event;
+    e.stage = _rec->stage;
+    e.arg   = arg;
+    _rec->head = (_rec->head + 1) % STALL_TRACE_SIZE;
+    if (_rec->count < STALL_TRACE_SIZE) _rec->count++;
+}
+
+const Breadcrumbs::Record* Breadcrumbs::lastStall() const {
+    return _haveLast ? &_last : nullptr;
+}
+
+uint32_t Breadcrumbs::getWdtResets() const {
+    return _rec->wdtResets;
+}
+
+uint32_t Breadcrumbs::getPanicResets() const {
+    return _rec->panicResets;
+}
+
+uint32_t Breadcrumbs::getBootCount() const {
+    return _rec->bootCount;
+}
+
+const char* Breadcrumbs::stageName(uint8_t stage) {
+    return stage < STAGE_COUNT ? STAGE_NAMES[stage] : "?";
+}
+
+const char* Breadcrumbs::eventName(uint8_t event) {
+    return event < sizeof(EVENT_NAMES) / sizeof(EVENT_NAMES[0]) ? EVENT_NAMES[event] : "?";
+}
+
+const char* Breadcrumbs::resetReasonName(uint8_t reason) {
+    switch (reason) {
+        case ESP_RST_POWERON:  return "power-on";
+        case ESP_RST_EXT:      return "external";
+        case ESP_RST_SW:       return "software";
+        case ESP_RST_PANIC:    return "panic";
+        case ESP_RST_INT_WDT:  return "interrupt watchdog";
+        case ESP_RST_TASK_WDT: return "task watchdog";
+        case ESP_RST_WDT:      return "watchdog";
+        case ESP_RST_DEEPSLEEP: return "deep sleep";
+        case ESP_RST_BROWNOUT: return "brownout";
+        default:               return "unknown";
+    }
+}
+
+int Breadcrumbs::toJson(char* buf, size_t len) const {
+    int pos = snprintf(buf, len,
+        "{\"boots\":%lu,\"wdt\":%lu,\"panic\":%lu,\"reset\":\"%s\"",
+        (unsigned long)_rec->bootCount, (unsigned long)_rec->wdtResets,
+        (unsigned long)_rec->panicResets, resetReasonName(_rec->resetReason));
+
+    if (_haveLast && pos < (int)len - 160) {
+        const Record& r = _last;
+        pos += snprintf(buf + pos, len - pos,
+            ",\"last\":{\"stage\":\"%s\",\"passes\":%lu,\"fed_ms\":%lu",
+            stageName(r.stage),
+            (unsigned long)r.loopCount, (unsigned long)r.loopTopMs);
+        if (r.i2cBus != 0xFF && pos < (int)len - 80) {
+            pos += snprintf(buf + pos, len - pos,
+                ",\"i2c\":{\"bus\":%u,\"addr\":%u,\"reg\":%u,\"start_ms\":%lu}",
+                r.i2cBus, r.i2cAddr, r.i2cReg, (unsigned long)r.i2cSinceMs);
+        }
+        if (pos < (int)len - 12) pos += snprintf(buf + pos, len - pos, ",\"trace\":[");
+
+        // Oldest first
+        uint8_t start = (r.head + STALL_TRACE_SIZE - r.count) % STALL_TRACE_SIZE;
+        for (uint8_t i = 0; i < r.count && pos < (int)len - 72; i++) {
+            const Entry& e = r.ring[(start + i) % STALL_TRACE_SIZE];
+            pos += snprintf(buf + pos, len - pos,
+                "%s{\"ms\":%lu,\"ev\":\"%s\",\"stage\":\"%s\",\"arg\":%u}",
+                i > 0 ? "," : "", (unsigned long)e.ms, eventName(e.event),
+                stageName(e.stage), e.arg);
+        }
+        if (pos < (int)len - 3) pos += snprintf(buf + pos, len - pos, "]}");
+    }
+    if (pos < (int)len - 2) pos += snprintf(buf + pos, len - pos, "}");
+    return pos < (int)len ? pos : (int)len - 1;
+}
@@ -0,0 +1,184 @@
+/**
+ * @file      Breadcrumbs.h
+ * @brief     Watchdog-stall forensics kept in RTC memory across a reset
+ * @details   The current loop stage, the I2C transaction in flight and a short
+ *            ring of trace events are written to RTC_NOINIT memory as the
+ *            firmware runs. That memory survives the panic reset that follows
+ *            a task-watchdog timeout, so the next boot can say where loop()
+ *            was stuck. Marking a stage is one byte store; a trace event is
+ *            one 8-byte ring write. Call from the loop task only (ES100/DS3231
+ *            I2C also runs there).
+ */
+
+#ifndef BREADCRUMBS_H
+#define BREADCRUMBS_H
+
+#include <Arduino.h>
+#include "config.h"
+
+// Loop stages, in roughly the order loop() visits them
+enum CrumbStage : uint8_t {
+    STAGE_NONE = 0,
+    STAGE_SETUP,
+    STAGE_LOOP_TOP,
+    STAGE_SQW,
+    STAGE_ES100_IRQ,
+    STAGE_TOUCH,
+    STAGE_WIFI,
+    STAGE_NTP,
+    STAGE_PTP,
+    STAGE_STATUS_HTTP,
+    STAGE_PORTAL,
+    STAGE_TIME_SAVE,
+    STAGE_LOG_SHIP,
+    STAGE_MQTT,
+    STAGE_ES100_INIT,
+    STAGE_TICK,
+    STAGE_DISPLAY,
+    STAGE_SYNC_SCHED,
+    STAGE_NTP_CLIENT,
+    STAGE_USB_REF,
+    STAGE_COUNT
+};
+
+// Trace events (arg meaning in the comment)
+enum CrumbEvent : uint8_t {
+    CRUMB_BOOT = 1,          // reset reason
+    CRUMB_ES100_START,       // control 0 value
+    CRUMB_ES100_STOP,        // 0
+    CRUMB_ES100_IRQ,         // IRQ status
+    CRUMB_I2C_ERROR,         // (bus << 8) | register
+    CRUMB_I2C_RECOVER,       // bus
+    CRUMB_RTC_WRITE,         // 0
+    CRUMB_NVS_SAVE,          // 0
+    CRUMB_WIFI_STATE,        // new WiFi state
+    CRUMB_NTP_QUERY,         // 0
+    CRUMB_NTP_REPLY,         // round trip (ms)
+    CRUMB_SLOW_PASS          // loop() pass longer than STALL_SLOW_PASS_MS (ms)
+};
+
+class Breadcrumbs {
+public:
+    Breadcrumbs();
+
+    struct Entry {
+        uint32_t ms;             // millis() when recorded
+        uint8_t  event;          // CrumbEvent
+        uint8_t  stage;          // Stage at the time
+        uint16_t arg;
+    };
+
+    /**
+     * @brief Persistent record (lives in RTC_NOINIT memory)
+     */
+    struct Record {
+        uint32_t magic;
+        uint32_t bootCount;      // Boots since power-on
+        uint32_t wdtResets;      // Task/interrupt watchdog resets since power-on
+        uint32_t panicResets;    // Other panics since power-on
+        uint32_t loopCount;      // loop() passes this boot
+        uint32_t loopTopMs;      // millis() at the last watchdog feed
+        uint32_t i2cSinceMs;     // millis() when the in-flight transaction began
+        uint8_t  stage;          // CrumbStage
+        uint8_t  i2cBus;         // 0 = Wire, 1 = Wire1, 0xFF = none in flight
+        uint8_t  i2cAddr;
+        uint8_t  i2cReg;
+        uint8_t  head;           // Next ring slot
+        uint8_t  count;          // Valid ring entries
+        uint8_t  resetReason;    // esp_reset_reason() of this boot
+        uint8_t  reserved;
+        Entry    ring[STALL_TRACE_SIZE];
+    };
+
+    /**
+     * @brief Examine the record left by the previous boot (call first in setup)
+     * @details After a watchdog or panic reset the previous record is kept as
+     *          the last-stall report and counted; the live record then starts
+     *          over. A power-on reset clears everything.
+     */
+    void begin();
+
+    /**
+     * @brief Mark the start of a loop() pass (next to esp_task_wdt_reset())
+     */
+    inline void loopTop() {
+        uint32_t now = millis();
+        uint32_t pass = now - _rec->loopTopMs;
+        if (_rec->loopCount != 0 && pass >= STALL_SLOW_PASS_MS) {
+            trace(CRUMB_SLOW_PASS, pass > 0xFFFF ? 0xFFFF : (uint16_t)pass);
+        }
+        _rec->loopCount++;
+        _rec->loopTopMs = now;
+        _rec->stage = STAGE_LOOP_TOP;
+    }
+
+    inline void stage(CrumbStage s) { _rec->stage = s; }
+    inline uint8_t currentStage() const { return _rec->stage; }
+
+    void trace(CrumbEvent event, uint16_t arg = 0);
+
+    inline void i2cBegin(uint8_t bus, uint8_t addr, uint8_t reg) {
+        _rec->i2cBus = bus;
+        _rec->i2cAddr = addr;
+        _rec->i2cReg = reg;
+        _rec->i2cSinceMs = millis();
+        _i2cStartUs = micros();
+    }
+    inline void i2cEnd() {
+        if (_rec->i2cBus < 2) _i2cBusyUs[_rec->i2cBus] += micros() - _i2cStartUs;
+        _rec->i2cBus = 0xFF;
+    }
+
+    /**
+     * @brief Time spent in marked transactions on a bus (µs, wraps; take differences)
+     */
+    inline uint32_t getI2CBusyUs(uint8_t bus) const { return bus < 2 ? _i2cBusyUs[bus] : 0; }
+
+    /**
+     * @brief Record from before the last watchdog/panic reset
+     * @return nullptr if this boot did not follow one
+     */
+    const Record* lastStall() const;
+
+    uint32_t getWdtResets() const;
+    uint32_t getPanicResets() const;
+    uint32_t getBootCount() const;
+
+    static const char* stageName(uint8_t stage);
+    static const char* eventName(uint8_t event);
+    static const char* resetReasonName(uint8_t reason);
+
+    /**
+     * @brief Reset counters and the last-stall report as a JSON object
+     * @return Characters written (snprintf semantics, clipped to len)
+     */
+    int toJson(char* buf, size_t len) const;
+
+private:
+    Record* _rec;                        // The RTC_NOINIT record
+    uint32_t _i2cStartUs = 0;            // micros() at i2cBegin()
+    uint32_t _i2cBusyUs[2] = { 0, 0 };   // Per-bus transaction time (energy accounting)
+    Record  _last;
+    bool    _haveLast = false;
+};
+
+/**
+ * @brief Marks an I2C transaction in flight for the lifetime of the scope
+ */
+class I2CCrumb {
+public:
+    I2CCrumb(uint8_t bus, uint8_t addr, uint8_t reg);
+    ~I2CCrumb();
+};
+
+extern Breadcrumbs Crumbs;
+
+inline I2CCrumb::I2CCrumb(uint8_t bus, uint8_t addr, uint8_t reg) {
+    Crumbs.i2cBegin(bus, addr, reg);
+}
+
+inline I2CCrumb::~I2CCrumb() {
+    Crumbs.i2cEnd();
+}
+
+#endif // BREADCRUMBS_H
@@ -5,18 +5,23 @@
  */
 
 #include "CaptivePortal.h"
+#include "EventLog.h"
+#include "StateStore.h"
+#include "PageWriter.h"
 
 static const byte DNS_PORT = 53;
 
 CaptivePortal::CaptivePortal()
-    : _httpServer(80), _running(false), _statusMessage("Not connected"), _timeManager(nullptr) {
+    : _httpServer(80), _running(false), _networkCount(0), _timeManager(nullptr) {
+    strlcpy(_statusMessage, "Not connected", sizeof(_statusMessage));
 }
 
 bool CaptivePortal::begin() {
     // AP must already be started by the caller via WiFi.softAP()
     // We only start DNS + HTTP servers here
     IPAddress apIP = WiFi.softAPIP();
-    Serial.printf("[PORTAL] Starting servers on AP IP: %s\n", apIP.toString().c_str());
+    Log.event(LOG_SEV_INFO, "[PORTAL] Starting servers on AP IP: %u.%u.%u.%u",
+              apIP[0], apIP[1], apIP[2], apIP[3]);
 
     // Start DNS server — redirect all domains to our AP IP
     _dnsServer.start(DNS_PORT, "*", apIP);
@@ -31,7 +36,7 @@ bool CaptivePortal::begin() {
     _httpServer.begin();
     _running = true;
 
-    Serial.println("[PORTAL] HTTP server started on port 80");
+    Log.event(LOG_SEV_DEBUG, "[PORTAL] HTTP server started on port 80");
     return true;
 }
 
@@ -45,7 +50,7 @@ void CaptivePortal::stop() {
     // when transitioning AP → STA on ESP32-S3.
     _running = false;
 
-    Serial.println("[PORTAL] Stopped");
+    Log.event(LOG_SEV_INFO, "[PORTAL] Stopped");
 }
 
 void CaptivePortal::handleClient() {
@@ -54,11 +59,19 @@ void CaptivePortal::handleClient() {
     _httpServer.handleClient();
 }
 
-void CaptivePortal::setNetworkList(const String& htmlOptions) {
-    _networkOptions = htmlOptions;
+void CaptivePortal::clearNetworks() {
+    _networkCount = 0;
 }
 
-void CaptivePortal::setOnCredentials(std::function<void(const String&, const String&)> cb) {
+void CaptivePortal::addNetwork(const char* ssid, int8_t rssi, bool secure) {
+    if (_networkCount >= WIFI_MAX_NETWORKS) return;
+    Network& n = _networks[_networkCount++];
+    strlcpy(n.ssid, ssid, sizeof(n.ssid));
+    n.rssi = rssi;
+    n.secure = secure;
+}
+
+void CaptivePortal::setOnCredentials(std::function<void(const char*, const char*)> cb) {
     _onCredentials = cb;
 }
 
@@ -66,17 +79,8 @@ void CaptivePortal::setTimeManager(TimeManager* tm) {
     _timeManager = tm;
 }
 
-void CaptivePortal::setTimezone(int8_t offset, bool dst) {
-    _utcOffset = offset;
-    _dst = dst;
-}
-
-void CaptivePortal::setTimeSource(uint8_t src) {
-    _timeSource = src;
-}
-
-void CaptivePortal::setStatus(const String& status) {
-    _statusMessage = status;
+void CaptivePortal::setStatus(const char* status) {
+    strlcpy(_statusMessage, status, sizeof(_statusMessage));
 }
 
 bool CaptivePortal::isRunning() const {
@@ -84,29 +88,35 @@ bool CaptivePortal::isRunning() const {
 }
 
 void CaptivePortal::handleRoot() {
-    _httpServer.send(200, "text/html", buildPage());
+    sendPage();
 }
 
 void CaptivePortal::handleConnect() {
-    String ssid = _httpServer.arg("ssid");
-    String password = _httpServer.arg("password");
+    char ssid[WIFI_SSID_MAX + 1];
+    char password[WIFI_PASS_MAX + 1];
+    strlcpy(ssid, _httpServer.arg("ssid").c_str(), sizeof(ssid));
+    strlcpy(password, _httpServer.arg("password").c_str(), sizeof(password));
 
-    if (ssid.length() == 0) {
+    if (ssid[0] == '\0') {
         _httpServer.send(400, "text/html", "<html><body><h2>SSID required</h2><a href='/'>Back</a></body></html>");
         return;
     }
 
-    Serial.printf("[PORTAL] Credentials received: SSID=%s\n", ssid.c_str());
+    Log.event(LOG_SEV_NOTICE, "[PORTAL] Credentials received: SSID=%s", ssid);
 
-    _statusMessage = "Connecting to " + ssid + "...";
+    snprintf(_statusMessage, sizeof(_statusMessage), "Connecting to %s...", ssid);
 
-    String response = "<html><head><meta name='viewport' content='width=device-width,initial-scale=1'>";
-    response += "<style>body{font-family:sans-serif;text-align:center;padding:40px;background:#1a1a2e;color:#e0e0e0;}</style>";
-    response += "<meta http-equiv='refresh' content='5;url=/status'></head><body>";
-    response += "<h2>Connecting to " + ssid + "...</h2>";
-    response += "<p>Please wait. This page will update automatically.</p>";
-    response += "</body></html>";
-    _httpServer.send(200, "text/html", response);
+    PageWriter html(_httpServer);
+    html.begin(200, "text/html");
+    html.add("<html><head><meta name='viewport' content='width=device-width,initial-scale=1'>");
+    html.add("<style>body{font-family:sans-serif;text-align:center;padding:40px;background:#1a1a2e;color:#e0e0e0;}</style>");
+    html.add("<meta http-equiv='refresh' content='5;url=/status'></head><body>");
+    html.add("<h2>Connecting to ");
+    html.addEscaped(ssid);
+    html.add("...</h2>");
+    html.add("<p>Please wait. This page will update automatically.</p>");
+    html.add("</body></html>");
+    html.end();
 
     if (_onCredentials) {
         _onCredentials(ssid, password);
@@ -114,19 +124,27 @@ void CaptivePortal::handleConnect() {
 }
 
 void CaptivePortal::handleStatus() {
-    String json = "{\"status\":\"" + _statusMessage + "\"}";
+    char json[sizeof(_statusMessage) * 2 + 16];
+    int pos = snprintf(json, sizeof(json), "{\"status\":\"");
+    for (const char* c = _statusMessage; *c && pos < (int)sizeof(json) - 4; c++) {
+        if (*c == '"' || *c == '\\') json[pos++] = '\\';
+        json[pos++] = *c;
+    }
+    snprintf(json + pos, sizeof(json) - pos, "\"}");
     _httpServer.send(200, "application/json", json);
 }
 
 void CaptivePortal::handleTime() {
     if (_timeManager) {
         ClockTime t = _timeManager->getUTCTime();
+        ClockState clk;
+        State.clock.read(clk);
         char buf[96];
         snprintf(buf, sizeof(buf),
             "{\"h\":%d,\"m\":%d,\"s\":%d,\"Y\":%d,\"M\":%d,\"D\":%d"
             ",\"off\":%d,\"dst\":%s,\"src\":%d}",
             t.hour, t.minute, t.second, t.year, t.month, t.day,
-            _utcOffset, _dst ? "true" : "false", _timeSource);
+            clk.utcOffset, clk.dstActive ? "true" : "false", clk.timeSource);
         _httpServer.send(200, "application/json", buf);
     } else {
         _httpServer.send(200, "application/json", "{\"error\":\"no time source\"}");
@@ -139,106 +157,112 @@ void CaptivePortal::handleNotFound() {
     _httpServer.send(302, "text/plain", "");
 }
 
-String CaptivePortal::buildPage() {
-    // Get current time for initial display
-    String timeStr = "--:--:--";
-    String dateStr = "----/--/--";
+void CaptivePortal::sendPage() {
+    // Current time for the initial display
+    char timeStr[12] = "--:--:--";
+    char dateStr[12] = "----/--/--";
     if (_timeManager) {
         ClockTime t = _timeManager->getUTCTime();
-        char buf[12];
-        snprintf(buf, sizeof(buf), "%02d:%02d:%02d", t.hour, t.minute, t.second);
-        timeStr = buf;
-        snprintf(buf, sizeof(buf), "%04d/%02d/%02d", t.year, t.month, t.day);
-        dateStr = buf;
+        snprintf(timeStr, sizeof(timeStr), "%02d:%02d:%02d", t.hour, t.minute, t.second);
+        snprintf(dateStr, sizeof(dateStr), "%04d/%02d/%02d", t.year, t.month, t.day);
     }
 
-    String html = "<!DOCTYPE html><html><head>";
-    html += "<meta name='viewport' content='width=device-width,initial-scale=1'>";
-    html += "<title>WWVB Clock WiFi Setup</title>";
-    html += "<style>";
-    html += "body{font-family:sans-serif;max-width:400px;margin:20px auto;padding:15px;background:#1a1a2e;color:#e0e0e0;}";
-    html += "h1{color:#00d4ff;font-size:22px;text-align:center;margin-bottom:4px;}";
-    html += "h2{color:#aaa;font-size:14px;text-align:center;font-weight:normal;margin-top:0;}";
-    html += ".clock{text-align:center;margin:12px 0;padding:12px;background:#0d0d1a;border-radius:8px;border:1px solid #333;}";
-    html += ".clock-time{font-size:36px;font-family:monospace;color:#00ff88;letter-spacing:2px;}";
-    html += ".clock-date{font-size:14px;color:#888;margin-top:4px;}";
-    html += ".clock-label{font-size:11px;color:#666;margin-top:2px;}";
-    html += ".local-time{font-size:22px;font-family:monospace;color:#00d4ff;margin-top:8px;}";
-    html += ".src-badge{display:inline-block;margin-top:4px;padding:2px 8px;border-radius:10px;font-size:11px;background:#2a2a3e;color:#aaa;}";
-    html += ".ntp-info{text-align:center;margin:8px 0 16px;padding:8px;background:#1a2a1a;border-radius:6px;border:1px solid #2a4a2a;font-size:12px;color:#88cc88;}";
-    html += "label{display:block;margin:12px 0 4px;font-size:14px;}";
-    html += "select,input{width:100%;padding:10px;border:1px solid #444;border-radius:6px;font-size:16px;background:#2a2a3e;color:#e0e0e0;box-sizing:border-box;}";
-    html += "button{width:100%;padding:12px;margin-top:16px;background:#00d4ff;color:#000;border:none;border-radius:6px;font-size:16px;font-weight:bold;cursor:pointer;}";
-    html += "button:active{background:#00a8cc;}";
-    html += ".status{text-align:center;margin-top:12px;padding:8px;border-radius:4px;background:#2a2a3e;font-size:13px;}";
-    html += ".show{display:flex;align-items:center;gap:8px;margin-top:4px;font-size:13px;}";
-    html += ".show input{width:auto;}";
-    html += "</style></head><body>";
+    PageWriter html(_httpServer);
+    html.begin(200, "text/html");
+    html.add("<!DOCTYPE html><html><head>");
+    html.add("<meta name='viewport' content='width=device-width,initial-scale=1'>");
+    html.add("<title>WWVB Clock WiFi Setup</title>");
+    html.add("<style>");
+    html.add("body{font-family:sans-serif;max-width:400px;margin:20px auto;padding:15px;background:#1a1a2e;color:#e0e0e0;}");
+    html.add("h1{color:#00d4ff;font-size:22px;text-align:center;margin-bottom:4px;}");
+    html.add("h2{color:#aaa;font-size:14px;text-align:center;font-weight:normal;margin-top:0;}");
+    html.add(".clock{text-align:center;margin:12px 0;padding:12px;background:#0d0d1a;border-radius:8px;border:1px solid #333;}");
+    html.add(".clock-time{font-size:36px;font-family:monospace;color:#00ff88;letter-spacing:2px;}");
+    html.add(".clock-date{font-size:14px;color:#888;margin-top:4px;}");
+    html.add(".clock-label{font-size:11px;color:#666;margin-top:2px;}");
+    html.add(".local-time{font-size:22px;font-family:monospace;color:#00d4ff;margin-top:8px;}");
+    html.add(".src-badge{display:inline-block;margin-top:4px;padding:2px 8px;border-radius:10px;font-size:11px;background:#2a2a3e;color:#aaa;}");
+    html.add(".ntp-info{text-align:center;margin:8px 0 16px;padding:8px;background:#1a2a1a;border-radius:6px;border:1px solid #2a4a2a;font-size:12px;color:#88cc88;}");
+    html.add("label{display:block;margin:12px 0 4px;font-size:14px;}");
+    html.add("select,input{width:100%;padding:10px;border:1px solid #444;border-radius:6px;font-size:16px;background:#2a2a3e;color:#e0e0e0;box-sizing:border-box;}");
+    html.add("button{width:100%;padding:12px;margin-top:16px;background:#00d4ff;color:#000;border:none;border-radius:6px;font-size:16px;font-weight:bold;cursor:pointer;}");
+    html.add("button:active{background:#00a8cc;}");
+    html.add(".status{text-align:center;margin-top:12px;padding:8px;border-radius:4px;background:#2a2a3e;font-size:13px;}");
+    html.add(".show{display:flex;align-items:center;gap:8px;margin-top:4px;font-size:13px;}");
+    html.add(".show input{width:auto;}");
+    html.add("</style></head><body>");
 
     // Header
-    html += "<h1>WWVB Atomic Clock</h1>";
-    html += "<h2>WiFi Configuration</h2>";
+    html.add("<h1>WWVB Atomic Clock</h1>");
+    html.add("<h2>WiFi Configuration</h2>");
 
     // Live clock display
-    html += "<div class='clock'>";
-    html += "<div class='clock-time' id='utc'>" + timeStr + "</div>";
-    html += "<div class='clock-date' id='date'>" + dateStr + "</div>";
-    html += "<div class='clock-label'>UTC</div>";
-    html += "<div class='local-time' id='local'>--:--:--</div>";
-    html += "<div class='clock-date' id='ldate'></div>";
-    html += "<div class='clock-label'>Local</div>";
-    html += "<div class='src-badge' id='srclabel'>Checking...</div>";
-    html += "</div>";
+    html.add("<div class='clock'>");
+    html.addf("<div class='clock-time' id='utc'>%s</div>", timeStr);
+    html.addf("<div class='clock-date' id='date'>%s</div>", dateStr);
+    html.add("<div class='clock-label'>UTC</div>");
+    html.add("<div class='local-time' id='local'>--:--:--</div>");
+    html.add("<div class='clock-date' id='ldate'></div>");
+    html.add("<div class='clock-label'>Local</div>");
+    html.add("<div class='src-badge' id='srclabel'>Checking...</div>");
+    html.add("</div>");
 
     // NTP server info
-    html += "<div class='ntp-info'>";
-    html += "NTP Server active on 192.168.4.1:123<br>";
-    html += "Stratum 1 | Reference: WWVB";
-    html += "</div>";
+    html.add("<div class='ntp-info'>");
+    html.add("NTP Server active on 192.168.4.1:123<br>");
+    html.add("Stratum 1 | Reference: WWVB");
+    html.add("</div>");
 
     // WiFi form
-    html += "<form action='/connect' method='POST'>";
-    html += "<label>Network:</label>";
-    html += "<select name='ssid'>";
-    if (_networkOptions.length() > 0) {
-        html += _networkOptions;
-    } else {
-        html += "<option value=''>No networks scanned</option>";
+    html.add("<form action='/connect' method='POST'>");
+    html.add("<label>Network:</label>");
+    html.add("<select name='ssid'>");
+    for (uint8_t i = 0; i < _networkCount; i++) {
+        const Network& n = _networks[i];
+        html.add("<option value='");
+        html.addEscaped(n.ssid);
+        html.add("'>");
+        html.addEscaped(n.ssid);
+        html.addf(" (%d dBm)%s</option>", n.rssi, n.secure ? " secured" : "");
+    }
+    if (_networkCount == 0) {
+        html.add("<option value=''>No networks scanned</option>");
     }
-    html += "</select>";
-    html += "<label>Password:</label>";
-    html += "<input type='password' name='password' id='pw' placeholder='Enter WiFi password'>";
-    html += "<div class='show'><input type='checkbox' onclick=\"document.getElementById('pw').type=this.checked?'text':'password'\"> Show password</div>";
-    html += "<button type='submit'>Connect</button>";
-    html += "</form>";
-    html += "<div class='status'>" + _statusMessage + "</div>";
+    html.add("</select>");
+    html.add("<label>Password:</label>");
+    html.add("<input type='password' name='password' id='pw' placeholder='Enter WiFi password'>");
+    html.add("<div class='show'><input type='checkbox' onclick=\"document.getElementById('pw').type=this.checked?'text':'password'\"> Show password</div>");
+    html.add("<button type='submit'>Connect</button>");
+    html.add("</form>");
+    html.add("<div class='status'>");
+    html.addEscaped(_statusMessage);
+    html.add("</div>");
 
     // JavaScript: poll /time every second, show UTC + local + source badge
-    html += "<script>";
-    html += "function pad(n){return n<10?'0'+n:n;}";
-    html += "var _srcNames=['No sync','RTC','NTP','WWVB'];";
-    html += "function tick(){fetch('/time').then(r=>r.json()).then(d=>{";
-    html += "if(d.h===undefined)return;";
+    html.add("<script>");
+    html.add("function pad(n){return n<10?'0'+n:n;}");
+    html.add("var _srcNames=['No sync','RTC','NTP','WWVB'];");
+    html.add("function tick(){fetch('/time').then(r=>r.json()).then(d=>{");
+    html.add("if(d.h===undefined)return;");
     // UTC display
-    html += "document.getElementById('utc').textContent=pad(d.h)+':'+pad(d.m)+':'+pad(d.s);";
-    html += "document.getElementById('date').textContent=d.Y+'/'+pad(d.M)+'/'+pad(d.D);";
+    html.add("document.getElementById('utc').textContent=pad(d.h)+':'+pad(d.m)+':'+pad(d.s);");
+    html.add("document.getElementById('date').textContent=d.Y+'/'+pad(d.M)+'/'+pad(d.D);");
     // Local time: use Date.UTC to handle day/month rollovers correctly
-    html += "var utcMs=Date.UTC(d.Y,d.M-1,d.D,d.h,d.m,d.s);";
-    html += "var lms=utcMs+(d.off||0)*3600000;";
-    html += "var ld=new Date(lms);";
-    html += "document.getElementById('local').textContent=pad(ld.getUTCHours())+':'+pad(ld.getUTCMinutes())+':'+pad(ld.getUTCSeconds());";
-    html += "document.getElementById('ldate').textContent=ld.getUTCFullYear()+'/'+pad(ld.getUTCMonth()+1)+'/'+pad(ld.getUTCDate());";
+    html.add("var utcMs=Date.UTC(d.Y,d.M-1,d.D,d.h,d.m,d.s);");
+    html.add("var lms=utcMs+(d.off||0)*3600000;");
+    html.add("var ld=new Date(lms);");
+    html.add("document.getElementById('local').textContent=pad(ld.getUTCHours())+':'+pad(ld.getUTCMinutes())+':'+pad(ld.getUTCSeconds());");
+    html.add("document.getElementById('ldate').textContent=ld.getUTCFullYear()+'/'+pad(ld.getUTCMonth()+1)+'/'+pad(ld.getUTCDate());");
     // Source badge
-    html += "var sl=document.getElementById('srclabel');";
-    html += "var sn=_srcNames[d.src||0]||'?';";
-    html += "sl.textContent=sn;";
-    html += "sl.style.background=d.src>=3?'#1a3a1a':d.src>=1?'#2a2a1a':'#2a2a2a';";
-    html += "sl.style.color=d.src>=3?'#88cc88':d.src>=1?'#cccc88':'#888';";
-    html += "}).catch(()=>{});}";
-    html += "setInterval(tick,1000);tick();";
-    html += "</script>";
-
-    html += "</body></html>";
-
-    return html;
+    html.add("var sl=document.getElementById('srclabel');");
+    html.add("var sn=_srcNames[d.src||0]||'?';");
+    html.add("sl.textContent=sn;");
+    html.add("sl.style.background=d.src>=3?'#1a3a1a':d.src>=1?'#2a2a1a':'#2a2a2a';");
+    html.add("sl.style.color=d.src>=3?'#88cc88':d.src>=1?'#cccc88':'#888';");
+    html.add("}).catch(()=>{});}");
+    html.add("setInterval(tick,1000);tick();");
+    html.add("</script>");
+
+    html.add("</body></html>");
+    html.end();
 }
@@ -37,38 +37,31 @@ public:
     void handleClient();
 
     /**
-     * @brief Update the network list shown in the HTML form
-     * @param htmlOptions HTML <option> tags for each scanned network
+     * @brief Empty the network list shown in the HTML form
      */
-    void setNetworkList(const String& htmlOptions);
+    void clearNetworks();
+
+    /**
+     * @brief Add a scanned network to the form (up to WIFI_MAX_NETWORKS)
+     */
+    void addNetwork(const char* ssid, int8_t rssi, bool secure);
 
     /**
      * @brief Set callback for when credentials are submitted
      * @param cb Callback receiving (ssid, password)
      */
-    void setOnCredentials(std::function<void(const String&, const String&)> cb);
+    void setOnCredentials(std::function<void(const char*, const char*)> cb);
 
     /**
      * @brief Set the connection status message shown on the portal
      */
-    void setStatus(const String& status);
+    void setStatus(const char* status);
 
     /**
      * @brief Set time manager for clock display on portal
      */
     void setTimeManager(TimeManager* tm);
 
-    /**
-     * @brief Set the current UTC offset and DST state for local time display
-     */
-    void setTimezone(int8_t offset, bool dst);
-
-    /**
-     * @brief Set the current time source for status badge on portal
-     * @param src 0=None, 1=RTC, 2=NTP, 3=WWVB
-     */
-    void setTimeSource(uint8_t src);
-
     /**
      * @brief Check if portal is running
      */
@@ -78,20 +71,23 @@ private:
     WebServer _httpServer;
     DNSServer _dnsServer;
     bool _running;
-    String _networkOptions;
-    String _statusMessage;
+    struct Network {
+        char   ssid[WIFI_SSID_MAX + 1];
+        int8_t rssi;
+        bool   secure;
+    };
+    Network _networks[WIFI_MAX_NETWORKS];
+    uint8_t _networkCount;
+    char    _statusMessage[WIFI_SSID_MAX + 24];
     TimeManager* _timeManager;
-    int8_t  _utcOffset  = 0;
-    bool    _dst        = false;
-    uint8_t _timeSource = 0;
-    std::function<void(const String&, const String&)> _onCredentials;
+    std::function<void(const char*, const char*)> _onCredentials;
 
     void handleRoot();
     void handleConnect();
     void handleStatus();
     void handleTime();
     void handleNotFound();
-    String buildPage();
+    void sendPage();
 };
 
 #endif // CAPTIVEPORTAL_H
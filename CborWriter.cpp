@@ -0,0 +1,128 @@
+/**
+ * @file      CborWriter.cpp
+ * @brief     CBOR encoder implementation
+ */
+
+#include "CborWriter.h"
+
+#define CBOR_UINT        0
+#define CBOR_NEGINT      1
+#define CBOR_BYTES       2
+#define CBOR_TEXT        3
+#define CBOR_ARRAY       4
+#define CBOR_MAP         5
+#define CBOR_SIMPLE      7
+
+#define CBOR_FALSE       0xF4
+#define CBOR_TRUE        0xF5
+#define CBOR_NULL        0xF6
+#define CBOR_FLOAT32     0xFA
+#define CBOR_BREAK       0xFF
+#define CBOR_INDEFINITE  31
+
+CborWriter::CborWriter(uint8_t* buf, size_t cap)
+    : _buf(buf), _cap(cap), _pos(0), _ok(true) {
+}
+
+void CborWriter::put(uint8_t b) {
+    if (!_ok || _pos >= _cap) {
+        _ok = false;
+        return;
+    }
+    _buf[_pos++] = b;
+}
+
+void CborWriter::put(const uint8_t* p, size_t n) {
+    if (!_ok || n > _cap - _pos) {
+        _ok = false;
+        return;
+    }
+    memcpy(_buf + _pos, p, n);
+    _pos += n;
+}
+
+// Initial byte plus 0/1/2/4/8-byte big-endian argument, shortest form
+void CborWriter::head(uint8_t major, uint64_t v) {
+    uint8_t h[9];
+    size_t n;
+    major <<= 5;
+    if (v < 24) {
+        h[0] = major | (uint8_t)v;
+        n = 1;
+    } else if (v <= 0xFF) {
+        h[0] = major | 24;
+        h[1] = (uint8_t)v;
+        n = 2;
+    } else if (v <= 0xFFFF) {
+        h[0] = major | 25;
+        h[1] = v >> 8;
+        h[2] = v & 0xFF;
+        n = 3;
+    } else if (v <= 0xFFFFFFFFULL) {
+        h[0] = major | 26;
+        for (uint8_t i = 0; i < 4; i++) h[1 + i] = (v >> (24 - 8 * i)) & 0xFF;
+        n = 5;
+    } else {
+        h[0] = major | 27;
+        for (uint8_t i = 0; i < 8; i++) h[1 + i] = (v >> (56 - 8 * i)) & 0xFF;
+        n = 9;
+    }
+    put(h, n);
+}
+
+void CborWriter::beginMap() {
+    put((CBOR_MAP << 5) | CBOR_INDEFINITE);
+}
+
+void CborWriter::beginMap(size_t pairs) {
+    head(CBOR_MAP, pairs);
+}
+
+void CborWriter::beginArray() {
+    put((CBOR_ARRAY << 5) | CBOR_INDEFINITE);
+}
+
+void CborWriter::beginArray(size_t items) {
+    head(CBOR_ARRAY, items);
+}
+
+void CborWriter::end() {
+    put(CBOR_BREAK);
+}
+
+void CborWriter::unsignedInt(uint64_t v) {
+    head(CBOR_UINT, v);
+}
+
+void CborWriter::signedInt(int64_t v) {
+    if (v >= 0) head(CBOR_UINT, (uint64_t)v);
+    else        head(CBOR_NEGINT, (uint64_t)(-1 - v));
+}
+
+void CborWriter::boolean(bool v) {
+    put(v ? CBOR_TRUE : CBOR_FALSE);
+}
+
+void CborWriter::null() {
+    put(CBOR_NULL);
+}
+
+void CborWriter::float32(float v) {
+    uint32_t bits;
+    memcpy(&bits, &v, 4);
+    uint8_t h[5] = { CBOR_FLOAT32,
+                     (uint8_t)(bits >> 24), (uint8_t)(bits >> 16),
+                     (uint8_t)(bits >> 8),  (uint8_t)bits };
+    put(h, sizeof(h));
+}
+
+void CborWriter::text(const char* s) {
+    size_t n = strlen(s);
+    head(CBOR_TEXT, n);
+    put((const uint8_t*)s, n);
+}
+
+void CborWriter::bytes(const uint8_t* data, size_t len) {
+    head(CBOR_BYTES, len);
+    put(data, len);
+}
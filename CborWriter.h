@@ -0,0 +1,57 @@
+/**
+ * @file      CborWriter.h
+ * @brief     Zero-allocation CBOR (RFC 8949) encoder into a caller buffer
+ * @details   Emits the shortest head for every integer and length. Maps and
+ *            arrays may be definite (count known up front) or indefinite
+ *            (closed with end()), which suits documents with optional blocks.
+ *            Running out of space sets a sticky error instead of truncating
+ *            mid-item; check ok() before sending.
+ */
+
+#ifndef CBORWRITER_H
+#define CBORWRITER_H
+
+#include <Arduino.h>
+
+class CborWriter {
+public:
+    CborWriter(uint8_t* buf, size_t cap);
+
+    void beginMap();                 // Indefinite-length; close with end()
+    void beginMap(size_t pairs);
+    void beginArray();               // Indefinite-length; close with end()
+    void beginArray(size_t items);
+    void end();                      // Break code for the innermost indefinite container
+
+    void unsignedInt(uint64_t v);
+    void signedInt(int64_t v);
+    void boolean(bool v);
+    void null();
+    void float32(float v);
+    void text(const char* s);
+    void bytes(const uint8_t* data, size_t len);
+
+    // Map-entry shorthands: key followed by value
+    void key(const char* k) { text(k); }
+    void kv(const char* k, uint64_t v)    { text(k); unsignedInt(v); }
+    void kvInt(const char* k, int64_t v)  { text(k); signedInt(v); }
+    void kvBool(const char* k, bool v)    { text(k); boolean(v); }
+    void kvFloat(const char* k, float v)  { text(k); float32(v); }
+    void kvText(const char* k, const char* v) { text(k); text(v); }
+
+    bool ok() const { return _ok; }
+    size_t size() const { return _pos; }
+    const uint8_t* data() const { return _buf; }
+
+private:
+    uint8_t* _buf;
+    size_t   _cap;
+    size_t   _pos;
+    bool     _ok;
+
+    void head(uint8_t major, uint64_t v);
+    void put(const uint8_t* p, size_t n);
+    void put(uint8_t b);
+};
+
+#endif // CBORWRITER_H
@@ -0,0 +1,161 @@
+/**
+ * @file      ClientAnalytics.cpp
+ * @brief     Client population sketches implementation
+ */
+
+#include "ClientAnalytics.h"
+#include <math.h>
+
+// Independent seeds for the count-min rows; row hashes are mix(ip ^ seed)
+static const uint32_t CMS_SEEDS[] = {
+    0x9E3779B9, 0x85EBCA6B, 0xC2B2AE35, 0x27D4EB2F,
+    0x165667B1, 0xD3A2646C, 0xFD7046C5, 0xB55A4F09
+};
+static_assert(CLIENT_CMS_DEPTH <= sizeof(CMS_SEEDS) / sizeof(CMS_SEEDS[0]),
+              "add seeds for a deeper count-min sketch");
+
+ClientAnalytics::ClientAnalytics() {
+    reset();
+}
+
+void ClientAnalytics::reset() {
+    memset(_hll, 0, sizeof(_hll));
+    memset(_cms, 0, sizeof(_cms));
+    memset(_top, 0, sizeof(_top));
+    memset(_poll, 0, sizeof(_poll));
+    memset(_version, 0, sizeof(_version));
+    _topUsed = 0;
+    _total   = 0;
+}
+
+// MurmurHash3 32-bit finalizer: full avalanche, enough for 32-bit keys
+uint32_t ClientAnalytics::mix(uint32_t x) {
+    x ^= x >> 16;
+    x *= 0x85EBCA6B;
+    x ^= x >> 13;
+    x *= 0xC2B2AE35;
+    x ^= x >> 16;
+    return x;
+}
+
+void ClientAnalytics::record(uint32_t ipv4, uint8_t version, int8_t poll) {
+    _total++;
+
+    // HyperLogLog: top bits pick the register, the rank of the first set
+    // bit in the rest is the observation
+    uint32_t h = mix(ipv4);
+    uint32_t idx = h >> (32 - CLIENT_HLL_PRECISION);
+    uint32_t w = h << CLIENT_HLL_PRECISION;
+    uint8_t rank = w ? (uint8_t)(__builtin_clz(w) + 1) : (uint8_t)(32 - CLIENT_HLL_PRECISION + 1);
+    if (rank > _hll[idx]) _hll[idx] = rank;
+
+    updateTop(ipv4, cmsAdd(ipv4));
+
+    if (poll < 0) poll = 0;
+    if (poll >= CLIENT_POLL_BUCKETS) poll = CLIENT_POLL_BUCKETS - 1;
+    _poll[poll]++;
+
+    _version[version & 0x07]++;
+}
+
+uint32_t ClientAnalytics::cmsAdd(uint32_t ipv4) {
+    uint32_t est = UINT32_MAX;
+    for (uint8_t d = 0; d < CLIENT_CMS_DEPTH; d++) {
+        uint32_t& c = _cms[d][mix(ipv4 ^ CMS_SEEDS[d]) % CLIENT_CMS_WIDTH];
+        if (c < UINT32_MAX) c++;
+        if (c < est) est = c;
+    }
+    return est;
+}
+
+void ClientAnalytics::updateTop(uint32_t ipv4, uint32_t estimate) {
+    uint8_t minIdx = 0;
+    for (uint8_t i = 0; i < _topUsed; i++) {
+        if (_top[i].ip == ipv4) {
+            _top[i].count = estimate;
+            return;
+        }
+        if (_top[i].count < _top[minIdx].count) minIdx = i;
+    }
+    if (_topUsed < CLIENT_TOPK) {
+        _top[_topUsed].ip = ipv4;
+        _top[_topUsed].count = estimate;
+        _topUsed++;
+    } else if (estimate > _top[minIdx].count) {
+        _top[minIdx].ip = ipv4;
+        _top[minIdx].count = estimate;
+    }
+}
+
+uint32_t ClientAnalytics::getDistinctClients() const {
+    const float m = (float)CLIENT_HLL_REGISTERS;
+    float sum = 0.0f;
+    uint32_t zeros = 0;
+    for (uint32_t i = 0; i < CLIENT_HLL_REGISTERS; i++) {
+        sum += ldexpf(1.0f, -(int)_hll[i]);
+        if (_hll[i] == 0) zeros++;
+    }
+    float est = (0.7213f / (1.0f + 1.079f / m)) * m * m / sum;
+
+    // Small-range correction (linear counting) covers any realistic LAN
+    if (est <= 2.5f * m && zeros > 0) {
+        est = m * logf(m / (float)zeros);
+    }
+    return (uint32_t)(est + 0.5f);
+}
+
+uint32_t ClientAnalytics::getTotalRequests() const {
+    return _total;
+}
+
+uint32_t ClientAnalytics::getPollCount(uint8_t exponent) const {
+    return exponent < CLIENT_POLL_BUCKETS ? _poll[exponent] : 0;
+}
+
+uint32_t ClientAnalytics::getVersionCount(uint8_t version) const {
+    return version < CLIENT_VERSIONS ? _version[version] : 0;
+}
+
+uint8_t ClientAnalytics::getTopClients(HeavyHitter* out) const {
+    memcpy(out, _top, _topUsed * sizeof(HeavyHitter));
+    // Insertion sort, descending; K is tiny
+    for (uint8_t i = 1; i < _topUsed; i++) {
+        HeavyHitter v = out[i];
+        int8_t j = i - 1;
+        while (j >= 0 && out[j].count < v.count) {
+            out[j + 1] = out[j];
+            j--;
+        }
+        out[j + 1] = v;
+    }
+    return _topUsed;
+}
+
+int ClientAnalytics::toJson(char* buf, size_t len) const {
+    int pos = snprintf(buf, len, "{\"distinct\":%lu,\"req\":%lu,\"ver\":[",
+                       (unsigned long)getDistinctClients(), (unsigned long)_total);
+    for (uint8_t i = 0; i < CLIENT_VERSIONS && pos < (int)len - 12; i++) {
+        pos += snprintf(buf + pos, len - pos, "%s%lu", i > 0 ? "," : "",
+                        (unsigned long)_version[i]);
+    }
+    if (pos < (int)len - 10) pos += snprintf(buf + pos, len - pos, "],\"poll\":[");
+    for (uint8_t i = 0; i < CLIENT_POLL_BUCKETS && pos < (int)len - 12; i++) {
+        pos += snprintf(buf + pos, len - pos, "%s%lu", i > 0 ? "," : "",
+                        (unsigned long)_poll[i]);
+    }
+    if (pos < (int)len - 10) pos += snprintf(buf + pos, len - pos, "],\"top\":[");
+
+    HeavyHitter top[CLIENT_TOPK];
+    uint8_t n = getTopClients(top);
+    for (uint8_t i = 0; i < n && pos < (int)len - 40; i++) {
+        // lwIP stores the address in network order: first octet in the low byte
+        uint32_t ip = top[i].ip;
+        pos += snprintf(buf + pos, len - pos, "%s{\"ip\":\"%u.%u.%u.%u\",\"n\":%lu}",
+                        i > 0 ? "," : "",
+                        (unsigned)(ip & 0xFF), (unsigned)((ip >> 8) & 0xFF),
+                        (unsigned)((ip >> 16) & 0xFF), (unsigned)(ip >> 24),
+                        (unsigned long)top[i].count);
+    }
+    if (pos < (int)len - 2) pos += snprintf(buf + pos, len - pos, "]}");
+    return pos < (int)len ? pos : (int)len - 1;
+}
@@ -0,0 +1,81 @@
+/**
+ * @file      ClientAnalytics.h
+ * @brief     Streaming sketches of the NTP client population
+ * @details   Fixed memory regardless of how many hosts poll the clock:
+ *            - HyperLogLog estimate of distinct client addresses
+ *            - Count-min sketch with a small top-K list for heavy hitters
+ *            - Histogram of the requested poll exponent (log2 seconds)
+ *            - NTP version mix
+ *            Counts run from boot. No allocation. Not thread-safe: NTPServer
+ *            feeds it from the loop task only.
+ */
+
+#ifndef CLIENTANALYTICS_H
+#define CLIENTANALYTICS_H
+
+#include <Arduino.h>
+#include "config.h"
+
+#define CLIENT_HLL_REGISTERS   (1u << CLIENT_HLL_PRECISION)
+
+// Poll exponents 0..17 (1 s .. 36 h); out-of-range values are clamped
+#define CLIENT_POLL_BUCKETS    18
+#define CLIENT_VERSIONS        8
+
+class ClientAnalytics {
+public:
+    struct HeavyHitter {
+        uint32_t ip;      // Network byte order, as stored by lwIP
+        uint32_t count;   // Count-min estimate (never under the true count)
+    };
+
+    ClientAnalytics();
+
+    /**
+     * @brief Account one accepted request
+     * @param ipv4    Client address (network byte order)
+     * @param version NTP version field (0-7)
+     * @param poll    Requested poll exponent (header byte 2, signed)
+     */
+    void record(uint32_t ipv4, uint8_t version, int8_t poll);
+
+    /**
+     * @brief Forget everything
+     */
+    void reset();
+
+    uint32_t getDistinctClients() const;     // HyperLogLog estimate
+    uint32_t getTotalRequests() const;
+    uint32_t getPollCount(uint8_t exponent) const;
+    uint32_t getVersionCount(uint8_t version) const;
+
+    /**
+     * @brief Heavy-hitter candidates, largest estimate first
+     * @param out Array of at least CLIENT_TOPK entries
+     * @return Number of entries written
+     */
+    uint8_t getTopClients(HeavyHitter* out) const;
+
+    /**
+     * @brief Write the full report as a JSON object
+     * @return Characters written (snprintf semantics, clipped to len)
+     * @details {"distinct":N,"req":N,"ver":[v0..v7],"poll":[p0..p17],
+     *          "top":[{"ip":"a.b.c.d","n":N},...]}
+     */
+    int toJson(char* buf, size_t len) const;
+
+private:
+    uint8_t  _hll[CLIENT_HLL_REGISTERS];
+    uint32_t _cms[CLIENT_CMS_DEPTH][CLIENT_CMS_WIDTH];
+    HeavyHitter _top[CLIENT_TOPK];
+    uint8_t  _topUsed;
+    uint32_t _poll[CLIENT_POLL_BUCKETS];
+    uint32_t _version[CLIENT_VERSIONS];
+    uint32_t _total;
+
+    static uint32_t mix(uint32_t x);
+    uint32_t cmsAdd(uint32_t ipv4);
+    void     updateTop(uint32_t ipv4, uint32_t estimate);
+};
+
+#endif // CLIENTANALYTICS_H
@@ -0,0 +1,152 @@
+/**
+ * @file      ClockDiscipline.cpp
+ * @brief     WWVB Phase/Frequency Estimator Implementation
+ */
+
+#include "ClockDiscipline.h"
+
+ClockDiscipline::ClockDiscipline()
+    : _head(0), _count(0), _total(0), _aging(0),
+      _phaseUs(0), _freqPpm(0.0f) {
+    memset(_window, 0, sizeof(_window));
+}
+
+void ClockDiscipline::reset() {
+    _head    = 0;
+    _count   = 0;
+    _phaseUs = 0;
+    _freqPpm = 0.0f;
+}
+
+// ============================================================================
+// Measurements
+// ============================================================================
+void ClockDiscipline::addMeasurement(unsigned long atMs, int32_t offsetUs) {
+    // A long gap means the run was interrupted (daytime, failed receptions);
+    // the clock may have been stepped since, so start a fresh window.
+    if (_count > 0 && (atMs - newest().atMs) > DISCIPLINE_MAX_GAP_MS) {
+        reset();
+    }
+
+    _window[_head].atMs     = atMs;
+    _window[_head].offsetUs = offsetUs;
+    _head = (_head + 1) % DISCIPLINE_WINDOW;
+    if (_count < DISCIPLINE_WINDOW) _count++;
+    _total++;
+    fit();
+}
+
+void ClockDiscipline::fit() {
+    if (_count == 0) {
+        _phaseUs = 0;
+        _freqPpm = 0.0f;
+        return;
+    }
+
+    // Least-squares line through (seconds since oldest, offset µs).
+    // Slope in µs/s is the frequency error in ppm.
+    unsigned long t0 = oldest().atMs;
+    float sumT = 0.0f, sumY = 0.0f;
+    for (uint8_t i = 0; i < _count; i++) {
+        const Sample& s = _window[(_head + DISCIPLINE_WINDOW - _count + i) % DISCIPLINE_WINDOW];
+        sumT += (float)(s.atMs - t0) / 1000.0f;
+        sumY += (float)s.offsetUs;
+    }
+    float meanT = sumT / _count;
+    float meanY = sumY / _count;
+
+    float sxx = 0.0f, sxy = 0.0f;
+    for (uint8_t i = 0; i < _count; i++) {
+        const Sample& s = _window[(_head + DISCIPLINE_WINDOW - _count + i) % DISCIPLINE_WINDOW];
+        float dt = (float)(s.atMs - t0) / 1000.0f - meanT;
+        sxx += dt * dt;
+        sxy += dt * ((float)s.offsetUs - meanY);
+    }
+    _freqPpm = (sxx > 0.0f) ? (sxy / sxx) : 0.0f;
+
+    float tNewest = (float)(newest().atMs - t0) / 1000.0f;
+    _phaseUs = (int32_t)lroundf(meanY + _freqPpm * (tNewest - meanT));
+}
+
+// ============================================================================
+// Corrections
+// ============================================================================
+int32_t ClockDiscipline::takePhaseCorrectionUs() {
+    if (_count == 0) return 0;
+    if (_phaseUs < DISCIPLINE_PHASE_DEADBAND_US && _phaseUs > -DISCIPLINE_PHASE_DEADBAND_US) {
+        return 0;
+    }
+
+    int32_t corr = _phaseUs / DISCIPLINE_PHASE_GAIN_DIV;
+    if (corr == 0) return 0;
+
+    // Re-express the window as if the correction had always been applied,
+    // so the frequency fit is unaffected by our own phase trims.
+    for (uint8_t i = 0; i < _count; i++) {
+        _window[(_head + DISCIPLINE_WINDOW - _count + i) % DISCIPLINE_WINDOW].offsetUs -= corr;
+    }
+    fit();
+    return corr;
+}
+
+bool ClockDiscipline::takeAgingUpdate(int8_t& outAging) {
+    if (!hasFrequency()) return false;
+    if (_freqPpm < DISCIPLINE_FREQ_DEADBAND_PPM && _freqPpm > -DISCIPLINE_FREQ_DEADBAND_PPM) {
+        return false;
+    }
+
+    // Positive aging slows the DS3231 oscillator; a fast clock needs a larger value
+    long steps = lroundf(_freqPpm / DISCIPLINE_AGING_PPM_PER_LSB);
+    if (steps >  DISCIPLINE_MAX_AGING_STEP) steps =  DISCIPLINE_MAX_AGING_STEP;
+    if (steps < -DISCIPLINE_MAX_AGING_STEP) steps = -DISCIPLINE_MAX_AGING_STEP;
+
+    long next = (long)_aging + steps;
+    if (next >  127) next =  127;
+    if (next < -127) next = -127;
+    if (next == _aging) return false;
+
+    _aging   = (int8_t)next;
+    outAging = _aging;
+    reset();  // The frequency changed; the old slope no longer applies
+    return true;
+}
+
+void ClockDiscipline::setAgingOffset(int8_t aging) {
+    _aging = aging;
+}
+
+int8_t ClockDiscipline::getAgingOffset() const {
+    return _aging;
+}
+
+// ============================================================================
+// Accessors
+// ============================================================================
+uint8_t ClockDiscipline::getCount() const {
+    return _count;
+}
+
+uint32_t ClockDiscipline::getTotalCount() const {
+    return _total;
+}
+
+int32_t ClockDiscipline::getPhaseUs() const {
+    return _phaseUs;
+}
+
+float ClockDiscipline::getFrequencyPpm() const {
+    return _freqPpm;
+}
+
+bool ClockDiscipline::hasFrequency() const {
+    return _count >= DISCIPLINE_MIN_POINTS &&
+           (newest().atMs - oldest().atMs) >= DISCIPLINE_MIN_SPAN_S * 1000UL;
+}
+
+const ClockDiscipline::Sample& ClockDiscipline::oldest() const {
+    return _window[(_head + DISCIPLINE_WINDOW - _count) % DISCIPLINE_WINDOW];
+}
+
+const ClockDiscipline::Sample& ClockDiscipline::newest() const {
+    return _window[(_head + DISCIPLINE_WINDOW - 1) % DISCIPLINE_WINDOW];
+}
@@ -0,0 +1,81 @@
+/**
+ * @file      ClockDiscipline.h
+ * @brief     Phase and frequency estimator fed by WWVB tracking measurements
+ * @details   Each measurement is the offset of the DS3231-held second from the
+ *            WWVB second (µs, positive = local clock ahead). A least-squares fit
+ *            over a sliding window yields the current phase error and the DS3231
+ *            frequency error. The phase error is removed gradually by trimming the
+ *            SQW phase anchor; the frequency error is removed in 0.1 ppm steps of
+ *            the DS3231 aging offset register.
+ */
+
+#ifndef CLOCKDISCIPLINE_H
+#define CLOCKDISCIPLINE_H
+
+#include <Arduino.h>
+#include "config.h"
+
+class ClockDiscipline {
+public:
+    ClockDiscipline();
+
+    /**
+     * @brief Add one phase measurement
+     * @param atMs     millis() when the measurement was taken
+     * @param offsetUs WWVB second boundary minus local second boundary
+     *                 (positive = local clock ahead of WWVB)
+     */
+    void addMeasurement(unsigned long atMs, int32_t offsetUs);
+
+    /**
+     * @brief Take the next slice of phase correction
+     * @return Microseconds to move the local second boundary later (negative =
+     *         earlier). The window is adjusted so the fit stays consistent.
+     */
+    int32_t takePhaseCorrectionUs();
+
+    /**
+     * @brief Take a DS3231 aging-offset update once the frequency fit is trusted
+     * @param outAging Output: new aging register value
+     * @return true if the register should be written; the window restarts
+     */
+    bool takeAgingUpdate(int8_t& outAging);
+
+    /**
+     * @brief Current aging register value (read from the DS3231 at boot)
+     */
+    void setAgingOffset(int8_t aging);
+    int8_t getAgingOffset() const;
+
+    /**
+     * @brief Forget all measurements (e.g. after the clock was stepped)
+     */
+    void reset();
+
+    uint8_t  getCount() const;
+    uint32_t getTotalCount() const;
+    int32_t  getPhaseUs() const;        // Fitted phase at the newest measurement
+    float    getFrequencyPpm() const;   // Fitted slope; positive = DS3231 fast
+    bool     hasFrequency() const;      // Window spans DISCIPLINE_MIN_SPAN_S
+
+private:
+    struct Sample {
+        unsigned long atMs;
+        int32_t       offsetUs;
+    };
+
+    Sample   _window[DISCIPLINE_WINDOW];
+    uint8_t  _head;
+    uint8_t  _count;
+    uint32_t _total;
+    int8_t   _aging;
+
+    int32_t  _phaseUs;
+    float    _freqPpm;
+
+    void fit();
+    const Sample& oldest() const;
+    const Sample& newest() const;
+};
+
+#endif // CLOCKDISCIPLINE_H
@@ -0,0 +1,246 @@
+/**
+ * @file      ClockQuality.cpp
+ * @brief     Clock-quality state machine implementation
+ */
+
+#include "ClockQuality.h"
+#include "SyncCadence.h"
+#include "EventLog.h"
+#include "CborWriter.h"
+
+static const uint32_t STATE_LIMIT_US[CQ_FREERUN] = {
+    CQ_LOCKED_MAX_US, CQ_HOLDOVER_MAX_US, CQ_DEGRADED_MAX_US
+};
+
+static const char* const STATE_NAMES[CQ_STATE_COUNT] = {
+    "LOCKED", "HOLDOVER", "DEGRADED", "FREERUN"
+};
+
+// Bound after ageS seconds at driftPpb (ns per s), saturating at UINT32_MAX
+static uint32_t growBound(uint32_t baseUs, uint32_t ageS, uint32_t driftPpb) {
+    uint64_t us = (uint64_t)baseUs + (uint64_t)ageS * driftPpb / 1000ULL;
+    return us > 0xFFFFFFFFULL ? 0xFFFFFFFFUL : (uint32_t)us;
+}
+
+// Reference ID as text: four ASCII characters for stratum 1/16, else dotted IPv4
+static void formatRefId(const uint8_t id[4], uint8_t stratum, char* out, size_t len) {
+    if (stratum >= 2 && stratum < 16) {
+        snprintf(out, len, "%u.%u.%u.%u", id[0], id[1], id[2], id[3]);
+    } else {
+        snprintf(out, len, "%.4s", (const char*)id);
+    }
+}
+
+ClockQuality::ClockQuality()
+    : _cadence(nullptr), _state(CQ_FREERUN), _settled(false), _valid(false),
+      _stratum(16), _leap(0), _syncUnix(0), _syncErrorUs(0), _enteredMs(0),
+      _transitions(0), _violations(0) {
+    memcpy(_refId, "LOCL", 4);
+}
+
+void ClockQuality::begin(const SyncCadence* cadence) {
+    _cadence = cadence;
+}
+
+// ============================================================================
+// Persistence
+// ============================================================================
+void ClockQuality::load(Preferences& prefs) {
+    _valid = prefs.getBool("cqOk", false);
+    if (!_valid) return;
+    _stratum     = prefs.getUChar("cqStr", 16);
+    _syncUnix    = prefs.getULong("cqRef", 0);
+    _syncErrorUs = prefs.getULong("cqErr", 0) + CQ_RESTORE_ERROR_US;
+    if (prefs.getBytes("cqId", _refId, sizeof(_refId)) != sizeof(_refId) ||
+        _stratum < 1 || _stratum > 2 || _syncUnix == 0) {
+        invalidate();
+    }
+}
+
+void ClockQuality::save(Preferences& prefs) const {
+    prefs.putBool("cqOk", _valid);
+    prefs.putUChar("cqStr", _stratum);
+    prefs.putULong("cqRef", _syncUnix);
+    prefs.putULong("cqErr", _syncErrorUs);
+    prefs.putBytes("cqId", _refId, sizeof(_refId));
+}
+
+// ============================================================================
+// Inputs
+// ============================================================================
+void ClockQuality::noteSync(uint8_t stratum, const uint8_t refId[4], uint32_t syncUnix,
+                            uint32_t errorUs) {
+    _valid       = true;
+    _stratum     = stratum;
+    _syncUnix    = syncUnix;
+    _syncErrorUs = errorUs;
+    memcpy(_refId, refId, 4);
+    update(syncUnix);
+}
+
+void ClockQuality::checkCorrection(int32_t correctionUs, uint32_t unixNow) {
+    if (!_valid) return;
+    uint32_t bound = getErrorBoundUs(unixNow);
+    uint32_t mag = correctionUs < 0 ? (uint32_t)(-(int64_t)correctionUs) : (uint32_t)correctionUs;
+    if (mag <= bound) return;
+    _violations++;
+    Log.event(LOG_SEV_WARNING, "[QUALITY] Correction %+ldus exceeded the %luus error bound",
+              (long)correctionUs, (unsigned long)bound);
+}
+
+void ClockQuality::invalidate() {
+    _valid       = false;
+    _stratum     = 16;
+    _syncUnix    = 0;
+    _syncErrorUs = 0;
+    memcpy(_refId, "LOCL", 4);
+}
+
+void ClockQuality::setLeapIndicator(uint8_t li) {
+    _leap = li <= 2 ? li : 0;
+    publish();
+}
+
+// ============================================================================
+// State machine
+// ============================================================================
+bool ClockQuality::update(uint32_t unixNow) {
+    uint32_t bound = getErrorBoundUs(unixNow);
+    bool stale = !_valid ||
+                 (unixNow > _syncUnix && unixNow - _syncUnix > NTP_UNSYNC_STRATUM_THRESHOLD_S);
+
+    // Worst state the bound allows, and best state it has recovered to
+    ClockQualityState down = CQ_FREERUN, up = CQ_FREERUN;
+    for (int8_t s = CQ_FREERUN - 1; !stale && s >= 0; s--) {
+        if (bound <= STATE_LIMIT_US[s]) down = (ClockQualityState)s;
+        if (bound <= (uint32_t)(STATE_LIMIT_US[s] * CQ_RECOVER_FRACTION)) up = (ClockQualityState)s;
+    }
+
+    ClockQualityState next = _state;
+    if (!_settled) {
+        next = down;
+        _settled = true;
+    } else if (down > _state) {
+        next = down;
+    } else if (up < _state &&
+               (_state == CQ_FREERUN || millis() - _enteredMs >= CQ_MIN_DWELL_MS)) {
+        // Only a new sync lowers the bound, so leaving FREERUN needs no dwell
+        next = up;
+    }
+
+    bool changed = next != _state;
+    if (changed) {
+        Log.event(LOG_SEV_NOTICE, "[QUALITY] %s -> %s (bound %lu us, stratum %u)",
+                  STATE_NAMES[_state], STATE_NAMES[next], (unsigned long)bound,
+                  next == CQ_FREERUN ? 16 : _stratum);
+        _state = next;
+        _enteredMs = millis();
+        _transitions++;
+    }
+    publish();
+    return changed;
+}
+
+void ClockQuality::publish() {
+    bool freerun = _state == CQ_FREERUN;
+    NtpRefState& ref = State.ntpRef.edit();
+    ref.quality       = _state;
+    ref.stratum       = freerun ? 16 : _stratum;
+    ref.leapIndicator = freerun ? 3 : _leap;
+    memcpy(ref.refId, freerun ? (const uint8_t*)"LOCL" : _refId, 4);
+    ref.lastSyncUnix  = _valid ? _syncUnix : 0;
+    ref.syncErrorUs   = _syncErrorUs;
+    ref.driftPpb      = driftPpb();
+    // Dispersion inputs in NTP units, so rootDispersion() needs no division
+    // or float on the response path: 16.16 s at the sync, and 2^-32 s per s
+    uint64_t base = (uint64_t)_syncErrorUs * 65536ULL / 1000000ULL;
+    ref.dispBase      = base > NTP_MAX_DISPERSION ? NTP_MAX_DISPERSION : (uint32_t)base;
+    ref.dispRate      = (uint32_t)((uint64_t)ref.driftPpb * 4294967296ULL / 1000000000ULL);
+    State.ntpRef.commit();  // No-op unless a field changed
+}
+
+float ClockQuality::driftPpm() const {
+    return _cadence ? _cadence->getBudgetPpm() : CADENCE_MIN_DRIFT_PPM;
+}
+
+uint32_t ClockQuality::driftPpb() const {
+    return (uint32_t)(driftPpm() * 1000.0f + 0.5f);
+}
+
+// ============================================================================
+// Queries
+// ============================================================================
+ClockQualityState ClockQuality::getState() const {
+    return _state;
+}
+
+uint32_t ClockQuality::getErrorBoundUs(uint32_t unixNow) const {
+    if (!_valid) return 0xFFFFFFFFUL;
+    return growBound(_syncErrorUs, unixNow > _syncUnix ? unixNow - _syncUnix : 0, driftPpb());
+}
+
+uint32_t ClockQuality::getTransitionCount() const {
+    return _transitions;
+}
+
+uint32_t ClockQuality::getViolationCount() const {
+    return _violations;
+}
+
+const char* ClockQuality::stateName(ClockQualityState s) {
+    return s < CQ_STATE_COUNT ? STATE_NAMES[s] : "?";
+}
+
+uint32_t ClockQuality::errorBoundUs(const NtpRefState& ref, uint32_t unixNow) {
+    if (ref.quality >= CQ_FREERUN || ref.lastSyncUnix == 0) return 0xFFFFFFFFUL;
+    return growBound(ref.syncErrorUs,
+                     unixNow > ref.lastSyncUnix ? unixNow - ref.lastSyncUnix : 0, ref.driftPpb);
+}
+
+uint32_t IRAM_ATTR ClockQuality::rootDispersion(const NtpRefState& ref, uint32_t unixNow) {
+    if (ref.quality >= CQ_FREERUN || ref.lastSyncUnix == 0) return NTP_MAX_DISPERSION;
+    // NTP fixed-point 16.16 seconds; a 32×32 multiply and a shift, no libgcc calls
+    uint32_t ageS = unixNow > ref.lastSyncUnix ? unixNow - ref.lastSyncUnix : 0;
+    uint64_t d = (uint64_t)ref.dispBase + (((uint64_t)ageS * ref.dispRate) >> 16);
+    if (d < NTP_MIN_DISPERSION) d = NTP_MIN_DISPERSION;
+    if (d > NTP_MAX_DISPERSION) d = NTP_MAX_DISPERSION;
+    return (uint32_t)d;
+}
+
+// ============================================================================
+// Reporting
+// ============================================================================
+int ClockQuality::toJson(char* buf, size_t len, uint32_t unixNow) const {
+    NtpRefState ref;
+    State.ntpRef.read(ref);
+    char id[16];
+    formatRefId(ref.refId, ref.stratum, id, sizeof(id));
+    uint32_t bound = getErrorBoundUs(unixNow);
+    int pos = snprintf(buf, len,
+        "{\"state\":\"%s\",\"err\":%ld,\"age\":%ld,\"stratum\":%u,\"li\":%u,\"ref\":\"%s\","
+        "\"disp\":%.1f,\"ppm\":%.2f,\"trans\":%lu,\"viol\":%lu}",
+        STATE_NAMES[_state], bound == 0xFFFFFFFFUL ? -1L : (long)bound,
+        _valid ? (long)(unixNow - _syncUnix) : -1L, ref.stratum, ref.leapIndicator, id,
+        rootDispersion(ref, unixNow) * 1000.0f / 65536.0f, driftPpm(),
+        (unsigned long)_transitions, (unsigned long)_violations);
+    return pos < (int)len ? pos : (int)len - 1;
+}
+
+void ClockQuality::toCbor(CborWriter& w, uint32_t unixNow) const {
+    NtpRefState ref;
+    State.ntpRef.read(ref);
+    char id[16];
+    formatRefId(ref.refId, ref.stratum, id, sizeof(id));
+    uint32_t bound = getErrorBoundUs(unixNow);
+    w.beginMap(10);
+    w.kvText("state", STATE_NAMES[_state]);
+    w.kvInt("err", bound == 0xFFFFFFFFUL ? -1 : (int64_t)bound);
+    w.kvInt("age", _valid ? (int64_t)(unixNow - _syncUnix) : -1);
+    w.kv("stratum", ref.stratum);
+    w.kv("li", ref.leapIndicator);
+    w.kvText("ref", id);
+    w.kvFloat("disp", rootDispersion(ref, unixNow) * 1000.0f / 65536.0f);
+    w.kvFloat("ppm", driftPpm());
+    w.kv("trans", _transitions);
+    w.kv("viol", _violations);
+}
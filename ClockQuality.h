@@ -0,0 +1,141 @@
+/**
+ * @file      ClockQuality.h
+ * @brief     Clock-quality state machine: the single writer of State.ntpRef
+ * @details   Every sync (WWVB fix, tracking measurement, NTP client) is reported
+ *            here with the error it leaves. From then on the error bound grows
+ *            at the SyncCadence drift budget, the measured DS3231 drift with a
+ *            margin. The bound selects the state:
+ *
+ *            | State    | Bound                 | Stratum / LI / ref ID        |
+ *            |----------|-----------------------|------------------------------|
+ *            | LOCKED   | ≤ CQ_LOCKED_MAX_US    | source (1 WWVB, 2 NTP)       |
+ *            | HOLDOVER | ≤ CQ_HOLDOVER_MAX_US  | source                       |
+ *            | DEGRADED | ≤ CQ_DEGRADED_MAX_US  | source                       |
+ *            | FREERUN  | beyond, or no sync    | 16 / 3 / LOCL                |
+ *
+ *            Root dispersion is the bound itself, so clients weigh the server
+ *            by how far it may really be off. A worse state is entered as soon
+ *            as the bound crosses its limit. A better one needs the bound under
+ *            CQ_RECOVER_FRACTION of the limit and CQ_MIN_DWELL_MS in the
+ *            current state, so a noisy fix cannot flap clients between strata.
+ *            The first sync out of FREERUN is taken at once.
+ *
+ *            The last sync record is kept in NVS. After a reset, a time read
+ *            back from the DS3231 continues the record instead of starting in
+ *            FREERUN.
+ */
+
+#ifndef CLOCKQUALITY_H
+#define CLOCKQUALITY_H
+
+#include <Arduino.h>
+#include <Preferences.h>
+#include "config.h"
+#include "StateStore.h"
+
+class CborWriter;
+class SyncCadence;
+
+class ClockQuality {
+public:
+    ClockQuality();
+
+    /**
+     * @brief Use the cadence's drift budget for the growth of the error bound
+     */
+    void begin(const SyncCadence* cadence);
+
+    /**
+     * @brief Restore the last sync record (caller has the namespace open)
+     */
+    void load(Preferences& prefs);
+
+    /**
+     * @brief Persist the last sync record (caller has the namespace open read-write)
+     */
+    void save(Preferences& prefs) const;
+
+    /**
+     * @brief Record a sync
+     * @param stratum  1 for WWVB, 2 for an NTP upstream
+     * @param refId    Reference ID to advertise ("WWVB" or the upstream IPv4)
+     * @param syncUnix UTC second of the sync
+     * @param errorUs  Error bound the sync leaves (µs)
+     */
+    void noteSync(uint8_t stratum, const uint8_t refId[4], uint32_t syncUnix, uint32_t errorUs);
+
+    /**
+     * @brief Compare the error a sync corrected with the bound held before it
+     * @details A correction larger than the bound is counted and logged; the
+     *          drift budget that caused it grows through SyncCadence.
+     */
+    void checkCorrection(int32_t correctionUs, uint32_t unixNow);
+
+    /**
+     * @brief Forget the sync record; the clock is FREERUN until the next sync
+     */
+    void invalidate();
+
+    /**
+     * @brief Leap warning to advertise outside FREERUN (RFC 5905 LI 0-2)
+     */
+    void setLeapIndicator(uint8_t li);
+
+    /**
+     * @brief Re-evaluate the state and publish State.ntpRef (call once a second)
+     * @return true if the state changed
+     */
+    bool update(uint32_t unixNow);
+
+    ClockQualityState getState() const;
+    uint32_t getErrorBoundUs(uint32_t unixNow) const;
+    uint32_t getTransitionCount() const;
+    uint32_t getViolationCount() const;
+
+    static const char* stateName(ClockQualityState s);
+
+    /**
+     * @brief Error bound of a published snapshot at unixNow (µs, saturating)
+     */
+    static uint32_t errorBoundUs(const NtpRefState& ref, uint32_t unixNow);
+
+    /**
+     * @brief NTP root dispersion (16.16 s) of a published snapshot at unixNow
+     * @details IRAM-resident and integer-only: it runs inside the NTP response
+     *          builder, which must not miss the cache after a flash write. The
+     *          snapshot carries the dispersion base and rate precomputed by
+     *          publish().
+     */
+    static uint32_t rootDispersion(const NtpRefState& ref, uint32_t unixNow);
+
+    /**
+     * @brief State, bound and advertised fields as a JSON object
+     * @return Characters written (snprintf semantics, clipped to len)
+     */
+    int toJson(char* buf, size_t len, uint32_t unixNow) const;
+
+    /**
+     * @brief Encode the same object as toJson() as a CBOR map
+     */
+    void toCbor(CborWriter& w, uint32_t unixNow) const;
+
+private:
+    const SyncCadence* _cadence;
+    ClockQualityState  _state;
+    bool     _settled;           // First update() after boot places the state directly
+    bool     _valid;             // A sync record is held
+    uint8_t  _stratum;
+    uint8_t  _refId[4];
+    uint8_t  _leap;
+    uint32_t _syncUnix;
+    uint32_t _syncErrorUs;
+    uint32_t _enteredMs;         // millis() when _state was entered
+    uint32_t _transitions;
+    uint32_t _violations;
+
+    float    driftPpm() const;
+    uint32_t driftPpb() const;
+    void     publish();
+};
+
+#endif // CLOCKQUALITY_H
@@ -5,6 +5,9 @@
  */
 
 #include "ES100.h"
+#include "EventLog.h"
+#include "Breadcrumbs.h"
+#include "EnergyMonitor.h"
 
 // ============================================================================
 // Constructor
@@ -38,22 +41,22 @@ bool ES100::begin(TwoWire *wirePort, int sdaPin, int sclPin) {
     
     // Verify device ID
     uint8_t deviceId = readDeviceID();
-    Serial.printf("ES100 Device ID: 0x%02X (expected 0x%02X)\n", deviceId, ES100_DEVICE_ID);
+    Log.event(LOG_SEV_INFO, "ES100 Device ID: 0x%02X (expected 0x%02X)", deviceId, ES100_DEVICE_ID);
     
     if (deviceId == ES100_DEVICE_ID) {
         _initialized = true;
         // Power off after verification — ES100 should only be on during reception
         // to avoid interfering with other devices on the shared I2C bus
         powerOff();
-        Serial.println("ES100 initialization successful (powered off until needed)");
+        Log.event(LOG_SEV_INFO, "ES100 initialization successful (powered off until needed)");
         return true;
     } else if (deviceId == 0xFF || deviceId == 0x00) {
         powerOff();
-        Serial.println("ES100 not responding - check I2C connections");
+        Log.event(LOG_SEV_ERR, "ES100 not responding - check I2C connections");
         return false;
     } else {
         powerOff();
-        Serial.println("ES100 unexpected device ID");
+        Log.event(LOG_SEV_ERR, "ES100 unexpected device ID");
         return false;
     }
 }
@@ -66,17 +69,19 @@ bool ES100::isPoweredOn() {
 }
 
 void ES100::powerOn() {
-    Serial.println("[ES100] Powering on (EN HIGH)...");
+    Log.event(LOG_SEV_DEBUG, "[ES100] Powering on (EN HIGH)...");
     digitalWrite(_enPin, HIGH);
+    Energy.setES100(true);
     delay(ES100_WAKEUP_TIME_MS);  // Wait for ES100 to wake up
 
     // Recover I2C bus - ES100 power-up can glitch SDA/SCL
     recoverBus();
-    Serial.println("[ES100] Power on complete, bus recovered");
+    Log.event(LOG_SEV_DEBUG, "[ES100] Power on complete, bus recovered");
 }
 
 void ES100::powerOff() {
     digitalWrite(_enPin, LOW);
+    Energy.setES100(false);
     _receiving = false;
 }
 
@@ -95,7 +100,7 @@ uint8_t ES100::readDeviceID() {
 // ============================================================================
 bool ES100::startReception(uint8_t mode) {
     if (!_initialized) {
-        Serial.println("ES100 not initialized");
+        Log.event(LOG_SEV_ERR, "ES100 not initialized");
         return false;
     }
     
@@ -109,11 +114,12 @@ bool ES100::startReception(uint8_t mode) {
     // This clears status/time registers and begins receiving
     if (writeRegister(ES100_REG_CONTROL0, mode)) {
         _receiving = true;
-        Serial.printf("ES100 reception started (mode 0x%02X)\n", mode);
+        Crumbs.trace(CRUMB_ES100_START, mode);
+        Log.event(LOG_SEV_INFO, "ES100 reception started (mode 0x%02X)", mode);
         return true;
     }
     
-    Serial.println("Failed to start ES100 reception");
+    Log.event(LOG_SEV_ERR, "Failed to start ES100 reception");
     return false;
 }
 
@@ -123,6 +129,7 @@ void ES100::stopReception() {
         writeRegister(ES100_REG_CONTROL0, 0x00);
     }
     _receiving = false;
+    Crumbs.trace(CRUMB_ES100_STOP);
     // Power off to free the I2C bus for other devices (touch, DS3231)
     powerOff();
 }
@@ -154,7 +161,7 @@ uint8_t ES100::readStatus0() {
 // ============================================================================
 bool ES100::readDateTime(ES100Time *time) {
     if (!isPoweredOn()) {
-        Serial.println("ES100 not powered - cannot read time");
+        Log.event(LOG_SEV_ERR, "ES100 not powered - cannot read time");
         return false;
     }
     
@@ -165,44 +172,20 @@ bool ES100::readDateTime(ES100Time *time) {
     // Read Status0 first to check RX_OK
     uint8_t status0 = readStatus0();
     if (!(status0 & ES100_STATUS_RX_OK)) {
-        Serial.println("RX_OK not set - time data not valid");
+        Log.event(LOG_SEV_WARNING, "RX_OK not set - time data not valid");
         return false;
     }
     
     // Read all time registers in one burst (registers 0x04-0x09)
-    uint8_t timeData[6];
-    if (readRegisters(ES100_REG_YEAR, timeData, 6) != 6) {
-        Serial.println("Failed to read time registers");
+    ES100Frame frame;
+    frame.status0 = status0;
+    if (readRegisters(ES100_REG_YEAR, frame.time, 6) != 6) {
+        Log.event(LOG_SEV_ERR, "Failed to read time registers");
         return false;
     }
+    decodeDateTime(frame, time);
     
-    // Convert BCD to decimal and populate structure
-    // Year is 2-digit BCD, we need to add century
-    uint8_t yearBcd = timeData[0];
-    time->year = 2000 + bcdToDec(yearBcd);
-    
-    // Month (1-12)
-    time->month = bcdToDec(timeData[1] & 0x1F);  // Mask upper bits
-    
-    // Day (1-31)
-    time->day = bcdToDec(timeData[2] & 0x3F);  // Mask upper bits
-    
-    // Hour (0-23) - UTC
-    time->hour = bcdToDec(timeData[3] & 0x3F);  // Mask upper bits
-    
-    // Minute (0-59)
-    time->minute = bcdToDec(timeData[4] & 0x7F);  // Mask upper bit
-    
-    // Second (0-59)
-    time->second = bcdToDec(timeData[5] & 0x7F);  // Mask upper bit
-    
-    // Extract DST status from Status0
-    time->dstStatus = (status0 & ES100_STATUS_DST_MASK) >> 5;
-    
-    // Check which antenna was used
-    time->antenna2Used = (status0 & ES100_STATUS_ANT) != 0;
-    
-    Serial.printf("ES100 read: %04d-%02d-%02d %02d:%02d:%02d UTC (Ant%d)\n",
+    Log.event(LOG_SEV_INFO, "ES100 read: %04d-%02d-%02d %02d:%02d:%02d UTC (Ant%d)",
                   time->year, time->month, time->day,
                   time->hour, time->minute, time->second,
                   time->antenna2Used ? 2 : 1);
@@ -219,7 +202,7 @@ bool ES100::readTrackingResult(uint8_t *second, bool *antenna2Used, uint8_t cach
     // Use cachedStatus0 if the caller already read it (avoids a redundant I2C transaction).
     uint8_t status0 = (cachedStatus0 != 0xFF) ? cachedStatus0 : readStatus0();
     if (!(status0 & ES100_STATUS_RX_OK) || !(status0 & ES100_STATUS_TRACKING)) {
-        Serial.printf("readTrackingResult: invalid status0=0x%02X (need RX_OK+TRACKING)\n", status0);
+        Log.event(LOG_SEV_WARNING, "readTrackingResult: invalid status0=0x%02X (need RX_OK+TRACKING)", status0);
         return false;
     }
 
@@ -231,11 +214,63 @@ bool ES100::readTrackingResult(uint8_t *second, bool *antenna2Used, uint8_t cach
         *antenna2Used = (status0 & ES100_STATUS_ANT) != 0;
     }
 
-    Serial.printf("ES100 tracking result: second=%02d (Ant%d)\n",
+    Log.event(LOG_SEV_INFO, "ES100 tracking result: second=%02d (Ant%d)",
                   *second, (status0 & ES100_STATUS_ANT) ? 2 : 1);
     return true;
 }
 
+// ============================================================================
+// IRQ Service Path
+// ============================================================================
+bool ES100::readFrame(ES100Frame *frame) {
+    if (frame == nullptr) {
+        return false;
+    }
+    uint8_t raw[ES100_FRAME_LEN];
+    if (readRegisters(ES100_FRAME_FIRST_REG, raw, ES100_FRAME_LEN) != ES100_FRAME_LEN) {
+        return false;
+    }
+    frame->irqStatus = raw[0];
+    frame->status0   = raw[1];
+    memcpy(frame->time, raw + 2, sizeof(frame->time));
+    return true;
+}
+
+void ES100::decodeDateTime(const ES100Frame &frame, ES100Time *time) {
+    // Year is 2-digit BCD, we need to add century
+    time->year   = 2000 + bcdToDec(frame.time[0]);
+    time->month  = bcdToDec(frame.time[1] & 0x1F);  // Mask upper bits
+    time->day    = bcdToDec(frame.time[2] & 0x3F);
+    time->hour   = bcdToDec(frame.time[3] & 0x3F);  // UTC
+    time->minute = bcdToDec(frame.time[4] & 0x7F);
+    time->second = bcdToDec(frame.time[5] & 0x7F);
+
+    time->dstStatus    = (frame.status0 & ES100_STATUS_DST_MASK) >> 5;
+    time->antenna2Used = (frame.status0 & ES100_STATUS_ANT) != 0;
+}
+
+uint8_t ES100::decodeSecond(const ES100Frame &frame) {
+    return bcdToDec(frame.time[5] & 0x7F);
+}
+
+bool ES100::readNextDST(ES100NextDST *next) {
+    if (next == nullptr || !isPoweredOn()) {
+        return false;
+    }
+    uint8_t raw[3];
+    if (readRegisters(ES100_REG_NEXT_DST_MO, raw, 3) != 3) {
+        return false;
+    }
+    next->month   = bcdToDec(raw[0] & 0x1F);
+    next->day     = bcdToDec(raw[1] & 0x3F);
+    next->hour    = bcdToDec(raw[2] & 0x0F);
+    next->special = (raw[2] >> 4) & 0x0F;
+
+    return next->month >= 1 && next->month <= 12 &&
+           next->day   >= 1 && next->day   <= 31 &&
+           next->hour  <= 23;
+}
+
 // ============================================================================
 // Low-Level I2C Functions
 // ============================================================================
@@ -244,15 +279,18 @@ uint8_t ES100::readRegister(uint8_t reg) {
         return 0xFF;
     }
     
+    I2CCrumb crumb(1, ES100_I2C_ADDR, reg);
     _wire->beginTransmission(ES100_I2C_ADDR);
     _wire->write(reg);
     if (_wire->endTransmission(true) != 0) {  // Send STOP, then re-START for read
-        Serial.printf("I2C error writing register address 0x%02X\n", reg);
+        Crumbs.trace(CRUMB_I2C_ERROR, (1 << 8) | reg);
+        Log.event(LOG_SEV_ERR, "I2C error writing register address 0x%02X", reg);
         return 0xFF;
     }
     
     if (_wire->requestFrom((uint8_t)ES100_I2C_ADDR, (uint8_t)1) != 1) {
-        Serial.printf("I2C error reading register 0x%02X\n", reg);
+        Crumbs.trace(CRUMB_I2C_ERROR, (1 << 8) | reg);
+        Log.event(LOG_SEV_ERR, "I2C error reading register 0x%02X", reg);
         return 0xFF;
     }
     
@@ -264,13 +302,15 @@ bool ES100::writeRegister(uint8_t reg, uint8_t value) {
         return false;
     }
     
+    I2CCrumb crumb(1, ES100_I2C_ADDR, reg);
     _wire->beginTransmission(ES100_I2C_ADDR);
     _wire->write(reg);
     _wire->write(value);
     uint8_t result = _wire->endTransmission();
     
     if (result != 0) {
-        Serial.printf("I2C error writing 0x%02X to register 0x%02X (error %d)\n", 
+        Crumbs.trace(CRUMB_I2C_ERROR, (1 << 8) | reg);
+        Log.event(LOG_SEV_ERR, "I2C error writing 0x%02X to register 0x%02X (error %d)", 
                       value, reg, result);
         return false;
     }
@@ -283,10 +323,12 @@ uint8_t ES100::readRegisters(uint8_t startReg, uint8_t *buffer, uint8_t count) {
         return 0;
     }
     
+    I2CCrumb crumb(1, ES100_I2C_ADDR, startReg);
     _wire->beginTransmission(ES100_I2C_ADDR);
     _wire->write(startReg);
     if (_wire->endTransmission(true) != 0) {  // Send STOP, then re-START for read
-        Serial.printf("I2C error writing start register 0x%02X\n", startReg);
+        Crumbs.trace(CRUMB_I2C_ERROR, (1 << 8) | startReg);
+        Log.event(LOG_SEV_ERR, "I2C error writing start register 0x%02X", startReg);
         return 0;
     }
     
@@ -315,7 +357,8 @@ void ES100::recoverBus() {
         return;  // Bus is fine, no recovery needed
     }
 
-    Serial.println("[ES100] I2C bus stuck - recovering...");
+    Crumbs.trace(CRUMB_I2C_RECOVER, 1);
+    Log.event(LOG_SEV_WARNING, "[ES100] I2C bus stuck - recovering...");
 
     // Toggle SCL up to 9 times to clock out any stuck slave
     pinMode(_sclPin, OUTPUT);
@@ -327,7 +370,7 @@ void ES100::recoverBus() {
 
         // Check if SDA released
         if (digitalRead(_sdaPin) == HIGH) {
-            Serial.printf("[ES100] Bus recovered after %d clock pulses\n", i + 1);
+            Log.event(LOG_SEV_INFO, "[ES100] Bus recovered after %d clock pulses", i + 1);
             break;
         }
     }
@@ -344,7 +387,7 @@ void ES100::recoverBus() {
     // Re-initialize Wire to restore normal I2C operation
     _wire->begin(_sdaPin, _sclPin);
 
-    Serial.println("[ES100] I2C bus recovery complete");
+    Log.event(LOG_SEV_INFO, "[ES100] I2C bus recovery complete");
 }
 
 // ============================================================================
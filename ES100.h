@@ -100,6 +100,33 @@ struct ES100Time {
     bool antenna2Used;  // True if Antenna 2 was used
 };
 
+/**
+ * @brief Next DST transition as broadcast by WWVB (registers 0x0A–0x0C)
+ * @details Month/day/hour are the local wall-clock date and hour of the next
+ *          DST change. A non-zero special code means the broadcast schedule does
+ *          not follow the standard rule and the fields should not be trusted.
+ */
+struct ES100NextDST {
+    uint8_t month;      // 1-12
+    uint8_t day;        // 1-31
+    uint8_t hour;       // 0-23, local time
+    uint8_t special;    // Upper nibble of NEXT_DST_HR (0 = normal schedule)
+};
+
+/**
+ * @brief Raw registers 0x02–0x09 captured in one I2C burst after an IRQ
+ * @details IRQ status, Status 0 and the six BCD time registers. Reading starts at
+ *          IRQ_STATUS, so the burst also releases the IRQ- pin.
+ */
+struct ES100Frame {
+    uint8_t irqStatus;  // Register 0x02
+    uint8_t status0;    // Register 0x03
+    uint8_t time[6];    // Registers 0x04–0x09 (year, month, day, hour, minute, second; BCD)
+};
+
+#define ES100_FRAME_FIRST_REG   ES100_REG_IRQ_STATUS
+#define ES100_FRAME_LEN         8
+
 // ============================================================================
 // ES100 Class Definition
 // ============================================================================
@@ -198,6 +225,35 @@ public:
      */
     bool readTrackingResult(uint8_t *second, bool *antenna2Used = nullptr,
                             uint8_t cachedStatus0 = 0xFF);
+
+    /**
+     * @brief Read IRQ status, Status 0 and all time registers in one I2C transaction
+     * @param frame Output: raw register contents
+     * @return true if all ES100_FRAME_LEN bytes were read
+     * @note No Serial output — this is the IRQ service path. Decode with
+     *       decodeDateTime() / decodeSecond() and log afterwards.
+     */
+    bool readFrame(ES100Frame *frame);
+
+    /**
+     * @brief Read the next DST transition registers (normal mode only)
+     * @param next Output: decoded month/day/hour/special code
+     * @return true if the registers were read and hold a plausible date
+     * @note Not part of the IRQ burst — call after the clock has been corrected.
+     */
+    bool readNextDST(ES100NextDST *next);
+
+    /**
+     * @brief Decode a normal-mode frame into date/time fields (no I2C, no logging)
+     * @param frame Raw frame from readFrame()
+     * @param time  Output: decoded UTC time, DST status and antenna
+     */
+    static void decodeDateTime(const ES100Frame &frame, ES100Time *time);
+
+    /**
+     * @brief Decode the seconds register (the only valid field after tracking)
+     */
+    static uint8_t decodeSecond(const ES100Frame &frame);
     
     /**
      * @brief Read a single register
@@ -244,7 +300,7 @@ private:
      * @param bcd BCD encoded value
      * @return Decimal value
      */
-    uint8_t bcdToDec(uint8_t bcd);
+    static uint8_t bcdToDec(uint8_t bcd);
     
     /**
      * @brief Convert decimal to BCD
@@ -0,0 +1,256 @@
+/**
+ * @file      EdgeCapture.cpp
+ * @brief     MCPWM capture edge timestamps implementation
+ * @details   IDF 4.4 (Arduino-ESP32 2.x) uses the legacy driver/mcpwm.h
+ *            capture API; IDF 5 uses driver/mcpwm_cap.h. Both run the
+ *            capture timer from the APB clock.
+ */
+
+#include "EdgeCapture.h"
+#include "EventLog.h"
+#include "CborWriter.h"
+#include <math.h>
+#if ESP_IDF_VERSION >= ESP_IDF_VERSION_VAL(5, 0, 0)
+#include "driver/mcpwm_cap.h"
+#else
+#include "driver/mcpwm.h"
+#include "driver/gpio.h"
+#include "soc/soc.h"
+#endif
+
+// Latest edge per channel, written by the capture interrupt
+struct EdgeLatch {
+    uint32_t    isrMicros;       // micros() on entry to the capture callback
+    uint32_t    edgeMicros;      // Hardware stamp converted to micros()
+    uint32_t    seq;
+    EdgeHandler handler;
+};
+
+static EdgeLatch s_latch[EDGE_CHANNELS];
+static uint32_t s_ticksPerUs = 80;
+static uint32_t s_minSkew = 0;           // Smallest (micros × ticksPerUs − capture), mod 2³²
+static bool     s_haveSkew = false;
+static portMUX_TYPE s_mux = portMUX_INITIALIZER_UNLOCKED;
+
+// A skew this far above the minimum is not ISR latency: the capture timer
+// was restarted, so start the minimum over
+#define EDGE_SKEW_RESET_US   20000UL
+
+static void IRAM_ATTR latchEdge(uint8_t ch, uint32_t capValue) {
+    uint32_t now = micros();
+    uint32_t skew = now * s_ticksPerUs - capValue;
+    uint32_t late = 0;
+
+    portENTER_CRITICAL_ISR(&s_mux);
+    if (!s_haveSkew || (int32_t)(skew - s_minSkew) < 0 ||
+        skew - s_minSkew > EDGE_SKEW_RESET_US * s_ticksPerUs) {
+        s_minSkew = skew;
+        s_haveSkew = true;
+    }
+    late = (skew - s_minSkew) / s_ticksPerUs;
+    EdgeLatch& l = s_latch[ch];
+    l.isrMicros = now;
+    l.edgeMicros = now - late;
+    l.seq++;
+    portEXIT_CRITICAL_ISR(&s_mux);
+
+    if (l.handler) l.handler(now - late);
+}
+
+#if ESP_IDF_VERSION >= ESP_IDF_VERSION_VAL(5, 0, 0)
+static bool IRAM_ATTR onCapture(mcpwm_cap_channel_handle_t, const mcpwm_capture_event_data_t* ev,
+                                void* ctx) {
+    latchEdge((uint8_t)(uintptr_t)ctx, ev->cap_value);
+    return false;
+}
+
+static bool startChannel(mcpwm_cap_timer_handle_t timer, int pin, uint8_t ch) {
+    mcpwm_capture_channel_config_t cfg = {};
+    cfg.gpio_num = pin;
+    cfg.prescale = 1;
+    cfg.flags.neg_edge = 1;
+    cfg.flags.pull_up = 1;
+    mcpwm_cap_channel_handle_t handle = nullptr;
+    if (mcpwm_new_capture_channel(timer, &cfg, &handle) != ESP_OK) return false;
+
+    mcpwm_capture_event_callbacks_t cbs = {};
+    cbs.on_cap = onCapture;
+    return mcpwm_capture_channel_register_event_callbacks(handle, &cbs,
+                                                          (void*)(uintptr_t)ch) == ESP_OK &&
+           mcpwm_capture_channel_enable(handle) == ESP_OK;
+}
+#else
+static bool IRAM_ATTR onCapture(mcpwm_unit_t, mcpwm_capture_channel_id_t,
+                                const cap_event_data_t* ev, void* ctx) {
+    latchEdge((uint8_t)(uintptr_t)ctx, ev->cap_value);
+    return false;
+}
+
+static bool startChannel(int pin, uint8_t ch) {
+    static const mcpwm_io_signals_t signals[] = { MCPWM_CAP_0, MCPWM_CAP_1 };
+    static const mcpwm_capture_channel_id_t channels[] = { MCPWM_SELECT_CAP0, MCPWM_SELECT_CAP1 };
+    if (mcpwm_gpio_init(MCPWM_UNIT_0, signals[ch], pin) != ESP_OK) return false;
+    gpio_pullup_en((gpio_num_t)pin);
+
+    mcpwm_capture_config_t cfg = {};
+    cfg.cap_edge = MCPWM_NEG_EDGE;
+    cfg.cap_prescale = 1;
+    cfg.capture_cb = onCapture;
+    cfg.user_data = (void*)(uintptr_t)ch;
+    return mcpwm_capture_enable_channel(MCPWM_UNIT_0, channels[ch], &cfg) == ESP_OK;
+}
+#endif
+
+EdgeCapture::EdgeCapture() : _running(false) {
+    memset(_stats, 0, sizeof(_stats));
+    memset(_track, 0, sizeof(_track));
+}
+
+void EdgeCapture::setHandler(EdgeChannel ch, EdgeHandler fn) {
+    if (ch < EDGE_CHANNELS) s_latch[ch].handler = fn;
+}
+
+bool EdgeCapture::begin(int sqwPin, int irqPin) {
+    const int pins[EDGE_CHANNELS] = { sqwPin, irqPin };
+    bool ok = true;
+
+#if ESP_IDF_VERSION >= ESP_IDF_VERSION_VAL(5, 0, 0)
+    mcpwm_capture_timer_config_t tcfg = {};
+    tcfg.group_id = 0;
+    tcfg.clk_src = MCPWM_CAPTURE_CLK_SRC_DEFAULT;
+    mcpwm_cap_timer_handle_t timer = nullptr;
+    uint32_t hz = 0;
+    ok = mcpwm_new_capture_timer(&tcfg, &timer) == ESP_OK &&
+         mcpwm_capture_timer_get_resolution(timer, &hz) == ESP_OK;
+    // The skew arithmetic needs a whole number of ticks per µs
+    if (ok && (hz < 1000000UL || hz % 1000000UL != 0)) ok = false;
+    if (ok) s_ticksPerUs = hz / 1000000UL;
+    for (uint8_t ch = 0; ok && ch < EDGE_CHANNELS; ch++) {
+        if (pins[ch] >= 0) ok = startChannel(timer, pins[ch], ch);
+    }
+    ok = ok && mcpwm_capture_timer_enable(timer) == ESP_OK &&
+         mcpwm_capture_timer_start(timer) == ESP_OK;
+#else
+    s_ticksPerUs = APB_CLK_FREQ / 1000000UL;
+    for (uint8_t ch = 0; ok && ch < EDGE_CHANNELS; ch++) {
+        if (pins[ch] >= 0) ok = startChannel(pins[ch], ch);
+    }
+#endif
+
+    if (!ok) {
+        Log.event(LOG_SEV_WARNING, "[EDGE] MCPWM capture unavailable, using GPIO interrupts");
+        return false;
+    }
+    _running = true;
+    Log.event(LOG_SEV_INFO, "[EDGE] MCPWM capture on SQW GPIO%d, ES100 IRQ GPIO%d (%lu ticks/us)",
+              sqwPin, irqPin, (unsigned long)s_ticksPerUs);
+    return true;
+}
+
+void EdgeCapture::service() {
+    if (!_running) return;
+
+    for (uint8_t ch = 0; ch < EDGE_CHANNELS; ch++) {
+        Track& t = _track[ch];
+        portENTER_CRITICAL(&s_mux);
+        uint32_t seq = s_latch[ch].seq;
+        uint32_t sw  = s_latch[ch].isrMicros;
+        uint32_t hw  = s_latch[ch].edgeMicros;
+        portEXIT_CRITICAL(&s_mux);
+        if (seq == t.seq) continue;
+
+        Stats& s = _stats[ch];
+        uint32_t gap = seq - t.seq;
+        t.seq = seq;
+        s.missed += gap - 1;
+        uint32_t lat = sw - hw;
+        if (s.edges == 0 || lat < s.latMinUs) s.latMinUs = lat;
+        if (lat > s.latMaxUs) s.latMaxUs = lat;
+        s.latSumUs += lat;
+        s.edges++;
+
+        // Jitter needs three consecutive SQW edges; a missed edge starts over
+        if (ch != EDGE_SQW || gap != 1) {
+            t.history = 0;
+        } else if (t.history >= 1) {
+            int32_t swInt = (int32_t)(sw - t.prevSw);
+            int32_t hwInt = (int32_t)(hw - t.prevHw);
+            if (t.history >= 2) {
+                int32_t dSw = swInt - t.prevSwInterval;
+                int32_t dHw = hwInt - t.prevHwInterval;
+                if (abs(dHw) < EDGE_JITTER_GATE_US && abs(dSw) < EDGE_JITTER_GATE_US) {
+                    s.swSumSq += (uint64_t)((int64_t)dSw * dSw);
+                    s.hwSumSq += (uint64_t)((int64_t)dHw * dHw);
+                    s.jitterN++;
+                }
+            }
+            t.prevSwInterval = swInt;
+            t.prevHwInterval = hwInt;
+        }
+        if (t.history < 2) t.history++;
+        t.prevSw = sw;
+        t.prevHw = hw;
+    }
+}
+
+bool EdgeCapture::isRunning() const {
+    return _running;
+}
+
+const EdgeCapture::Stats& EdgeCapture::getStats(EdgeChannel ch) const {
+    return _stats[ch < EDGE_CHANNELS ? ch : 0];
+}
+
+float EdgeCapture::getJitterUs(EdgeChannel ch, bool hardware) const {
+    const Stats& s = getStats(ch);
+    if (s.jitterN == 0) return 0.0f;
+    // Second difference of white timing noise σ has variance 6σ²
+    return sqrtf((float)(hardware ? s.hwSumSq : s.swSumSq) / s.jitterN / 6.0f);
+}
+
+static const char* const CHANNEL_NAMES[EDGE_CHANNELS] = { "sqw", "irq" };
+
+int EdgeCapture::toJson(char* buf, size_t len) const {
+    int pos = snprintf(buf, len, "{\"on\":%s", _running ? "true" : "false");
+    for (uint8_t ch = 0; ch < EDGE_CHANNELS && pos < (int)len - 140; ch++) {
+        const Stats& s = _stats[ch];
+        pos += snprintf(buf + pos, len - pos,
+            ",\"%s\":{\"n\":%lu,\"miss\":%lu,\"lat\":[%lu,%lu,%lu]",
+            CHANNEL_NAMES[ch], (unsigned long)s.edges, (unsigned long)s.missed,
+            (unsigned long)s.latMinUs,
+            (unsigned long)(s.edges ? s.latSumUs / s.edges : 0),
+            (unsigned long)s.latMaxUs);
+        if (ch == EDGE_SQW) {
+            pos += snprintf(buf + pos, len - pos, ",\"jit\":{\"n\":%lu,\"sw\":%.1f,\"hw\":%.1f}",
+                            (unsigned long)s.jitterN,
+                            getJitterUs((EdgeChannel)ch, false), getJitterUs((EdgeChannel)ch, true));
+        }
+        pos += snprintf(buf + pos, len - pos, "}");
+    }
+    if (pos < (int)len - 2) pos += snprintf(buf + pos, len - pos, "}");
+    return pos < (int)len ? pos : (int)len - 1;
+}
+
+void EdgeCapture::toCbor(CborWriter& w) const {
+    w.beginMap(1 + EDGE_CHANNELS);
+    w.kvBool("on", _running);
+    for (uint8_t ch = 0; ch < EDGE_CHANNELS; ch++) {
+        const Stats& s = _stats[ch];
+        w.key(CHANNEL_NAMES[ch]);
+        w.beginMap(ch == EDGE_SQW ? 4 : 3);
+        w.kv("n", s.edges);
+        w.kv("miss", s.missed);
+        w.key("lat");
+        w.beginArray(3);
+        w.unsignedInt(s.latMinUs);
+        w.unsignedInt(s.edges ? s.latSumUs / s.edges : 0);
+        w.unsignedInt(s.latMaxUs);
+        if (ch == EDGE_SQW) {
+            w.key("jit");
+            w.beginMap(3);
+            w.kv("n", s.jitterN);
+            w.kvFloat("sw", getJitterUs((EdgeChannel)ch, false));
+            w.kvFloat("hw", getJitterUs((EdgeChannel)ch, true));
+        }
+    }
+}
@@ -0,0 +1,110 @@
+/**
+ * @file      EdgeCapture.h
+ * @brief     Hardware timestamps for the SQW and ES100 IRQ edges (MCPWM capture)
+ * @details   The MCPWM capture unit latches a free-running timer (APB clock,
+ *            80 ticks/µs) in hardware on each falling edge. The capture
+ *            interrupt then reads micros(), and the difference between the two
+ *            timebases is that interrupt's entry latency plus a fixed offset.
+ *            Both timers run off the same crystal, so the fixed offset is the
+ *            smallest difference seen so far. Each edge is handed on as
+ *            micros() minus the latency above that minimum.
+ *
+ *            The result is in the micros()/esp_timer timebase that TimeManager
+ *            and the SQW phase anchor already use. It is late by only the
+ *            fastest ISR entry ever observed, which is a constant and is
+ *            absorbed by the IRQ latency calibration.
+ *
+ *            service() measures how much this removes. For each edge it
+ *            records the ISR latency above the hardware stamp. For SQW it
+ *            also estimates per-edge jitter from consecutive 1 s intervals,
+ *            once with the software stamps and once with the hardware stamps.
+ */
+
+#ifndef EDGECAPTURE_H
+#define EDGECAPTURE_H
+
+#include <Arduino.h>
+#include "config.h"
+
+class CborWriter;
+
+enum EdgeChannel : uint8_t {
+    EDGE_SQW = 0,            // DS3231 1 Hz square wave
+    EDGE_ES100_IRQ,          // ES100 IRQ (falling)
+    EDGE_CHANNELS
+};
+
+/**
+ * @brief Called from the capture interrupt with the edge time in micros()
+ */
+typedef void (*EdgeHandler)(uint32_t edgeMicros);
+
+class EdgeCapture {
+public:
+    struct Stats {
+        uint32_t edges;          // Edges seen by service()
+        uint32_t missed;         // Edges that arrived between two service() calls
+        uint32_t latMinUs;       // ISR latency above the hardware stamp
+        uint32_t latMaxUs;
+        uint64_t latSumUs;
+        uint32_t jitterN;        // Interval pairs in the jitter sums (SQW only)
+        uint64_t swSumSq;        // Σ (second difference of software stamps)²
+        uint64_t hwSumSq;        // Σ (second difference of hardware stamps)²
+    };
+
+    EdgeCapture();
+
+    /**
+     * @brief Route the pins to capture channels and start the capture timer
+     * @param sqwPin    DS3231 SQW GPIO, or -1 to skip
+     * @param irqPin    ES100 IRQ GPIO, or -1 to skip
+     * @return false if the MCPWM driver refused; use GPIO interrupts instead
+     */
+    bool begin(int sqwPin, int irqPin);
+
+    /**
+     * @brief Set the handler an edge is passed to (before begin())
+     */
+    void setHandler(EdgeChannel ch, EdgeHandler fn);
+
+    /**
+     * @brief Fold new edges into the latency and jitter statistics (call from loop)
+     */
+    void service();
+
+    bool isRunning() const;
+    const Stats& getStats(EdgeChannel ch) const;
+
+    /**
+     * @brief Per-edge jitter estimate in µs: RMS second difference / √6
+     * @param hardware true for the capture stamps, false for ISR-entry stamps
+     */
+    float getJitterUs(EdgeChannel ch, bool hardware) const;
+
+    /**
+     * @brief Statistics for both channels as a JSON object
+     * @return Characters written (snprintf semantics, clipped to len)
+     */
+    int toJson(char* buf, size_t len) const;
+
+    /**
+     * @brief Encode the same object as toJson() as a CBOR map
+     */
+    void toCbor(CborWriter& w) const;
+
+private:
+    struct Track {
+        uint32_t seq;            // Last latch sequence folded in
+        uint32_t prevSw;
+        uint32_t prevHw;
+        int32_t  prevSwInterval;
+        int32_t  prevHwInterval;
+        uint8_t  history;        // Consecutive edges held (0-2) for the interval math
+    };
+
+    bool  _running;
+    Stats _stats[EDGE_CHANNELS];
+    Track _track[EDGE_CHANNELS];
+};
+
+#endif // EDGECAPTURE_H
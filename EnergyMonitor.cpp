@@ -0,0 +1,250 @@
+/**
+ * @file      EnergyMonitor.cpp
+ * @brief     Per-subsystem energy accounting implementation
+ */
+
+#include "EnergyMonitor.h"
+#include "Breadcrumbs.h"
+#include "EventLog.h"
+#include <WiFi.h>
+
+#define BATTERY_MWH ((float)ENERGY_BATTERY_MAH * (float)ENERGY_BATTERY_NOMINAL_MV / 1000.0f)
+
+EnergyMonitor Energy;
+
+static const char* const SUBSYSTEM_NAMES[ENERGY_COUNT] = {
+    "base", "cpu", "radio", "es100", "display", "i2c"
+};
+
+EnergyMonitor::EnergyMonitor()
+    : _lastMs(0), _started(false), _es100On(false), _es100SinceMs(0), _es100PendingMs(0),
+      _idleUs(0), _apl(0.3f), _brightness(0), _battMv(0), _charging(false), _cpuBusy(0.0f),
+      _scale(1.0f), _calCount(0), _pctAvg(-1.0f), _dischargeS(0), _calActive(false),
+      _calStartPct(0.0f), _calStartMWh(0.0), _powerMw(-1.0f) {
+    memset(_mWh, 0, sizeof(_mWh));
+    memset(_onMs, 0, sizeof(_onMs));
+    _i2cLastUs[0] = _i2cLastUs[1] = 0;
+}
+
+// ============================================================================
+// Persistence
+// ============================================================================
+void EnergyMonitor::load(Preferences& prefs) {
+    _scale    = prefs.getFloat("nrgK", 1.0f);
+    _calCount = prefs.getUShort("nrgN", 0);
+    if (!(_scale >= ENERGY_SCALE_MIN && _scale <= ENERGY_SCALE_MAX)) {
+        _scale = 1.0f;
+        _calCount = 0;
+    }
+}
+
+void EnergyMonitor::save(Preferences& prefs) const {
+    prefs.putFloat("nrgK", _scale);
+    prefs.putUShort("nrgN", _calCount);
+}
+
+// ============================================================================
+// Inputs
+// ============================================================================
+void EnergyMonitor::setES100(bool on) {
+    if (on == _es100On) return;
+    uint32_t now = millis();
+    if (!on) _es100PendingMs += now - _es100SinceMs;
+    _es100SinceMs = now;
+    _es100On = on;
+}
+
+void EnergyMonitor::noteFrame(const uint16_t* pixels, uint32_t count) {
+    if (!pixels || count == 0) return;
+    // Panel byte order: swap back to RGB565, then average the channel levels
+    uint32_t sum = 0, n = 0;
+    for (uint32_t i = 0; i < count; i += ENERGY_PIXEL_STRIDE, n++) {
+        uint16_t c = (uint16_t)((pixels[i] >> 8) | (pixels[i] << 8));
+        // Scale each channel to 0-63 so they weigh the same
+        sum += ((c >> 11) << 1) + ((c >> 5) & 0x3F) + ((c & 0x1F) << 1);
+    }
+    _apl = (float)sum / ((float)n * 189.0f);
+}
+
+void EnergyMonitor::idleDelay(uint32_t ms) {
+    uint32_t start = micros();
+    delay(ms);
+    _idleUs += micros() - start;
+}
+
+// ============================================================================
+// Integration
+// ============================================================================
+void EnergyMonitor::service(uint8_t brightness, uint16_t battMv, uint8_t battPct, bool charging) {
+    uint32_t now = millis();
+    if (!_started) {
+        _started = true;
+        _lastMs = now;
+        _idleUs = 0;
+        _i2cLastUs[0] = Crumbs.getI2CBusyUs(0);
+        _i2cLastUs[1] = Crumbs.getI2CBusyUs(1);
+        _es100PendingMs = 0;
+        _es100SinceMs = now;
+        return;
+    }
+    uint32_t dtMs = now - _lastMs;
+    if (dtMs == 0) return;
+    _lastMs = now;
+
+    // Per-subsystem on-time over the interval and charge drawn (mA × ms)
+    uint32_t onMs[ENERGY_COUNT];
+    float    maMs[ENERGY_COUNT];
+
+    onMs[ENERGY_BASE] = dtMs;
+    maMs[ENERGY_BASE] = ENERGY_BASE_MA * dtMs;
+
+    // CPU: loop() idle is its end-of-pass delay; everything else counts as active
+    uint32_t idleMs = _idleUs / 1000UL;
+    _idleUs = 0;
+    if (idleMs > dtMs) idleMs = dtMs;
+    onMs[ENERGY_CPU] = dtMs - idleMs;
+    maMs[ENERGY_CPU] = ENERGY_CPU_ACTIVE_MA * onMs[ENERGY_CPU] + ENERGY_CPU_IDLE_MA * idleMs;
+    _cpuBusy = (float)onMs[ENERGY_CPU] / (float)dtMs;
+
+    wifi_mode_t mode = WiFi.getMode();
+    onMs[ENERGY_RADIO] = mode == WIFI_OFF ? 0 : dtMs;
+    maMs[ENERGY_RADIO] = ((mode == WIFI_AP || mode == WIFI_AP_STA) ? ENERGY_WIFI_AP_MA
+                                                                   : ENERGY_WIFI_STA_MA) *
+                         onMs[ENERGY_RADIO];
+
+    uint32_t es100Ms = _es100PendingMs + (_es100On ? now - _es100SinceMs : 0);
+    _es100PendingMs = 0;
+    _es100SinceMs = now;
+    onMs[ENERGY_ES100] = es100Ms < dtMs ? es100Ms : dtMs;
+    maMs[ENERGY_ES100] = ENERGY_ES100_MA * onMs[ENERGY_ES100];
+
+    onMs[ENERGY_DISPLAY] = brightness ? dtMs : 0;
+    maMs[ENERGY_DISPLAY] = (ENERGY_DISPLAY_BASE_MA +
+                            ENERGY_DISPLAY_FULL_MA * ((float)brightness / 255.0f) * _apl) *
+                           onMs[ENERGY_DISPLAY];
+
+    uint32_t i2cUs = 0;
+    for (uint8_t b = 0; b < 2; b++) {
+        uint32_t busy = Crumbs.getI2CBusyUs(b);
+        i2cUs += busy - _i2cLastUs[b];
+        _i2cLastUs[b] = busy;
+    }
+    onMs[ENERGY_I2C] = i2cUs / 1000UL < dtMs ? i2cUs / 1000UL : dtMs;
+    maMs[ENERGY_I2C] = ENERGY_I2C_MA * i2cUs / 1000.0f;
+
+    // mA × V × h = mWh; the load is drawn from the cell at its present voltage
+    float volts = (battMv > 0 ? battMv : ENERGY_BATTERY_NOMINAL_MV) / 1000.0f;
+    float intervalMWh = 0.0f;
+    for (uint8_t i = 0; i < ENERGY_COUNT; i++) {
+        float e = maMs[i] * volts / 3600000.0f;
+        _mWh[i] += e;
+        _onMs[i] += onMs[i];
+        intervalMWh += e;
+    }
+
+    float mw = intervalMWh * _scale * 3600000.0f / (float)dtMs;
+    float dtS = (float)dtMs / 1000.0f;
+    if (_powerMw < 0.0f) _powerMw = mw;
+    else _powerMw += (mw - _powerMw) * (dtS < ENERGY_POWER_TAU_S ? dtS / ENERGY_POWER_TAU_S : 1.0f);
+
+    _brightness = brightness;
+    _battMv = battMv;
+    _charging = charging;
+
+    // Battery charge, smoothed against load sag; restarted after charging
+    if (battMv == 0 || charging) {
+        _pctAvg = -1.0f;
+        _dischargeS = 0;
+        _calActive = false;
+        return;
+    }
+    if (_pctAvg < 0.0f) _pctAvg = battPct;
+    else _pctAvg += ((float)battPct - _pctAvg) *
+                    (dtS < ENERGY_PCT_TAU_S ? dtS / ENERGY_PCT_TAU_S : 1.0f);
+    _dischargeS += (uint32_t)(dtS + 0.5f);
+    calibrate(totalModelMWh());
+}
+
+double EnergyMonitor::totalModelMWh() const {
+    double sum = 0.0;
+    for (uint8_t i = 0; i < ENERGY_COUNT; i++) sum += _mWh[i];
+    return sum;
+}
+
+void EnergyMonitor::calibrate(double modelMWh) {
+    // The voltage keeps relaxing for a while after the charger is removed
+    if (_dischargeS < 2UL * ENERGY_PCT_TAU_S) return;
+    if (!_calActive) {
+        _calActive   = true;
+        _calStartPct = _pctAvg;
+        _calStartMWh = modelMWh;
+        return;
+    }
+
+    float drop = _calStartPct - _pctAvg;
+    if (drop < ENERGY_CAL_MIN_DROP_PCT) return;
+    float battMWh = drop / 100.0f * BATTERY_MWH;
+    float usedMWh = (float)(modelMWh - _calStartMWh);
+    _calStartPct = _pctAvg;
+    _calStartMWh = modelMWh;
+    if (usedMWh <= 0.0f) return;
+
+    float k = battMWh / usedMWh;
+    if (k < ENERGY_SCALE_MIN) k = ENERGY_SCALE_MIN;
+    if (k > ENERGY_SCALE_MAX) k = ENERGY_SCALE_MAX;
+    _scale = _calCount == 0 ? k : _scale + (k - _scale) / ENERGY_CAL_DEPTH;
+    if (_calCount < 0xFFFF) _calCount++;
+    Log.event(LOG_SEV_INFO, "[ENERGY] %.1f%% discharge = %.0f mWh, model %.0f mWh -> scale %.2f",
+              drop, battMWh, usedMWh, _scale);
+}
+
+// ============================================================================
+// Queries
+// ============================================================================
+float EnergyMonitor::getMWh(uint8_t subsystem) const {
+    return subsystem < ENERGY_COUNT ? (float)(_mWh[subsystem] * _scale) : 0.0f;
+}
+
+uint32_t EnergyMonitor::getOnSeconds(uint8_t subsystem) const {
+    return subsystem < ENERGY_COUNT ? (uint32_t)(_onMs[subsystem] / 1000ULL) : 0;
+}
+
+float EnergyMonitor::getPowerMw() const {
+    return _powerMw > 0.0f ? _powerMw : 0.0f;
+}
+
+float EnergyMonitor::getRuntimeHours() const {
+    if (_pctAvg < 0.0f || _powerMw <= 0.0f) return -1.0f;
+    float left = _pctAvg - CRITICAL_BATTERY_THRESHOLD;
+    if (left < 0.0f) left = 0.0f;
+    return left / 100.0f * BATTERY_MWH / _powerMw;
+}
+
+float EnergyMonitor::getScale() const {
+    return _scale;
+}
+
+uint16_t EnergyMonitor::getCalCount() const {
+    return _calCount;
+}
+
+const char* EnergyMonitor::subsystemName(uint8_t subsystem) {
+    return subsystem < ENERGY_COUNT ? SUBSYSTEM_NAMES[subsystem] : "?";
+}
+
+int EnergyMonitor::toJson(char* buf, size_t len) const {
+    int pos = snprintf(buf, len,
+        "{\"mw\":%.1f,\"runtime_h\":%.1f,\"scale\":%.3f,\"cal\":%u,\"mv\":%u,\"pct\":%.1f,"
+        "\"chg\":%s,\"cap_mwh\":%.0f,\"cpu_busy\":%.3f,\"bright\":%u,\"apl\":%.3f,"
+        "\"i2c_us\":[%lu,%lu],\"sub\":{",
+        getPowerMw(), getRuntimeHours(), _scale, _calCount, _battMv, _pctAvg,
+        _charging ? "true" : "false", BATTERY_MWH, _cpuBusy, _brightness, _apl,
+        (unsigned long)Crumbs.getI2CBusyUs(0), (unsigned long)Crumbs.getI2CBusyUs(1));
+    for (uint8_t i = 0; i < ENERGY_COUNT && pos < (int)len - 48; i++) {
+        pos += snprintf(buf + pos, len - pos, "%s\"%s\":{\"mwh\":%.2f,\"on\":%lu}",
+                        i ? "," : "", SUBSYSTEM_NAMES[i], getMWh(i),
+                        (unsigned long)getOnSeconds(i));
+    }
+    if (pos < (int)len - 2) pos += snprintf(buf + pos, len - pos, "}}");
+    return pos < (int)len ? pos : (int)len - 1;
+}
@@ -0,0 +1,134 @@
+/**
+ * @file      EnergyMonitor.h
+ * @brief     Per-subsystem energy accounting and battery runtime prediction
+ * @details   On-times are collected where they happen: ES100 EN edges in
+ *            ES100::powerOn()/powerOff(), I2C transaction time from the
+ *            breadcrumb marks, loop() idle time from its end-of-pass delay,
+ *            and the average picture level of each pushed frame. Once a second
+ *            service() turns them into mWh using the ENERGY_* currents in
+ *            config.h and the battery voltage.
+ *
+ *            The currents are estimates, so the model is calibrated against
+ *            the battery. Over a discharge, the charge the voltage curve says
+ *            was used (ENERGY_BATTERY_MAH) is compared with the mWh the model
+ *            counted, and the ratio scales every figure. Runtime is the charge
+ *            left above the shutdown threshold divided by the smoothed,
+ *            scaled power draw.
+ */
+
+#ifndef ENERGYMONITOR_H
+#define ENERGYMONITOR_H
+
+#include <Arduino.h>
+#include <Preferences.h>
+#include "config.h"
+
+enum EnergySubsystem : uint8_t {
+    ENERGY_BASE = 0,         // Always-on board load
+    ENERGY_CPU,              // loop() active and idle
+    ENERGY_RADIO,            // Wi-Fi STA/AP
+    ENERGY_ES100,            // EN high
+    ENERGY_DISPLAY,          // AMOLED, brightness × picture level
+    ENERGY_I2C,              // Marked transactions on both buses
+    ENERGY_COUNT
+};
+
+class EnergyMonitor {
+public:
+    EnergyMonitor();
+
+    /**
+     * @brief Restore the calibration scale (caller has the namespace open)
+     */
+    void load(Preferences& prefs);
+
+    /**
+     * @brief Persist the calibration scale (caller has the namespace open read-write)
+     */
+    void save(Preferences& prefs) const;
+
+    /**
+     * @brief ES100 EN pin changed (called from ES100::powerOn()/powerOff())
+     */
+    void setES100(bool on);
+
+    /**
+     * @brief Sample a frame's average picture level (call when it is pushed)
+     * @param pixels RGB565 frame in panel byte order (as TFT_eSprite stores it)
+     */
+    void noteFrame(const uint16_t* pixels, uint32_t count);
+
+    /**
+     * @brief delay() that is counted as CPU idle (the end-of-pass wait in loop())
+     */
+    void idleDelay(uint32_t ms);
+
+    /**
+     * @brief Integrate since the last call and update calibration (call once a second)
+     * @param brightness Display brightness (0 = off)
+     * @param battMv     Battery voltage from the PMU (0 = no battery)
+     * @param battPct    Charge the voltage curve gives for battMv
+     * @param charging   Charger active
+     */
+    void service(uint8_t brightness, uint16_t battMv, uint8_t battPct, bool charging);
+
+    /**
+     * @brief Calibrated energy used since boot (mWh)
+     */
+    float getMWh(uint8_t subsystem) const;
+
+    /**
+     * @brief Time the subsystem was on since boot (s)
+     */
+    uint32_t getOnSeconds(uint8_t subsystem) const;
+
+    float    getPowerMw() const;        // Smoothed, calibrated draw
+    float    getRuntimeHours() const;   // -1 while charging or without a battery
+    float    getScale() const;          // Battery-measured / modelled energy
+    uint16_t getCalCount() const;
+
+    static const char* subsystemName(uint8_t subsystem);
+
+    /**
+     * @brief Per-subsystem breakdown, calibration and prediction as JSON
+     * @return Characters written (snprintf semantics, clipped to len)
+     */
+    int toJson(char* buf, size_t len) const;
+
+private:
+    double   _mWh[ENERGY_COUNT];        // Model energy (unscaled; double, months of mWh)
+    uint64_t _onMs[ENERGY_COUNT];
+    uint32_t _lastMs;
+    bool     _started;
+
+    // Collected between service() calls
+    bool     _es100On;
+    uint32_t _es100SinceMs;
+    uint32_t _es100PendingMs;
+    uint32_t _idleUs;
+    uint32_t _i2cLastUs[2];
+    float    _apl;                      // Average picture level of the last frame (0-1)
+
+    // Last instantaneous figures, for reporting
+    uint8_t  _brightness;
+    uint16_t _battMv;
+    bool     _charging;
+    float    _cpuBusy;                  // Active fraction over the last second
+
+    // Calibration and prediction
+    float    _scale;
+    uint16_t _calCount;
+    float    _pctAvg;                   // Smoothed charge (%), -1 until a battery reading
+    uint32_t _dischargeS;               // Seconds since the charger was last seen
+    bool     _calActive;
+    float    _calStartPct;
+    double   _calStartMWh;
+    float    _powerMw;                  // Smoothed calibrated draw, -1 until first service()
+
+    double totalModelMWh() const;
+    void   calibrate(double modelMWh);
+};
+
+extern EnergyMonitor Energy;
+
+#endif // ENERGYMONITOR_H
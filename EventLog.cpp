@@ -0,0 +1,231 @@
+/**
+ * @file      EventLog.cpp
+ * @brief     Structured event log and syslog shipper implementation
+ */
+
+#include "EventLog.h"
+#include <WiFi.h>
+#include <stdarg.h>
+#include <time.h>
+
+EventLog Log;
+
+EventLog::EventLog()
+    : _head(0), _count(0), _pending(0), _seq(0), _shipped(0), _dropped(0),
+      _throttled(0), _oldestPendingMs(0), _lineLen(0), _nextSeverity(-1),
+      _tokens(LOG_RATE_BURST), _refillMs(0), _clock(nullptr),
+      _collectorValid(false) {
+}
+
+void EventLog::begin(unsigned long baud) {
+#if DEBUG_SERIAL
+    Serial.begin(baud);
+#endif
+    _collectorValid = LOG_SYSLOG_HOST[0] != '\0' && _collector.fromString(LOG_SYSLOG_HOST);
+}
+
+void EventLog::flush() {
+#if DEBUG_SERIAL
+    Serial.flush();
+#endif
+}
+
+void EventLog::setClock(bool (*now)(uint32_t&, uint16_t&)) {
+    _clock = now;
+}
+
+// ============================================================================
+// Line capture
+// ============================================================================
+
+size_t EventLog::write(uint8_t c) {
+    return write(&c, 1);
+}
+
+size_t EventLog::write(const uint8_t* buf, size_t len) {
+#if DEBUG_SERIAL
+    Serial.write(buf, len);
+#endif
+    for (size_t i = 0; i < len; i++) {
+        char c = (char)buf[i];
+        if (c == '\n') {
+            commitLine();
+        } else if (c != '\r' && _lineLen < sizeof(_line) - 1) {
+            _line[_lineLen++] = c;
+        }
+    }
+    return len;
+}
+
+void EventLog::event(uint8_t severity, const char* fmt, ...) {
+#if !DEBUG_SERIAL
+    if (severity > LOG_SHIP_SEVERITY) return;    // Nowhere to send it
+#endif
+    char buf[sizeof(_line)];
+    va_list ap;
+    va_start(ap, fmt);
+    int n = vsnprintf(buf, sizeof(buf), fmt, ap);
+    va_end(ap);
+    if (n < 0) return;
+    if (n >= (int)sizeof(buf)) n = sizeof(buf) - 1;
+
+    // Finish any partial line first so the two don't merge
+    if (_lineLen > 0) commitLine();
+    _nextSeverity = severity;
+    write((const uint8_t*)buf, n);
+    if (n == 0 || buf[n - 1] != '\n') write((const uint8_t*)"\n", 1);
+    _nextSeverity = -1;
+}
+
+void EventLog::commitLine() {
+    _line[_lineLen] = '\0';
+    size_t len = _lineLen;
+    _lineLen = 0;
+
+    // Skip blank/separator lines ("\n\n===="), which carry nothing
+    size_t start = 0;
+    while (start < len && (_line[start] == ' ' || _line[start] == '=')) start++;
+    if (start == len) return;
+
+    uint8_t sev = _nextSeverity >= 0 ? (uint8_t)_nextSeverity : inferSeverity(_line);
+    if (sev > LOG_SHIP_SEVERITY) return;
+    push(sev, _line, len);
+}
+
+// Last resort for Print-interface lines; call sites pass event() a severity
+uint8_t EventLog::inferSeverity(const char* text) {
+    if (strcasestr(text, "error") || strcasestr(text, "fail")) return LOG_SEV_ERR;
+    if (strcasestr(text, "warn")) return LOG_SEV_WARNING;
+    return LOG_SEV_INFO;
+}
+
+void EventLog::push(uint8_t severity, const char* text, size_t len) {
+    Event& e = _ring[_head];
+
+    // An unshipped event about to be overwritten is lost
+    if (_count == LOG_RING_SIZE && _pending == LOG_RING_SIZE) {
+        _dropped++;
+        _pending--;
+    }
+
+    e.seq      = ++_seq;
+    e.uptimeMs = millis();
+    e.severity = severity;
+    e.tag[0]   = '\0';
+
+    // "[TAG] message" → tag + message
+    const char* msg = text;
+    if (text[0] == '[') {
+        const char* close = (const char*)memchr(text, ']', len);
+        if (close && close - text - 1 < LOG_TAG_MAX) {
+            size_t tlen = close - text - 1;
+            memcpy(e.tag, text + 1, tlen);
+            e.tag[tlen] = '\0';
+            msg = close + 1;
+            while (*msg == ' ') msg++;
+        }
+    }
+    strncpy(e.msg, msg, LOG_MSG_MAX - 1);
+    e.msg[LOG_MSG_MAX - 1] = '\0';
+
+    if (_pending == 0) _oldestPendingMs = e.uptimeMs;
+    _head = (_head + 1) % LOG_RING_SIZE;
+    if (_count < LOG_RING_SIZE) _count++;
+    _pending++;
+}
+
+// ============================================================================
+// Shipping
+// ============================================================================
+
+void EventLog::service(bool busy) {
+    if (_pending == 0) return;
+    if (!_collectorValid) {
+        _pending = 0;           // Ring-only mode: nothing to wait for
+        return;
+    }
+    if (WiFi.status() != WL_CONNECTED) return;
+
+    uint32_t now = millis();
+    uint32_t waited = now - _oldestPendingMs;
+    if (_pending < LOG_BATCH_MAX && waited < LOG_BATCH_MS) return;
+    if (busy && waited < LOG_MAX_DEFER_MS) return;
+
+    // Refill the datagram budget
+    if (_refillMs == 0) _refillMs = now;
+    _tokens += (now - _refillMs) * (LOG_RATE_PER_S / 1000.0f);
+    if (_tokens > LOG_RATE_BURST) _tokens = LOG_RATE_BURST;
+    _refillMs = now;
+
+    uint8_t sent = 0;
+    while (_pending > 0 && sent < LOG_BATCH_MAX) {
+        if (_tokens < 1.0f) {
+            _throttled++;
+            break;
+        }
+        uint16_t idx = (_head + LOG_RING_SIZE - _pending) % LOG_RING_SIZE;
+        if (!ship(_ring[idx], now)) break;
+        _tokens -= 1.0f;
+        _pending--;
+        sent++;
+    }
+    if (_pending > 0) {
+        uint16_t idx = (_head + LOG_RING_SIZE - _pending) % LOG_RING_SIZE;
+        _oldestPendingMs = _ring[idx].uptimeMs;
+    }
+}
+
+// RFC 5424: <PRI>1 TIMESTAMP HOSTNAME APP-NAME PROCID MSGID [SD] MSG
+bool EventLog::ship(const Event& e, uint32_t nowMs) {
+    char ts[32] = "-";
+    uint32_t unixNow;
+    uint16_t msNow;
+    if (_clock && _clock(unixNow, msNow)) {
+        // Back-date from now by the event's age
+        uint64_t nowTotalMs = (uint64_t)unixNow * 1000 + msNow;
+        uint64_t evMs = nowTotalMs - (nowMs - e.uptimeMs);
+        time_t sec = (time_t)(evMs / 1000);
+        struct tm t;
+        gmtime_r(&sec, &t);
+        snprintf(ts, sizeof(ts), "%04d-%02d-%02dT%02d:%02d:%02d.%03uZ",
+                 t.tm_year + 1900, t.tm_mon + 1, t.tm_mday,
+                 t.tm_hour, t.tm_min, t.tm_sec, (unsigned)(evMs % 1000));
+    }
+
+    char pkt[LOG_MSG_MAX + 160];
+    int n = snprintf(pkt, sizeof(pkt),
+                     "<%u>1 %s %s wwvb_clock - %s [meta sequenceId=\"%lu\" sysUpTime=\"%lu\"] %s",
+                     (unsigned)(LOG_FACILITY * 8 + e.severity), ts, LOG_HOSTNAME,
+                     e.tag[0] ? e.tag : "-",
+                     (unsigned long)e.seq, (unsigned long)(e.uptimeMs / 10), e.msg);
+    if (n <= 0) return false;
+    if (n >= (int)sizeof(pkt)) n = sizeof(pkt) - 1;
+
+    if (!_udp.beginPacket(_collector, LOG_SYSLOG_PORT)) return false;
+    _udp.write((const uint8_t*)pkt, n);
+    if (!_udp.endPacket()) return false;
+    _shipped++;
+    return true;
+}
+
+bool EventLog::getRecent(uint16_t n, Event& out) const {
+    if (n >= _count) return false;
+    out = _ring[(_head + LOG_RING_SIZE - 1 - n) % LOG_RING_SIZE];
+    return true;
+}
+
+uint32_t EventLog::getShippedCount() const {
+    return _shipped;
+}
+
+uint32_t EventLog::getDroppedCount() const {
+    return _dropped;
+}
+
+uint32_t EventLog::getPendingCount() const {
+    return _pending;
+}
+
+uint32_t EventLog::getThrottledCount() const {
+    return _throttled;
+}
@@ -0,0 +1,117 @@
+/**
+ * @file      EventLog.h
+ * @brief     Structured event log with batched RFC 5424 syslog shipping
+ * @details   A Print sink that replaces direct Serial logging. Each completed
+ *            line becomes an event: uptime, severity, tag (the leading "[TAG]")
+ *            and message. Events go to a fixed RAM ring and are shipped from
+ *            loop() to a syslog collector in rate-limited batches, while NTP
+ *            is quiet. With DEBUG_SERIAL 0 the USB CDC port is never touched.
+ *            Call from the Arduino loop task only, as with Serial before.
+ */
+
+#ifndef EVENTLOG_H
+#define EVENTLOG_H
+
+#include <Arduino.h>
+#include <WiFiUdp.h>
+#include "config.h"
+
+// RFC 5424 severities
+#define LOG_SEV_ERR       3
+#define LOG_SEV_WARNING   4
+#define LOG_SEV_NOTICE    5
+#define LOG_SEV_INFO      6
+#define LOG_SEV_DEBUG     7
+
+#define LOG_TAG_MAX       12
+
+class EventLog : public Print {
+public:
+    struct Event {
+        uint32_t seq;
+        uint32_t uptimeMs;
+        uint8_t  severity;
+        char     tag[LOG_TAG_MAX];
+        char     msg[LOG_MSG_MAX];
+    };
+
+    EventLog();
+
+    /**
+     * @brief Start the Serial port (only when DEBUG_SERIAL is enabled)
+     */
+    void begin(unsigned long baud);
+
+    /**
+     * @brief Flush the Serial port (no-op when DEBUG_SERIAL is disabled)
+     */
+    void flush();
+
+    /**
+     * @brief Log one line at an explicit severity
+     * @details Every firmware call site uses this. Lines that arrive through
+     *          the Print interface (library code handed Log as a Print) carry
+     *          no severity, and only those fall back to a guess from their text.
+     */
+    void event(uint8_t severity, const char* fmt, ...) __attribute__((format(printf, 3, 4)));
+
+    /**
+     * @brief Wall-clock source for syslog timestamps (events carry uptime only)
+     * @param now Returns Unix seconds and ms, or false while the clock is unset
+     */
+    void setClock(bool (*now)(uint32_t& unixSec, uint16_t& ms));
+
+    /**
+     * @brief Ship pending events if a batch is due (call from loop)
+     * @param busy True while NTP clients are active; shipping waits unless
+     *             events have been held for LOG_MAX_DEFER_MS
+     */
+    void service(bool busy);
+
+    /**
+     * @brief Copy the n-th newest event held in the ring (0 = newest)
+     * @return false if the ring holds fewer than n+1 events
+     */
+    bool getRecent(uint16_t n, Event& out) const;
+
+    uint32_t getShippedCount() const;     // Datagrams sent to the collector
+    uint32_t getDroppedCount() const;     // Unshipped events overwritten in the ring
+    uint32_t getPendingCount() const;     // Events not yet shipped
+    uint32_t getThrottledCount() const;   // Service passes cut short by the rate limit
+
+    // Print interface
+    size_t write(uint8_t c) override;
+    size_t write(const uint8_t* buf, size_t len) override;
+
+private:
+    Event    _ring[LOG_RING_SIZE];
+    uint16_t _head;                       // Next slot to write
+    uint16_t _count;                      // Valid events in the ring
+    uint16_t _pending;                    // Newest _pending events are unshipped
+    uint32_t _seq;
+    uint32_t _shipped;
+    uint32_t _dropped;
+    uint32_t _throttled;
+    uint32_t _oldestPendingMs;
+
+    char     _line[LOG_MSG_MAX + LOG_TAG_MAX + 4];
+    uint16_t _lineLen;
+    int8_t   _nextSeverity;               // -1: infer from the text
+
+    float    _tokens;
+    uint32_t _refillMs;
+
+    bool   (*_clock)(uint32_t&, uint16_t&);
+    WiFiUDP  _udp;
+    IPAddress _collector;
+    bool     _collectorValid;
+
+    void commitLine();
+    void push(uint8_t severity, const char* text, size_t len);
+    bool ship(const Event& e, uint32_t nowMs);
+    static uint8_t inferSeverity(const char* text);
+};
+
+extern EventLog Log;
+
+#endif // EVENTLOG_H
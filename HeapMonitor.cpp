@@ -0,0 +1,201 @@
+/**
+ * @file      HeapMonitor.cpp
+ * @brief     Heap and PSRAM fragmentation telemetry implementation
+ */
+
+#include "HeapMonitor.h"
+#include "EventLog.h"
+#include <esp_heap_caps.h>
+
+#define HEAP_CAPS_INTERNAL (MALLOC_CAP_INTERNAL | MALLOC_CAP_8BIT)
+
+HeapMonitor Heap;
+
+// Lifetime counts, written from the allocator on any task
+static uint32_t s_allocs[HeapMonitor::SLOT_COUNT];
+static uint32_t s_bytes[HeapMonitor::SLOT_COUNT];
+static TaskHandle_t s_loopTask = nullptr;
+
+HeapMonitor::HeapMonitor()
+    : _intMin(0), _psramMin(0), _worstLargest(0), _lowWarned(false),
+      _histHead(0), _histCount(0), _lastHistoryMs(0), _rateIntervalMs(0) {
+    memset(&_last, 0, sizeof(_last));
+    memset(_history, 0, sizeof(_history));
+    memset(_prevAllocs, 0, sizeof(_prevAllocs));
+    memset(_prevBytes, 0, sizeof(_prevBytes));
+    memset(_rateAllocs, 0, sizeof(_rateAllocs));
+    memset(_rateBytes, 0, sizeof(_rateBytes));
+}
+
+void HeapMonitor::begin() {
+    s_loopTask = xTaskGetCurrentTaskHandle();
+    sample(millis());
+    Log.event(LOG_SEV_INFO, "[HEAP] Internal %lu free (largest %lu), PSRAM %lu free%s",
+              (unsigned long)_last.intFree, (unsigned long)_last.intLargest,
+              (unsigned long)_last.psramFree,
+              HEAP_ALLOC_TRACKING ? ", allocation tracking on" : "");
+}
+
+void HeapMonitor::service() {
+    uint32_t now = millis();
+    if (now - _last.ms >= HEAP_SAMPLE_INTERVAL_MS) sample(now);
+}
+
+void HeapMonitor::sample(uint32_t now) {
+    uint32_t prevMs = _last.ms;
+
+    _last.ms           = now;
+    _last.intFree      = heap_caps_get_free_size(HEAP_CAPS_INTERNAL);
+    _last.intLargest   = heap_caps_get_largest_free_block(HEAP_CAPS_INTERNAL);
+    _last.psramFree    = psramFound() ? heap_caps_get_free_size(MALLOC_CAP_SPIRAM) : 0;
+    _last.psramLargest = psramFound() ? heap_caps_get_largest_free_block(MALLOC_CAP_SPIRAM) : 0;
+
+    // The allocator keeps the true low-water mark; a 10 s poll would miss dips
+    _intMin   = heap_caps_get_minimum_free_size(HEAP_CAPS_INTERNAL);
+    _psramMin = psramFound() ? heap_caps_get_minimum_free_size(MALLOC_CAP_SPIRAM) : 0;
+    if (_worstLargest == 0 || _last.intLargest < _worstLargest) {
+        _worstLargest = _last.intLargest;
+    }
+
+    if (_histCount == 0 || now - _lastHistoryMs >= HEAP_HISTORY_INTERVAL_MS) {
+        _lastHistoryMs = now;
+        _history[_histHead] = _last;
+        _histHead = (_histHead + 1) % HEAP_HISTORY_SIZE;
+        if (_histCount < HEAP_HISTORY_SIZE) _histCount++;
+    }
+
+    if (!_lowWarned && _last.intLargest < HEAP_LOW_BLOCK_BYTES) {
+        _lowWarned = true;
+        Log.event(LOG_SEV_WARNING, "[HEAP] Largest free block %lu bytes (%lu free, %u%% fragmented)",
+                  (unsigned long)_last.intLargest, (unsigned long)_last.intFree,
+                  getFragmentationPct());
+    } else if (_lowWarned && _last.intLargest >= 2UL * HEAP_LOW_BLOCK_BYTES) {
+        _lowWarned = false;
+    }
+
+#if HEAP_ALLOC_TRACKING
+    for (uint8_t i = 0; i < SLOT_COUNT; i++) {
+        uint32_t a = __atomic_load_n(&s_allocs[i], __ATOMIC_RELAXED);
+        uint32_t b = __atomic_load_n(&s_bytes[i], __ATOMIC_RELAXED);
+        _rateAllocs[i] = a - _prevAllocs[i];
+        _rateBytes[i]  = b - _prevBytes[i];
+        _prevAllocs[i] = a;
+        _prevBytes[i]  = b;
+    }
+    _rateIntervalMs = now - prevMs;
+#else
+    (void)prevMs;
+#endif
+}
+
+const HeapMonitor::Sample& HeapMonitor::getLast() const {
+    return _last;
+}
+
+uint32_t HeapMonitor::getInternalMinFree() const {
+    return _intMin;
+}
+
+uint32_t HeapMonitor::getPsramMinFree() const {
+    return _psramMin;
+}
+
+uint32_t HeapMonitor::getWorstLargest() const {
+    return _worstLargest;
+}
+
+uint8_t HeapMonitor::getFragmentationPct() const {
+    if (_last.intFree == 0) return 0;
+    return (uint8_t)(100 - (uint64_t)_last.intLargest * 100 / _last.intFree);
+}
+
+bool HeapMonitor::getAllocRate(uint8_t slot, uint32_t& allocs, uint32_t& bytes,
+                               uint32_t& intervalMs) const {
+    if (!HEAP_ALLOC_TRACKING || slot >= SLOT_COUNT) return false;
+    allocs = _rateAllocs[slot];
+    bytes = _rateBytes[slot];
+    intervalMs = _rateIntervalMs;
+    return true;
+}
+
+const char* HeapMonitor::slotName(uint8_t slot) {
+    return slot == SLOT_TASKS ? "tasks" : Breadcrumbs::stageName(slot);
+}
+
+int HeapMonitor::toJson(char* buf, size_t len) const {
+    int pos = snprintf(buf, len,
+        "{\"int\":{\"free\":%lu,\"big\":%lu,\"min\":%lu,\"worst_big\":%lu,\"frag\":%u},"
+        "\"psram\":{\"free\":%lu,\"big\":%lu,\"min\":%lu}",
+        (unsigned long)_last.intFree, (unsigned long)_last.intLargest,
+        (unsigned long)_intMin, (unsigned long)_worstLargest, getFragmentationPct(),
+        (unsigned long)_last.psramFree, (unsigned long)_last.psramLargest,
+        (unsigned long)_psramMin);
+
+    // Allocations per second by subsystem over the last interval (busy ones only)
+    if (HEAP_ALLOC_TRACKING && pos < (int)len - 32) {
+        pos += snprintf(buf + pos, len - pos, ",\"alloc\":{\"interval_ms\":%lu,\"by\":{",
+                        (unsigned long)_rateIntervalMs);
+        bool first = true;
+        for (uint8_t i = 0; i < SLOT_COUNT && pos < (int)len - 64; i++) {
+            if (_rateAllocs[i] == 0 || _rateIntervalMs == 0) continue;
+            pos += snprintf(buf + pos, len - pos,
+                "%s\"%s\":{\"n_s\":%.2f,\"b_s\":%.0f}",
+                first ? "" : ",", slotName(i),
+                _rateAllocs[i] * 1000.0f / _rateIntervalMs,
+                _rateBytes[i] * 1000.0f / _rateIntervalMs);
+            first = false;
+        }
+        if (pos < (int)len - 3) pos += snprintf(buf + pos, len - pos, "}}");
+    }
+
+    // Hourly points, oldest first: [age_s, free, largest, psram free]
+    if (pos < (int)len - 16) pos += snprintf(buf + pos, len - pos, ",\"hist\":[");
+    uint8_t start = (_histHead + HEAP_HISTORY_SIZE - _histCount) % HEAP_HISTORY_SIZE;
+    for (uint8_t i = 0; i < _histCount && pos < (int)len - 48; i++) {
+        const Sample& s = _history[(start + i) % HEAP_HISTORY_SIZE];
+        pos += snprintf(buf + pos, len - pos, "%s[%lu,%lu,%lu,%lu]",
+                        i > 0 ? "," : "", (unsigned long)((_last.ms - s.ms) / 1000),
+                        (unsigned long)s.intFree, (unsigned long)s.intLargest,
+                        (unsigned long)s.psramFree);
+    }
+    if (pos < (int)len - 3) pos += snprintf(buf + pos, len - pos, "]}");
+    return pos < (int)len ? pos : (int)len - 1;
+}
+
+void IRAM_ATTR HeapMonitor::noteAlloc(size_t bytes) {
+    if (s_loopTask != nullptr && xTaskGetCurrentTaskHandle() == s_loopTask) {
+        uint8_t slot = Crumbs.currentStage();
+        if (slot >= STAGE_COUNT) slot = STAGE_NONE;
+        s_allocs[slot]++;                    // Only the loop task writes these slots
+        s_bytes[slot] += bytes;
+    } else {
+        __atomic_fetch_add(&s_allocs[SLOT_TASKS], 1, __ATOMIC_RELAXED);
+        __atomic_fetch_add(&s_bytes[SLOT_TASKS], (uint32_t)bytes, __ATOMIC_RELAXED);
+    }
+}
+
+// ============================================================================
+// Allocator wrappers (linked with -Wl,--wrap=malloc,--wrap=calloc,--wrap=realloc)
+// ============================================================================
+#if HEAP_ALLOC_TRACKING
+extern "C" {
+void* __real_malloc(size_t size);
+void* __real_calloc(size_t n, size_t size);
+void* __real_realloc(void* ptr, size_t size);
+
+void* IRAM_ATTR __wrap_malloc(size_t size) {
+    HeapMonitor::noteAlloc(size);
+    return __real_malloc(size);
+}
+
+void* IRAM_ATTR __wrap_calloc(size_t n, size_t size) {
+    HeapMonitor::noteAlloc(n * size);
+    return __real_calloc(n, size);
+}
+
+void* IRAM_ATTR __wrap_realloc(void* ptr, size_t size) {
+    if (size > 0) HeapMonitor::noteAlloc(size);   // String growth lands here
+    return __real_realloc(ptr, size);
+}
+}
+#endif
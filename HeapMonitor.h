@@ -0,0 +1,97 @@
+/**
+ * @file      HeapMonitor.h
+ * @brief     Heap and PSRAM fragmentation telemetry
+ * @details   Samples free bytes, the largest free block and the low-water
+ *            mark of the internal heap and PSRAM. Hourly points are kept so a
+ *            slow leak or creeping fragmentation shows up as a trend.
+ *
+ *            With HEAP_ALLOC_TRACKING the allocator is wrapped at link time.
+ *            Each malloc/calloc/realloc is then counted against the loop()
+ *            stage the stall breadcrumbs say is running, or against "tasks"
+ *            when it comes from another task (lwIP, WiFi, timers). Rates are
+ *            reported per sample interval.
+ */
+
+#ifndef HEAPMONITOR_H
+#define HEAPMONITOR_H
+
+#include <Arduino.h>
+#include "config.h"
+#include "Breadcrumbs.h"
+
+class HeapMonitor {
+public:
+    struct Sample {
+        uint32_t ms;                 // millis() when taken
+        uint32_t intFree;            // Internal heap free bytes
+        uint32_t intLargest;         // Largest free internal block
+        uint32_t psramFree;          // 0 without PSRAM
+        uint32_t psramLargest;
+    };
+
+    // One counter slot per loop stage plus one for all other tasks
+    static const uint8_t SLOT_TASKS = STAGE_COUNT;
+    static const uint8_t SLOT_COUNT = STAGE_COUNT + 1;
+
+    HeapMonitor();
+
+    /**
+     * @brief Take the first sample and note the loop task (call from setup)
+     */
+    void begin();
+
+    /**
+     * @brief Sample when HEAP_SAMPLE_INTERVAL_MS has passed (call from loop)
+     */
+    void service();
+
+    const Sample& getLast() const;
+    uint32_t getInternalMinFree() const;     // Low-water mark since boot
+    uint32_t getPsramMinFree() const;
+    uint32_t getWorstLargest() const;        // Smallest largest-block seen
+    uint8_t  getFragmentationPct() const;    // 100 - largest/free, internal heap
+
+    /**
+     * @brief Allocations in the last sample interval for one slot
+     * @return false if allocation tracking is not built in
+     */
+    bool getAllocRate(uint8_t slot, uint32_t& allocs, uint32_t& bytes, uint32_t& intervalMs) const;
+
+    static const char* slotName(uint8_t slot);
+
+    /**
+     * @brief Current state, per-stage rates and the hourly history as JSON
+     * @return Characters written (snprintf semantics, clipped to len)
+     */
+    int toJson(char* buf, size_t len) const;
+
+    /**
+     * @brief Count one allocation (called from the allocator wrappers)
+     */
+    static void IRAM_ATTR noteAlloc(size_t bytes);
+
+private:
+    Sample   _last;
+    uint32_t _intMin;
+    uint32_t _psramMin;
+    uint32_t _worstLargest;
+    bool     _lowWarned;
+
+    Sample   _history[HEAP_HISTORY_SIZE];
+    uint8_t  _histHead;
+    uint8_t  _histCount;
+    uint32_t _lastHistoryMs;
+
+    // Per-slot counts over the last sample interval
+    uint32_t _prevAllocs[SLOT_COUNT];
+    uint32_t _prevBytes[SLOT_COUNT];
+    uint32_t _rateAllocs[SLOT_COUNT];
+    uint32_t _rateBytes[SLOT_COUNT];
+    uint32_t _rateIntervalMs;
+
+    void sample(uint32_t now);
+};
+
+extern HeapMonitor Heap;
+
+#endif // HEAPMONITOR_H
@@ -0,0 +1,104 @@
+/**
+ * @file      LatencyCalibrator.cpp
+ * @brief     ES100 IRQ Latency Calibration Implementation
+ */
+
+#include "LatencyCalibrator.h"
+
+LatencyCalibrator::LatencyCalibrator() {
+    reset();
+}
+
+void LatencyCalibrator::reset() {
+    for (uint8_t i = 0; i < LATCAL_BUCKETS; i++) {
+        _estimateUs[i] = ES100_IRQ_BASE_LATENCY_US;
+        _samples[i]    = 0;
+    }
+    _outliers = 0;
+}
+
+// ============================================================================
+// Persistence
+// ============================================================================
+void LatencyCalibrator::load(Preferences& prefs) {
+    char key[8];
+    for (uint8_t i = 0; i < LATCAL_BUCKETS; i++) {
+        snprintf(key, sizeof(key), "lat%u", i);
+        _estimateUs[i] = prefs.getInt(key, ES100_IRQ_BASE_LATENCY_US);
+        snprintf(key, sizeof(key), "latn%u", i);
+        _samples[i] = prefs.getUShort(key, 0);
+        // An estimate outside the gate is left over from a different build/antenna setup
+        int32_t dev = _estimateUs[i] - ES100_IRQ_BASE_LATENCY_US;
+        if (dev > ES100_LATCAL_MAX_US || dev < -ES100_LATCAL_MAX_US) {
+            _estimateUs[i] = ES100_IRQ_BASE_LATENCY_US;
+            _samples[i]    = 0;
+        }
+    }
+}
+
+void LatencyCalibrator::save(Preferences& prefs) const {
+    char key[8];
+    for (uint8_t i = 0; i < LATCAL_BUCKETS; i++) {
+        snprintf(key, sizeof(key), "lat%u", i);
+        prefs.putInt(key, _estimateUs[i]);
+        snprintf(key, sizeof(key), "latn%u", i);
+        prefs.putUShort(key, _samples[i]);
+    }
+}
+
+// ============================================================================
+// Estimation
+// ============================================================================
+int32_t LatencyCalibrator::getCorrectionUs(bool tracking, bool ant2) const {
+    return _estimateUs[bucketIndex(tracking, ant2)];
+}
+
+bool LatencyCalibrator::addSample(bool tracking, bool ant2, int32_t irqPhaseUs) {
+    uint8_t b = bucketIndex(tracking, ant2);
+
+    // Gate against the running estimate once it has settled; a stray sample
+    // (DS3231 phase from a different source, loop stall in the ISR path) must
+    // not drag the estimate.
+    int32_t err = irqPhaseUs - _estimateUs[b];
+    if (_samples[b] >= ES100_LATCAL_MIN_SAMPLES &&
+        (err > ES100_LATCAL_GATE_US || err < -ES100_LATCAL_GATE_US)) {
+        _outliers++;
+        return false;
+    }
+    int32_t dev = irqPhaseUs - ES100_IRQ_BASE_LATENCY_US;
+    if (dev > ES100_LATCAL_MAX_US || dev < -ES100_LATCAL_MAX_US) {
+        _outliers++;
+        return false;
+    }
+
+    // Running mean until ES100_LATCAL_AVG_DEPTH samples, then an EWMA of that depth
+    uint16_t n = (_samples[b] < ES100_LATCAL_AVG_DEPTH) ? _samples[b] + 1
+                                                         : ES100_LATCAL_AVG_DEPTH;
+    _estimateUs[b] += err / (int32_t)n;
+    if (_samples[b] < 0xFFFF) _samples[b]++;
+    return true;
+}
+
+// ============================================================================
+// Accessors
+// ============================================================================
+int32_t LatencyCalibrator::getEstimateUs(uint8_t bucket) const {
+    return bucket < LATCAL_BUCKETS ? _estimateUs[bucket] : 0;
+}
+
+uint16_t LatencyCalibrator::getSampleCount(uint8_t bucket) const {
+    return bucket < LATCAL_BUCKETS ? _samples[bucket] : 0;
+}
+
+uint32_t LatencyCalibrator::getOutlierCount() const {
+    return _outliers;
+}
+
+const char* LatencyCalibrator::bucketName(uint8_t bucket) {
+    static const char* const names[LATCAL_BUCKETS] = { "N1", "N2", "T1", "T2" };
+    return bucket < LATCAL_BUCKETS ? names[bucket] : "--";
+}
+
+uint8_t LatencyCalibrator::bucketIndex(bool tracking, bool ant2) {
+    return (tracking ? 2 : 0) + (ant2 ? 1 : 0);
+}
@@ -0,0 +1,84 @@
+/**
+ * @file      LatencyCalibrator.h
+ * @brief     ES100 IRQ latency calibration against the DS3231 SQW timebase
+ * @details   The ES100 asserts IRQ some time after the second it reports, and the
+ *            delay differs between normal and tracking mode and between antennas.
+ *            While the clock is phase-locked to the DS3231 1 Hz edge, the offset of
+ *            each IRQ from the held second boundary is recorded per mode×antenna
+ *            and folded into a running estimate that is applied to later fixes.
+ *
+ *            The DS3231 only holds the phase of the previous WWVB fix, so these
+ *            measurements resolve the latency of each bucket relative to the
+ *            others. The common level is anchored by ES100_IRQ_BASE_LATENCY_US,
+ *            which must be measured once against an external reference.
+ *
+ *            That base is 0 by default, and nothing here can learn it. Until it
+ *            is set, the absolute ES100 IRQ latency stays uncorrected: every fix
+ *            is late by the receiver's real delay, and calibration only removes
+ *            the differences between modes and antennas.
+ */
+
+#ifndef LATENCYCALIBRATOR_H
+#define LATENCYCALIBRATOR_H
+
+#include <Arduino.h>
+#include <Preferences.h>
+#include "config.h"
+
+// normal/tracking × antenna 1/2
+#define LATCAL_BUCKETS  4
+
+class LatencyCalibrator {
+public:
+    LatencyCalibrator();
+
+    /**
+     * @brief Restore estimates from NVS (caller has the namespace open)
+     */
+    void load(Preferences& prefs);
+
+    /**
+     * @brief Persist estimates to NVS (caller has the namespace open read-write)
+     */
+    void save(Preferences& prefs) const;
+
+    /**
+     * @brief Latency to add to the elapsed time since the IRQ edge
+     * @param tracking True for a tracking-mode fix
+     * @param ant2     True if antenna 2 produced the fix
+     * @return Estimated delay from the reported second boundary to the IRQ edge (µs)
+     */
+    int32_t getCorrectionUs(bool tracking, bool ant2) const;
+
+    /**
+     * @brief Feed one measurement
+     * @param tracking   True for a tracking-mode fix
+     * @param ant2       True if antenna 2 produced the fix
+     * @param irqPhaseUs Offset of the IRQ edge from the nearest SQW-held second (µs)
+     * @return true if the sample was used; false if rejected as an outlier
+     */
+    bool addSample(bool tracking, bool ant2, int32_t irqPhaseUs);
+
+    /**
+     * @brief Discard all samples and return every bucket to the configured base
+     */
+    void reset();
+
+    int32_t  getEstimateUs(uint8_t bucket) const;
+    uint16_t getSampleCount(uint8_t bucket) const;
+    uint32_t getOutlierCount() const;
+
+    /**
+     * @brief Short bucket label ("N1", "N2", "T1", "T2")
+     */
+    static const char* bucketName(uint8_t bucket);
+
+private:
+    int32_t  _estimateUs[LATCAL_BUCKETS];
+    uint16_t _samples[LATCAL_BUCKETS];
+    uint32_t _outliers;
+
+    static uint8_t bucketIndex(bool tracking, bool ant2);
+};
+
+#endif // LATENCYCALIBRATOR_H
@@ -0,0 +1,87 @@
+/**
+ * @file      LatencyHistogram.cpp
+ * @brief     Fixed-Bucket Latency Histogram Implementation
+ */
+
+#include "LatencyHistogram.h"
+#include "CborWriter.h"
+
+static const uint32_t BUCKET_BOUNDS_US[LATHIST_BUCKETS - 1] = {
+    100, 200, 500,
+    1000, 2000, 5000,
+    10000, 20000, 50000,
+    100000, 200000, 500000,
+    1000000
+};
+
+LatencyHistogram::LatencyHistogram() {
+    reset();
+}
+
+void LatencyHistogram::reset() {
+    memset(_counts, 0, sizeof(_counts));
+    _total  = 0;
+    _minUs  = 0;
+    _maxUs  = 0;
+    _lastUs = 0;
+}
+
+void LatencyHistogram::add(uint32_t us) {
+    uint8_t b = 0;
+    while (b < LATHIST_BUCKETS - 1 && us >= BUCKET_BOUNDS_US[b]) b++;
+    _counts[b]++;
+
+    if (_total == 0 || us < _minUs) _minUs = us;
+    if (us > _maxUs) _maxUs = us;
+    _lastUs = us;
+    _total++;
+}
+
+uint32_t LatencyHistogram::getCount(uint8_t bucket) const {
+    return bucket < LATHIST_BUCKETS ? _counts[bucket] : 0;
+}
+
+uint32_t LatencyHistogram::getTotal() const {
+    return _total;
+}
+
+uint32_t LatencyHistogram::getMinUs() const {
+    return _minUs;
+}
+
+uint32_t LatencyHistogram::getMaxUs() const {
+    return _maxUs;
+}
+
+uint32_t LatencyHistogram::getLastUs() const {
+    return _lastUs;
+}
+
+uint32_t LatencyHistogram::upperBoundUs(uint8_t bucket) {
+    return bucket < LATHIST_BUCKETS - 1 ? BUCKET_BOUNDS_US[bucket] : 0;
+}
+
+int LatencyHistogram::toJson(char* buf, size_t len) const {
+    int pos = snprintf(buf, len, "{\"n\":%lu,\"min\":%lu,\"max\":%lu,\"last\":%lu,\"h\":[",
+                       (unsigned long)_total, (unsigned long)_minUs,
+                       (unsigned long)_maxUs, (unsigned long)_lastUs);
+    for (uint8_t i = 0; i < LATHIST_BUCKETS && pos < (int)len - 12; i++) {
+        pos += snprintf(buf + pos, len - pos, "%s%lu", i > 0 ? "," : "",
+                        (unsigned long)_counts[i]);
+    }
+    if (pos < (int)len - 2) {
+        pos += snprintf(buf + pos, len - pos, "]}");
+    }
+    return pos < (int)len ? pos : (int)len - 1;
+}
+
+void LatencyHistogram::toCbor(CborWriter& w) const {
+    w.beginMap(5);
+    w.kv("n", _total);
+    w.kv("min", _minUs);
+    w.kv("max", _maxUs);
+    w.kv("last", _lastUs);
+    w.key("h");
+    w.beginArray(LATHIST_BUCKETS);
+    for (uint8_t i = 0; i < LATHIST_BUCKETS; i++) w.unsignedInt(_counts[i]);
+}
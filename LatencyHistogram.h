@@ -0,0 +1,66 @@
+/**
+ * @file      LatencyHistogram.h
+ * @brief     Fixed-bucket latency histogram (1-2-5 series, 100 µs to 1 s)
+ * @details   Constant memory and O(buckets) insert, cheap enough for service
+ *            paths. Used for the ES100 IRQ→clock-set latency and the NTP
+ *            receive→send latency.
+ */
+
+#ifndef LATENCYHISTOGRAM_H
+#define LATENCYHISTOGRAM_H
+
+#include <Arduino.h>
+
+// 13 upper bounds plus one overflow bucket
+#define LATHIST_BUCKETS 14
+
+class CborWriter;
+
+class LatencyHistogram {
+public:
+    LatencyHistogram();
+
+    /**
+     * @brief Record one latency sample
+     * @param us Latency in microseconds
+     */
+    void add(uint32_t us);
+
+    /**
+     * @brief Clear all counts
+     */
+    void reset();
+
+    uint32_t getCount(uint8_t bucket) const;
+    uint32_t getTotal() const;
+    uint32_t getMinUs() const;     // 0 if empty
+    uint32_t getMaxUs() const;
+    uint32_t getLastUs() const;
+
+    /**
+     * @brief Exclusive upper bound of a bucket in µs (0 for the overflow bucket)
+     */
+    static uint32_t upperBoundUs(uint8_t bucket);
+
+    /**
+     * @brief Append the histogram as a JSON object to buf
+     * @return Characters written (snprintf semantics, clipped to len)
+     * @details {"n":N,"min":us,"max":us,"last":us,"h":[c0,...]} — bucket i counts
+     *          samples below upperBoundUs(i) and at or above upperBoundUs(i-1).
+     */
+    int toJson(char* buf, size_t len) const;
+
+    /**
+     * @brief Encode the same object as toJson() as a CBOR map
+     */
+    void toCbor(CborWriter& w) const;
+
+private:
+    uint32_t _counts[LATHIST_BUCKETS];
+    uint32_t _total;
+    uint32_t _minUs;
+    uint32_t _maxUs;
+    uint32_t _lastUs;
+};
+
+#endif // LATENCYHISTOGRAM_H
@@ -0,0 +1,521 @@
+/**
+ * @file      MqttPublisher.cpp
+ * @brief     MQTT telemetry publisher implementation
+ */
+
+#include "MqttPublisher.h"
+#include "NTPServer.h"
+#include "ReceptionHistory.h"
+#include "ClockDiscipline.h"
+#include "ClockQuality.h"
+#include "EventLog.h"
+#include "Breadcrumbs.h"
+#include "HeapMonitor.h"
+#include "lwip/sockets.h"
+#include "lwip/dns.h"
+#include "lwip/priv/tcpip_priv.h"
+
+// MQTT 3.1.1 control packet types (fixed header, high nibble)
+#define MQTT_PKT_CONNECT      0x10
+#define MQTT_PKT_CONNACK      0x20
+#define MQTT_PKT_PUBLISH      0x30
+#define MQTT_PKT_PINGREQ      0xC0
+#define MQTT_PKT_DISCONNECT   0xE0
+
+// CONNECT flags
+#define MQTT_FLAG_USER        0x80
+#define MQTT_FLAG_PASS        0x40
+#define MQTT_FLAG_WILL_RETAIN 0x20
+#define MQTT_FLAG_WILL        0x04
+#define MQTT_FLAG_CLEAN       0x02
+
+#define MQTT_TOPIC_MAX        64
+
+static const char* const SOURCE_NAMES[] = { "none", "rtc", "ntp", "wwvb" };
+
+// dns_gethostbyname() is a raw lwIP call, so it goes through tcpip_api_call()
+// like the raw NTP/PTP pcbs.  ERR_OK means addr is already filled (numeric or
+// cached); ERR_INPROGRESS means found() will run later in the tcpip thread.
+struct MqttDnsCall {
+    struct tcpip_api_call_data call;  // must be first
+    dns_found_callback found;
+    void*      arg;
+    ip_addr_t  addr;
+};
+
+static err_t mqttDnsStart(struct tcpip_api_call_data* data) {
+    MqttDnsCall* c = (MqttDnsCall*)data;
+    return dns_gethostbyname(MQTT_BROKER, &c->addr, c->found, c->arg);
+}
+
+MqttPublisher::MqttPublisher()
+    : _state(MQTT_IDLE), _stateMs(0), _fd(-1), _brokerIp(0), _dnsDone(false),
+      _lastTxMs(0), _lastMetricsMs(0),
+      _deferStartMs(0), _lastReqCount(0), _lastReqMs(0), _publishCount(0), _connectCount(0),
+      _failCount(0), _stateDirty(true), _lastSyncMillis(0), _pktLen(0) {
+    _pub.valid = false;
+}
+
+void MqttPublisher::begin() {
+    State.subscribe(onStateChange, this);
+}
+
+void MqttPublisher::onStateChange(void* ctx, StateSliceId slice, uint32_t) {
+    if (slice != STATE_RECEIVER) static_cast<MqttPublisher*>(ctx)->_stateDirty = true;
+}
+
+void MqttPublisher::setNTPServer(const NTPServer* ntp)            { _ntpServer = ntp; }
+void MqttPublisher::setReceptionHistory(ReceptionHistory* rh)     { _receptionHistory = rh; }
+void MqttPublisher::setClockDiscipline(const ClockDiscipline* d)  { _clockDiscipline = d; }
+
+bool     MqttPublisher::isConnected() const     { return _state == MQTT_CONNECTED; }
+uint32_t MqttPublisher::getPublishCount() const { return _publishCount; }
+uint32_t MqttPublisher::getConnectCount() const { return _connectCount; }
+uint32_t MqttPublisher::getFailCount() const    { return _failCount; }
+
+// ============================================================================
+// Service
+// ============================================================================
+
+void MqttPublisher::service(bool busy) {
+    if (MQTT_BROKER[0] == '\0') return;
+    uint32_t now = millis();
+
+    // An attempt in progress is polled every pass, busy or not; each poll is
+    // a flag check or a zero-timeout select()
+    switch (_state) {
+        case MQTT_RESOLVING:     pollResolve(now);    return;
+        case MQTT_CONNECTING:    pollTcpConnect(now); return;
+        case MQTT_AWAIT_CONNACK: pollConnack(now);    return;
+        default: break;
+    }
+
+    // Hold everything (including reconnects) while NTP is busy, up to the cap
+    if (busy) {
+        if (_deferStartMs == 0) _deferStartMs = now | 1;
+        if (now - _deferStartMs < MQTT_MAX_DEFER_MS) return;
+    }
+    _deferStartMs = 0;
+
+    if (_state == MQTT_IDLE) {
+        if (WiFi.status() != WL_CONNECTED) return;
+        if (_stateMs != 0 && now - _stateMs < MQTT_RECONNECT_MS) return;
+        startConnect(now);
+        return;
+    }
+
+    if (!_client.connected()) {
+        Log.event(LOG_SEV_WARNING, "[MQTT] Connection lost");
+        _client.stop();
+        _state = MQTT_IDLE;
+        _failCount++;
+        return;
+    }
+    drainInput();
+
+    publishState(now);
+    if (now - _lastMetricsMs >= MQTT_METRICS_INTERVAL_MS) {
+        publishMetrics(now);
+        _lastMetricsMs = now;
+    }
+    if (_pktLen == 0 && now - _lastTxMs >= (uint32_t)MQTT_KEEPALIVE_S * 500UL) {
+        uint8_t* p = reserve(2);
+        if (p) {
+            p[0] = MQTT_PKT_PINGREQ;
+            p[1] = 0;
+            _pktLen += 2;
+        }
+    }
+    flush();
+}
+
+void MqttPublisher::stop() {
+    if (_state == MQTT_CONNECTED) {
+        uint8_t pkt[2] = { MQTT_PKT_DISCONNECT, 0 };
+        _client.write(pkt, sizeof(pkt));
+    }
+    if (_fd >= 0) {
+        close(_fd);
+        _fd = -1;
+    }
+    _client.stop();
+    _state = MQTT_IDLE;
+    _pktLen = 0;
+}
+
+// ============================================================================
+// Connection
+// ============================================================================
+
+void MqttPublisher::startConnect(uint32_t now) {
+    _stateMs = now | 1;
+    _pktLen = 0;
+    __atomic_store_n(&_dnsDone, false, __ATOMIC_RELAXED);
+
+    MqttDnsCall c;
+    c.found = onDnsFound;
+    c.arg = this;
+    err_t err = tcpip_api_call(mqttDnsStart, &c.call);
+    if (err == ERR_OK) {
+        _brokerIp = IP_IS_V4(&c.addr) ? ip4_addr_get_u32(ip_2_ip4(&c.addr)) : 0;
+        __atomic_store_n(&_dnsDone, true, __ATOMIC_RELEASE);
+    } else if (err != ERR_INPROGRESS) {
+        connectFailed("DNS lookup could not start");
+        return;
+    }
+    _state = MQTT_RESOLVING;
+    pollResolve(now);
+}
+
+void MqttPublisher::onDnsFound(const char*, const ip_addr_t* addr, void* arg) {
+    // tcpip thread: publish the address, then the flag
+    MqttPublisher* self = static_cast<MqttPublisher*>(arg);
+    self->_brokerIp = (addr && IP_IS_V4(addr)) ? ip4_addr_get_u32(ip_2_ip4(addr)) : 0;
+    __atomic_store_n(&self->_dnsDone, true, __ATOMIC_RELEASE);
+}
+
+void MqttPublisher::pollResolve(uint32_t now) {
+    if (!__atomic_load_n(&_dnsDone, __ATOMIC_ACQUIRE)) {
+        if (now - _stateMs >= MQTT_CONNECT_TIMEOUT_MS) connectFailed("DNS timeout");
+        return;
+    }
+    if (_brokerIp == 0) {
+        connectFailed("DNS lookup failed");
+        return;
+    }
+
+    _fd = socket(AF_INET, SOCK_STREAM, IPPROTO_TCP);
+    if (_fd < 0) {
+        connectFailed("no socket");
+        return;
+    }
+    fcntl(_fd, F_SETFL, fcntl(_fd, F_GETFL, 0) | O_NONBLOCK);
+    struct sockaddr_in sa;
+    memset(&sa, 0, sizeof(sa));
+    sa.sin_family      = AF_INET;
+    sa.sin_port        = htons(MQTT_PORT);
+    sa.sin_addr.s_addr = _brokerIp;
+    if (connect(_fd, (struct sockaddr*)&sa, sizeof(sa)) < 0 && errno != EINPROGRESS) {
+        connectFailed("TCP connect refused");
+        return;
+    }
+    _state = MQTT_CONNECTING;
+}
+
+void MqttPublisher::pollTcpConnect(uint32_t now) {
+    fd_set wfds;
+    FD_ZERO(&wfds);
+    FD_SET(_fd, &wfds);
+    struct timeval tv = { 0, 0 };
+    int r = select(_fd + 1, nullptr, &wfds, nullptr, &tv);
+    if (r == 0) {
+        if (now - _stateMs >= MQTT_CONNECT_TIMEOUT_MS) connectFailed("TCP connect timeout");
+        return;
+    }
+    int soErr = 0;
+    socklen_t len = sizeof(soErr);
+    if (r < 0 || getsockopt(_fd, SOL_SOCKET, SO_ERROR, &soErr, &len) < 0 || soErr != 0) {
+        connectFailed("TCP connect failed");
+        return;
+    }
+
+    // Connected: back to a blocking socket, as WiFiClient::connect() leaves it,
+    // and hand it over
+    fcntl(_fd, F_SETFL, fcntl(_fd, F_GETFL, 0) & ~O_NONBLOCK);
+    _client = WiFiClient(_fd);
+    _fd = -1;
+    sendConnect();
+}
+
+void MqttPublisher::connectFailed(const char* why) {
+    Log.event(LOG_SEV_WARNING, "[MQTT] Connect to %s:%d failed: %s", MQTT_BROKER, MQTT_PORT, why);
+    if (_fd >= 0) {
+        close(_fd);
+        _fd = -1;
+    }
+    _client.stop();
+    _state = MQTT_IDLE;
+    _failCount++;
+}
+
+void MqttPublisher::sendConnect() {
+    _client.setNoDelay(true);    // Each pass is already one coalesced write
+
+    char willTopic[MQTT_TOPIC_MAX];
+    snprintf(willTopic, sizeof(willTopic), "%s/status", MQTT_TOPIC_PREFIX);
+    const char* willMsg = "offline";
+
+    uint8_t flags = MQTT_FLAG_CLEAN | MQTT_FLAG_WILL | MQTT_FLAG_WILL_RETAIN;
+    uint32_t rem = 10 + 2 + strlen(MQTT_CLIENT_ID) + 2 + strlen(willTopic) + 2 + strlen(willMsg);
+    if (MQTT_USER[0] != '\0') { flags |= MQTT_FLAG_USER; rem += 2 + strlen(MQTT_USER); }
+    if (MQTT_PASS[0] != '\0') { flags |= MQTT_FLAG_PASS; rem += 2 + strlen(MQTT_PASS); }
+
+    uint8_t* p = reserve(1 + 4 + rem);
+    if (!p) {
+        connectFailed("CONNECT exceeds MQTT_PACKET_MAX");
+        return;
+    }
+    uint16_t n = 0;
+    p[n++] = MQTT_PKT_CONNECT;
+    n += encodeLength(p + n, rem);
+    n += putString(p + n, "MQTT");
+    p[n++] = 4;                                  // Protocol level 3.1.1
+    p[n++] = flags;
+    p[n++] = (uint8_t)(MQTT_KEEPALIVE_S >> 8);
+    p[n++] = (uint8_t)(MQTT_KEEPALIVE_S & 0xFF);
+    n += putString(p + n, MQTT_CLIENT_ID);
+    n += putString(p + n, willTopic);
+    n += putString(p + n, willMsg);
+    if (flags & MQTT_FLAG_USER) n += putString(p + n, MQTT_USER);
+    if (flags & MQTT_FLAG_PASS) n += putString(p + n, MQTT_PASS);
+    _pktLen = (uint16_t)(p - _pkt) + n;
+
+    if (flush()) _state = MQTT_AWAIT_CONNACK;   // On failure flush() has dropped the session
+}
+
+void MqttPublisher::pollConnack(uint32_t now) {
+    if (_client.available() >= 4) {
+        uint8_t ack[4];
+        for (uint8_t i = 0; i < 4; i++) ack[i] = (uint8_t)_client.read();
+        if (ack[0] == MQTT_PKT_CONNACK && ack[1] == 2 && ack[3] == 0) {
+            _state = MQTT_CONNECTED;
+            _connectCount++;
+            _pub.valid = false;                  // Re-assert all retained state
+            _lastMetricsMs = now - MQTT_METRICS_INTERVAL_MS;
+            Log.event(LOG_SEV_NOTICE, "[MQTT] Connected to %s:%d", MQTT_BROKER, MQTT_PORT);
+            publish("status", "online", true);
+            return;
+        }
+        Log.event(LOG_SEV_ERR, "[MQTT] Broker refused connection (code %u)", ack[3]);
+    } else if (now - _stateMs < MQTT_CONNECT_TIMEOUT_MS && _client.connected()) {
+        return;
+    } else {
+        Log.event(LOG_SEV_WARNING, "[MQTT] CONNACK timeout");
+    }
+    _client.stop();
+    _state = MQTT_IDLE;
+    _failCount++;
+}
+
+void MqttPublisher::drainInput() {
+    // Only PINGRESP (and nothing else at QoS 0 with no subscriptions) arrives
+    int avail = _client.available();
+    while (avail-- > 0) _client.read();
+}
+
+// ============================================================================
+// State and metrics
+// ============================================================================
+
+void MqttPublisher::publishState(uint32_t now) {
+    // Nothing to compare unless a slice changed or sync age crossed a step
+    int32_t ageSteps = -1;
+    if (_lastSyncMillis > 0) {
+        ageSteps = (int32_t)((now - _lastSyncMillis) / 1000UL / MQTT_SYNC_AGE_STEP_S);
+    }
+    bool force = !_pub.valid;
+    if (!force && !_stateDirty && ageSteps == _pub.syncAgeSteps) return;
+
+    ClockState clk;
+    NtpRefState ref;
+    PowerState pwr;
+    State.clock.read(clk);
+    State.ntpRef.read(ref);
+    State.power.read(pwr);
+    _lastSyncMillis = clk.lastSyncMillis;
+    char val[16];
+
+    int8_t source = (int8_t)clk.timeSource;
+    if (force || source != _pub.source) {
+        uint8_t idx = (source >= 0 && source < 4) ? source : 0;
+        if (!publish("state/source", SOURCE_NAMES[idx], true)) return;
+        _pub.source = source;
+    }
+
+    int8_t stratum = (int8_t)ref.stratum;
+    if (force || stratum != _pub.stratum) {
+        snprintf(val, sizeof(val), "%d", stratum);
+        if (!publish("state/stratum", val, true)) return;
+        _pub.stratum = stratum;
+    }
+
+    int8_t leap = (int8_t)ref.leapIndicator;
+    if (force || leap != _pub.leap) {
+        snprintf(val, sizeof(val), "%d", leap);
+        if (!publish("state/leap", val, true)) return;
+        _pub.leap = leap;
+    }
+
+    int8_t quality = (int8_t)ref.quality;
+    if (force || quality != _pub.quality) {
+        if (!publish("state/quality", ClockQuality::stateName((ClockQualityState)ref.quality),
+                     true)) return;
+        _pub.quality = quality;
+    }
+
+    ageSteps = -1;
+    if (clk.lastSyncMillis > 0) {
+        ageSteps = (int32_t)((now - clk.lastSyncMillis) / 1000UL / MQTT_SYNC_AGE_STEP_S);
+    }
+    if (force || ageSteps != _pub.syncAgeSteps) {
+        snprintf(val, sizeof(val), "%ld", ageSteps < 0 ? -1L : (long)ageSteps * MQTT_SYNC_AGE_STEP_S);
+        if (!publish("state/sync_age", val, true)) return;
+        _pub.syncAgeSteps = ageSteps;
+    }
+
+    int16_t pct = pwr.batteryPct;
+    if (force || abs(pct - _pub.batteryPct) >= MQTT_BATTERY_STEP_PCT) {
+        snprintf(val, sizeof(val), "%d", pct);
+        if (!publish("state/battery", val, true)) return;
+        _pub.batteryPct = pct;
+    }
+
+    float tc = pwr.temperatureC;
+    if (force || fabsf(tc - _pub.temperatureC) >= MQTT_TEMP_STEP_C) {
+        snprintf(val, sizeof(val), "%.1f", tc);
+        if (!publish("state/temperature", val, true)) return;
+        _pub.temperatureC = tc;
+    }
+
+    _pub.valid = true;
+    _stateDirty = false;
+}
+
+void MqttPublisher::publishMetrics(uint32_t now) {
+    if (!_ntpServer) return;
+    char buf[512];
+    int pos = 0;
+
+    // Rate over the real interval (the first report after boot has no baseline)
+    uint32_t req = _ntpServer->getRequestCount();
+    uint32_t delta = _lastReqMs != 0 ? req - _lastReqCount : 0;
+    float perS = _lastReqMs != 0 && now != _lastReqMs
+               ? delta * 1000.0f / (float)(now - _lastReqMs) : 0.0f;
+    _lastReqCount = req;
+    _lastReqMs = now | 1;
+
+    const NTPRateLimiter& rl = _ntpServer->getRateLimiter();
+    pos += snprintf(buf + pos, sizeof(buf) - pos,
+        "{\"uptime\":%lu,\"ntp\":{\"req\":%lu,\"delta\":%lu,\"rps\":%.2f,"
+        "\"limited\":%lu,\"kod\":%lu,\"malformed\":%lu,\"txerr\":%lu",
+        (unsigned long)(now / 1000), (unsigned long)req, (unsigned long)delta, perS,
+        (unsigned long)rl.getLimitedCount(), (unsigned long)rl.getKoDCount(),
+        (unsigned long)_ntpServer->getMalformedCount(),
+        (unsigned long)_ntpServer->getSendFailCount());
+    // Shedding exists only on the WiFiUDP path; the raw path reports lwIP drops
+    int32_t lwDrops = NTPServer::getLwipUdpDrops();
+    if (!NTPServer::usesRawPbuf()) {
+        pos += snprintf(buf + pos, sizeof(buf) - pos, ",\"shed\":%lu",
+                        (unsigned long)_ntpServer->getShedCount());
+    } else if (lwDrops >= 0) {
+        pos += snprintf(buf + pos, sizeof(buf) - pos, ",\"lwdrop\":%ld", (long)lwDrops);
+    }
+    pos += snprintf(buf + pos, sizeof(buf) - pos, "}");
+
+    if (_receptionHistory && pos < (int)sizeof(buf) - 96) {
+        ReceiverState rx;
+        State.receiver.read(rx);
+        pos += snprintf(buf + pos, sizeof(buf) - pos,
+            ",\"wwvb\":{\"ok\":%d,\"tries\":%d,\"recent_ok\":%d,\"ant1\":%u,\"ant2\":%u}",
+            _receptionHistory->getTotalSuccessCount(),
+            _receptionHistory->getTotalAttemptCount(),
+            _receptionHistory->getRecentSuccessCount(),
+            rx.ant1Successes, rx.ant2Successes);
+    }
+
+    if (_clockDiscipline && pos < (int)sizeof(buf) - 96) {
+        pos += snprintf(buf + pos, sizeof(buf) - pos,
+            ",\"offset\":{\"n\":%u,\"total\":%lu,\"phase_us\":%ld",
+            _clockDiscipline->getCount(),
+            (unsigned long)_clockDiscipline->getTotalCount(),
+            (long)_clockDiscipline->getPhaseUs());
+        if (_clockDiscipline->hasFrequency() && pos < (int)sizeof(buf) - 32) {
+            pos += snprintf(buf + pos, sizeof(buf) - pos, ",\"freq_ppm\":%.3f",
+                            _clockDiscipline->getFrequencyPpm());
+        }
+        if (pos < (int)sizeof(buf) - 2) pos += snprintf(buf + pos, sizeof(buf) - pos, "}");
+    }
+
+    if (pos < (int)sizeof(buf) - 48) {
+        pos += snprintf(buf + pos, sizeof(buf) - pos,
+            ",\"resets\":{\"wdt\":%lu,\"panic\":%lu}",
+            (unsigned long)Crumbs.getWdtResets(), (unsigned long)Crumbs.getPanicResets());
+    }
+
+    if (pos < (int)sizeof(buf) - 72) {
+        pos += snprintf(buf + pos, sizeof(buf) - pos,
+            ",\"heap\":{\"free\":%lu,\"big\":%lu,\"min\":%lu,\"frag\":%u}",
+            (unsigned long)Heap.getLast().intFree, (unsigned long)Heap.getLast().intLargest,
+            (unsigned long)Heap.getInternalMinFree(), Heap.getFragmentationPct());
+    }
+
+    if (pos < (int)sizeof(buf) - 2) {
+        snprintf(buf + pos, sizeof(buf) - pos, "}");
+        publish("metrics", buf, false);
+    }
+}
+
+// ============================================================================
+// Packet assembly
+// ============================================================================
+
+uint8_t* MqttPublisher::reserve(uint16_t n) {
+    if (n > sizeof(_pkt)) return nullptr;
+    if (_pktLen + n > sizeof(_pkt) && !flush()) return nullptr;
+    return _pkt + _pktLen;
+}
+
+bool MqttPublisher::publish(const char* subtopic, const char* payload, bool retain) {
+    char topic[MQTT_TOPIC_MAX];
+    int tlen = snprintf(topic, sizeof(topic), "%s/%s", MQTT_TOPIC_PREFIX, subtopic);
+    if (tlen <= 0 || tlen >= (int)sizeof(topic)) return false;
+
+    size_t plen = strlen(payload);
+    uint32_t rem = 2 + tlen + plen;
+    uint8_t* p = reserve(1 + 4 + rem);
+    if (!p) return false;
+
+    uint16_t n = 0;
+    p[n++] = MQTT_PKT_PUBLISH | (retain ? 0x01 : 0x00);     // QoS 0
+    n += encodeLength(p + n, rem);
+    n += putString(p + n, topic);
+    memcpy(p + n, payload, plen);
+    n += plen;
+    _pktLen += n;
+    _publishCount++;
+    return true;
+}
+
+bool MqttPublisher::flush() {
+    if (_pktLen == 0) return true;
+    size_t sent = _client.write(_pkt, _pktLen);
+    bool ok = sent == _pktLen;
+    _pktLen = 0;
+    _lastTxMs = millis();
+    if (!ok) {
+        Log.event(LOG_SEV_WARNING, "[MQTT] Write failed, dropping session");
+        _client.stop();
+        _state = MQTT_IDLE;
+        _failCount++;
+    }
+    return ok;
+}
+
+uint8_t MqttPublisher::encodeLength(uint8_t* out, uint32_t len) {
+    uint8_t n = 0;
+    do {
+        uint8_t b = len & 0x7F;
+        len >>= 7;
+        if (len > 0) b |= 0x80;
+        out[n++] = b;
+    } while (len > 0 && n < 4);
+    return n;
+}
+
+uint16_t MqttPublisher::putString(uint8_t* out, const char* s) {
+    uint16_t len = (uint16_t)strlen(s);
+    out[0] = (uint8_t)(len >> 8);
+    out[1] = (uint8_t)(len & 0xFF);
+    memcpy(out + 2, s, len);
+    return len + 2;
+}
@@ -0,0 +1,123 @@
+/**
+ * @file      MqttPublisher.h
+ * @brief     Publish-only MQTT 3.1.1 telemetry client
+ * @details   Retained state topics are published only when their value moves
+ *            past a threshold; counters and offset statistics go out as one
+ *            batched JSON document per MQTT_METRICS_INTERVAL_MS. Every packet
+ *            due in a service pass is coalesced into a single TCP write so a
+ *            pass costs one pbuf chain, and passes run from loop() only while
+ *            NTP is quiet. QoS 0 only; the broker's Last Will marks the clock
+ *            offline if the connection drops. Connecting never blocks loop():
+ *            the broker name is resolved by lwIP's asynchronous DNS and the
+ *            TCP connect runs on a non-blocking socket, both polled per pass.
+ */
+
+#ifndef MQTTPUBLISHER_H
+#define MQTTPUBLISHER_H
+
+#include <Arduino.h>
+#include <WiFi.h>
+#include "config.h"
+#include "StateStore.h"
+#include "lwip/ip_addr.h"
+
+class NTPServer;
+class ReceptionHistory;
+class ClockDiscipline;
+
+class MqttPublisher {
+public:
+    MqttPublisher();
+
+    /**
+     * @brief Subscribe to State changes (call once from setup)
+     */
+    void begin();
+
+    void setNTPServer(const NTPServer* ntp);
+    void setReceptionHistory(ReceptionHistory* rh);
+    void setClockDiscipline(const ClockDiscipline* d);
+
+    /**
+     * @brief Connect, publish changed state and due metrics (call from loop)
+     * @param busy True while NTP clients are active; work waits unless it has
+     *             been held for MQTT_MAX_DEFER_MS
+     */
+    void service(bool busy);
+
+    /**
+     * @brief Send DISCONNECT and close the connection (Last Will is not sent)
+     */
+    void stop();
+
+    bool     isConnected() const;
+    uint32_t getPublishCount() const;    // PUBLISH packets sent
+    uint32_t getConnectCount() const;    // Successful CONNACKs
+    uint32_t getFailCount() const;       // Failed or refused connects, dropped sessions
+
+private:
+    enum ConnState : uint8_t {
+        MQTT_IDLE, MQTT_RESOLVING, MQTT_CONNECTING, MQTT_AWAIT_CONNACK, MQTT_CONNECTED
+    };
+
+    // Last published value of each retained state topic
+    struct Published {
+        bool    valid;
+        int8_t  source;
+        int8_t  stratum;
+        int8_t  leap;
+        int8_t  quality;
+        int32_t syncAgeSteps;            // -1 = never synced
+        int16_t batteryPct;
+        float   temperatureC;
+    };
+
+    WiFiClient _client;
+    ConnState  _state;
+    uint32_t   _stateMs;                 // millis() of the last connect attempt
+    int        _fd;                      // Socket while MQTT_CONNECTING, else -1
+    uint32_t   _brokerIp;                // Set with _dnsDone by the DNS callback (0 = not found)
+    bool       _dnsDone;
+    uint32_t   _lastTxMs;                // For keep-alive PINGREQ
+    uint32_t   _lastMetricsMs;
+    uint32_t   _deferStartMs;            // 0 = not deferring
+    bool       _stateDirty;              // A State slice changed since the last pass
+    unsigned long _lastSyncMillis;       // From the last clock snapshot, for sync age
+    uint32_t   _lastReqCount;
+    uint32_t   _lastReqMs;               // 0 = no baseline yet
+
+    uint32_t   _publishCount;
+    uint32_t   _connectCount;
+    uint32_t   _failCount;
+
+    Published  _pub;
+
+    const NTPServer*       _ntpServer = nullptr;
+    ReceptionHistory*      _receptionHistory = nullptr;
+    const ClockDiscipline* _clockDiscipline = nullptr;
+
+    uint8_t    _pkt[MQTT_PACKET_MAX];
+    uint16_t   _pktLen;
+
+    // Connect sequence, one step per pass: resolve, TCP connect, CONNECT/CONNACK
+    void startConnect(uint32_t now);
+    void pollResolve(uint32_t now);
+    void pollTcpConnect(uint32_t now);
+    void sendConnect();
+    void pollConnack(uint32_t now);
+    void connectFailed(const char* why);
+    static void onDnsFound(const char* name, const ip_addr_t* addr, void* arg);
+    void drainInput();
+    void publishState(uint32_t now);
+    void publishMetrics(uint32_t now);
+    static void onStateChange(void* ctx, StateSliceId slice, uint32_t generation);
+
+    // Packet assembly into _pkt; flush() sends whatever is queued in one write
+    uint8_t* reserve(uint16_t n);
+    bool publish(const char* subtopic, const char* payload, bool retain);
+    bool flush();
+    static uint8_t encodeLength(uint8_t* out, uint32_t len);
+    static uint16_t putString(uint8_t* out, const char* s);
+};
+
+#endif // MQTTPUBLISHER_H
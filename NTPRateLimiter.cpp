@@ -0,0 +1,88 @@
+/**
+ * @file      NTPRateLimiter.cpp
+ * @brief     Per-client token bucket implementation
+ */
+
+#include "NTPRateLimiter.h"
+
+NTPRateLimiter::NTPRateLimiter() {
+    reset();
+}
+
+void NTPRateLimiter::reset() {
+    memset(_table, 0, sizeof(_table));
+    _limited = 0;
+    _kod     = 0;
+}
+
+NTPRateLimiter::Entry* NTPRateLimiter::lookup(uint32_t ipv4, uint32_t nowMs) {
+    Entry* victim = &_table[0];
+    for (uint8_t i = 0; i < NTP_RATE_TABLE_SIZE; i++) {
+        Entry& e = _table[i];
+        if (e.used && e.ip == ipv4) return &e;
+        if (!e.used) {
+            if (victim->used) victim = &e;
+        } else if (victim->used && (nowMs - e.lastSeenMs) > (nowMs - victim->lastSeenMs)) {
+            victim = &e;
+        }
+    }
+
+    // New client (or evicting the least recently seen): start with a full
+    // bucket so an iburst start-up is never limited.
+    victim->used       = true;
+    victim->ip         = ipv4;
+    victim->tokens     = NTP_RATE_BURST;
+    victim->refillMs   = nowMs;
+    victim->lastSeenMs = nowMs;
+    victim->lastKoDMs  = 0;
+    victim->kodSent    = false;
+    return victim;
+}
+
+NTPRateLimiter::Verdict NTPRateLimiter::check(uint32_t ipv4, uint32_t nowMs) {
+    Entry* e = lookup(ipv4, nowMs);
+    e->lastSeenMs = nowMs;
+
+    // Refill in whole tokens, carrying the remainder forward
+    uint32_t add = (nowMs - e->refillMs) / NTP_RATE_REFILL_MS;
+    if (add > 0) {
+        if (e->tokens + add >= NTP_RATE_BURST) {
+            e->tokens   = NTP_RATE_BURST;
+            e->refillMs = nowMs;
+        } else {
+            e->tokens   += add;
+            e->refillMs += add * NTP_RATE_REFILL_MS;
+        }
+    }
+
+    if (e->tokens > 0) {
+        e->tokens--;
+        return RATE_ALLOW;
+    }
+
+    _limited++;
+    // KoD is itself rate limited, or a spoofed source could use us as a reflector
+    if (!e->kodSent || (nowMs - e->lastKoDMs) >= NTP_KOD_INTERVAL_MS) {
+        e->kodSent   = true;
+        e->lastKoDMs = nowMs;
+        _kod++;
+        return RATE_KOD;
+    }
+    return RATE_DROP;
+}
+
+uint32_t NTPRateLimiter::getLimitedCount() const {
+    return _limited;
+}
+
+uint32_t NTPRateLimiter::getKoDCount() const {
+    return _kod;
+}
+
+uint8_t NTPRateLimiter::getTrackedClients() const {
+    uint8_t n = 0;
+    for (uint8_t i = 0; i < NTP_RATE_TABLE_SIZE; i++) {
+        if (_table[i].used) n++;
+    }
+    return n;
+}
@@ -0,0 +1,60 @@
+/**
+ * @file      NTPRateLimiter.h
+ * @brief     Per-client token bucket for the NTP server
+ * @details   Fixed table of recently seen IPv4 clients, each with a small token
+ *            bucket. A client that empties its bucket is dropped, with an
+ *            occasional RATE kiss-o'-death (RFC 5905 §7.4) so a well-behaved
+ *            implementation backs off. No allocation; oldest entry is evicted.
+ */
+
+#ifndef NTPRATELIMITER_H
+#define NTPRATELIMITER_H
+
+#include <Arduino.h>
+#include "config.h"
+
+class NTPRateLimiter {
+public:
+    enum Verdict : uint8_t {
+        RATE_ALLOW,   // Serve normally
+        RATE_DROP,    // Over limit, stay silent
+        RATE_KOD      // Over limit, answer with a RATE kiss-o'-death
+    };
+
+    NTPRateLimiter();
+
+    /**
+     * @brief Charge one request to a client
+     * @param ipv4  Client address (network byte order, as stored by lwIP)
+     * @param nowMs millis() at receive
+     */
+    Verdict check(uint32_t ipv4, uint32_t nowMs);
+
+    /**
+     * @brief Forget all clients and zero the counters
+     */
+    void reset();
+
+    uint32_t getLimitedCount() const;   // Requests over the limit (dropped or KoD)
+    uint32_t getKoDCount() const;       // RATE KoDs sent
+    uint8_t  getTrackedClients() const;
+
+private:
+    struct Entry {
+        uint32_t ip;
+        uint32_t refillMs;    // millis() up to which tokens have been credited
+        uint32_t lastSeenMs;  // For eviction
+        uint32_t lastKoDMs;
+        uint8_t  tokens;
+        bool     used;
+        bool     kodSent;
+    };
+
+    Entry    _table[NTP_RATE_TABLE_SIZE];
+    uint32_t _limited;
+    uint32_t _kod;
+
+    Entry* lookup(uint32_t ipv4, uint32_t nowMs);
+};
+
+#endif // NTPRATELIMITER_H
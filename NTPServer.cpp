@@ -6,121 +6,325 @@
  */
 
 #include "NTPServer.h"
+#include "EventLog.h"
+#include "StateStore.h"
+#include "ClockQuality.h"
+#if NTP_USE_RAW_PBUF
+#include "lwip/priv/tcpip_priv.h"
+#include "lwip/stats.h"
+#endif
 
 // NTP packet is always 48 bytes
 #define NTP_PACKET_SIZE 48
 
+#if NTP_USE_RAW_PBUF
+// Raw lwIP calls made outside the tcpip thread go through tcpip_api_call(),
+// the same way the core's AsyncUDP does.
+struct NTPRawCall {
+    struct tcpip_api_call_data call;  // must be first
+    NTPServer* server;
+    udp_recv_fn recv;
+    struct udp_pcb* pcb;
+};
+
+static err_t ntpRawOpen(struct tcpip_api_call_data* data) {
+    NTPRawCall* c = (NTPRawCall*)data;
+    c->pcb = udp_new();
+    if (!c->pcb) return ERR_MEM;
+    err_t err = udp_bind(c->pcb, IP_ANY_TYPE, NTP_PORT);
+    if (err != ERR_OK) {
+        udp_remove(c->pcb);
+        c->pcb = nullptr;
+        return err;
+    }
+    udp_recv(c->pcb, c->recv, c->server);
+    return ERR_OK;
+}
+
+static err_t ntpRawClose(struct tcpip_api_call_data* data) {
+    NTPRawCall* c = (NTPRawCall*)data;
+    udp_remove(c->pcb);
+    return ERR_OK;
+}
+#endif
+
 NTPServer::NTPServer()
     : _timeManager(nullptr), _running(false), _requestCount(0),
-      _stratum(1), _leapIndicator(0), _lastSyncUnixTime(0) {
-    memcpy(_refId, "WWVB", 4);
+      _lastRequestMillis(0),
+      _cyclesLast(0), _cyclesMin(0), _cyclesMax(0), _cyclesTotal(0), _cyclesCount(0),
+      _queueDepth(0), _queueHighWater(0), _queueFullCount(0), _shedCount(0),
+      _malformedCount(0), _sendFailCount(0),
+      _sampleHead(0), _sampleTail(0), _samplesLost(0)
+#if NTP_USE_RAW_PBUF
+      , _pcb(nullptr), _rawLastDoneUs(0)
+#endif
+      {
 }
 
 bool NTPServer::begin(TimeManager* tm) {
     if (!tm) {
-        Serial.println("[NTP] Error: null TimeManager");
+        Log.event(LOG_SEV_ERR, "[NTP] Error: null TimeManager");
         return false;
     }
 
     _timeManager = tm;
-
+#if PCAP_ENABLED
+    _capture.begin();
+#endif
+
+#if NTP_USE_RAW_PBUF
+    // Reset first: the callback can fire as soon as ntpRawOpen registers it
+    _requestCount = 0;
+    _servedLatency.reset();
+    _cyclesCount = 0;
+    _cyclesTotal = 0;
+    _queueHighWater = 0;
+    _rawLastDoneUs = 0;
+    _rateLimiter.reset();
+    NTPRawCall c;
+    c.server = this;
+    c.recv = onRawRecv;
+    c.pcb = nullptr;
+    if (tcpip_api_call(ntpRawOpen, &c.call) == ERR_OK && c.pcb) {
+        _pcb = c.pcb;
+        _running = true;
+        Log.event(LOG_SEV_NOTICE, "[NTP] Server started on UDP port %d (raw pbuf)", NTP_PORT);
+        return true;
+    }
+#else
     if (_udp.begin(NTP_PORT)) {
         _running = true;
         _requestCount = 0;
-        Serial.printf("[NTP] Server started on UDP port %d\n", NTP_PORT);
+        _servedLatency.reset();
+        _cyclesCount = 0;
+        _cyclesTotal = 0;
+        _queueHighWater = 0;
+        _rateLimiter.reset();
+        Log.event(LOG_SEV_NOTICE, "[NTP] Server started on UDP port %d", NTP_PORT);
         return true;
     }
+#endif
 
-    Serial.println("[NTP] Failed to bind UDP port");
+    Log.event(LOG_SEV_ERR, "[NTP] Failed to bind UDP port");
     return false;
 }
 
 void NTPServer::stop() {
     if (_running) {
+#if NTP_USE_RAW_PBUF
+        NTPRawCall c;
+        c.server = this;
+        c.pcb = _pcb;
+        tcpip_api_call(ntpRawClose, &c.call);
+        _pcb = nullptr;
+#else
         _udp.stop();
+#endif
         _running = false;
-        Serial.println("[NTP] Server stopped");
+        Log.event(LOG_SEV_NOTICE, "[NTP] Server stopped");
     }
 }
 
 void NTPServer::handleClient() {
     if (!_running) return;
+    drainClientSamples();
+#if NTP_USE_RAW_PBUF
+    return;  // Requests are answered from onRawRecv()
+#else
+    // Drain everything lwIP has queued for the socket in one pass.  The count
+    // is the receive-mailbox depth at the moment we got to it; WiFiUDP gives no
+    // other view of the queue.
+    struct Pending {
+        uint8_t   pkt[NTP_PACKET_SIZE];
+        uint16_t  len;
+        IPAddress ip;
+        uint16_t  port;
+        uint32_t  rxCycles;
+        uint32_t  rxMicros;
+        uint32_t  rxUnix;
+        uint16_t  rxMs;
+    };
+    static Pending pending[NTP_RECV_MBOX_SIZE];
+    uint8_t depth = 0;
+    uint8_t count = 0;
+
+    while (depth < NTP_RECV_MBOX_SIZE) {
+        uint32_t rxCycles = ESP.getCycleCount();
+        int packetSize = _udp.parsePacket();
+        if (packetSize == 0) break;  // Queue empty
+        depth++;
+
+        // Take T2 before anything else touches the packet — validation and
+        // logging all come after the receive timestamp.
+        Pending& r = pending[count];
+        r.rxCycles = rxCycles;
+        r.rxMicros = micros();
+        _timeManager->getTimeSnapshot(r.rxUnix, r.rxMs);
+        r.ip   = _udp.remoteIP();
+        r.port = _udp.remotePort();
+
+        if (packetSize < NTP_PACKET_SIZE) {
+            Log.event(LOG_SEV_DEBUG, "[NTP] Undersized packet (%d bytes) from %u.%u.%u.%u:%d — ignored",
+                         packetSize, r.ip[0], r.ip[1], r.ip[2], r.ip[3], r.port);
+            // Flush the undersized packet so it doesn't block the buffer
+            uint8_t discard[NTP_PACKET_SIZE];
+            _udp.read(discard, packetSize);
+            _malformedCount++;
+            continue;
+        }
+        // Extension fields / MAC beyond the header are dropped by the next parsePacket()
+        r.len = _udp.read(r.pkt, NTP_PACKET_SIZE);
+        count++;
+    }
+    if (depth == 0) return;
+
+    _lastRequestMillis = millis();
+    _queueDepth = depth;
+    if (depth > _queueHighWater) _queueHighWater = depth;
+    if (depth >= NTP_RECV_MBOX_SIZE) {
+        // Mailbox was full when we reached it: anything arriving meanwhile
+        // was dropped inside lwIP
+        _queueFullCount++;
+        Log.event(LOG_SEV_WARNING, "[NTP] Receive queue full (%d) — lwIP may have dropped requests", depth);
+    }
 
-    int packetSize = _udp.parsePacket();
-    if (packetSize == 0) return;  // No packet available
+    // Shed oldest first: they waited longest, so their T2 is the stalest
+    uint8_t first = 0;
+    if (count > NTP_SHED_THRESHOLD) {
+        first = count - NTP_SHED_THRESHOLD;
+        _shedCount += first;
+        Log.event(LOG_SEV_WARNING, "[NTP] Backlog %d — shedding %d oldest", count, first);
+    }
 
-    // Log every incoming packet for diagnostics
-    IPAddress remoteIP = _udp.remoteIP();
-    uint16_t remotePort = _udp.remotePort();
+    for (uint8_t i = first; i < count; i++) {
+        Pending& r = pending[i];
+        uint8_t clientVN = (r.pkt[0] >> 3) & 0x07;
+        uint8_t clientMode = r.pkt[0] & 0x07;
 
-    if (packetSize < NTP_PACKET_SIZE) {
-        Serial.printf("[NTP] Undersized packet (%d bytes) from %s:%d — ignored\n",
-                     packetSize, remoteIP.toString().c_str(), remotePort);
-        // Flush the undersized packet so it doesn't block the buffer
-        uint8_t discard[NTP_PACKET_SIZE];
-        _udp.read(discard, packetSize);
-        return;
-    }
+        NTPRateLimiter::Verdict verdict = admit(r.pkt, (uint32_t)r.ip, _lastRequestMillis);
+        if (verdict == NTPRateLimiter::RATE_DROP) continue;
 
-    // Read incoming NTP request
-    uint8_t request[NTP_PACKET_SIZE];
-    _udp.read(request, NTP_PACKET_SIZE);
+        uint8_t response[NTP_PACKET_SIZE];
+        if (verdict == NTPRateLimiter::RATE_KOD) {
+            buildKoD(r.pkt, response);
+        } else {
+            buildResponse(r.pkt, response, r.rxUnix, r.rxMs);
+        }
 
-    uint8_t clientVN = (request[0] >> 3) & 0x07;
-    uint8_t clientMode = request[0] & 0x07;
+        // Send response back to the client
+        _udp.beginPacket(r.ip, r.port);
+        _udp.write(response, NTP_PACKET_SIZE);
+        int sent = _udp.endPacket();
+        if (!sent) _sendFailCount++;
+        if (_capture.wants((uint32_t)r.ip)) {
+            _capture.record((uint32_t)r.ip, r.port, r.pkt, r.len, response, NTP_PACKET_SIZE,
+                            r.rxUnix, r.rxMs, r.rxMicros, micros());
+        }
 
-    // RFC 5905: only respond to client (mode 3) or symmetric-active (mode 1) requests.
-    // Ignore server probes (4), broadcast (5), control (6), and private (7) messages.
-    if (clientMode != 3 && clientMode != 1) {
-        Serial.printf("[NTP] Ignoring non-client mode %d from %s:%d\n",
-                     clientMode, remoteIP.toString().c_str(), remotePort);
-        return;
+        if (verdict == NTPRateLimiter::RATE_KOD) {
+            Log.event(LOG_SEV_INFO, "[NTP] RATE KoD → %u.%u.%u.%u:%d",
+                      r.ip[0], r.ip[1], r.ip[2], r.ip[3], r.port);
+            continue;
+        }
+
+        recordCycles(ESP.getCycleCount() - r.rxCycles);
+        _servedLatency.add(micros() - r.rxMicros);
+        _requestCount++;
+
+        // Per-request line at debug severity: Serial only, never shipped.
+        // The address is formatted in place; IPAddress::toString() would
+        // allocate a String for every request even when nothing is printed.
+        Log.event(LOG_SEV_DEBUG, "[NTP] #%lu %u.%u.%u.%u:%d v%d mode%d → stratum %d, NTP-ts %lu, send=%s",
+                  (unsigned long)_requestCount,
+                  r.ip[0], r.ip[1], r.ip[2], r.ip[3], r.port,
+                  clientVN, clientMode,
+                  response[1], (unsigned long)unixToNTP(r.rxUnix),
+                  sent ? "OK" : "FAIL");
+
+        // Hex dump of response for first request (helps diagnose Windows issues)
+        if (_requestCount == 1) {
+            char hex[NTP_PACKET_SIZE * 2 + NTP_PACKET_SIZE / 4 + 1];
+            int n = 0;
+            for (int j = 0; j < NTP_PACKET_SIZE; j++) {
+                n += snprintf(hex + n, sizeof(hex) - n, (j % 4 == 3) ? "%02X " : "%02X", response[j]);
+            }
+            Log.event(LOG_SEV_DEBUG, "[NTP] Response hex: %s", hex);
+        }
     }
+#endif
+}
 
-    // Don't respond if time hasn't been set — would serve year-2000 timestamps
-    if (!_timeManager->isTimeSet()) {
-        Serial.printf("[NTP] Ignoring request from %s:%d — time not set\n",
-                     remoteIP.toString().c_str(), remotePort);
+#if NTP_USE_RAW_PBUF
+void NTPServer::onRawRecv(void* arg, struct udp_pcb* pcb, struct pbuf* p,
+                          const ip_addr_t* addr, u16_t port) {
+    if (!p) return;
+    ((NTPServer*)arg)->serveRaw(pcb, p, addr, port);
+}
+
+void NTPServer::serveRaw(struct udp_pcb* pcb, struct pbuf* p,
+                         const ip_addr_t* addr, u16_t port) {
+    uint32_t rxCycles = ESP.getCycleCount();
+    uint32_t rxMicros = micros();
+    uint32_t rxUnix;
+    uint16_t rxMs;
+    _timeManager->getTimeSnapshot(rxUnix, rxMs);
+    _lastRequestMillis = millis();
+
+    // lwIP's tcpip mailbox can't be inspected.  A request that reaches us
+    // within NTP_RAW_BACKLOG_GAP_US of the previous reply going out was
+    // queued behind it, so the length of such a run stands in for the depth.
+    uint8_t run = (_rawLastDoneUs != 0 && rxMicros - _rawLastDoneUs < NTP_RAW_BACKLOG_GAP_US)
+                  ? _queueDepth : 0;
+    if (run < 0xFF) run++;
+    _queueDepth = run;
+    if (run > _queueHighWater) _queueHighWater = run;
+
+    // The first pbuf of a 48-byte datagram is always contiguous in practice;
+    // a chained or short one is dropped rather than copied.
+    if (p->len < NTP_PACKET_SIZE) {
+        _malformedCount++;
+        pbuf_free(p);
+        _rawLastDoneUs = micros();
         return;
     }
 
-    // Verify NTP timestamp is reasonable (after year 2020 = NTP 3786825600)
-    uint32_t ntpNow = unixToNTP(_timeManager->getUnixTime());
-    if (ntpNow < 3786825600UL) {
-        Serial.printf("[NTP] Ignoring request — NTP timestamp %lu is before 2020\n",
-                     (unsigned long)ntpNow);
+    uint8_t* pkt = (uint8_t*)p->payload;
+    uint32_t ipv4 = IP_IS_V4(addr) ? ip4_addr_get_u32(ip_2_ip4(addr)) : 0;
+    NTPRateLimiter::Verdict verdict = admit(pkt, ipv4, _lastRequestMillis);
+    if (verdict == NTPRateLimiter::RATE_DROP) {
+        pbuf_free(p);
+        _rawLastDoneUs = micros();
         return;
     }
 
-    // Build response
-    uint8_t response[NTP_PACKET_SIZE];
-    buildResponse(request, response);
-
-    // Send response back to the client
-    _udp.beginPacket(remoteIP, remotePort);
-    _udp.write(response, NTP_PACKET_SIZE);
-    int sent = _udp.endPacket();
+    // The request is about to be overwritten: keep a copy if it is captured
+    bool capture = _capture.wants(ipv4);
+    uint8_t reqCopy[PCAP_SNAPLEN];
+    uint16_t reqLen = p->tot_len;
+    if (capture) memcpy(reqCopy, pkt, p->len < PCAP_SNAPLEN ? p->len : PCAP_SNAPLEN);
+
+    // Rewrite the request into the response in the same buffer, trim any
+    // extension fields / MAC, and hand the pbuf straight back to lwIP.
+    if (verdict == NTPRateLimiter::RATE_KOD) {
+        buildKoD(pkt, pkt);
+    } else {
+        buildResponse(pkt, pkt, rxUnix, rxMs);
+    }
+    if (p->tot_len > NTP_PACKET_SIZE) pbuf_realloc(p, NTP_PACKET_SIZE);
+    if (udp_sendto(pcb, p, addr, port) != ERR_OK) _sendFailCount++;
+    if (capture) {
+        _capture.record(ipv4, port, reqCopy, reqLen, pkt, NTP_PACKET_SIZE,
+                        rxUnix, rxMs, rxMicros, micros());
+    }
+    pbuf_free(p);
+    _rawLastDoneUs = micros();
+    if (verdict == NTPRateLimiter::RATE_KOD) return;
 
+    recordCycles(ESP.getCycleCount() - rxCycles);
+    _servedLatency.add(_rawLastDoneUs - rxMicros);
     _requestCount++;
-
-    // Log every request for debugging (can reduce later once working)
-    Serial.printf("[NTP] #%lu %s:%d v%d mode%d → stratum %d, NTP-ts %lu, send=%s\n",
-                 (unsigned long)_requestCount,
-                 remoteIP.toString().c_str(), remotePort,
-                 clientVN, clientMode,
-                 _stratum, (unsigned long)ntpNow,
-                 sent ? "OK" : "FAIL");
-
-    // Hex dump of response for first request (helps diagnose Windows issues)
-    if (_requestCount == 1) {
-        Serial.print("[NTP] Response hex: ");
-        for (int i = 0; i < NTP_PACKET_SIZE; i++) {
-            Serial.printf("%02X", response[i]);
-            if (i % 4 == 3) Serial.print(" ");
-        }
-        Serial.println();
-    }
 }
+#endif
 
 bool NTPServer::isRunning() const {
     return _running;
@@ -130,7 +334,171 @@ uint32_t NTPServer::getRequestCount() const {
     return _requestCount;
 }
 
-void NTPServer::buildResponse(const uint8_t* request, uint8_t* response) {
+const LatencyHistogram& NTPServer::getServedLatency() const {
+    return _servedLatency;
+}
+
+uint32_t NTPServer::getLastRequestMillis() const {
+    return _lastRequestMillis;
+}
+
+void NTPServer::recordCycles(uint32_t cycles) {
+    if (_cyclesCount == 0 || cycles < _cyclesMin) _cyclesMin = cycles;
+    if (cycles > _cyclesMax) _cyclesMax = cycles;
+    _cyclesLast = cycles;
+    _cyclesTotal += cycles;
+    _cyclesCount++;
+}
+
+uint32_t NTPServer::getCyclesLast() const {
+    return _cyclesLast;
+}
+
+uint32_t NTPServer::getCyclesMin() const {
+    return _cyclesMin;
+}
+
+uint32_t NTPServer::getCyclesMax() const {
+    return _cyclesMax;
+}
+
+uint32_t NTPServer::getCyclesAvg() const {
+    return _cyclesCount ? (uint32_t)(_cyclesTotal / _cyclesCount) : 0;
+}
+
+bool NTPServer::usesRawPbuf() {
+    return NTP_USE_RAW_PBUF != 0;
+}
+
+uint8_t NTPServer::getQueueDepth() const {
+    return _queueDepth;
+}
+
+uint8_t NTPServer::getQueueHighWater() const {
+    return _queueHighWater;
+}
+
+uint32_t NTPServer::getQueueFullCount() const {
+    return _queueFullCount;
+}
+
+uint32_t NTPServer::getShedCount() const {
+    return _shedCount;
+}
+
+uint32_t NTPServer::getSendFailCount() const {
+    return _sendFailCount;
+}
+
+int32_t NTPServer::getLwipUdpDrops() {
+#if NTP_USE_RAW_PBUF && LWIP_STATS && UDP_STATS
+    // Datagrams lwIP itself discarded: no buffer, bad checksum/length, no pcb
+    return (int32_t)lwip_stats.udp.drop + lwip_stats.udp.memerr;
+#else
+    return -1;
+#endif
+}
+
+uint32_t NTPServer::getMalformedCount() const {
+    return _malformedCount;
+}
+
+const NTPRateLimiter& NTPServer::getRateLimiter() const {
+    return _rateLimiter;
+}
+
+const ClientAnalytics& NTPServer::getClientAnalytics() const {
+    return _clientStats;
+}
+
+uint32_t NTPServer::getClientSamplesLost() const {
+    return _samplesLost;
+}
+
+void NTPServer::drainClientSamples() {
+    uint32_t tail = _sampleTail;
+    uint32_t head = __atomic_load_n(&_sampleHead, __ATOMIC_ACQUIRE);
+    while (tail != head) {
+        const ClientSample& s = _samples[tail & (CLIENT_SAMPLE_RING - 1)];
+        _clientStats.record(s.ip, s.version, s.poll);
+        tail++;
+    }
+    __atomic_store_n(&_sampleTail, tail, __ATOMIC_RELEASE);
+}
+
+PacketCapture& NTPServer::getCapture() {
+    return _capture;
+}
+
+NTPRateLimiter::Verdict NTPServer::admit(const uint8_t* pkt, uint32_t ipv4, uint32_t nowMs) {
+    // RFC 5905: only respond to client (mode 3) or symmetric-active (mode 1) requests.
+    // Ignore server probes (4), broadcast (5), control (6), and private (7) messages.
+    uint8_t clientMode = pkt[0] & 0x07;
+    if (clientMode != 3 && clientMode != 1) {
+        _malformedCount++;
+        return NTPRateLimiter::RATE_DROP;
+    }
+
+#if NTP_CLIENT_ANALYTICS_ENABLED
+    // Every well-formed client request counts, including ones later limited.
+    // Only an 8-byte sample is queued here; the sketches are updated on the
+    // loop task, off the lwIP thread.
+    uint32_t head = _sampleHead;
+    if (head - __atomic_load_n(&_sampleTail, __ATOMIC_ACQUIRE) < CLIENT_SAMPLE_RING) {
+        ClientSample& s = _samples[head & (CLIENT_SAMPLE_RING - 1)];
+        s.ip      = ipv4;
+        s.version = (pkt[0] >> 3) & 0x07;
+        s.poll    = (int8_t)pkt[2];
+        __atomic_store_n(&_sampleHead, head + 1, __ATOMIC_RELEASE);
+    } else {
+        _samplesLost++;
+    }
+#endif
+
+    // Don't respond if time hasn't been set — would serve year-2000 timestamps.
+    // Also verify the NTP timestamp is reasonable (after year 2020 = NTP 3786825600).
+    if (!_timeManager->isTimeSet() ||
+        unixToNTP(_timeManager->getUnixTime()) < 3786825600UL) {
+        return NTPRateLimiter::RATE_DROP;
+    }
+
+#if NTP_RATE_LIMIT_ENABLED
+    return _rateLimiter.check(ipv4, nowMs);
+#else
+    return NTPRateLimiter::RATE_ALLOW;
+#endif
+}
+
+void NTPServer::buildKoD(const uint8_t* request, uint8_t* response) {
+    uint8_t clientVersion = (request[0] >> 3) & 0x07;
+    uint8_t clientPoll    = request[2];
+    uint8_t clientTx[8];
+    memcpy(clientTx, &request[40], 8);
+
+    // RFC 5905 §7.4: LI=3, stratum 0, kiss code in the reference ID, origin
+    // timestamp echoed so the client can match it; all other timestamps zero.
+    memset(response, 0, NTP_PACKET_SIZE);
+    if (clientVersion < 3) clientVersion = 3;
+    response[0] = (3 << 6) | (clientVersion << 3) | 0x04;
+    response[1] = 0;
+    response[2] = clientPoll;
+    memcpy(&response[12], "RATE", 4);
+    memcpy(&response[24], clientTx, 8);
+}
+
+// The response builder and everything it calls (TimeManager reads, unixToNTP,
+// writeUint32) live in IRAM; member data and the TimeManager are in DRAM.
+// A flash write invalidates the instruction cache, and a flash-resident builder
+// would then miss on every line between T2 and T3.
+void IRAM_ATTR NTPServer::buildResponse(const uint8_t* request, uint8_t* response,
+                                        uint32_t rxUnix, uint16_t rxMs) {
+    // Pull the request fields we echo before clearing — the raw path builds
+    // the response over the request in place.
+    uint8_t clientVersion = (request[0] >> 3) & 0x07;
+    uint8_t clientPoll    = request[2];
+    uint8_t clientTx[8];
+    memcpy(clientTx, &request[40], 8);
+
     memset(response, 0, NTP_PACKET_SIZE);
 
     // Atomically sample seconds + milliseconds — avoids second-boundary race where
@@ -141,17 +509,21 @@ void NTPServer::buildResponse(const uint8_t* request, uint8_t* response) {
     uint32_t ntpNow      = unixToNTP(unixNow);
     uint32_t ntpFraction = (uint32_t)ms * 4294967UL;
 
+    // read() is always_inline and ref lives on this stack, so the snapshot
+    // copy stays in IRAM/DRAM with the rest of the builder
+    NtpRefState ref;
+    State.ntpRef.read(ref);
+
     // Byte 0: LI (2 bits) + VN (3 bits) + Mode (3 bits)
     // LI reflects the leap-second warning decoded from the WWVB frame (RFC 5905).
-    uint8_t clientVersion = (request[0] >> 3) & 0x07;
     if (clientVersion < 3) clientVersion = 3;  // Floor at NTPv3
-    response[0] = (_leapIndicator << 6) | (clientVersion << 3) | 0x04;
+    response[0] = (ref.leapIndicator << 6) | (clientVersion << 3) | 0x04;
 
     // Byte 1: Stratum (1=primary/WWVB, 2=NTP-synced)
-    response[1] = _stratum;
+    response[1] = ref.stratum;
 
     // Byte 2: Poll interval — echo client's requested poll interval
-    response[2] = request[2];
+    response[2] = clientPoll;
 
     // Byte 3: Precision = -10 (2^-10 ~ 1 millisecond, matches millis()-based timekeeping)
     response[3] = 0xF6;
@@ -159,40 +531,29 @@ void NTPServer::buildResponse(const uint8_t* request, uint8_t* response) {
     // Bytes 4-7: Root Delay = 0 (primary reference clock)
     // Already zeroed by memset
 
-    // Bytes 8-11: Root Dispersion — grows at DS3231 drift rate since last sync.
-    // NTP fixed-point 16.16: integer part in upper 16 bits, fraction in lower 16 bits.
-    uint32_t dispersion = NTP_MIN_DISPERSION;
-    if (_lastSyncUnixTime > 0 && unixNow > _lastSyncUnixTime) {
-        uint32_t ageSec = unixNow - _lastSyncUnixTime;
-        // drift = ageSec * ppm / 1,000,000  →  fixed-point 16.16
-        uint32_t driftFixed = (uint32_t)((uint64_t)ageSec * NTP_DS3231_DRIFT_PPM
-                                         * 65536ULL / 1000000ULL);
-        dispersion = NTP_MIN_DISPERSION + driftFixed;
-        if (dispersion > NTP_MAX_DISPERSION) dispersion = NTP_MAX_DISPERSION;
-    }
-    writeUint32(&response[8], dispersion);
+    // Bytes 8-11: Root Dispersion — the ClockQuality error bound: error at the
+    // last sync plus the measured drift budget since (NTP fixed-point 16.16).
+    // rootDispersion() is IRAM_ATTR and integer-only, from inputs precomputed
+    // when the snapshot was published.
+    writeUint32(&response[8], ClockQuality::rootDispersion(ref, unixNow));
 
     // Bytes 12-15: Reference ID
-    memcpy(&response[12], _refId, 4);
+    memcpy(&response[12], ref.refId, 4);
 
     // Bytes 16-23: Reference Timestamp — time of most recent clock sync (RFC 5905 §7.3)
-    uint32_t refNTP = (_lastSyncUnixTime > 0)
-                      ? unixToNTP(_lastSyncUnixTime)
+    uint32_t refNTP = (ref.lastSyncUnix > 0)
+                      ? unixToNTP(ref.lastSyncUnix)
                       : ntpNow;  // Fallback to now if sync time not yet recorded
     writeUint32(&response[16], refNTP);
     writeUint32(&response[20], 0);        // Fraction: 1-second sync precision
 
     // Bytes 24-31: Origin Timestamp = client's Transmit Timestamp
-    // Copy bytes 40-47 from the request
-    memcpy(&response[24], &request[40], 8);
+    // Copied from bytes 40-47 of the request
+    memcpy(&response[24], clientTx, 8);
 
-    // Bytes 32-39: Receive Timestamp — re-sample atomically before writing.
-    // Must NOT reuse the stale unixNow/ntpFraction from the beginning of this function:
-    // if processing above takes >1s, the timestamp becomes stale and NTP clients will
-    // compensate by advancing their clocks by the processing delay, causing errors of 1-3s.
-    uint32_t rxUnix;
-    uint16_t rxMs;
-    _timeManager->getTimeSnapshot(rxUnix, rxMs);
+    // Bytes 32-39: Receive Timestamp — sampled by handleClient() as soon as
+    // parsePacket() returned, so read/validation/logging time counts as server
+    // processing (T3 - T2) rather than skewing the client's offset estimate.
     writeUint32(&response[32], unixToNTP(rxUnix));
     writeUint32(&response[36], (uint32_t)rxMs * 4294967UL);
 
@@ -207,40 +568,14 @@ void NTPServer::buildResponse(const uint8_t* request, uint8_t* response) {
     writeUint32(&response[44], (uint32_t)txMs * 4294967UL);
 }
 
-uint32_t NTPServer::unixToNTP(uint32_t unixTime) {
+uint32_t IRAM_ATTR NTPServer::unixToNTP(uint32_t unixTime) {
     return unixTime + NTP_EPOCH_OFFSET;
 }
 
-void NTPServer::writeUint32(uint8_t* buf, uint32_t val) {
+void IRAM_ATTR NTPServer::writeUint32(uint8_t* buf, uint32_t val) {
     buf[0] = (val >> 24) & 0xFF;
     buf[1] = (val >> 16) & 0xFF;
     buf[2] = (val >> 8) & 0xFF;
     buf[3] = val & 0xFF;
 }
 
-void NTPServer::setStratum(uint8_t stratum, const char* refId) {
-    _stratum = stratum;
-    memset(_refId, 0, 4);
-    if (refId) {
-        size_t len = strlen(refId);
-        if (len > 4) len = 4;
-        memcpy(_refId, refId, len);
-    }
-}
-
-void NTPServer::setStratum(uint8_t stratum, IPAddress refIP) {
-    _stratum = stratum;
-    // RFC 5905: For stratum 2+, reference ID = IPv4 address of upstream server
-    _refId[0] = refIP[0];
-    _refId[1] = refIP[1];
-    _refId[2] = refIP[2];
-    _refId[3] = refIP[3];
-}
-
-void NTPServer::setLastSyncTime(uint32_t unixTime) {
-    _lastSyncUnixTime = unixTime;
-}
-
-void NTPServer::setLeapIndicator(uint8_t li) {
-    _leapIndicator = li & 0x03;
-}
@@ -4,15 +4,33 @@
  * @details   Listens on UDP port 123 and responds to NTP client requests
  *            with the current UTC time from TimeManager (WWVB-synced).
  *            Reference ID: "WWVB" (Stratum 1 primary reference clock)
+ *
+ *            With NTP_USE_RAW_PBUF the server binds a raw lwIP udp_pcb instead
+ *            of WiFiUDP. Requests are answered inside the lwIP receive callback
+ *            by rewriting the received pbuf in place and sending it back, with
+ *            no socket mailbox hop, no RX/TX staging copies and no heap
+ *            allocation of our own.
+ *
+ *            Stratum, leap indicator, reference ID and reference time come
+ *            from a State.ntpRef snapshot taken per request, so a reply never
+ *            mixes fields from two updates.
  */
 
 #ifndef NTPSERVER_H
 #define NTPSERVER_H
 
 #include <Arduino.h>
+#include "config.h"
 #include <WiFiUdp.h>
+#if NTP_USE_RAW_PBUF
+#include "lwip/udp.h"
+#include "lwip/pbuf.h"
+#endif
 #include "TimeManager.h"
-#include "config.h"
+#include "LatencyHistogram.h"
+#include "NTPRateLimiter.h"
+#include "ClientAnalytics.h"
+#include "PacketCapture.h"
 
 class NTPServer {
 public:
@@ -46,48 +64,153 @@ public:
     uint32_t getRequestCount() const;
 
     /**
-     * @brief Set stratum level and reference ID (ASCII for Stratum 1)
-     * @param stratum 1=WWVB primary
-     * @param refId 4-char reference ID (e.g., "WWVB")
+     * @brief Receive→send latency of served requests (µs)
+     * @details Raw pbuf path: from entry to the lwIP receive callback to the
+     *          reply being sent and its pbuf freed. WiFiUDP path: from
+     *          parsePacket() returning a datagram to endPacket() completing.
+     *          Either way a request held in lwIP during a flash write is timed
+     *          from when it reaches the server, so the wait is not here.
+     */
+    const LatencyHistogram& getServedLatency() const;
+
+    /**
+     * @brief millis() of the most recent datagram received (0 if none yet)
+     * @details Lets the main loop hold NVS writes until client traffic is quiet.
+     */
+    uint32_t getLastRequestMillis() const;
+
+    /**
+     * @brief CPU cycles spent per served request, for comparing the two paths
+     * @details WiFiUDP path: parsePacket() through endPacket().
+     *          Raw path: receive callback entry through udp_sendto().
+     */
+    uint32_t getCyclesLast() const;
+    uint32_t getCyclesMin() const;
+    uint32_t getCyclesMax() const;
+    uint32_t getCyclesAvg() const;
+
+    /**
+     * @brief True when serving from the raw lwIP pbuf path
+     */
+    static bool usesRawPbuf();
+
+    // Receive-queue instrumentation.  Depth is the WiFiUDP drain size, or on
+    // the raw path the run of back-to-back requests (NTP_RAW_BACKLOG_GAP_US).
+    // Mailbox-full and shed counts exist only on the WiFiUDP path; the raw
+    // path reports lwIP's own UDP drops instead.
+    uint8_t  getQueueDepth() const;        // Datagrams found on the last drain / current run
+    uint8_t  getQueueHighWater() const;    // Deepest drain or run since begin()
+    uint32_t getQueueFullCount() const;    // Drains that found the mailbox full (WiFiUDP)
+    uint32_t getShedCount() const;         // Oldest requests skipped under backlog (WiFiUDP)
+    uint32_t getMalformedCount() const;    // Undersized or non-client datagrams
+    uint32_t getSendFailCount() const;     // Replies the stack refused to send
+
+    /**
+     * @brief UDP datagrams dropped inside lwIP (raw path, needs LWIP_STATS)
+     * @return Drop + out-of-memory count, or -1 when not available
      */
-    void setStratum(uint8_t stratum, const char* refId);
+    static int32_t getLwipUdpDrops();
 
     /**
-     * @brief Set stratum level with upstream server IP as reference ID
-     * @param stratum 2+ = NTP-synced
-     * @param refIP IPv4 address of upstream NTP server (stored as 4 binary bytes per RFC 5905)
+     * @brief Per-client rate limiter (limited / KoD counters)
      */
-    void setStratum(uint8_t stratum, IPAddress refIP);
+    const NTPRateLimiter& getRateLimiter() const;
 
     /**
-     * @brief Record the Unix time of the most recent clock sync for dispersion calculation.
-     * @param unixTime  Unix timestamp of the sync event
+     * @brief Sketches of the client population (distinct, heavy hitters, poll/version mix)
+     * @details Updated from handleClient() on the loop task; read it there too.
      */
-    void setLastSyncTime(uint32_t unixTime);
+    const ClientAnalytics& getClientAnalytics() const;
+    uint32_t getClientSamplesLost() const;       // Samples dropped on a full hand-off ring
 
     /**
-     * @brief Set the RFC 5905 Leap Indicator for NTP responses.
-     * @param li  0=no warning, 1=last minute has 61 seconds,
-     *            2=last minute has 59 seconds, 3=alarm/unsynchronized
+     * @brief Ring of recent request/response pairs (arm, filter, pcap export)
      */
-    void setLeapIndicator(uint8_t li);
+    PacketCapture& getCapture();
 
 private:
     WiFiUDP _udp;
     TimeManager* _timeManager;
     bool _running;
     uint32_t _requestCount;
-    uint8_t _stratum;
-    char     _refId[4];
-    uint8_t  _leapIndicator;     // 0=none, 1=+1s, 2=-1s, 3=unsynchronized (RFC 5905)
-    uint32_t _lastSyncUnixTime;  // Unix time of last sync, for dispersion growth and reference timestamp
+    uint32_t _lastRequestMillis; // millis() of last received datagram
+    LatencyHistogram _servedLatency;
+
+    // Per-request cycle counts (ESP.getCycleCount())
+    uint32_t _cyclesLast;
+    uint32_t _cyclesMin;
+    uint32_t _cyclesMax;
+    uint64_t _cyclesTotal;
+    uint32_t _cyclesCount;
+
+    void recordCycles(uint32_t cycles);
+
+    uint8_t  _queueDepth;
+    uint8_t  _queueHighWater;
+    uint32_t _queueFullCount;
+    uint32_t _shedCount;
+    uint32_t _malformedCount;
+    uint32_t _sendFailCount;
+    NTPRateLimiter _rateLimiter;
+    ClientAnalytics _clientStats;
+
+    // Single-producer (request path, possibly the lwIP thread) / single-
+    // consumer (loop task) hand-off for the analytics.  Indices run freely
+    // and are masked on use.
+    struct ClientSample {
+        uint32_t ip;
+        uint8_t  version;
+        int8_t   poll;
+    };
+    ClientSample _samples[CLIENT_SAMPLE_RING];
+    uint32_t _sampleHead;        // Written by the producer only
+    uint32_t _sampleTail;        // Written by the consumer only
+    uint32_t _samplesLost;
+
+    void drainClientSamples();
+    PacketCapture _capture;
+
+    /**
+     * @brief Build a RATE kiss-o'-death (stratum 0, LI=3) for a limited client
+     * @details request and response may be the same buffer.
+     */
+    void buildKoD(const uint8_t* request, uint8_t* response);
+
+    /**
+     * @brief Validate and rate-check a request
+     * @return Rate verdict, or RATE_DROP for anything that must not be answered
+     */
+    NTPRateLimiter::Verdict admit(const uint8_t* pkt, uint32_t ipv4, uint32_t nowMs);
+
+#if NTP_USE_RAW_PBUF
+    struct udp_pcb* _pcb;
+    uint32_t _rawLastDoneUs;     // micros() when the previous request was finished with
+
+    /**
+     * @brief lwIP receive callback (runs in the tcpip thread)
+     */
+    static void onRawRecv(void* arg, struct udp_pcb* pcb, struct pbuf* p,
+                          const ip_addr_t* addr, u16_t port);
+
+    /**
+     * @brief Answer one request in place; takes ownership of p
+     */
+    void serveRaw(struct udp_pcb* pcb, struct pbuf* p,
+                  const ip_addr_t* addr, u16_t port);
+#endif
 
     /**
      * @brief Build a 48-byte NTP response packet
      * @param request The incoming request packet (48 bytes)
      * @param response Output buffer for the response (48 bytes)
+     * @param rxUnix  Receive timestamp (T2) seconds, sampled when the datagram arrived
+     * @param rxMs    Receive timestamp (T2) milliseconds
+     * @details IRAM-resident together with the TimeManager reads it calls, so
+     *          a cold instruction cache after a flash write cannot stretch T3.
+     *          request and response may be the same buffer.
      */
-    void buildResponse(const uint8_t* request, uint8_t* response);
+    void buildResponse(const uint8_t* request, uint8_t* response,
+                       uint32_t rxUnix, uint16_t rxMs);
 
     /**
      * @brief Convert Unix timestamp to NTP timestamp (seconds since 1900-01-01)
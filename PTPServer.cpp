@@ -0,0 +1,426 @@
+/**
+ * @file      PTPServer.cpp
+ * @brief     PTPv2 Software Grandmaster Implementation
+ * @details   Message layouts follow IEEE 1588-2008 §13. All multi-byte fields
+ *            are big-endian.
+ */
+
+#include "PTPServer.h"
+#include "EventLog.h"
+#include "StateStore.h"
+#include "ClockQuality.h"
+#include <WiFi.h>
+#include "lwip/priv/tcpip_priv.h"
+#include "lwip/igmp.h"
+
+// PTP primary multicast group (IEEE 1588-2008 Annex D)
+static const IPAddress PTP_MCAST_ADDR(224, 0, 1, 129);
+
+// Message types (low nibble of byte 0)
+#define PTP_MSG_SYNC         0x0
+#define PTP_MSG_DELAY_REQ    0x1
+#define PTP_MSG_FOLLOW_UP    0x8
+#define PTP_MSG_DELAY_RESP   0x9
+#define PTP_MSG_ANNOUNCE     0xB
+
+// Message lengths
+#define PTP_HEADER_LEN       34
+#define PTP_SYNC_LEN         44
+#define PTP_FOLLOW_UP_LEN    44
+#define PTP_DELAY_REQ_LEN    44
+#define PTP_DELAY_RESP_LEN   54
+#define PTP_ANNOUNCE_LEN     64
+
+// flagField bits
+#define PTP_FLAG0_TWO_STEP   0x02
+#define PTP_FLAG1_LEAP61     0x01
+#define PTP_FLAG1_LEAP59     0x02
+#define PTP_FLAG1_UTC_VALID  0x04
+#define PTP_FLAG1_PTP_SCALE  0x08
+#define PTP_FLAG1_TIME_TRACE 0x10
+#define PTP_FLAG1_FREQ_TRACE 0x20
+
+// timeSource enumeration
+#define PTP_SRC_TERRESTRIAL  0x30
+#define PTP_SRC_NTP          0x50
+#define PTP_SRC_INTERNAL_OSC 0xA0
+
+// Raw lwIP calls made outside the tcpip thread go through tcpip_api_call(),
+// as in NTPServer.cpp.
+struct PTPRawCall {
+    struct tcpip_api_call_data call;  // must be first
+    PTPServer*      server;
+    udp_recv_fn     recv;
+    struct udp_pcb* pcb;
+    const uint8_t*  data;             // Send: datagram to multicast on 319
+    uint16_t        len;
+    uint32_t        txMicros;         // Send: micros() as udp_sendto() returned
+};
+
+static void ptpGroup(ip4_addr_t* group) {
+    IP4_ADDR(group, 224, 0, 1, 129);
+}
+
+// The receive callback is registered here, in the tcpip thread, so the pcb
+// never sees a datagram without its handler
+static err_t ptpRawOpen(struct tcpip_api_call_data* data) {
+    PTPRawCall* c = (PTPRawCall*)data;
+    c->pcb = udp_new();
+    if (!c->pcb) return ERR_MEM;
+    ip4_addr_t group;
+    ptpGroup(&group);
+    err_t err = udp_bind(c->pcb, IP_ANY_TYPE, PTP_EVENT_PORT);
+    if (err == ERR_OK) err = igmp_joingroup(IP4_ADDR_ANY4, &group);
+    if (err != ERR_OK) {
+        udp_remove(c->pcb);
+        c->pcb = nullptr;
+        return err;
+    }
+    udp_recv(c->pcb, c->recv, c->server);
+    return ERR_OK;
+}
+
+static err_t ptpRawClose(struct tcpip_api_call_data* data) {
+    PTPRawCall* c = (PTPRawCall*)data;
+    ip4_addr_t group;
+    ptpGroup(&group);
+    igmp_leavegroup(IP4_ADDR_ANY4, &group);
+    udp_remove(c->pcb);
+    return ERR_OK;
+}
+
+static err_t ptpRawSend(struct tcpip_api_call_data* data) {
+    PTPRawCall* c = (PTPRawCall*)data;
+    struct pbuf* p = pbuf_alloc(PBUF_TRANSPORT, c->len, PBUF_RAM);
+    if (!p) return ERR_MEM;
+    memcpy(p->payload, c->data, c->len);
+    ip_addr_t dst;
+    IP_ADDR4(&dst, 224, 0, 1, 129);
+    err_t err = udp_sendto(c->pcb, p, &dst, PTP_EVENT_PORT);
+    // Taken here rather than after tcpip_api_call() returns, so the wake-up
+    // of the calling task does not count as wire time
+    c->txMicros = micros();
+    pbuf_free(p);
+    return err;
+}
+
+PTPServer::PTPServer()
+    : _eventPcb(nullptr), _timeManager(nullptr), _running(false),
+      _syncSeq(0), _announceSeq(0), _lastSyncMs(0), _lastAnnounceMs(0),
+      _syncCount(0), _announceCount(0), _delayReqCount(0),
+      _reqHead(0), _reqTail(0), _delayReqLost(0) {
+    memset(_clockId, 0, sizeof(_clockId));
+}
+
+bool PTPServer::begin(TimeManager* tm) {
+    if (!tm) {
+        Log.event(LOG_SEV_ERR, "[PTP] Error: null TimeManager");
+        return false;
+    }
+    _timeManager = tm;
+
+    // clockIdentity: EUI-48 → EUI-64 by inserting FF FE in the middle
+    uint8_t mac[6];
+    WiFi.macAddress(mac);
+    _clockId[0] = mac[0]; _clockId[1] = mac[1]; _clockId[2] = mac[2];
+    _clockId[3] = 0xFF;   _clockId[4] = 0xFE;
+    _clockId[5] = mac[3]; _clockId[6] = mac[4]; _clockId[7] = mac[5];
+
+    _reqTail = _reqHead;    // No producer until the pcb is open
+    PTPRawCall c;
+    c.server = this;
+    c.recv = onEventRecv;
+    c.pcb = nullptr;
+    if (tcpip_api_call(ptpRawOpen, &c.call) != ERR_OK || !c.pcb) {
+        Log.event(LOG_SEV_ERR, "[PTP] Failed to bind event port 319");
+        return false;
+    }
+    _eventPcb = c.pcb;
+    if (!_general.beginMulticast(PTP_MCAST_ADDR, PTP_GENERAL_PORT)) {
+        Log.event(LOG_SEV_ERR, "[PTP] Failed to bind general port 320");
+        tcpip_api_call(ptpRawClose, &c.call);
+        _eventPcb = nullptr;
+        return false;
+    }
+
+    _running = true;
+    _lastSyncMs = millis();
+    _lastAnnounceMs = millis() - (1000UL << PTP_LOG_ANNOUNCE_INTERVAL);  // Announce at once
+    Log.event(LOG_SEV_NOTICE, "[PTP] Grandmaster started, clockIdentity %02X%02X%02X.FFFE.%02X%02X%02X domain %d",
+                  mac[0], mac[1], mac[2], mac[3], mac[4], mac[5], PTP_DOMAIN);
+    return true;
+}
+
+void PTPServer::stop() {
+    if (_running) {
+        PTPRawCall c;
+        c.server = this;
+        c.pcb = _eventPcb;
+        tcpip_api_call(ptpRawClose, &c.call);
+        _eventPcb = nullptr;
+        _general.stop();
+        _running = false;
+        Log.event(LOG_SEV_NOTICE, "[PTP] Grandmaster stopped");
+    }
+}
+
+bool PTPServer::isRunning() const {
+    return _running;
+}
+
+uint32_t PTPServer::getSyncCount() const {
+    return _syncCount;
+}
+
+uint32_t PTPServer::getAnnounceCount() const {
+    return _announceCount;
+}
+
+uint32_t PTPServer::getDelayReqCount() const {
+    return _delayReqCount;
+}
+
+uint32_t PTPServer::getDelayReqLost() const {
+    return _delayReqLost;
+}
+
+uint8_t PTPServer::getClockClass() const {
+    if (!_timeManager) return 248;
+    uint8_t clockClass, accuracy, timeSource, flags1;
+    currentQuality(clockClass, accuracy, timeSource, flags1);
+    return clockClass;
+}
+
+void PTPServer::handleClient() {
+    if (!_running) return;
+
+    // Delay_Req receive times were stamped in the lwIP callback; answering
+    // them late delays the Delay_Resp but does not change what it carries
+    serviceDelayReq();
+
+    // A grandmaster with no time has nothing to distribute
+    if (!_timeManager->isTimeSet()) return;
+
+    uint32_t now = millis();
+    if (now - _lastAnnounceMs >= (1000UL << PTP_LOG_ANNOUNCE_INTERVAL)) {
+        _lastAnnounceMs = now;
+        sendAnnounce();
+    }
+    if (now - _lastSyncMs >= (1000UL << PTP_LOG_SYNC_INTERVAL)) {
+        _lastSyncMs = now;
+        sendSync();
+    }
+}
+
+// ============================================================================
+// Event Messages
+// ============================================================================
+
+void PTPServer::sendSync() {
+    uint8_t clockClass, accuracy, timeSource, flags1;
+    currentQuality(clockClass, accuracy, timeSource, flags1);
+    uint16_t seq = _syncSeq++;
+
+    // Two-step: the Sync carries an estimate, the Follow_Up the time
+    // udp_sendto() returned in the tcpip thread (closest point to the driver
+    // we see).
+    uint8_t sync[PTP_SYNC_LEN];
+    writeHeader(sync, PTP_MSG_SYNC, PTP_SYNC_LEN, seq, 0x00,
+                PTP_LOG_SYNC_INTERVAL, PTP_FLAG0_TWO_STEP, flags1);
+    uint32_t estSec, estUs;
+    _timeManager->getTimeAtMicros(micros(), estSec, estUs);
+    writeTimestamp(&sync[34], estSec, estUs * 1000UL);
+
+    PTPRawCall c;
+    c.server = this;
+    c.pcb = _eventPcb;
+    c.data = sync;
+    c.len = PTP_SYNC_LEN;
+    c.txMicros = 0;
+    if (tcpip_api_call(ptpRawSend, &c.call) != ERR_OK) return;
+    uint32_t txMicros = c.txMicros;
+
+    uint32_t txSec, txUs;
+    _timeManager->getTimeAtMicros(txMicros, txSec, txUs);
+
+    uint8_t fup[PTP_FOLLOW_UP_LEN];
+    writeHeader(fup, PTP_MSG_FOLLOW_UP, PTP_FOLLOW_UP_LEN, seq, 0x02,
+                PTP_LOG_SYNC_INTERVAL, 0, flags1);
+    writeTimestamp(&fup[34], txSec, txUs * 1000UL);
+
+    _general.beginPacket(PTP_MCAST_ADDR, PTP_GENERAL_PORT);
+    _general.write(fup, PTP_FOLLOW_UP_LEN);
+    _general.endPacket();
+    _syncCount++;
+}
+
+void PTPServer::onEventRecv(void* arg, struct udp_pcb* pcb, struct pbuf* p,
+                            const ip_addr_t* addr, u16_t port) {
+    if (!p) return;
+    ((PTPServer*)arg)->queueDelayReq(p);
+}
+
+void PTPServer::queueDelayReq(struct pbuf* p) {
+    uint32_t rxMicros = micros();
+    const uint8_t* req = (const uint8_t*)p->payload;
+
+    // Our own multicast Sync may loop back on 319 — only Delay_Req is of interest
+    if (p->len >= PTP_DELAY_REQ_LEN &&
+        (req[0] & 0x0F) == PTP_MSG_DELAY_REQ &&
+        (req[1] & 0x0F) == 2 &&
+        req[4] == PTP_DOMAIN) {
+        uint32_t head = _reqHead;
+        if (head - __atomic_load_n(&_reqTail, __ATOMIC_ACQUIRE) < PTP_DELAY_REQ_RING) {
+            DelayReq& r = _reqs[head & (PTP_DELAY_REQ_RING - 1)];
+            r.rxMicros = rxMicros;
+            memcpy(r.correction, &req[8], 8);
+            memcpy(r.portId, &req[20], 10);
+            r.seq = ((uint16_t)req[30] << 8) | req[31];
+            __atomic_store_n(&_reqHead, head + 1, __ATOMIC_RELEASE);
+        } else {
+            _delayReqLost++;
+        }
+    }
+    pbuf_free(p);
+}
+
+void PTPServer::serviceDelayReq() {
+    uint32_t tail = _reqTail;
+    uint32_t head = __atomic_load_n(&_reqHead, __ATOMIC_ACQUIRE);
+    if (tail == head) return;
+
+    uint8_t clockClass, accuracy, timeSource, flags1;
+    currentQuality(clockClass, accuracy, timeSource, flags1);
+    bool timeSet = _timeManager->isTimeSet();
+
+    for (; tail != head; tail++) {
+        if (!timeSet) continue;     // Nothing to answer with; discard
+        const DelayReq& r = _reqs[tail & (PTP_DELAY_REQ_RING - 1)];
+        uint32_t rxSec, rxUs;
+        _timeManager->getTimeAtMicros(r.rxMicros, rxSec, rxUs);
+
+        uint8_t resp[PTP_DELAY_RESP_LEN];
+        writeHeader(resp, PTP_MSG_DELAY_RESP, PTP_DELAY_RESP_LEN, r.seq, 0x03,
+                    PTP_LOG_MIN_DELAY_REQ_INTERVAL, 0, flags1);
+        memcpy(&resp[8], r.correction, 8);       // correctionField from the request
+        writeTimestamp(&resp[34], rxSec, rxUs * 1000UL);
+        memcpy(&resp[44], r.portId, 10);         // requestingPortIdentity
+
+        _general.beginPacket(PTP_MCAST_ADDR, PTP_GENERAL_PORT);
+        _general.write(resp, PTP_DELAY_RESP_LEN);
+        _general.endPacket();
+        _delayReqCount++;
+    }
+    __atomic_store_n(&_reqTail, tail, __ATOMIC_RELEASE);
+}
+
+// ============================================================================
+// General Messages
+// ============================================================================
+
+void PTPServer::sendAnnounce() {
+    uint8_t clockClass, accuracy, timeSource, flags1;
+    currentQuality(clockClass, accuracy, timeSource, flags1);
+
+    uint8_t msg[PTP_ANNOUNCE_LEN];
+    writeHeader(msg, PTP_MSG_ANNOUNCE, PTP_ANNOUNCE_LEN, _announceSeq++, 0x05,
+                PTP_LOG_ANNOUNCE_INTERVAL, 0, flags1);
+    memset(&msg[34], 0, 10);                         // originTimestamp (optional)
+    msg[44] = (PTP_TAI_UTC_OFFSET_S >> 8) & 0xFF;    // currentUtcOffset
+    msg[45] = PTP_TAI_UTC_OFFSET_S & 0xFF;
+    msg[46] = 0;                                     // reserved
+    msg[47] = PTP_PRIORITY1;
+    msg[48] = clockClass;                            // grandmasterClockQuality
+    msg[49] = accuracy;
+    msg[50] = 0xFF;                                  // offsetScaledLogVariance: not computed
+    msg[51] = 0xFF;
+    msg[52] = PTP_PRIORITY2;
+    memcpy(&msg[53], _clockId, 8);                   // grandmasterIdentity
+    msg[61] = 0;                                     // stepsRemoved
+    msg[62] = 0;
+    msg[63] = timeSource;
+
+    _general.beginPacket(PTP_MCAST_ADDR, PTP_GENERAL_PORT);
+    _general.write(msg, PTP_ANNOUNCE_LEN);
+    _general.endPacket();
+    _announceCount++;
+}
+
+// ============================================================================
+// Helpers
+// ============================================================================
+
+void PTPServer::writeHeader(uint8_t* buf, uint8_t type, uint16_t len, uint16_t seq,
+                            uint8_t control, int8_t logInterval,
+                            uint8_t flags0, uint8_t flags1) {
+    memset(buf, 0, PTP_HEADER_LEN);
+    buf[0]  = type & 0x0F;                 // transportSpecific 0
+    buf[1]  = 0x02;                        // versionPTP 2
+    buf[2]  = (len >> 8) & 0xFF;
+    buf[3]  = len & 0xFF;
+    buf[4]  = PTP_DOMAIN;
+    buf[6]  = flags0;
+    buf[7]  = flags1;
+    // 8-15 correctionField = 0, 16-19 reserved
+    memcpy(&buf[20], _clockId, 8);         // sourcePortIdentity.clockIdentity
+    buf[28] = 0;                           // sourcePortIdentity.portNumber = 1
+    buf[29] = 1;
+    buf[30] = (seq >> 8) & 0xFF;
+    buf[31] = seq & 0xFF;
+    buf[32] = control;
+    buf[33] = (uint8_t)logInterval;
+}
+
+void PTPServer::writeTimestamp(uint8_t* buf, uint32_t unixSeconds, uint32_t nanos) {
+    uint32_t tai = unixSeconds + PTP_TAI_UTC_OFFSET_S;
+    buf[0] = 0;                            // secondsField upper 16 bits
+    buf[1] = 0;
+    buf[2] = (tai >> 24) & 0xFF;
+    buf[3] = (tai >> 16) & 0xFF;
+    buf[4] = (tai >> 8) & 0xFF;
+    buf[5] = tai & 0xFF;
+    buf[6] = (nanos >> 24) & 0xFF;
+    buf[7] = (nanos >> 16) & 0xFF;
+    buf[8] = (nanos >> 8) & 0xFF;
+    buf[9] = nanos & 0xFF;
+}
+
+// clockAccuracy code (IEEE 1588-2008 Table 6) for an error bound in µs
+static uint8_t accuracyCode(uint32_t boundUs) {
+    static const uint32_t limitsUs[] = {
+        1, 2, 10, 25, 100, 250, 1000, 2500, 10000, 25000, 100000, 250000, 1000000, 10000000
+    };
+    for (uint8_t i = 0; i < sizeof(limitsUs) / sizeof(limitsUs[0]); i++) {
+        if (boundUs <= limitsUs[i]) return 0x23 + i;        // 0x23 = 1 µs … 0x30 = 10 s
+    }
+    return 0x31;                                            // > 10 s
+}
+
+void PTPServer::currentQuality(uint8_t& clockClass, uint8_t& accuracy,
+                               uint8_t& timeSource, uint8_t& flags1) const {
+    NtpRefState ref;
+    State.ntpRef.read(ref);
+    uint8_t li = ref.leapIndicator;
+
+    flags1 = PTP_FLAG1_PTP_SCALE | PTP_FLAG1_UTC_VALID;
+    if (li == 1) flags1 |= PTP_FLAG1_LEAP61;
+    if (li == 2) flags1 |= PTP_FLAG1_LEAP59;
+
+    if (ref.quality >= CQ_FREERUN) {
+        clockClass = 248;                  // Default / free-running
+        accuracy   = 0xFE;                 // Unknown
+        timeSource = PTP_SRC_INTERNAL_OSC;
+        return;
+    }
+
+    // ClockQuality state → locked / holdover in spec / degradation alternative A,
+    // for a primary reference (6, 7, 52) or an application-specific one (13, 14, 58)
+    static const uint8_t primary[CQ_FREERUN] = { 6, 7, 52 };
+    static const uint8_t appSpecific[CQ_FREERUN] = { 13, 14, 58 };
+    bool wwvb = ref.stratum == 1;
+    clockClass = wwvb ? primary[ref.quality] : appSpecific[ref.quality];
+    accuracy   = accuracyCode(ClockQuality::errorBoundUs(ref, _timeManager->getUnixTime()));
+    timeSource = wwvb ? PTP_SRC_TERRESTRIAL : PTP_SRC_NTP;
+    flags1    |= PTP_FLAG1_TIME_TRACE;
+    if (wwvb && ref.quality == CQ_LOCKED) flags1 |= PTP_FLAG1_FREQ_TRACE;
+}
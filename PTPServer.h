@@ -0,0 +1,129 @@
+/**
+ * @file      PTPServer.h
+ * @brief     IEEE 1588-2008 (PTPv2) software grandmaster over UDP/IPv4
+ * @details   Multicasts Announce and two-step Sync/Follow_Up on 224.0.1.129
+ *            and answers Delay_Req with Delay_Resp (end-to-end delay
+ *            mechanism). Timestamps come from TimeManager at microsecond
+ *            resolution. The event port is a raw lwIP pcb: a Sync's precise
+ *            origin time is taken in the tcpip thread as udp_sendto() returns,
+ *            and a Delay_Req's receive time on entry to the receive callback,
+ *            independent of how long loop() takes to get round to answering.
+ *            Clock quality follows the stratum the NTP
+ *            server advertises (State.ntpRef): WWVB → class 6, NTP → class 13,
+ *            unsynced → class 248.
+ */
+
+#ifndef PTPSERVER_H
+#define PTPSERVER_H
+
+#include <Arduino.h>
+#include <WiFiUdp.h>
+#include "lwip/udp.h"
+#include "TimeManager.h"
+#include "config.h"
+
+#define PTP_EVENT_PORT      319
+#define PTP_GENERAL_PORT    320
+
+class PTPServer {
+public:
+    PTPServer();
+
+    /**
+     * @brief Join the PTP multicast group and start serving
+     * @param tm  TimeManager providing the disciplined timebase
+     * @return true if both sockets were opened
+     */
+    bool begin(TimeManager* tm);
+
+    /**
+     * @brief Leave the multicast group and close both sockets
+     */
+    void stop();
+
+    /**
+     * @brief Answer Delay_Req and send due Sync/Announce messages (call from loop)
+     */
+    void handleClient();
+
+    bool isRunning() const;
+
+    uint32_t getSyncCount() const;
+    uint32_t getAnnounceCount() const;
+    uint32_t getDelayReqCount() const;
+    uint32_t getDelayReqLost() const;      // Dropped on a full hand-off ring
+
+    /**
+     * @brief clockClass currently advertised in Announce (6, 13 or 248)
+     */
+    uint8_t getClockClass() const;
+
+private:
+    struct udp_pcb* _eventPcb;  // UDP 319: Sync, Delay_Req (raw, tcpip thread)
+    WiFiUDP _general;           // UDP 320: Announce, Follow_Up, Delay_Resp
+    TimeManager* _timeManager;
+    bool _running;
+
+    uint8_t  _clockId[8];       // EUI-64 from the station MAC
+    uint16_t _syncSeq;
+    uint16_t _announceSeq;
+    uint32_t _lastSyncMs;
+    uint32_t _lastAnnounceMs;
+
+    uint32_t _syncCount;
+    uint32_t _announceCount;
+    uint32_t _delayReqCount;
+
+    // Delay_Req hand-off from the lwIP thread (producer) to the loop task
+    // (consumer): the receive stamp and the fields the Delay_Resp echoes.
+    // Indices run freely and are masked on use.
+    struct DelayReq {
+        uint32_t rxMicros;
+        uint8_t  correction[8];
+        uint8_t  portId[10];
+        uint16_t seq;
+    };
+    DelayReq _reqs[PTP_DELAY_REQ_RING];
+    uint32_t _reqHead;          // Written by the producer only
+    uint32_t _reqTail;          // Written by the consumer only
+    uint32_t _delayReqLost;
+
+    void sendSync();
+    void sendAnnounce();
+
+    /**
+     * @brief Answer every Delay_Req queued since the last pass
+     */
+    void serviceDelayReq();
+
+    /**
+     * @brief lwIP receive callback for the event port (runs in the tcpip thread)
+     */
+    static void onEventRecv(void* arg, struct udp_pcb* pcb, struct pbuf* p,
+                            const ip_addr_t* addr, u16_t port);
+
+    /**
+     * @brief Stamp and queue a Delay_Req; takes ownership of p
+     */
+    void queueDelayReq(struct pbuf* p);
+
+    /**
+     * @brief Write the 34-byte common header
+     * @param flags1 Second flagField byte (leap, UTC-offset-valid, timescale, traceable)
+     */
+    void writeHeader(uint8_t* buf, uint8_t type, uint16_t len, uint16_t seq,
+                     uint8_t control, int8_t logInterval, uint8_t flags0, uint8_t flags1);
+
+    /**
+     * @brief Write a 10-byte PTP timestamp (48-bit seconds, 32-bit ns) in TAI
+     */
+    static void writeTimestamp(uint8_t* buf, uint32_t unixSeconds, uint32_t nanos);
+
+    /**
+     * @brief Derive clockClass / clockAccuracy / timeSource / flags from the NTP state
+     */
+    void currentQuality(uint8_t& clockClass, uint8_t& accuracy,
+                        uint8_t& timeSource, uint8_t& flags1) const;
+};
+
+#endif // PTPSERVER_H
@@ -0,0 +1,199 @@
+/**
+ * @file      PacketCapture.cpp
+ * @brief     NTP exchange capture ring implementation
+ */
+
+#include "PacketCapture.h"
+#include "EventLog.h"
+
+#define PCAP_MAGIC_US        0xA1B2C3D4
+#define PCAP_LINKTYPE_IPV4   228
+#define PCAP_IP_UDP_HDR      28           // IPv4 (no options) + UDP
+#define NTP_PORT_SERVER      123
+#define PCAP_EXPORT_CHUNK    1280
+
+static inline void putLe16(uint8_t* p, uint16_t v) {
+    p[0] = v & 0xFF;
+    p[1] = v >> 8;
+}
+
+static inline void putLe32(uint8_t* p, uint32_t v) {
+    p[0] = v & 0xFF;
+    p[1] = (v >> 8) & 0xFF;
+    p[2] = (v >> 16) & 0xFF;
+    p[3] = v >> 24;
+}
+
+static inline void putBe16(uint8_t* p, uint16_t v) {
+    p[0] = v >> 8;
+    p[1] = v & 0xFF;
+}
+
+PacketCapture::PacketCapture()
+    : _ring(nullptr), _head(0), _count(0), _total(0),
+      _armed(false), _filterIp(0), _mux(portMUX_INITIALIZER_UNLOCKED) {
+}
+
+bool PacketCapture::begin() {
+    if (_ring) return true;
+    if (!psramFound()) {
+        Log.event(LOG_SEV_WARNING, "[PCAP] No PSRAM — capture unavailable");
+        return false;
+    }
+    _ring = (Slot*)ps_malloc(sizeof(Slot) * PCAP_RING_ENTRIES);
+    if (!_ring) {
+        Log.event(LOG_SEV_ERR, "[PCAP] PSRAM allocation failed");
+        return false;
+    }
+    Log.event(LOG_SEV_INFO, "[PCAP] Ring ready: %d exchanges, %lu bytes PSRAM",
+                  PCAP_RING_ENTRIES, (unsigned long)(sizeof(Slot) * PCAP_RING_ENTRIES));
+    return true;
+}
+
+void PacketCapture::arm(bool on, uint32_t clientIp) {
+    portENTER_CRITICAL(&_mux);
+    _filterIp = clientIp;
+    _armed = on && _ring != nullptr;
+    portEXIT_CRITICAL(&_mux);
+}
+
+void PacketCapture::clear() {
+    portENTER_CRITICAL(&_mux);
+    _head  = 0;
+    _count = 0;
+    _total = 0;
+    portEXIT_CRITICAL(&_mux);
+}
+
+void PacketCapture::record(uint32_t clientIp, uint16_t clientPort,
+                           const uint8_t* req, size_t reqLen,
+                           const uint8_t* resp, size_t respLen,
+                           uint32_t rxUnix, uint16_t rxMs,
+                           uint32_t rxMicros, uint32_t txMicros) {
+    if (!_ring) return;
+    portENTER_CRITICAL(&_mux);
+    Slot& s = _ring[_head];
+    s.clientIp   = clientIp;
+    s.clientPort = clientPort;
+    s.rxUnix     = rxUnix;
+    s.rxMs       = rxMs;
+    s.rxMicros   = rxMicros;
+    s.txMicros   = txMicros;
+    s.reqLen     = reqLen;
+    s.respLen    = respLen;
+    memcpy(s.req, req, reqLen < PCAP_SNAPLEN ? reqLen : PCAP_SNAPLEN);
+    memcpy(s.resp, resp, respLen < PCAP_SNAPLEN ? respLen : PCAP_SNAPLEN);
+    _head = (_head + 1) % PCAP_RING_ENTRIES;
+    if (_count < PCAP_RING_ENTRIES) _count++;
+    _total++;
+    portEXIT_CRITICAL(&_mux);
+}
+
+// One captured packet: pcap record header, then a synthesised IPv4/UDP
+// header (UDP checksum 0, which IPv4 allows) and the stored payload.
+size_t PacketCapture::frame(const Slot& s, bool response, uint32_t serverIp, uint8_t* out) {
+    uint16_t origLen = response ? s.respLen : s.reqLen;
+    uint16_t inclLen = origLen < PCAP_SNAPLEN ? origLen : PCAP_SNAPLEN;
+
+    // Request at T2; response at T2 plus the measured receive→send time
+    uint32_t sec = s.rxUnix;
+    uint32_t us  = (uint32_t)s.rxMs * 1000;
+    if (response) {
+        us += s.txMicros - s.rxMicros;
+        sec += us / 1000000;
+        us %= 1000000;
+    }
+    putLe32(&out[0], sec);
+    putLe32(&out[4], us);
+    putLe32(&out[8], PCAP_IP_UDP_HDR + inclLen);
+    putLe32(&out[12], PCAP_IP_UDP_HDR + origLen);
+
+    uint8_t* ip = &out[16];
+    uint16_t ipLen = PCAP_IP_UDP_HDR + origLen;
+    memset(ip, 0, PCAP_IP_UDP_HDR);
+    ip[0] = 0x45;                       // IPv4, 20-byte header
+    putBe16(&ip[2], ipLen);
+    ip[8] = 64;                         // TTL
+    ip[9] = 17;                         // UDP
+    // Addresses are in network byte order already: copy the bytes as stored
+    uint32_t src = response ? serverIp : s.clientIp;
+    uint32_t dst = response ? s.clientIp : serverIp;
+    memcpy(&ip[12], &src, 4);
+    memcpy(&ip[16], &dst, 4);
+    uint32_t sum = 0;
+    for (uint8_t i = 0; i < 20; i += 2) sum += ((uint16_t)ip[i] << 8) | ip[i + 1];
+    while (sum >> 16) sum = (sum & 0xFFFF) + (sum >> 16);
+    putBe16(&ip[10], ~sum & 0xFFFF);
+
+    uint8_t* udp = &ip[20];
+    putBe16(&udp[0], response ? NTP_PORT_SERVER : s.clientPort);
+    putBe16(&udp[2], response ? s.clientPort : NTP_PORT_SERVER);
+    putBe16(&udp[4], 8 + origLen);
+
+    memcpy(&udp[8], response ? s.resp : s.req, inclLen);
+    return 16 + PCAP_IP_UDP_HDR + inclLen;
+}
+
+uint16_t PacketCapture::exportPcap(uint32_t clientIp, uint32_t serverIp,
+                                   std::function<void(const uint8_t*, size_t)> sink) const {
+    uint8_t hdr[24];
+    putLe32(&hdr[0], PCAP_MAGIC_US);
+    putLe16(&hdr[4], 2);                // Version 2.4
+    putLe16(&hdr[6], 4);
+    putLe32(&hdr[8], 0);                // Timestamps are UTC
+    putLe32(&hdr[12], 0);
+    putLe32(&hdr[16], PCAP_IP_UDP_HDR + PCAP_SNAPLEN);
+    putLe32(&hdr[20], PCAP_LINKTYPE_IPV4);
+    sink(hdr, sizeof(hdr));
+    if (!_ring) return 0;
+
+    // Snapshot the ring position, then copy one slot at a time under the
+    // lock; the NTP callback may overwrite the oldest slots meanwhile.
+    portENTER_CRITICAL(&_mux);
+    uint16_t count = _count;
+    uint16_t start = (_head + PCAP_RING_ENTRIES - _count) % PCAP_RING_ENTRIES;
+    portEXIT_CRITICAL(&_mux);
+
+    // Batch exchanges into roughly one TCP segment per sink() call
+    const size_t pairMax = 2 * (16 + PCAP_IP_UDP_HDR + PCAP_SNAPLEN);
+    uint8_t out[PCAP_EXPORT_CHUNK + pairMax];
+    size_t used = 0;
+    uint16_t written = 0;
+    for (uint16_t i = 0; i < count; i++) {
+        Slot s;
+        portENTER_CRITICAL(&_mux);
+        s = _ring[(start + i) % PCAP_RING_ENTRIES];
+        portEXIT_CRITICAL(&_mux);
+        if (clientIp != 0 && s.clientIp != clientIp) continue;
+
+        used += frame(s, false, serverIp, out + used);
+        used += frame(s, true, serverIp, out + used);
+        written++;
+        if (used >= PCAP_EXPORT_CHUNK) {
+            sink(out, used);
+            used = 0;
+        }
+    }
+    if (used > 0) sink(out, used);
+    return written;
+}
+
+bool PacketCapture::isAvailable() const {
+    return _ring != nullptr;
+}
+
+bool PacketCapture::isArmed() const {
+    return _armed;
+}
+
+uint32_t PacketCapture::getFilter() const {
+    return _filterIp;
+}
+
+uint16_t PacketCapture::getCount() const {
+    return _count;
+}
+
+uint32_t PacketCapture::getTotal() const {
+    return _total;
+}
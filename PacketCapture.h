@@ -0,0 +1,105 @@
+/**
+ * @file      PacketCapture.h
+ * @brief     Rolling capture of NTP exchanges, exported as pcap
+ * @details   Fixed ring of the last PCAP_RING_ENTRIES request/response pairs
+ *            in PSRAM, each with receive and transmit micros() stamps. Export
+ *            synthesises IPv4/UDP headers around the payloads and writes a
+ *            standard pcap (LINKTYPE_IPV4) that Wireshark opens directly.
+ *            When disarmed the NTP path pays one flag test per request.
+ */
+
+#ifndef PACKETCAPTURE_H
+#define PACKETCAPTURE_H
+
+#include <Arduino.h>
+#include <functional>
+#include "config.h"
+
+class PacketCapture {
+public:
+    PacketCapture();
+
+    /**
+     * @brief Allocate the ring in PSRAM (once)
+     * @return false if there is no PSRAM; capture then stays unavailable
+     */
+    bool begin();
+
+    /**
+     * @brief Start or stop capturing
+     * @param on       Capture new exchanges
+     * @param clientIp Only capture this client (network byte order, 0 = all)
+     */
+    void arm(bool on, uint32_t clientIp = 0);
+
+    /**
+     * @brief Drop all captured exchanges
+     */
+    void clear();
+
+    /**
+     * @brief True if an exchange with this client should be recorded
+     * @details Called on the NTP fast path before anything is copied.
+     */
+    inline bool wants(uint32_t clientIp) const {
+        return _armed && (_filterIp == 0 || _filterIp == clientIp);
+    }
+
+    /**
+     * @brief Store one request/response pair
+     * @param clientIp   Client address (network byte order)
+     * @param clientPort Client UDP port
+     * @param req, reqLen   Request datagram (copied up to PCAP_SNAPLEN)
+     * @param resp, respLen Response datagram (copied up to PCAP_SNAPLEN)
+     * @param rxUnix, rxMs  Server clock at receive (T2)
+     * @param rxMicros   micros() at receive
+     * @param txMicros   micros() after the send returned
+     */
+    void record(uint32_t clientIp, uint16_t clientPort,
+                const uint8_t* req, size_t reqLen,
+                const uint8_t* resp, size_t respLen,
+                uint32_t rxUnix, uint16_t rxMs,
+                uint32_t rxMicros, uint32_t txMicros);
+
+    /**
+     * @brief Stream the ring, oldest first, as a pcap file
+     * @param clientIp Only export this client (network byte order, 0 = all)
+     * @param serverIp Address to use for the clock's side of each exchange
+     * @param sink     Receives the file in pieces
+     * @return Exchanges written
+     */
+    uint16_t exportPcap(uint32_t clientIp, uint32_t serverIp,
+                        std::function<void(const uint8_t*, size_t)> sink) const;
+
+    bool     isAvailable() const;
+    bool     isArmed() const;
+    uint32_t getFilter() const;
+    uint16_t getCount() const;        // Exchanges currently held
+    uint32_t getTotal() const;        // Exchanges recorded since the last clear()
+
+private:
+    struct Slot {
+        uint32_t clientIp;
+        uint32_t rxUnix;
+        uint32_t rxMicros;
+        uint32_t txMicros;
+        uint16_t clientPort;
+        uint16_t rxMs;
+        uint16_t reqLen;              // Original lengths; stored bytes are capped
+        uint16_t respLen;
+        uint8_t  req[PCAP_SNAPLEN];
+        uint8_t  resp[PCAP_SNAPLEN];
+    };
+
+    Slot*    _ring;
+    uint16_t _head;                   // Next slot to write
+    uint16_t _count;
+    uint32_t _total;
+    volatile bool _armed;
+    uint32_t _filterIp;
+    mutable portMUX_TYPE _mux;
+
+    static size_t frame(const Slot& s, bool response, uint32_t serverIp, uint8_t* out);
+};
+
+#endif // PACKETCAPTURE_H
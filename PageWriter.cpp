@@ -0,0 +1,66 @@
+/**
+ * @file      PageWriter.cpp
+ * @brief     Chunked HTML response writer implementation
+ */
+
+#include "PageWriter.h"
+#include <stdarg.h>
+
+PageWriter::PageWriter(WebServer& server) : _server(server), _len(0) {
+}
+
+void PageWriter::begin(int code, const char* contentType) {
+    _len = 0;
+    _server.setContentLength(CONTENT_LENGTH_UNKNOWN);
+    _server.send(code, contentType, "");
+}
+
+void PageWriter::add(const char* s) {
+    add(s, strlen(s));
+}
+
+void PageWriter::add(const char* s, size_t n) {
+    while (n > 0) {
+        size_t room = CHUNK_SIZE - _len;
+        size_t take = n < room ? n : room;
+        memcpy(_buf + _len, s, take);
+        _len += take;
+        s += take;
+        n -= take;
+        if (_len == CHUNK_SIZE) flush();
+    }
+}
+
+void PageWriter::addf(const char* fmt, ...) {
+    char tmp[256];
+    va_list args;
+    va_start(args, fmt);
+    int n = vsnprintf(tmp, sizeof(tmp), fmt, args);
+    va_end(args);
+    if (n <= 0) return;
+    add(tmp, (size_t)n < sizeof(tmp) ? (size_t)n : sizeof(tmp) - 1);
+}
+
+void PageWriter::addEscaped(const char* s) {
+    for (; *s; s++) {
+        switch (*s) {
+            case '&':  add("&amp;", 5);  break;
+            case '<':  add("&lt;", 4);   break;
+            case '>':  add("&gt;", 4);   break;
+            case '"':  add("&quot;", 6); break;
+            case '\'': add("&#39;", 5);  break;
+            default:   add(s, 1);        break;
+        }
+    }
+}
+
+void PageWriter::end() {
+    flush();
+    _server.sendContent("", 0);
+}
+
+void PageWriter::flush() {
+    if (_len == 0) return;
+    _server.sendContent(_buf, _len);
+    _len = 0;
+}
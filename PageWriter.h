@@ -0,0 +1,50 @@
+/**
+ * @file      PageWriter.h
+ * @brief     Chunked HTML response writer with a fixed buffer
+ * @details   Pages are streamed with chunked transfer encoding. Text collects
+ *            in a 1 KB stack buffer, which goes out as one chunk whenever it
+ *            fills. A page of any size therefore costs no heap, unlike a String
+ *            that grows by realloc() and leaves holes. Values inserted into
+ *            markup go through addEscaped().
+ */
+
+#ifndef PAGEWRITER_H
+#define PAGEWRITER_H
+
+#include <Arduino.h>
+#include <WebServer.h>
+
+class PageWriter {
+public:
+    static const size_t CHUNK_SIZE = 1024;
+
+    explicit PageWriter(WebServer& server);
+
+    /**
+     * @brief Send the status line and headers; the body follows in chunks
+     */
+    void begin(int code, const char* contentType);
+
+    void add(const char* s);
+    void add(const char* s, size_t n);
+    void addf(const char* fmt, ...) __attribute__((format(printf, 2, 3)));
+
+    /**
+     * @brief Append text with & < > " ' replaced by entities
+     */
+    void addEscaped(const char* s);
+
+    /**
+     * @brief Send what is buffered and the terminating chunk
+     */
+    void end();
+
+private:
+    WebServer& _server;
+    char       _buf[CHUNK_SIZE];
+    size_t     _len;
+
+    void flush();
+};
+
+#endif // PAGEWRITER_H
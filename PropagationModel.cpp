@@ -0,0 +1,180 @@
+/**
+ * @file      PropagationModel.cpp
+ * @brief     WWVB propagation delay model implementation
+ * @details   Spherical Earth (mean radius). The solar position uses the
+ *            low-precision formulas from the Astronomical Almanac, good to
+ *            about 0.01° — far finer than the twilight blend needs.
+ */
+
+#include "PropagationModel.h"
+#include "EventLog.h"
+#include "CborWriter.h"
+#include <math.h>
+
+#define EARTH_RADIUS_KM     6371.0
+#define US_PER_KM           3.335641     // 1 km at c
+#define DEG2RAD             (M_PI / 180.0)
+#define RAD2DEG             (180.0 / M_PI)
+#define J2000_UNIX          946728000.0  // 2000-01-01 12:00 UTC
+
+PropagationModel::PropagationModel()
+    : _configured(false), _midLatRad(0.0), _midLonDeg(0.0), _distanceKm(0.0f),
+      _groundUs(0), _dayUs(0), _nightUs(0), _lastUs(0) {
+    _skyUs[0] = _skyUs[1] = 0;
+    _hops[0] = _hops[1] = 0;
+}
+
+bool PropagationModel::begin(double latDeg, double lonDeg) {
+    _configured = !(latDeg == 0.0 && lonDeg == 0.0);
+    if (!_configured) {
+        Log.event(LOG_SEV_WARNING, "[PROP] Receiver location not set, WWVB propagation delay not applied");
+        return false;
+    }
+
+    double lat1 = WWVB_TX_LATITUDE_DEG * DEG2RAD;
+    double lat2 = latDeg * DEG2RAD;
+    double dLon = (lonDeg - WWVB_TX_LONGITUDE_DEG) * DEG2RAD;
+
+    // Haversine central angle
+    double a = sin((lat2 - lat1) / 2) * sin((lat2 - lat1) / 2) +
+               cos(lat1) * cos(lat2) * sin(dLon / 2) * sin(dLon / 2);
+    double theta = 2.0 * atan2(sqrt(a), sqrt(1.0 - a));
+
+    // Great-circle midpoint
+    double bx = cos(lat2) * cos(dLon);
+    double by = cos(lat2) * sin(dLon);
+    _midLatRad = atan2(sin(lat1) + sin(lat2), sqrt((cos(lat1) + bx) * (cos(lat1) + bx) + by * by));
+    _midLonDeg = WWVB_TX_LONGITUDE_DEG + atan2(by, cos(lat1) + bx) * RAD2DEG;
+
+    double km = theta * EARTH_RADIUS_KM;
+    _distanceKm = (float)km;
+    _groundUs = (int32_t)lround(km * US_PER_KM / PROP_GROUND_VELOCITY);
+    _skyUs[0] = skyDelayUs(theta, PROP_SKY_DAY_HEIGHT_KM, _hops[0]);
+    _skyUs[1] = skyDelayUs(theta, PROP_SKY_NIGHT_HEIGHT_KM, _hops[1]);
+    _dayUs   = km <= PROP_DAY_GROUND_KM ? _groundUs : _skyUs[0];
+    _nightUs = km < PROP_NIGHT_SKY_KM ? _groundUs : _skyUs[1];
+    _lastUs  = _nightUs;
+
+    Log.event(LOG_SEV_INFO, "[PROP] %.0f km from WWVB: ground %ldus, sky %ldus/%u hop day, "
+              "%ldus/%u hop night -> day %ldus, night %ldus",
+              km, (long)_groundUs, (long)_skyUs[0], _hops[0],
+              (long)_skyUs[1], _hops[1], (long)_dayUs, (long)_nightUs);
+    return true;
+}
+
+int32_t PropagationModel::skyDelayUs(double theta, double heightKm, uint8_t& hops) {
+    // Longest hop: the ray leaves and arrives tangent to the ground
+    double r = EARTH_RADIUS_KM;
+    double rh = EARTH_RADIUS_KM + heightKm;
+    double maxHalf = acos(r / rh);
+    double n = ceil(theta / (2.0 * maxHalf));
+    if (n < 1.0) n = 1.0;
+    hops = (uint8_t)(n > 255.0 ? 255.0 : n);
+
+    // Each hop is two equal slant legs between the ground and the layer
+    double half = theta / (2.0 * n);
+    double leg = sqrt(r * r + rh * rh - 2.0 * r * rh * cos(half));
+    return (int32_t)lround(2.0 * n * leg * US_PER_KM);
+}
+
+bool PropagationModel::isConfigured() const {
+    return _configured;
+}
+
+float PropagationModel::getNightWeight(uint32_t unixTime, float* elevDeg) const {
+    if (unixTime == 0) {
+        if (elevDeg) *elevDeg = NAN;
+        return 1.0f;
+    }
+
+    double n = ((double)unixTime - J2000_UNIX) / 86400.0;
+    double L = fmod(280.460 + 0.9856474 * n, 360.0);
+    double g = fmod(357.528 + 0.9856003 * n, 360.0) * DEG2RAD;
+    double lambda = (L + 1.915 * sin(g) + 0.020 * sin(2.0 * g)) * DEG2RAD;
+    double eps = (23.439 - 0.0000004 * n) * DEG2RAD;
+    double ra = atan2(cos(eps) * sin(lambda), cos(lambda));
+    double decl = asin(sin(eps) * sin(lambda));
+    double gmstDeg = fmod(280.46061837 + 360.98564736629 * n, 360.0);
+    double ha = gmstDeg * DEG2RAD + _midLonDeg * DEG2RAD - ra;
+
+    double elev = asin(sin(_midLatRad) * sin(decl) +
+                       cos(_midLatRad) * cos(decl) * cos(ha)) * RAD2DEG;
+    if (elevDeg) *elevDeg = (float)elev;
+
+    if (elev >= 0.0) return 0.0f;
+    if (elev <= -PROP_TWILIGHT_DEG) return 1.0f;
+    return (float)(-elev / PROP_TWILIGHT_DEG);
+}
+
+int32_t PropagationModel::estimateUs(uint32_t unixTime) const {
+    if (!_configured) return 0;
+    float w = getNightWeight(unixTime);
+    return _dayUs + (int32_t)lroundf(w * (float)(_nightUs - _dayUs));
+}
+
+int32_t PropagationModel::getDelayUs(uint32_t unixTime) {
+    _lastUs = estimateUs(unixTime);
+    return _lastUs;
+}
+
+int32_t PropagationModel::getLastDelayUs() const {
+    return _configured ? _lastUs : 0;
+}
+
+float PropagationModel::getDistanceKm() const {
+    return _distanceKm;
+}
+
+int32_t PropagationModel::getGroundUs() const {
+    return _groundUs;
+}
+
+int32_t PropagationModel::getSkyUs(bool night) const {
+    return _skyUs[night ? 1 : 0];
+}
+
+uint8_t PropagationModel::getHops(bool night) const {
+    return _hops[night ? 1 : 0];
+}
+
+int PropagationModel::toJson(char* buf, size_t len, uint32_t unixTime) const {
+    if (!_configured) {
+        int pos = snprintf(buf, len, "{\"on\":false}");
+        return pos < (int)len ? pos : (int)len - 1;
+    }
+    float elev;
+    float w = getNightWeight(unixTime, &elev);
+    int pos = snprintf(buf, len,
+        "{\"on\":true,\"km\":%.0f,\"gnd\":%ld,\"skyd\":[%ld,%u],\"skyn\":[%ld,%u],"
+        "\"elev\":%.1f,\"w\":%.2f,\"us\":%ld,\"last\":%ld}",
+        _distanceKm, (long)_groundUs, (long)_skyUs[0], _hops[0],
+        (long)_skyUs[1], _hops[1], isnan(elev) ? 0.0f : elev, w,
+        (long)estimateUs(unixTime), (long)_lastUs);
+    return pos < (int)len ? pos : (int)len - 1;
+}
+
+void PropagationModel::toCbor(CborWriter& w, uint32_t unixTime) const {
+    if (!_configured) {
+        w.beginMap(1);
+        w.kvBool("on", false);
+        return;
+    }
+    float elev;
+    float weight = getNightWeight(unixTime, &elev);
+    w.beginMap(9);
+    w.kvBool("on", true);
+    w.kvFloat("km", _distanceKm);
+    w.kvInt("gnd", _groundUs);
+    w.key("skyd");
+    w.beginArray(2);
+    w.signedInt(_skyUs[0]);
+    w.unsignedInt(_hops[0]);
+    w.key("skyn");
+    w.beginArray(2);
+    w.signedInt(_skyUs[1]);
+    w.unsignedInt(_hops[1]);
+    w.kvFloat("elev", isnan(elev) ? 0.0f : elev);
+    w.kvFloat("w", weight);
+    w.kvInt("us", estimateUs(unixTime));
+    w.kvInt("last", _lastUs);
+}
@@ -0,0 +1,101 @@
+/**
+ * @file      PropagationModel.h
+ * @brief     WWVB signal propagation delay from Fort Collins to the receiver
+ * @details   The second marker leaves the WWVB antennas on time and reaches the
+ *            receiver some milliseconds later. This model estimates that delay
+ *            from the configured receiver location:
+ *
+ *            - Ground wave: great-circle distance over the ground-wave speed.
+ *            - Sky wave: the path is split into the fewest equal hops that the
+ *              ionosphere can reflect (D layer, about 70 km, by day; E layer,
+ *              about 90 km, at night). The delay is the length of the slant
+ *              paths up to the layer and back down.
+ *
+ *            Which wave the ES100 locks to depends on distance and on daylight
+ *            along the path. The solar elevation at the great-circle midpoint
+ *            sets a day/night weight, and the model blends linearly between the
+ *            day and night estimates through twilight.
+ *
+ *            The result is a model, not a measurement: expect it to be right
+ *            to a few hundred µs, against a raw error of several ms.
+ */
+
+#ifndef PROPAGATIONMODEL_H
+#define PROPAGATIONMODEL_H
+
+#include <Arduino.h>
+#include "config.h"
+
+class CborWriter;
+
+class PropagationModel {
+public:
+    PropagationModel();
+
+    /**
+     * @brief Compute the path geometry for a receiver location
+     * @param latDeg Receiver latitude (degrees, north positive)
+     * @param lonDeg Receiver longitude (degrees, east positive)
+     * @return false if the location is unset (0, 0); the delay is then zero
+     */
+    bool begin(double latDeg, double lonDeg);
+
+    bool isConfigured() const;
+
+    /**
+     * @brief Delay to apply to a fix received now, and remember it
+     * @param unixTime Current UTC, or 0 if unknown (assumes night, when most
+     *                 fixes are received)
+     * @return Transmitter-to-receiver delay (µs)
+     */
+    int32_t getDelayUs(uint32_t unixTime);
+
+    /**
+     * @brief Delay applied to the most recent fix (µs)
+     */
+    int32_t getLastDelayUs() const;
+
+    /**
+     * @brief Same as getDelayUs() without recording it
+     */
+    int32_t estimateUs(uint32_t unixTime) const;
+
+    /**
+     * @brief Day/night weight for the path: 0 = daylight, 1 = night
+     * @param unixTime Current UTC, or 0 if unknown
+     * @param elevDeg  Optional: solar elevation at the path midpoint (degrees)
+     */
+    float getNightWeight(uint32_t unixTime, float* elevDeg = nullptr) const;
+
+    float   getDistanceKm() const;
+    int32_t getGroundUs() const;
+    int32_t getSkyUs(bool night) const;
+    uint8_t getHops(bool night) const;
+
+    /**
+     * @brief Path geometry and current estimate as a JSON object
+     * @return Characters written (snprintf semantics, clipped to len)
+     */
+    int toJson(char* buf, size_t len, uint32_t unixTime) const;
+
+    /**
+     * @brief Encode the same object as toJson() as a CBOR map
+     */
+    void toCbor(CborWriter& w, uint32_t unixTime) const;
+
+private:
+    static int32_t skyDelayUs(double centralAngle, double heightKm, uint8_t& hops);
+
+    bool    _configured;
+    double  _midLatRad;          // Great-circle midpoint, for the solar elevation
+    double  _midLonDeg;
+    float   _distanceKm;
+    int32_t _groundUs;
+    int32_t _skyUs[2];           // [day, night]
+    uint8_t _hops[2];
+    int32_t _dayUs;              // Delay used in full daylight / full night
+    int32_t _nightUs;
+    int32_t _lastUs;
+};
+
+#endif // PROPAGATIONMODEL_H
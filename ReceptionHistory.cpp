@@ -4,6 +4,7 @@
  */
 
 #include "ReceptionHistory.h"
+#include "EventLog.h"
 
 // ============================================================================
 // Constructor
@@ -24,7 +25,7 @@ ReceptionHistory::ReceptionHistory()
 void ReceptionHistory::begin() {
     reset();
     _lastHourMillis = millis();
-    Serial.println("ReceptionHistory initialized");
+    Log.event(LOG_SEV_DEBUG, "ReceptionHistory initialized");
 }
 
 void ReceptionHistory::reset() {
@@ -54,10 +55,10 @@ void ReceptionHistory::recordAttempt(bool success) {
             _buckets[_currentBucket]++;
         }
         
-        Serial.printf("ReceptionHistory: Success recorded (bucket %d now = %d)\n", 
+        Log.event(LOG_SEV_DEBUG, "ReceptionHistory: Success recorded (bucket %d now = %d)", 
                       _currentBucket, _buckets[_currentBucket]);
     } else {
-        Serial.println("ReceptionHistory: Failed attempt recorded");
+        Log.event(LOG_SEV_DEBUG, "ReceptionHistory: Failed attempt recorded");
     }
 }
 
@@ -72,7 +73,7 @@ void ReceptionHistory::hourlyTick() {
     if (_secondsInCurrentHour >= 3600) {
         _secondsInCurrentHour = 0;
         shiftBuckets();
-        Serial.println("ReceptionHistory: Hour elapsed, buckets shifted");
+        Log.event(LOG_SEV_DEBUG, "ReceptionHistory: Hour elapsed, buckets shifted");
     }
 }
 
@@ -0,0 +1,223 @@
+/**
+ * @file      ReceptionPolicy.cpp
+ * @brief     Early abort / antenna switch policy implementation
+ */
+
+#include "ReceptionPolicy.h"
+#include "ES100.h"
+#include "EventLog.h"
+#include "CborWriter.h"
+
+ReceptionPolicy::ReceptionPolicy()
+    : _minOkMs(RXP_MIN_OK_MS), _active(false), _toggle(false), _hour(-1), _ant(0),
+      _cycles(0), _switchCtrl(0), _startMs(0), _cycleStartMs(0), _attempts(0),
+      _failedCycles(0), _aborts(0), _switches(0), _probes(0), _fixes(0), _rxMs(0),
+      _savedMs(0) {
+    memset(_cells, 0, sizeof(_cells));
+}
+
+// ============================================================================
+// Persistence
+// ============================================================================
+void ReceptionPolicy::load(Preferences& prefs) {
+    if (prefs.getBytes("rxpTab", _cells, sizeof(_cells)) != sizeof(_cells)) {
+        memset(_cells, 0, sizeof(_cells));
+    }
+    _minOkMs = prefs.getULong("rxpMinOk", RXP_MIN_OK_MS);
+    if (_minOkMs < RXP_MIN_OK_FLOOR_MS || _minOkMs > SYNC_TIMEOUT_NORMAL_MS) {
+        _minOkMs = RXP_MIN_OK_MS;
+    }
+}
+
+void ReceptionPolicy::save(Preferences& prefs) const {
+    prefs.putBytes("rxpTab", _cells, sizeof(_cells));
+    prefs.putULong("rxpMinOk", _minOkMs);
+}
+
+// ============================================================================
+// Attempt tracking
+// ============================================================================
+void ReceptionPolicy::beginAttempt(uint8_t ctrl, int8_t hour, uint32_t nowMs) {
+    bool ant1Off = (ctrl & ES100_CTRL0_ANT1_OFF) != 0;
+    bool ant2Off = (ctrl & ES100_CTRL0_ANT2_OFF) != 0;
+    _active       = true;
+    _toggle       = !ant1Off && !ant2Off;
+    _hour         = (hour >= 0 && hour < RXP_HOURS) ? hour : -1;
+    _ant          = ant1Off ? 1 : ant2Off ? 0 : ((ctrl & ES100_CTRL0_START_ANT) ? 1 : 0);
+    _cycles       = 0;
+    _startMs      = nowMs;
+    _cycleStartMs = nowMs;
+    _attempts++;
+}
+
+RxDecision ReceptionPolicy::onCycleComplete(uint32_t nowMs, uint32_t timeoutMs) {
+    if (!_active) return RXP_CONTINUE;
+
+    uint8_t failed = _ant;
+    record(_cycles > 0, failed, false);
+    _failedCycles++;
+    if (_cycles < 0xFF) _cycles++;
+    if (_toggle) _ant ^= 1;
+    _cycleStartMs = nowMs;
+
+    uint32_t elapsed = nowMs - _startMs;
+    uint32_t left = timeoutMs > elapsed ? timeoutMs - elapsed : 0;
+    RxDecision d = RXP_CONTINUE;
+    char why[64];
+
+    if (left < _minOkMs) {
+        // Not even the fastest decode seen would finish before the timeout
+        snprintf(why, sizeof(why), "%lus left < %lus shortest decode",
+                 (unsigned long)(left / 1000UL), (unsigned long)(_minOkMs / 1000UL));
+        d = RXP_ABORT;
+    } else {
+        float next  = getOdds(_hour, _ant, true);
+        float other = getOdds(_hour, _ant ^ 1, true);
+        if (next >= 0.0f && next < RXP_MIN_ODDS) {
+            if (++_probes % RXP_PROBE_EVERY == 0) {
+                // Let an occasional doomed-looking cycle run so its odds can recover
+                snprintf(why, sizeof(why), "Ant%u odds %.2f, probing", _ant + 1, next);
+            } else if (_toggle && other >= RXP_MIN_ODDS) {
+                snprintf(why, sizeof(why), "Ant%u odds %.2f < Ant%u %.2f",
+                         _ant + 1, next, (_ant ^ 1) + 1, other);
+                d = RXP_SWITCH;
+            } else {
+                snprintf(why, sizeof(why), "Ant%u odds %.2f", _ant + 1, next);
+                d = RXP_ABORT;
+            }
+        } else {
+            snprintf(why, sizeof(why), "Ant%u odds %.2f", _ant + 1, next);
+        }
+    }
+
+    static const char* const ACTIONS[] = { "continue", "switch antenna", "abort" };
+    Log.event(LOG_SEV_INFO, "[RXP] Cycle %u failed on Ant%u after %lus (hour %d): %s -> %s%s",
+              _cycles, failed + 1, (unsigned long)(elapsed / 1000UL), _hour, why,
+              ACTIONS[d], (d != RXP_CONTINUE && !RXP_EARLY_ABORT) ? " (shadow)" : "");
+
+    if (d == RXP_SWITCH) {
+        _switches++;
+        if (!RXP_EARLY_ABORT) return RXP_CONTINUE;  // The ES100 keeps toggling
+        _ant ^= 1;
+        _toggle = false;
+        _switchCtrl = _ant ? ES100_CTRL0_ANT2_ONLY : ES100_CTRL0_ANT1_ONLY;
+    } else if (d == RXP_ABORT) {
+        _aborts++;
+        if (RXP_EARLY_ABORT) _savedMs += left;
+    }
+    return RXP_EARLY_ABORT ? d : RXP_CONTINUE;
+}
+
+uint8_t ReceptionPolicy::getSwitchCtrl() const {
+    return _switchCtrl;
+}
+
+void ReceptionPolicy::endAttempt(uint32_t nowMs, int8_t result, bool ant2) {
+    if (!_active) return;
+    if (result >= 0) {
+        bool ok = result > 0;
+        record(_cycles > 0, ant2 ? 1 : 0, ok);
+        if (ok) {
+            _fixes++;
+            uint32_t d = nowMs - _cycleStartMs;
+            if (d < RXP_MIN_OK_FLOOR_MS) d = RXP_MIN_OK_FLOOR_MS;
+            // Take a faster decode at once; drift up slowly so one lucky
+            // decode does not keep every retry alive forever
+            if (d < _minOkMs) _minOkMs = d;
+            else _minOkMs += (d - _minOkMs) / RXP_MIN_OK_RELAX;
+        }
+    }
+    finish(nowMs);
+}
+
+void ReceptionPolicy::finish(uint32_t nowMs) {
+    _rxMs  += nowMs - _startMs;
+    _active = false;
+}
+
+bool ReceptionPolicy::isActive() const {
+    return _active;
+}
+
+uint8_t ReceptionPolicy::getCycleAntenna() const {
+    return _ant + 1;
+}
+
+// ============================================================================
+// Odds
+// ============================================================================
+void ReceptionPolicy::record(bool retry, uint8_t ant, bool ok) {
+    if (_hour < 0) return;  // Time not known: nothing to file it under
+    Cell& c = _cells[retry ? 1 : 0][_hour][ant];
+    if (c.n >= RXP_MAX_COUNT) {
+        c.n  /= 2;
+        c.ok /= 2;
+    }
+    c.n++;
+    if (ok) c.ok++;
+}
+
+float ReceptionPolicy::cellOdds(const Cell& c) const {
+    return c.n >= RXP_MIN_SAMPLES ? (float)c.ok / (float)c.n : -1.0f;
+}
+
+float ReceptionPolicy::getOdds(int8_t hour, uint8_t ant, bool retry) const {
+    const Cell (*table)[RXP_ANTS] = _cells[retry ? 1 : 0];
+    if (hour >= 0 && hour < RXP_HOURS) {
+        float p = cellOdds(table[hour][ant]);
+        if (p >= 0.0f) return p;
+    }
+    if (!retry) return -1.0f;
+
+    // Retries are rarer; fall back to this antenna's retries at any hour
+    uint32_t ok = 0, n = 0;
+    for (uint8_t h = 0; h < RXP_HOURS; h++) {
+        ok += table[h][ant].ok;
+        n  += table[h][ant].n;
+    }
+    return n >= RXP_MIN_SAMPLES ? (float)ok / (float)n : -1.0f;
+}
+
+uint8_t ReceptionPolicy::preferredAntenna(int8_t hour, uint8_t fallback) const {
+    float p1 = getOdds(hour, 0, false);
+    float p2 = getOdds(hour, 1, false);
+    if (p1 < 0.0f || p2 < 0.0f || p1 == p2) return fallback;
+    return p2 > p1 ? 2 : 1;
+}
+
+// ============================================================================
+// Reporting
+// ============================================================================
+int ReceptionPolicy::toJson(char* buf, size_t len, int8_t hour) const {
+    int pos = snprintf(buf, len,
+        "{\"hr\":%d,\"odds\":[[%.2f,%.2f],[%.2f,%.2f]],\"minok\":%lu,\"att\":%lu,"
+        "\"cyc\":%lu,\"abort\":%lu,\"sw\":%lu,\"saved\":%lu,\"rx\":%lu,\"fix\":%lu,"
+        "\"fph\":%.2f}",
+        hour, getOdds(hour, 0, false), getOdds(hour, 1, false),
+        getOdds(hour, 0, true), getOdds(hour, 1, true),
+        (unsigned long)(_minOkMs / 1000UL), (unsigned long)_attempts,
+        (unsigned long)_failedCycles, (unsigned long)_aborts, (unsigned long)_switches,
+        (unsigned long)(_savedMs / 1000UL), (unsigned long)(_rxMs / 1000UL),
+        (unsigned long)_fixes, _rxMs ? (float)_fixes * 3600000.0f / (float)_rxMs : 0.0f);
+    return pos < (int)len ? pos : (int)len - 1;
+}
+
+void ReceptionPolicy::toCbor(CborWriter& w, int8_t hour) const {
+    w.beginMap(11);
+    w.kvInt("hr", hour);
+    w.key("odds");
+    w.beginArray(2);
+    for (uint8_t r = 0; r < 2; r++) {
+        w.beginArray(RXP_ANTS);
+        for (uint8_t a = 0; a < RXP_ANTS; a++) w.float32(getOdds(hour, a, r != 0));
+    }
+    w.kv("minok", _minOkMs / 1000UL);
+    w.kv("att", _attempts);
+    w.kv("cyc", _failedCycles);
+    w.kv("abort", _aborts);
+    w.kv("sw", _switches);
+    w.kv("saved", _savedMs / 1000UL);
+    w.kv("rx", _rxMs / 1000UL);
+    w.kv("fix", _fixes);
+    w.kvFloat("fph", _rxMs ? (float)_fixes * 3600000.0f / (float)_rxMs : 0.0f);
+}
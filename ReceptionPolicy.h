@@ -0,0 +1,153 @@
+/**
+ * @file      ReceptionPolicy.h
+ * @brief     Early abort / antenna switch for failing normal-mode ES100 receptions
+ * @details   In normal mode the ES100 runs one reception cycle on an antenna,
+ *            raises IRQ_CYCLE_COMPLETE if it failed, toggles antenna and tries
+ *            again until SYNC_TIMEOUT_NORMAL_MS. Many of those retries cannot
+ *            succeed, but they keep the receiver powered for the full timeout.
+ *
+ *            Every cycle outcome is counted per local hour of day, antenna, and
+ *            whether it was the first cycle of the attempt or a retry after a
+ *            failed one (signal conditions within an attempt are correlated, so
+ *            a retry is judged on retry history). At each cycle-complete event
+ *            the next cycle is:
+ *
+ *            - abandoned if the time left before the timeout is shorter than the
+ *              shortest decode seen (a cycle that cannot finish),
+ *            - moved to the other antenna if its learned odds are below
+ *              RXP_MIN_ODDS but the other antenna's are not,
+ *            - otherwise abandoned if its odds are below RXP_MIN_ODDS.
+ *
+ *            Odds are used only once a bucket holds RXP_MIN_SAMPLES cycles (else
+ *            the antenna's retries pooled over all hours). Counts are halved at
+ *            RXP_MAX_COUNT so the table follows seasonal changes, and every
+ *            RXP_PROBE_EVERY-th low-odds cycle is allowed to run so an hour
+ *            written off can still earn its odds back. Tracking mode
+ *            is a single 22 s window with its own timeout and is not covered.
+ */
+
+#ifndef RECEPTIONPOLICY_H
+#define RECEPTIONPOLICY_H
+
+#include <Arduino.h>
+#include <Preferences.h>
+#include "config.h"
+
+class CborWriter;
+
+#define RXP_HOURS   24
+#define RXP_ANTS    2
+
+enum RxDecision {
+    RXP_CONTINUE,       // Let the ES100 run its next cycle
+    RXP_SWITCH,         // Restart on getSwitchCtrl()'s antenna
+    RXP_ABORT           // Stop the reception now
+};
+
+class ReceptionPolicy {
+public:
+    ReceptionPolicy();
+
+    /**
+     * @brief Restore the odds table and shortest decode (caller has the namespace open)
+     */
+    void load(Preferences& prefs);
+
+    /**
+     * @brief Persist the odds table and shortest decode (caller has the namespace open read-write)
+     */
+    void save(Preferences& prefs) const;
+
+    /**
+     * @brief A normal-mode reception was started
+     * @param ctrl  Control 0 value written (start antenna, antenna-off bits)
+     * @param hour  Local hour of day, or -1 if the time is not known
+     */
+    void beginAttempt(uint8_t ctrl, int8_t hour, uint32_t nowMs);
+
+    /**
+     * @brief Count a failed cycle and decide what the next one should do
+     * @param timeoutMs Receiver time allowed for the whole attempt
+     */
+    RxDecision onCycleComplete(uint32_t nowMs, uint32_t timeoutMs);
+
+    /**
+     * @brief Control 0 value for an RXP_SWITCH decision
+     */
+    uint8_t getSwitchCtrl() const;
+
+    /**
+     * @brief The attempt ended
+     * @param result 1 = decoded, 0 = cycle finished without a decode,
+     *               -1 = cut short (timeout, abort, register read failure)
+     * @param ant2   Antenna reported by the ES100 (ignored for result -1)
+     */
+    void endAttempt(uint32_t nowMs, int8_t result, bool ant2);
+
+    /**
+     * @brief True while a normal-mode attempt is being followed
+     */
+    bool isActive() const;
+
+    /**
+     * @brief Antenna that just failed or is running the current cycle (1 or 2)
+     */
+    uint8_t getCycleAntenna() const;
+
+    /**
+     * @brief Antenna with the better first-cycle odds at this hour (1 or 2)
+     * @param fallback Returned when either antenna's odds are not yet known
+     */
+    uint8_t preferredAntenna(int8_t hour, uint8_t fallback) const;
+
+    /**
+     * @brief Learned cycle success odds (0-1), or -1 if too few samples
+     * @param ant   0 = Antenna 1, 1 = Antenna 2
+     * @param retry Odds of a cycle after a failed one in the same attempt
+     */
+    float getOdds(int8_t hour, uint8_t ant, bool retry) const;
+
+    /**
+     * @brief Odds table and receiver-time counters as a JSON object
+     * @return Characters written (snprintf semantics, clipped to len)
+     */
+    int toJson(char* buf, size_t len, int8_t hour) const;
+
+    /**
+     * @brief Encode the same object as toJson() as a CBOR map
+     */
+    void toCbor(CborWriter& w, int8_t hour) const;
+
+private:
+    struct Cell {
+        uint8_t ok;             // Decoded cycles
+        uint8_t n;              // All completed cycles
+    };
+    Cell     _cells[2][RXP_HOURS][RXP_ANTS];   // [first / retry][hour][antenna]
+    uint32_t _minOkMs;          // Shortest cycle that has decoded (slowly relaxes upward)
+
+    bool     _active;
+    bool     _toggle;           // ES100 alternates antennas after each failed cycle
+    int8_t   _hour;
+    uint8_t  _ant;              // Antenna of the current cycle (0/1)
+    uint8_t  _cycles;           // Failed cycles so far this attempt
+    uint8_t  _switchCtrl;
+    uint32_t _startMs;
+    uint32_t _cycleStartMs;
+
+    // Counters since boot
+    uint32_t _attempts;
+    uint32_t _failedCycles;
+    uint32_t _aborts;
+    uint32_t _switches;
+    uint32_t _probes;           // Low-odds decisions; every RXP_PROBE_EVERY-th continues
+    uint32_t _fixes;
+    uint32_t _rxMs;             // Receiver time spent in normal-mode attempts
+    uint32_t _savedMs;          // Timeout remaining when attempts were abandoned
+
+    void record(bool retry, uint8_t ant, bool ok);
+    float cellOdds(const Cell& c) const;
+    void finish(uint32_t nowMs);
+};
+
+#endif // RECEPTIONPOLICY_H
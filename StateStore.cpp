@@ -0,0 +1,40 @@
+/**
+ * @file      StateStore.cpp
+ * @brief     Published state store implementation
+ */
+
+#include "StateStore.h"
+
+StateStore State;
+
+StateStore::StateStore()
+    : clock(this, STATE_CLOCK), ntpRef(this, STATE_NTP_REF),
+      receiver(this, STATE_RECEIVER), power(this, STATE_POWER),
+      _listenerCount(0), _commits(0) {
+    // Unsynchronized until ClockQuality publishes a state
+    NtpRefState& r = ntpRef.edit();
+    r.stratum = 16;
+    r.leapIndicator = 3;
+    r.quality = CQ_FREERUN;
+    memcpy(r.refId, "LOCL", 4);
+    ntpRef.commit();
+}
+
+bool StateStore::subscribe(Listener fn, void* ctx) {
+    if (!fn || _listenerCount >= STATE_MAX_LISTENERS) return false;
+    _listeners[_listenerCount].fn  = fn;
+    _listeners[_listenerCount].ctx = ctx;
+    _listenerCount++;
+    return true;
+}
+
+uint32_t StateStore::getCommitCount() const {
+    return _commits;
+}
+
+void StateStore::notify(StateSliceId slice, uint32_t generation) {
+    _commits++;
+    for (uint8_t i = 0; i < _listenerCount; i++) {
+        _listeners[i].fn(_listeners[i].ctx, slice, generation);
+    }
+}
@@ -0,0 +1,202 @@
+/**
+ * @file      StateStore.h
+ * @brief     Versioned, lock-free published state shared across tasks
+ * @details   The store holds typed slices of clock state. Each slice has one
+ *            writer, the Arduino loop task. The writer edits a private staging
+ *            copy and commits it. A commit that changed something is copied
+ *            into the inactive half of a double buffer, and then the slice's
+ *            generation counter is advanced with release ordering.
+ *
+ *            Readers on any task or core copy the buffer the generation
+ *            selects and retry if the generation moved during the copy. They
+ *            never block the writer or each other. A caching consumer keeps
+ *            the generation it last saw, and a push consumer subscribes for a
+ *            callback on commit.
+ */
+
+#ifndef STATESTORE_H
+#define STATESTORE_H
+
+#include <Arduino.h>
+
+// ============================================================================
+// Slices
+// ============================================================================
+
+/**
+ * @brief Time source, last sync and timezone
+ */
+struct ClockState {
+    unsigned long lastSyncMillis;   // millis() of last time sync (0 = never)
+    uint8_t  timeSource;            // 0=None, 1=RTC, 2=NTP, 3=WWVB
+    int8_t   utcOffset;             // Current UTC offset (hours)
+    bool     dstActive;             // DST currently applied
+    uint8_t  leapSecondWarning;     // 0=none, 1=positive(+1s), 2=negative(-1s)
+    char     lastSyncTimeStr[20];   // "YYYY-MM-DD HH:MM:SS" UTC of last sync, "" if never
+};
+
+/**
+ * @brief Service level of the clock, worst last
+ */
+enum ClockQualityState : uint8_t {
+    CQ_LOCKED = 0,                  // Recently synced, error bound within CQ_LOCKED_MAX_US
+    CQ_HOLDOVER,                    // Running on the DS3231 within CQ_HOLDOVER_MAX_US
+    CQ_DEGRADED,                    // Within CQ_DEGRADED_MAX_US
+    CQ_FREERUN,                     // Never synced, bound exceeded, or sync too old
+    CQ_STATE_COUNT
+};
+
+/**
+ * @brief What the NTP server advertises (read per request on the lwIP thread)
+ * @details Written only by ClockQuality.
+ */
+struct NtpRefState {
+    uint32_t lastSyncUnix;          // Reference timestamp (0 = not yet synced)
+    uint8_t  stratum;               // 1 = WWVB, 2 = NTP upstream, 16 = unsynchronized
+    uint8_t  leapIndicator;         // RFC 5905 LI (0-3)
+    uint8_t  refId[4];              // ASCII kiss code or upstream IPv4
+    uint8_t  quality;               // ClockQualityState
+    uint32_t syncErrorUs;           // Error bound at lastSyncUnix (µs)
+    uint32_t driftPpb;              // Growth of the error bound after lastSyncUnix (ns/s)
+    uint32_t dispBase;              // Root dispersion at lastSyncUnix (16.16 s)
+    uint32_t dispRate;              // Root dispersion growth (2^-32 s per s)
+};
+
+/**
+ * @brief ES100 receiver state and per-antenna success counts
+ */
+struct ReceiverState {
+    uint16_t ant1Successes;         // Lifetime Antenna 1 sync successes
+    uint16_t ant2Successes;         // Lifetime Antenna 2 sync successes
+    bool     available;             // ES100 hardware initialized
+    bool     receiving;             // Currently receiving WWVB signal
+    bool     tracking;              // Current receive attempt is tracking mode (vs normal)
+    bool     pendingTracking;       // Waiting to write Control 0 at second :55
+    bool     trackingReady;         // At least one normal-mode sync done; tracking mode available
+};
+
+/**
+ * @brief Battery and board temperature
+ */
+struct PowerState {
+    float    temperatureC;          // DS3231 temperature (Celsius)
+    uint16_t batteryMv;             // Battery voltage in millivolts
+    uint8_t  batteryPct;            // Battery percentage (LiPo curve, 0-100)
+    bool     batteryCharging;       // True if USB charging
+};
+
+enum StateSliceId : uint8_t {
+    STATE_CLOCK = 0,
+    STATE_NTP_REF,
+    STATE_RECEIVER,
+    STATE_POWER,
+    STATE_SLICE_COUNT
+};
+
+#define STATE_MAX_LISTENERS 4
+
+class StateStore;
+
+// ============================================================================
+// StateSlice
+// ============================================================================
+
+template <typename T>
+class StateSlice {
+public:
+    StateSlice(StateStore* owner, StateSliceId id) : _owner(owner), _id(id), _gen(0) {
+        memset(_buf, 0, sizeof(_buf));
+        memset(&_staging, 0, sizeof(_staging));
+    }
+
+    /**
+     * @brief Writer only: staging copy holding the last committed value
+     * @details Modify fields in place, then commit(). Fields not touched keep
+     *          their committed value.
+     */
+    T& edit() { return _staging; }
+
+    /**
+     * @brief Writer only: publish the staging copy if it differs
+     * @return true if a new generation was published
+     */
+    bool commit();
+
+    /**
+     * @brief Copy a consistent snapshot (any task, any core; not from an ISR)
+     * @return Generation of the snapshot
+     */
+    inline __attribute__((always_inline)) uint32_t read(T& out) const {
+        for (;;) {
+            uint32_t g = __atomic_load_n(&_gen, __ATOMIC_ACQUIRE);
+            memcpy(&out, &_buf[g & 1], sizeof(T));
+            __atomic_thread_fence(__ATOMIC_ACQUIRE);
+            // The writer only touches buf[g & 1] after publishing g + 1
+            if (__atomic_load_n(&_gen, __ATOMIC_RELAXED) == g) return g;
+        }
+    }
+
+    /**
+     * @brief Number of published changes (0 until the first commit)
+     */
+    uint32_t generation() const { return __atomic_load_n(&_gen, __ATOMIC_ACQUIRE); }
+
+private:
+    StateStore*  _owner;
+    StateSliceId _id;
+    T            _buf[2];
+    T            _staging;
+    uint32_t     _gen;
+};
+
+// ============================================================================
+// StateStore
+// ============================================================================
+
+class StateStore {
+public:
+    /**
+     * @brief Change callback, run on the writer's task right after a commit
+     */
+    typedef void (*Listener)(void* ctx, StateSliceId slice, uint32_t generation);
+
+    StateStore();
+
+    StateSlice<ClockState>    clock;
+    StateSlice<NtpRefState>   ntpRef;
+    StateSlice<ReceiverState> receiver;
+    StateSlice<PowerState>    power;
+
+    /**
+     * @brief Register a push consumer
+     * @return false if STATE_MAX_LISTENERS are already registered
+     */
+    bool subscribe(Listener fn, void* ctx);
+
+    uint32_t getCommitCount() const;       // Commits that published a change
+
+    void notify(StateSliceId slice, uint32_t generation);
+
+private:
+    struct Subscriber {
+        Listener fn;
+        void*    ctx;
+    };
+    Subscriber _listeners[STATE_MAX_LISTENERS];
+    uint8_t    _listenerCount;
+    uint32_t   _commits;
+};
+
+template <typename T>
+bool StateSlice<T>::commit() {
+    uint32_t g = _gen;                       // Only this task writes _gen
+    if (memcmp(&_staging, &_buf[g & 1], sizeof(T)) == 0) return false;
+    memcpy(&_buf[(g + 1) & 1], &_staging, sizeof(T));
+    __atomic_store_n(&_gen, g + 1, __ATOMIC_RELEASE);
+    _owner->notify(_id, g + 1);
+    return true;
+}
+
+extern StateStore State;
+
+#endif // STATESTORE_H
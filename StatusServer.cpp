@@ -5,17 +5,23 @@
  */
 
 #include "StatusServer.h"
+#include "EventLog.h"
+#include "CborWriter.h"
+#include "Breadcrumbs.h"
+#include "PageWriter.h"
+#include "HeapMonitor.h"
+#include "EnergyMonitor.h"
 
 StatusServer::StatusServer()
     : _httpServer(80), _running(false), _timeManager(nullptr),
-      _ntpServer(nullptr), _statusData(nullptr), _receptionHistory(nullptr),
+      _ntpServer(nullptr), _receptionHistory(nullptr),
       _onSyncRequest(nullptr), _onTrackingRequest(nullptr), _onSettingsRequest(nullptr) {
 }
 
 bool StatusServer::begin() {
     if (_running) return true;
 
-    Serial.printf("[STATUS] Starting web server on %s:80\n",
+    Log.event(LOG_SEV_INFO, "[STATUS] Starting web server on %s:80",
                   WiFi.localIP().toString().c_str());
 
     _httpServer.on("/", HTTP_GET, [this]() { handleRoot(); });
@@ -26,12 +32,23 @@ bool StatusServer::begin() {
     _httpServer.on("/api/settings", HTTP_GET,  [this]() { handleApiSettings(); });
     _httpServer.on("/api/settings", HTTP_POST, [this]() { handleApiSettings(); });
     _httpServer.on("/api/log", HTTP_GET, [this]() { handleApiLog(); });
+    _httpServer.on("/api/clients", HTTP_GET, [this]() { handleApiClients(); });
+    _httpServer.on("/api/pcap", HTTP_GET,  [this]() { handleApiPcap(); });
+    _httpServer.on("/api/pcap", HTTP_POST, [this]() { handleApiPcap(); });
+    _httpServer.on("/api/events", HTTP_GET, [this]() { handleApiEvents(); });
+    _httpServer.on("/api/stall", HTTP_GET, [this]() { handleApiStall(); });
+    _httpServer.on("/api/heap", HTTP_GET, [this]() { handleApiHeap(); });
+    _httpServer.on("/api/energy", HTTP_GET, [this]() { handleApiEnergy(); });
     _httpServer.onNotFound([this]() { handleNotFound(); });
 
+    // Accept selects JSON or CBOR for /api/status and /api/log
+    static const char* headerKeys[] = { "Accept" };
+    _httpServer.collectHeaders(headerKeys, 1);
+
     _httpServer.begin();
     _running = true;
 
-    Serial.println("[STATUS] Web server started");
+    Log.event(LOG_SEV_NOTICE, "[STATUS] Web server started");
     return true;
 }
 
@@ -41,7 +58,7 @@ void StatusServer::stop() {
     _httpServer.stop();
     _running = false;
 
-    Serial.println("[STATUS] Web server stopped");
+    Log.event(LOG_SEV_NOTICE, "[STATUS] Web server stopped");
 }
 
 void StatusServer::handleClient() {
@@ -57,14 +74,54 @@ void StatusServer::setNTPServer(NTPServer* ntp) {
     _ntpServer = ntp;
 }
 
-void StatusServer::setStatusData(StatusData* data) {
-    _statusData = data;
-}
-
 void StatusServer::setReceptionHistory(ReceptionHistory* rh) {
     _receptionHistory = rh;
 }
 
+void StatusServer::setWWVBValidator(const WWVBValidator* v) {
+    _wwvbValidator = v;
+}
+
+void StatusServer::setLatencyCalibrator(const LatencyCalibrator* c) {
+    _latencyCalibrator = c;
+}
+
+void StatusServer::setPropagationModel(const PropagationModel* p) {
+    _propagation = p;
+}
+
+void StatusServer::setSyncCadence(const SyncCadence* c) {
+    _syncCadence = c;
+}
+
+void StatusServer::setClockQuality(const ClockQuality* q) {
+    _clockQuality = q;
+}
+
+void StatusServer::setReceptionPolicy(const ReceptionPolicy* p) {
+    _receptionPolicy = p;
+}
+
+void StatusServer::setClockDiscipline(const ClockDiscipline* d) {
+    _clockDiscipline = d;
+}
+
+void StatusServer::setIRQLatencyHistogram(const LatencyHistogram* h) {
+    _irqLatency = h;
+}
+
+void StatusServer::setEdgeCapture(const EdgeCapture* edges) {
+    _edgeCapture = edges;
+}
+
+void StatusServer::setPTPServer(const PTPServer* ptp) {
+    _ptpServer = ptp;
+}
+
+void StatusServer::setUsbRefclock(const UsbRefclock* usb) {
+    _usbRefclock = usb;
+}
+
 void StatusServer::setOnSyncRequest(std::function<void()> cb) {
     _onSyncRequest = cb;
 }
@@ -98,38 +155,82 @@ const char* StatusServer::timeSourceName(uint8_t src) {
 }
 
 void StatusServer::handleRoot() {
-    _httpServer.send(200, "text/html; charset=utf-8", buildPage());
+    sendPage();
+}
+
+bool StatusServer::wantsCbor() {
+    return _httpServer.hasHeader("Accept") &&
+           _httpServer.header("Accept").indexOf("application/cbor") >= 0;
+}
+
+void StatusServer::sendTimed(const char* type, const uint8_t* body, size_t len, uint32_t startUs) {
+    // Build time lets a collector compare encoders on the device itself
+    _httpServer.sendHeader("X-Build-Us", String(micros() - startUs));
+    _httpServer.sendHeader("Vary", "Accept");
+    // send_P with a length sends binary bodies verbatim (flat address space on ESP32)
+    _httpServer.send_P(200, type, (const char*)body, len);
+}
+
+void StatusServer::signalQuality(const ReceiverState& rx, const char*& sigq, const char*& sigm,
+                                 char* siga, size_t sigaLen) {
+    // ES100 has no RSSI/SNR register; derived from reception statistics
+    int recent48h = _receptionHistory ? _receptionHistory->getRecentSuccessCount() : 0;
+    if      (recent48h >= 8) sigq = "STRONG";
+    else if (recent48h >= 4) sigq = "GOOD";
+    else if (recent48h >= 1) sigq = "FAIR";
+    else                     sigq = "POOR";
+
+    sigm = rx.trackingReady ? "TRACKING" : "NORMAL";
+
+    uint16_t a1 = rx.ant1Successes;
+    uint16_t a2 = rx.ant2Successes;
+    if      (a1 == 0 && a2 == 0)                    snprintf(siga, sigaLen, "---");
+    else if ((uint32_t)a1 >= (uint32_t)a2 * 2)      snprintf(siga, sigaLen, "A1");
+    else if ((uint32_t)a2 >= (uint32_t)a1 * 2)      snprintf(siga, sigaLen, "A2");
+    else                                             snprintf(siga, sigaLen, "A1+A2");
 }
 
 void StatusServer::handleApiStatus() {
-    if (!_timeManager || !_statusData) {
+    if (!_timeManager) {
         _httpServer.send(503, "application/json", "{\"error\":\"not ready\"}");
         return;
     }
+    uint32_t startUs = micros();
+    if (wantsCbor()) {
+        sendStatusCbor(startUs);
+        return;
+    }
+
+    ClockState clk;
+    PowerState pwr;
+    ReceiverState rx;
+    State.clock.read(clk);
+    State.power.read(pwr);
+    State.receiver.read(rx);
 
     ClockTime utc = _timeManager->getUTCTime();
-    ClockTime local = _timeManager->getLocalTime(_statusData->utcOffset, _statusData->dstActive);
+    ClockTime local = _timeManager->getLocalTime(clk.utcOffset, clk.dstActive);
 
-    float tempC = _statusData->temperatureC;
+    float tempC = pwr.temperatureC;
     float tempF = (tempC * 9.0f / 5.0f) + 32.0f;
 
-    uint16_t battMv = _statusData->batteryMv;
-    int battPct = _statusData->batteryPct;
+    uint16_t battMv = pwr.batteryMv;
+    int battPct = pwr.batteryPct;
 
     uint32_t ntpReq = _ntpServer ? _ntpServer->getRequestCount() : 0;
 
     unsigned long syncAgo = 0;
-    if (_statusData->lastSyncMillis > 0) {
-        syncAgo = (millis() - _statusData->lastSyncMillis) / 1000;
+    if (clk.lastSyncMillis > 0) {
+        syncAgo = (millis() - clk.lastSyncMillis) / 1000;
     }
 
-    int8_t totalOff = _statusData->utcOffset + (_statusData->dstActive ? 1 : 0);
+    int8_t totalOff = clk.utcOffset + (clk.dstActive ? 1 : 0);
     char tzLabel[16];
     snprintf(tzLabel, sizeof(tzLabel), "UTC%+d%s", totalOff,
-             _statusData->dstActive ? " DST" : "");
+             clk.dstActive ? " DST" : "");
 
     // Build JSON — base fields first
-    char buf[1024];
+    char buf[2560];
     int pos = snprintf(buf, sizeof(buf),
         "{\"utc\":{\"h\":%d,\"m\":%d,\"s\":%d,\"Y\":%d,\"M\":%d,\"D\":%d},"
         "\"local\":{\"h\":%d,\"m\":%d,\"s\":%d,\"Y\":%d,\"M\":%d,\"D\":%d},"
@@ -140,12 +241,12 @@ void StatusServer::handleApiStatus() {
         "\"sync\":{\"src\":\"%s\",\"ago\":%lu,\"time\":\"%s\"}",
         utc.hour, utc.minute, utc.second, utc.year, utc.month, utc.day,
         local.hour, local.minute, local.second, local.year, local.month, local.day,
-        (int)_statusData->utcOffset, _statusData->dstActive ? "true" : "false", tzLabel,
+        (int)clk.utcOffset, clk.dstActive ? "true" : "false", tzLabel,
         tempC, tempF,
-        (int)battMv, battPct, _statusData->batteryCharging ? "true" : "false",
+        (int)battMv, battPct, pwr.batteryCharging ? "true" : "false",
         (unsigned long)ntpReq,
-        timeSourceName(_statusData->timeSource), (unsigned long)syncAgo,
-        _statusData->lastSyncTimeStr);
+        timeSourceName(clk.timeSource), (unsigned long)syncAgo,
+        clk.lastSyncTimeStr);
 
     // Add reception history if available
     if (_receptionHistory && pos < (int)sizeof(buf) - 200) {
@@ -169,39 +270,201 @@ void StatusServer::handleApiStatus() {
     if (pos < (int)sizeof(buf) - 80) {
         pos += snprintf(buf + pos, sizeof(buf) - pos,
             ",\"es100avail\":%s,\"es100recv\":%s,\"es100trk\":%s,\"es100pend\":%s",
-            _statusData->es100Available      ? "true" : "false",
-            _statusData->es100Receiving      ? "true" : "false",
-            _statusData->es100Tracking       ? "true" : "false",
-            _statusData->es100PendingTracking ? "true" : "false");
+            rx.available      ? "true" : "false",
+            rx.receiving      ? "true" : "false",
+            rx.tracking       ? "true" : "false",
+            rx.pendingTracking ? "true" : "false");
     }
 
     // Leap second warning + antenna performance
     if (pos < (int)sizeof(buf) - 40) {
         pos += snprintf(buf + pos, sizeof(buf) - pos,
             ",\"lsw\":%d,\"ant1\":%d,\"ant2\":%d",
-            (int)_statusData->leapSecondWarning,
-            (int)_statusData->ant1Successes,
-            (int)_statusData->ant2Successes);
+            (int)clk.leapSecondWarning,
+            (int)rx.ant1Successes,
+            (int)rx.ant2Successes);
     }
 
-    // Signal quality (ES100 has no RSSI/SNR register; derived from reception statistics)
-    if (pos < (int)sizeof(buf) - 60) {
-        int recent48h = _receptionHistory ? _receptionHistory->getRecentSuccessCount() : 0;
-        const char* sigq;
-        if      (recent48h >= 8) sigq = "STRONG";
-        else if (recent48h >= 4) sigq = "GOOD";
-        else if (recent48h >= 1) sigq = "FAIR";
-        else                     sigq = "POOR";
+    // WWVB frame validation: accepted / held for confirmation / rejected
+    if (_wwvbValidator && pos < (int)sizeof(buf) - 110) {
+        pos += snprintf(buf + pos, sizeof(buf) - pos,
+            ",\"val\":{\"ok\":%lu,\"hold\":%lu,\"rej\":%lu,\"why\":\"%s\"}",
+            (unsigned long)_wwvbValidator->getAcceptCount(),
+            (unsigned long)_wwvbValidator->getPendingCount(),
+            (unsigned long)_wwvbValidator->getRejectCount(),
+            _wwvbValidator->getLastReason());
+    }
+
+    // ES100 IRQ latency estimates per mode/antenna: [estimate_us, samples], and the
+    // configured common base (0 = absolute latency uncorrected)
+    if (_latencyCalibrator && pos < (int)sizeof(buf) - 156) {
+        pos += snprintf(buf + pos, sizeof(buf) - pos, ",\"lat\":{\"base\":%ld,",
+                        (long)ES100_IRQ_BASE_LATENCY_US);
+        for (uint8_t i = 0; i < LATCAL_BUCKETS; i++) {
+            pos += snprintf(buf + pos, sizeof(buf) - pos, "\"%s\":[%ld,%u],",
+                           LatencyCalibrator::bucketName(i),
+                           (long)_latencyCalibrator->getEstimateUs(i),
+                           _latencyCalibrator->getSampleCount(i));
+        }
+        pos += snprintf(buf + pos, sizeof(buf) - pos, "\"out\":%lu}",
+                       (unsigned long)_latencyCalibrator->getOutlierCount());
+    }
+
+    // WWVB propagation: distance, ground/sky-wave delays [µs, hops], solar
+    // elevation at the path midpoint, night weight, current and last-applied µs
+    if (_propagation && pos < (int)sizeof(buf) - 180) {
+        pos += snprintf(buf + pos, sizeof(buf) - pos, ",\"prop\":");
+        pos += _propagation->toJson(buf + pos, sizeof(buf) - pos,
+                                    _timeManager->isTimeSet() ? _timeManager->getUnixTime() : 0);
+    }
+
+    // Clock quality: state, error bound (µs, -1 = none), sync age (s), advertised
+    // stratum/LI/reference ID, root dispersion (ms), drift budget, transitions, violations
+    if (_clockQuality && pos < (int)sizeof(buf) - 200) {
+        pos += snprintf(buf + pos, sizeof(buf) - pos, ",\"cq\":");
+        pos += _clockQuality->toJson(buf + pos, sizeof(buf) - pos, _timeManager->getUnixTime());
+    }
+
+    // Drift-aware cadence: measured drift (ppm) over its span (h), the drift
+    // budgeted for, and the resulting tracking age, anchor, fallback and intervals (s)
+    if (_syncCadence && pos < (int)sizeof(buf) - 200) {
+        pos += snprintf(buf + pos, sizeof(buf) - pos, ",\"cad\":");
+        pos += _syncCadence->toJson(buf + pos, sizeof(buf) - pos);
+    }
+
+    // Reception policy: local hour, cycle odds [[first Ant1, Ant2], [retry Ant1, Ant2]]
+    // (-1 = too few samples), shortest decode (s), attempts, failed cycles, aborts,
+    // antenna switches, receiver time saved and spent (s), fixes, fixes per receiver-hour
+    if (_receptionPolicy && pos < (int)sizeof(buf) - 220) {
+        pos += snprintf(buf + pos, sizeof(buf) - pos, ",\"rxp\":");
+        pos += _receptionPolicy->toJson(buf + pos, sizeof(buf) - pos,
+                                        _timeManager->isTimeSet() ? (int8_t)local.hour : -1);
+    }
+
+    // Continuous-tracking discipline: window size, fitted phase/frequency, DS3231 aging
+    if (_clockDiscipline && pos < (int)sizeof(buf) - 100) {
+        pos += snprintf(buf + pos, sizeof(buf) - pos,
+            ",\"disc\":{\"n\":%u,\"tot\":%lu,\"ph\":%ld,\"ppm\":%.3f,\"age\":%d}",
+            _clockDiscipline->getCount(),
+            (unsigned long)_clockDiscipline->getTotalCount(),
+            (long)_clockDiscipline->getPhaseUs(),
+            _clockDiscipline->getFrequencyPpm(),
+            (int)_clockDiscipline->getAgingOffset());
+    }
+
+    // ES100 IRQ edge → clock-set latency histogram (µs, 1-2-5 buckets from 100 µs)
+    if (_irqLatency && pos < (int)sizeof(buf) - 240) {
+        pos += snprintf(buf + pos, sizeof(buf) - pos, ",\"irqlat\":");
+        pos += _irqLatency->toJson(buf + pos, sizeof(buf) - pos);
+    }
+
+    // SQW / ES100 IRQ edge stamps: ISR latency [min,avg,max] above the MCPWM
+    // capture and SQW jitter with software vs hardware stamps (µs)
+    if (_edgeCapture && pos < (int)sizeof(buf) - 200) {
+        pos += snprintf(buf + pos, sizeof(buf) - pos, ",\"edge\":");
+        pos += _edgeCapture->toJson(buf + pos, sizeof(buf) - pos);
+    }
+
+    // NTP receive → send latency histogram (µs); flash-cache stalls show up here
+    if (_ntpServer && pos < (int)sizeof(buf) - 240) {
+        pos += snprintf(buf + pos, sizeof(buf) - pos, ",\"ntplat\":");
+        pos += _ntpServer->getServedLatency().toJson(buf + pos, sizeof(buf) - pos);
+    }
+
+    // CPU cycles per served request — compare NTP_USE_RAW_PBUF 1 vs 0
+    if (_ntpServer && pos < (int)sizeof(buf) - 100) {
+        pos += snprintf(buf + pos, sizeof(buf) - pos,
+            ",\"ntpcyc\":{\"raw\":%s,\"avg\":%lu,\"min\":%lu,\"max\":%lu,\"last\":%lu}",
+            NTPServer::usesRawPbuf() ? "true" : "false",
+            (unsigned long)_ntpServer->getCyclesAvg(),
+            (unsigned long)_ntpServer->getCyclesMin(),
+            (unsigned long)_ntpServer->getCyclesMax(),
+            (unsigned long)_ntpServer->getCyclesLast());
+    }
+
+    // NTP receive queue and overload counters.  Mailbox-full and shed exist
+    // only on the WiFiUDP path; the raw path has lwIP's own drops, if counted.
+    if (_ntpServer && pos < (int)sizeof(buf) - 160) {
+        const NTPRateLimiter& rl = _ntpServer->getRateLimiter();
+        pos += snprintf(buf + pos, sizeof(buf) - pos, ",\"ntpq\":{\"depth\":%u,\"hwm\":%u,",
+            _ntpServer->getQueueDepth(), _ntpServer->getQueueHighWater());
+        int32_t lwDrops = NTPServer::getLwipUdpDrops();
+        if (!NTPServer::usesRawPbuf()) {
+            pos += snprintf(buf + pos, sizeof(buf) - pos, "\"full\":%lu,\"shed\":%lu,",
+                (unsigned long)_ntpServer->getQueueFullCount(),
+                (unsigned long)_ntpServer->getShedCount());
+        } else if (lwDrops >= 0) {
+            pos += snprintf(buf + pos, sizeof(buf) - pos, "\"lwdrop\":%ld,", (long)lwDrops);
+        }
+        pos += snprintf(buf + pos, sizeof(buf) - pos,
+            "\"bad\":%lu,\"txerr\":%lu,\"limited\":%lu,\"kod\":%lu,\"clients\":%u}",
+            (unsigned long)_ntpServer->getMalformedCount(),
+            (unsigned long)_ntpServer->getSendFailCount(),
+            (unsigned long)rl.getLimitedCount(),
+            (unsigned long)rl.getKoDCount(),
+            rl.getTrackedClients());
+    }
+
+    // PTP grandmaster
+    if (_ptpServer && pos < (int)sizeof(buf) - 120) {
+        pos += snprintf(buf + pos, sizeof(buf) - pos,
+            ",\"ptp\":{\"on\":%s,\"class\":%u,\"sync\":%lu,\"ann\":%lu,\"dreq\":%lu,\"dlost\":%lu}",
+            _ptpServer->isRunning() ? "true" : "false",
+            _ptpServer->getClockClass(),
+            (unsigned long)_ptpServer->getSyncCount(),
+            (unsigned long)_ptpServer->getAnnounceCount(),
+            (unsigned long)_ptpServer->getDelayReqCount(),
+            (unsigned long)_ptpServer->getDelayReqLost());
+    }
+
+    // USB reference-clock link
+    if (_usbRefclock && pos < (int)sizeof(buf) - 60) {
+        pos += snprintf(buf + pos, sizeof(buf) - pos,
+            ",\"usbref\":{\"req\":%lu,\"bad\":%lu,\"skip\":%lu}",
+            (unsigned long)_usbRefclock->getRequestCount(),
+            (unsigned long)_usbRefclock->getBadCount(),
+            (unsigned long)_usbRefclock->getSkippedCount());
+    }
+
+    // Watchdog/panic resets since power-on and where the last one struck
+    if (pos < (int)sizeof(buf) - 100) {
+        const Breadcrumbs::Record* last = Crumbs.lastStall();
+        pos += snprintf(buf + pos, sizeof(buf) - pos,
+            ",\"stall\":{\"boots\":%lu,\"wdt\":%lu,\"panic\":%lu,\"stage\":\"%s\"}",
+            (unsigned long)Crumbs.getBootCount(),
+            (unsigned long)Crumbs.getWdtResets(),
+            (unsigned long)Crumbs.getPanicResets(),
+            last ? Breadcrumbs::stageName(last->stage) : "");
+    }
+
+    // Internal heap (free, largest block, low-water mark) and PSRAM
+    if (pos < (int)sizeof(buf) - 110) {
+        const HeapMonitor::Sample& hs = Heap.getLast();
+        pos += snprintf(buf + pos, sizeof(buf) - pos,
+            ",\"heap\":{\"free\":%lu,\"big\":%lu,\"min\":%lu,\"frag\":%u,\"psfree\":%lu}",
+            (unsigned long)hs.intFree, (unsigned long)hs.intLargest,
+            (unsigned long)Heap.getInternalMinFree(), Heap.getFragmentationPct(),
+            (unsigned long)hs.psramFree);
+    }
 
-        const char* sigm = _statusData->es100TrackingReady ? "TRACKING" : "NORMAL";
+    // Modelled power, predicted runtime and calibrated mWh per subsystem
+    if (pos < (int)sizeof(buf) - 160) {
+        pos += snprintf(buf + pos, sizeof(buf) - pos,
+            ",\"nrg\":{\"mw\":%.1f,\"rt\":%.1f,\"k\":%.2f,\"mwh\":[",
+            Energy.getPowerMw(), Energy.getRuntimeHours(), Energy.getScale());
+        for (uint8_t i = 0; i < ENERGY_COUNT; i++) {
+            pos += snprintf(buf + pos, sizeof(buf) - pos, "%s%.1f", i ? "," : "",
+                            Energy.getMWh(i));
+        }
+        pos += snprintf(buf + pos, sizeof(buf) - pos, "]}");
+    }
 
+    // Signal quality
+    if (pos < (int)sizeof(buf) - 60) {
+        const char* sigq;
+        const char* sigm;
         char siga[8];
-        uint16_t a1 = _statusData->ant1Successes;
-        uint16_t a2 = _statusData->ant2Successes;
-        if      (a1 == 0 && a2 == 0)                    snprintf(siga, sizeof(siga), "---");
-        else if ((uint32_t)a1 >= (uint32_t)a2 * 2)      snprintf(siga, sizeof(siga), "A1");
-        else if ((uint32_t)a2 >= (uint32_t)a1 * 2)      snprintf(siga, sizeof(siga), "A2");
-        else                                             snprintf(siga, sizeof(siga), "A1+A2");
+        signalQuality(rx, sigq, sigm, siga, sizeof(siga));
 
         pos += snprintf(buf + pos, sizeof(buf) - pos,
             ",\"sigq\":\"%s\",\"sigm\":\"%s\",\"siga\":\"%s\"",
@@ -214,16 +477,261 @@ void StatusServer::handleApiStatus() {
         buf[pos] = '\0';
     }
 
-    _httpServer.send(200, "application/json", buf);
+    sendTimed("application/json", (const uint8_t*)buf, pos, startUs);
+}
+
+// Same document as the JSON above, key for key. Floats go out as float32
+// and the reception history as one byte string instead of 48 integers.
+void StatusServer::sendStatusCbor(uint32_t startUs) {
+    ClockState clk;
+    PowerState pwr;
+    ReceiverState rx;
+    State.clock.read(clk);
+    State.power.read(pwr);
+    State.receiver.read(rx);
+
+    ClockTime utc = _timeManager->getUTCTime();
+    ClockTime local = _timeManager->getLocalTime(clk.utcOffset, clk.dstActive);
+    float tempC = pwr.temperatureC;
+
+    unsigned long syncAgo = 0;
+    if (clk.lastSyncMillis > 0) {
+        syncAgo = (millis() - clk.lastSyncMillis) / 1000;
+    }
+
+    int8_t totalOff = clk.utcOffset + (clk.dstActive ? 1 : 0);
+    char tzLabel[16];
+    snprintf(tzLabel, sizeof(tzLabel), "UTC%+d%s", totalOff,
+             clk.dstActive ? " DST" : "");
+
+    uint8_t buf[1664];
+    CborWriter w(buf, sizeof(buf));
+    w.beginMap();
+
+    const ClockTime* times[2] = { &utc, &local };
+    const char* timeKeys[2] = { "utc", "local" };
+    for (uint8_t i = 0; i < 2; i++) {
+        w.key(timeKeys[i]);
+        w.beginMap(6);
+        w.kv("h", times[i]->hour);
+        w.kv("m", times[i]->minute);
+        w.kv("s", times[i]->second);
+        w.kv("Y", times[i]->year);
+        w.kv("M", times[i]->month);
+        w.kv("D", times[i]->day);
+    }
+
+    w.key("tz");
+    w.beginMap(3);
+    w.kvInt("off", clk.utcOffset);
+    w.kvBool("dst", clk.dstActive);
+    w.kvText("label", tzLabel);
+
+    w.key("temp");
+    w.beginMap(2);
+    w.kvFloat("c", tempC);
+    w.kvFloat("f", tempC * 9.0f / 5.0f + 32.0f);
+
+    w.key("batt");
+    w.beginMap(3);
+    w.kv("mv", pwr.batteryMv);
+    w.kvInt("pct", pwr.batteryPct);
+    w.kvBool("chg", pwr.batteryCharging);
+
+    w.key("ntp");
+    w.beginMap(1);
+    w.kv("req", _ntpServer ? _ntpServer->getRequestCount() : 0);
+
+    w.key("sync");
+    w.beginMap(3);
+    w.kvText("src", timeSourceName(clk.timeSource));
+    w.kv("ago", syncAgo);
+    w.kvText("time", clk.lastSyncTimeStr);
+
+    if (_receptionHistory) {
+        uint8_t histData[HISTORY_BUCKETS];
+        _receptionHistory->getHistoryData(histData);
+        w.key("wwvb");
+        w.beginMap(4);
+        w.kvInt("rate", _receptionHistory->getSuccessRate());
+        w.kvInt("ok", _receptionHistory->getTotalSuccessCount());
+        w.kvInt("tries", _receptionHistory->getTotalAttemptCount());
+        w.key("h");
+        w.bytes(histData, HISTORY_BUCKETS);
+    }
+
+    w.kvBool("es100avail", rx.available);
+    w.kvBool("es100recv", rx.receiving);
+    w.kvBool("es100trk", rx.tracking);
+    w.kvBool("es100pend", rx.pendingTracking);
+    w.kvInt("lsw", clk.leapSecondWarning);
+    w.kv("ant1", rx.ant1Successes);
+    w.kv("ant2", rx.ant2Successes);
+
+    if (_wwvbValidator) {
+        w.key("val");
+        w.beginMap(4);
+        w.kv("ok", _wwvbValidator->getAcceptCount());
+        w.kv("hold", _wwvbValidator->getPendingCount());
+        w.kv("rej", _wwvbValidator->getRejectCount());
+        w.kvText("why", _wwvbValidator->getLastReason());
+    }
+
+    if (_latencyCalibrator) {
+        w.key("lat");
+        w.beginMap(LATCAL_BUCKETS + 2);
+        w.kvInt("base", ES100_IRQ_BASE_LATENCY_US);
+        for (uint8_t i = 0; i < LATCAL_BUCKETS; i++) {
+            w.key(LatencyCalibrator::bucketName(i));
+            w.beginArray(2);
+            w.signedInt(_latencyCalibrator->getEstimateUs(i));
+            w.unsignedInt(_latencyCalibrator->getSampleCount(i));
+        }
+        w.kv("out", _latencyCalibrator->getOutlierCount());
+    }
+
+    if (_propagation) {
+        w.key("prop");
+        _propagation->toCbor(w, _timeManager->isTimeSet() ? _timeManager->getUnixTime() : 0);
+    }
+
+    if (_clockQuality) {
+        w.key("cq");
+        _clockQuality->toCbor(w, _timeManager->getUnixTime());
+    }
+
+    if (_syncCadence) {
+        w.key("cad");
+        _syncCadence->toCbor(w);
+    }
+
+    if (_receptionPolicy) {
+        w.key("rxp");
+        _receptionPolicy->toCbor(w, _timeManager->isTimeSet() ? (int8_t)local.hour : -1);
+    }
+
+    if (_clockDiscipline) {
+        w.key("disc");
+        w.beginMap(5);
+        w.kv("n", _clockDiscipline->getCount());
+        w.kv("tot", _clockDiscipline->getTotalCount());
+        w.kvInt("ph", _clockDiscipline->getPhaseUs());
+        w.kvFloat("ppm", _clockDiscipline->getFrequencyPpm());
+        w.kvInt("age", _clockDiscipline->getAgingOffset());
+    }
+
+    if (_irqLatency) {
+        w.key("irqlat");
+        _irqLatency->toCbor(w);
+    }
+
+    if (_edgeCapture) {
+        w.key("edge");
+        _edgeCapture->toCbor(w);
+    }
+
+    if (_ntpServer) {
+        w.key("ntplat");
+        _ntpServer->getServedLatency().toCbor(w);
+
+        w.key("ntpcyc");
+        w.beginMap(5);
+        w.kvBool("raw", NTPServer::usesRawPbuf());
+        w.kv("avg", _ntpServer->getCyclesAvg());
+        w.kv("min", _ntpServer->getCyclesMin());
+        w.kv("max", _ntpServer->getCyclesMax());
+        w.kv("last", _ntpServer->getCyclesLast());
+
+        const NTPRateLimiter& rl = _ntpServer->getRateLimiter();
+        int32_t lwDrops = NTPServer::getLwipUdpDrops();
+        bool raw = NTPServer::usesRawPbuf();
+        w.key("ntpq");
+        w.beginMap(7 + (raw ? (lwDrops >= 0 ? 1 : 0) : 2));
+        w.kv("depth", _ntpServer->getQueueDepth());
+        w.kv("hwm", _ntpServer->getQueueHighWater());
+        if (!raw) {
+            w.kv("full", _ntpServer->getQueueFullCount());
+            w.kv("shed", _ntpServer->getShedCount());
+        } else if (lwDrops >= 0) {
+            w.kv("lwdrop", (uint32_t)lwDrops);
+        }
+        w.kv("bad", _ntpServer->getMalformedCount());
+        w.kv("txerr", _ntpServer->getSendFailCount());
+        w.kv("limited", rl.getLimitedCount());
+        w.kv("kod", rl.getKoDCount());
+        w.kv("clients", rl.getTrackedClients());
+    }
+
+    if (_ptpServer) {
+        w.key("ptp");
+        w.beginMap(6);
+        w.kvBool("on", _ptpServer->isRunning());
+        w.kv("class", _ptpServer->getClockClass());
+        w.kv("sync", _ptpServer->getSyncCount());
+        w.kv("ann", _ptpServer->getAnnounceCount());
+        w.kv("dreq", _ptpServer->getDelayReqCount());
+        w.kv("dlost", _ptpServer->getDelayReqLost());
+    }
+
+    if (_usbRefclock) {
+        w.key("usbref");
+        w.beginMap(3);
+        w.kv("req", _usbRefclock->getRequestCount());
+        w.kv("bad", _usbRefclock->getBadCount());
+        w.kv("skip", _usbRefclock->getSkippedCount());
+    }
+
+    const Breadcrumbs::Record* last = Crumbs.lastStall();
+    w.key("stall");
+    w.beginMap(4);
+    w.kv("boots", Crumbs.getBootCount());
+    w.kv("wdt", Crumbs.getWdtResets());
+    w.kv("panic", Crumbs.getPanicResets());
+    w.kvText("stage", last ? Breadcrumbs::stageName(last->stage) : "");
+
+    const HeapMonitor::Sample& hs = Heap.getLast();
+    w.key("heap");
+    w.beginMap(5);
+    w.kv("free", hs.intFree);
+    w.kv("big", hs.intLargest);
+    w.kv("min", Heap.getInternalMinFree());
+    w.kv("frag", Heap.getFragmentationPct());
+    w.kv("psfree", hs.psramFree);
+
+    w.key("nrg");
+    w.beginMap(4);
+    w.kvFloat("mw", Energy.getPowerMw());
+    w.kvFloat("rt", Energy.getRuntimeHours());
+    w.kvFloat("k", Energy.getScale());
+    w.key("mwh");
+    w.beginArray(ENERGY_COUNT);
+    for (uint8_t i = 0; i < ENERGY_COUNT; i++) w.float32(Energy.getMWh(i));
+
+    const char* sigq;
+    const char* sigm;
+    char siga[8];
+    signalQuality(rx, sigq, sigm, siga, sizeof(siga));
+    w.kvText("sigq", sigq);
+    w.kvText("sigm", sigm);
+    w.kvText("siga", siga);
+    w.end();
+
+    if (!w.ok()) {
+        _httpServer.send(500, "application/json", "{\"error\":\"cbor overflow\"}");
+        return;
+    }
+    sendTimed("application/cbor", w.data(), w.size(), startUs);
 }
 
 bool StatusServer::checkEs100Ready(bool checkPending) {
-    if (!_statusData || !_statusData->es100Available) {
+    ReceiverState rx;
+    State.receiver.read(rx);
+    if (!rx.available) {
         _httpServer.send(503, "application/json", "{\"error\":\"ES100 not available\"}");
         return false;
     }
-    bool busy = _statusData->es100Receiving ||
-                (checkPending && _statusData->es100PendingTracking);
+    bool busy = rx.receiving ||
+                (checkPending && rx.pendingTracking);
     if (busy) {
         _httpServer.send(409, "application/json", "{\"error\":\"sync already in progress\"}");
         return false;
@@ -262,27 +770,52 @@ void StatusServer::handleApiSettings() {
         _onSettingsRequest(off, dst);
         _httpServer.send(200, "application/json", "{\"ok\":true}");
     } else {
-        if (!_statusData) {
-            _httpServer.send(503, "application/json", "{\"error\":\"not ready\"}");
-            return;
-        }
+        ClockState clk;
+        State.clock.read(clk);
         char buf[64];
         snprintf(buf, sizeof(buf), "{\"off\":%d,\"dst\":%s}",
-                 (int)_statusData->utcOffset,
-                 _statusData->dstActive ? "true" : "false");
+                 (int)clk.utcOffset,
+                 clk.dstActive ? "true" : "false");
         _httpServer.send(200, "application/json", buf);
     }
 }
 
 void StatusServer::handleApiLog() {
+    bool cbor = wantsCbor();
     if (!_syncLog || !_syncLogHead || !_syncLogFilled) {
-        _httpServer.send(200, "application/json", "[]");
+        if (cbor) {
+            static const char empty[] = { (char)0x80 };   // Empty array
+            _httpServer.send_P(200, "application/cbor", empty, sizeof(empty));
+        } else {
+            _httpServer.send(200, "application/json", "[]");
+        }
         return;
     }
 
+    uint32_t startUs = micros();
     uint8_t count = *_syncLogFilled;
     uint8_t head  = *_syncLogHead;
 
+    if (cbor) {
+        uint8_t out[SYNC_LOG_SIZE * 48 + 8];
+        CborWriter w(out, sizeof(out));
+        w.beginArray(count);
+        for (uint8_t i = 0; i < count; i++) {
+            const SyncLogEntry& e = _syncLog[(head + SYNC_LOG_SIZE - 1 - i) % SYNC_LOG_SIZE];
+            w.beginMap(4);
+            w.kvText("t", e.timeStr);
+            w.kvBool("ok", e.success);
+            w.kvBool("trk", e.tracking);
+            w.kv("ant", e.antenna);
+        }
+        if (!w.ok()) {
+            _httpServer.send(500, "application/json", "{\"error\":\"cbor overflow\"}");
+            return;
+        }
+        sendTimed("application/cbor", w.data(), w.size(), startUs);
+        return;
+    }
+
     // Build JSON array of last `count` entries, newest first
     char buf[1200];
     int pos = 0;
@@ -305,6 +838,112 @@ void StatusServer::handleApiLog() {
         buf[pos] = '\0';
     }
 
+    sendTimed("application/json", (const uint8_t*)buf, pos, startUs);
+}
+
+void StatusServer::handleApiClients() {
+    if (!_ntpServer) {
+        _httpServer.send(200, "application/json", "{}");
+        return;
+    }
+    char buf[768];
+    int n = _ntpServer->getClientAnalytics().toJson(buf, sizeof(buf) - 24);
+    // Samples the lwIP thread could not hand over (ring full)
+    if (n > 0 && buf[n - 1] == '}') {
+        snprintf(buf + n - 1, sizeof(buf) - n + 1, ",\"lost\":%lu}",
+                 (unsigned long)_ntpServer->getClientSamplesLost());
+    }
+    _httpServer.send(200, "application/json", buf);
+}
+
+void StatusServer::handleApiPcap() {
+    if (!_ntpServer || !_ntpServer->getCapture().isAvailable()) {
+        _httpServer.send(503, "application/json", "{\"error\":\"capture unavailable\"}");
+        return;
+    }
+    PacketCapture& cap = _ntpServer->getCapture();
+
+    // Optional client filter for both arming and download
+    uint32_t clientIp = 0;
+    if (_httpServer.hasArg("ip")) {
+        IPAddress ip;
+        if (!ip.fromString(_httpServer.arg("ip").c_str())) {
+            _httpServer.send(400, "application/json", "{\"error\":\"bad ip\"}");
+            return;
+        }
+        clientIp = (uint32_t)ip;
+    }
+
+    if (_httpServer.method() == HTTP_POST) {
+        if (_httpServer.arg("clear") == "1") cap.clear();
+        if (_httpServer.hasArg("on")) cap.arm(_httpServer.arg("on") == "1", clientIp);
+        uint32_t f = cap.getFilter();
+        char buf[128];
+        snprintf(buf, sizeof(buf),
+                 "{\"armed\":%s,\"filter\":\"%u.%u.%u.%u\",\"held\":%u,\"total\":%lu}",
+                 cap.isArmed() ? "true" : "false",
+                 (unsigned)(f & 0xFF), (unsigned)((f >> 8) & 0xFF),
+                 (unsigned)((f >> 16) & 0xFF), (unsigned)(f >> 24),
+                 cap.getCount(), (unsigned long)cap.getTotal());
+        _httpServer.send(200, "application/json", buf);
+        return;
+    }
+
+    // Stream the ring as a pcap file; WebServer sends it chunked
+    _httpServer.sendHeader("Content-Disposition", "attachment; filename=\"ntp.pcap\"");
+    _httpServer.setContentLength(CONTENT_LENGTH_UNKNOWN);
+    _httpServer.send(200, "application/vnd.tcpdump.pcap", "");
+    cap.exportPcap(clientIp, (uint32_t)WiFi.localIP(), [this](const uint8_t* d, size_t n) {
+        _httpServer.sendContent((const char*)d, n);
+    });
+    _httpServer.sendContent("", 0);
+}
+
+void StatusServer::handleApiEvents() {
+    _httpServer.setContentLength(CONTENT_LENGTH_UNKNOWN);
+    _httpServer.send(200, "application/json", "");
+
+    char buf[LOG_MSG_MAX * 2 + 96];
+    int pos = snprintf(buf, sizeof(buf),
+        "{\"shipped\":%lu,\"dropped\":%lu,\"pending\":%lu,\"throttled\":%lu,\"ev\":[",
+        (unsigned long)Log.getShippedCount(), (unsigned long)Log.getDroppedCount(),
+        (unsigned long)Log.getPendingCount(), (unsigned long)Log.getThrottledCount());
+    _httpServer.sendContent(buf, pos);
+
+    // One chunk per event, newest first; the ring is too large for one stack buffer
+    EventLog::Event e;
+    for (uint16_t i = 0; Log.getRecent(i, e); i++) {
+        pos = snprintf(buf, sizeof(buf),
+            "%s{\"seq\":%lu,\"up\":%lu,\"sev\":%u,\"tag\":\"%s\",\"msg\":\"",
+            i > 0 ? "," : "", (unsigned long)e.seq, (unsigned long)e.uptimeMs,
+            e.severity, e.tag);
+        for (const char* c = e.msg; *c && pos < (int)sizeof(buf) - 8; c++) {
+            if (*c == '"' || *c == '\\') buf[pos++] = '\\';
+            if ((uint8_t)*c < 0x20) continue;
+            buf[pos++] = *c;
+        }
+        pos += snprintf(buf + pos, sizeof(buf) - pos, "\"}");
+        _httpServer.sendContent(buf, pos);
+    }
+    _httpServer.sendContent("]}", 2);
+    _httpServer.sendContent("", 0);
+}
+
+void StatusServer::handleApiStall() {
+    char buf[256 + STALL_TRACE_SIZE * 72];
+    Crumbs.toJson(buf, sizeof(buf));
+    _httpServer.send(200, "application/json", buf);
+}
+
+void StatusServer::handleApiHeap() {
+    char buf[384 + HEAP_HISTORY_SIZE * 40 + HeapMonitor::SLOT_COUNT * 48];
+    Heap.toJson(buf, sizeof(buf));
+    _httpServer.send(200, "application/json", buf);
+}
+
+void StatusServer::handleApiEnergy() {
+    char buf[320 + ENERGY_COUNT * 48];
+    Energy.toJson(buf, sizeof(buf));
     _httpServer.send(200, "application/json", buf);
 }
 
@@ -312,272 +951,268 @@ void StatusServer::handleNotFound() {
     _httpServer.send(404, "text/plain", "Not Found");
 }
 
-String StatusServer::buildPage() {
-    // Get initial time values for server-rendered display
-    String localStr = "--:--:--", localDate = "----/--/--";
-    String utcStr = "--:--:--", utcDate = "----/--/--";
-    String tzLabel = "Local Time";
+void StatusServer::sendPage() {
+    // Initial time values for the server-rendered display
+    char localStr[12] = "--:--:--", localDate[12] = "----/--/--";
+    char utcStr[12] = "--:--:--", utcDate[12] = "----/--/--";
+    char tzLabel[24] = "Local Time";
 
-    if (_timeManager && _statusData) {
+    if (_timeManager) {
+        ClockState clk;
+        State.clock.read(clk);
         ClockTime utc = _timeManager->getUTCTime();
-        ClockTime local = _timeManager->getLocalTime(_statusData->utcOffset, _statusData->dstActive);
-        char buf[12];
-
-        snprintf(buf, sizeof(buf), "%02d:%02d:%02d", local.hour, local.minute, local.second);
-        localStr = buf;
-        snprintf(buf, sizeof(buf), "%04d/%02d/%02d", local.year, local.month, local.day);
-        localDate = buf;
-
-        snprintf(buf, sizeof(buf), "%02d:%02d:%02d", utc.hour, utc.minute, utc.second);
-        utcStr = buf;
-        snprintf(buf, sizeof(buf), "%04d/%02d/%02d", utc.year, utc.month, utc.day);
-        utcDate = buf;
-
-        int8_t totalOff = _statusData->utcOffset + (_statusData->dstActive ? 1 : 0);
-        char tz[16];
-        snprintf(tz, sizeof(tz), "Local (UTC%+d%s)", totalOff,
-                 _statusData->dstActive ? " DST" : "");
-        tzLabel = tz;
-    }
-
-    String html = "<!DOCTYPE html><html><head>";
-    html += "<meta name='viewport' content='width=device-width,initial-scale=1'>";
-    html += "<meta http-equiv='refresh' content='300'>";
-    html += "<title>WWVB Clock Status</title>";
-    html += "<style>";
-    html += "body{font-family:sans-serif;max-width:420px;margin:20px auto;padding:15px;background:#1a1a2e;color:#e0e0e0;}";
-    html += "h1{color:#00d4ff;font-size:22px;text-align:center;margin-bottom:4px;}";
-    html += "h2{color:#aaa;font-size:14px;text-align:center;font-weight:normal;margin-top:0;}";
-    html += ".clock{text-align:center;margin:12px 0;padding:12px;background:#0d0d1a;border-radius:8px;border:1px solid #333;}";
-    html += ".clock-time{font-size:36px;font-family:monospace;color:#00ff88;letter-spacing:2px;}";
-    html += ".clock-date{font-size:14px;color:#888;margin-top:4px;}";
-    html += ".clock-label{font-size:11px;color:#666;margin-top:2px;}";
-    html += ".info{margin:16px 0;background:#0d0d1a;border-radius:8px;border:1px solid #333;overflow:hidden;}";
-    html += ".row{display:flex;justify-content:space-between;padding:10px 14px;border-bottom:1px solid #222;}";
-    html += ".row:last-child{border-bottom:none;}";
-    html += ".row:nth-child(even){background:#12122a;}";
-    html += ".row span:first-child{color:#888;}";
-    html += ".row span:last-child{color:#e0e0e0;font-family:monospace;}";
-    html += ".ntp-info{text-align:center;margin:12px 0;padding:8px;background:#1a2a1a;border-radius:6px;border:1px solid #2a4a2a;font-size:12px;color:#88cc88;}";
-    html += ".chart{margin:16px 0;background:#0d0d1a;border-radius:8px;border:1px solid #333;padding:12px;}";
-    html += ".chart-title{font-size:13px;color:#888;text-align:center;margin-bottom:8px;}";
-    html += ".chart-bars{display:flex;align-items:flex-end;height:50px;gap:1px;}";
-    html += ".chart-bars div{flex:1;background:#00ff88;min-width:2px;border-radius:1px 1px 0 0;transition:height .3s;}";
-    html += ".chart-stats{display:flex;justify-content:space-between;margin-top:8px;font-size:11px;color:#666;}";
-    html += ".sync{text-align:center;margin:12px 0;}";
-    html += ".sync-btns{display:flex;gap:8px;justify-content:center;margin-bottom:6px;}";
-    html += "#syncbtn{flex:1;max-width:170px;padding:10px 8px;background:#00d4ff;color:#000;border:none;border-radius:6px;font-size:14px;font-weight:bold;cursor:pointer;}";
-    html += "#syncbtn:disabled{background:#444;color:#888;cursor:default;}";
-    html += "#trkbtn{flex:1;max-width:170px;padding:10px 8px;background:#ff9900;color:#000;border:none;border-radius:6px;font-size:14px;font-weight:bold;cursor:pointer;}";
-    html += "#trkbtn:disabled{background:#444;color:#888;cursor:default;}";
-    html += ".trkwarn{font-size:11px;color:#777;margin-top:3px;}";
-    html += "#syncmsg{font-size:12px;color:#888;margin-top:6px;min-height:16px;}";
-    html += ".adj{padding:1px 7px;margin:0 2px;background:#2a2a4a;color:#e0e0e0;border:1px solid #444;border-radius:4px;font-size:13px;cursor:pointer;}";
-    html += ".adj:active{background:#3a3a5a;}";
-    html += ".log{margin:16px 0;background:#0d0d1a;border-radius:8px;border:1px solid #333;padding:10px 12px;}";
-    html += ".log-title{font-size:13px;color:#888;text-align:center;margin-bottom:6px;}";
-    html += "#logtbl{width:100%;border-collapse:collapse;font-size:11px;font-family:monospace;}";
-    html += "#logtbl th{color:#666;padding:3px 4px;border-bottom:1px solid #333;text-align:left;font-weight:normal;}";
-    html += "#logtbl td{padding:2px 4px;border-bottom:1px solid #1a1a2a;}";
-    html += "</style></head><body>";
+        ClockTime local = _timeManager->getLocalTime(clk.utcOffset, clk.dstActive);
+
+        snprintf(localStr, sizeof(localStr), "%02d:%02d:%02d", local.hour, local.minute, local.second);
+        snprintf(localDate, sizeof(localDate), "%04d/%02d/%02d", local.year, local.month, local.day);
+        snprintf(utcStr, sizeof(utcStr), "%02d:%02d:%02d", utc.hour, utc.minute, utc.second);
+        snprintf(utcDate, sizeof(utcDate), "%04d/%02d/%02d", utc.year, utc.month, utc.day);
+
+        int8_t totalOff = clk.utcOffset + (clk.dstActive ? 1 : 0);
+        snprintf(tzLabel, sizeof(tzLabel), "Local (UTC%+d%s)", totalOff,
+                 clk.dstActive ? " DST" : "");
+    }
+
+    PageWriter html(_httpServer);
+    html.begin(200, "text/html; charset=utf-8");
+    html.add("<!DOCTYPE html><html><head>");
+    html.add("<meta name='viewport' content='width=device-width,initial-scale=1'>");
+    html.add("<meta http-equiv='refresh' content='300'>");
+    html.add("<title>WWVB Clock Status</title>");
+    html.add("<style>");
+    html.add("body{font-family:sans-serif;max-width:420px;margin:20px auto;padding:15px;background:#1a1a2e;color:#e0e0e0;}");
+    html.add("h1{color:#00d4ff;font-size:22px;text-align:center;margin-bottom:4px;}");
+    html.add("h2{color:#aaa;font-size:14px;text-align:center;font-weight:normal;margin-top:0;}");
+    html.add(".clock{text-align:center;margin:12px 0;padding:12px;background:#0d0d1a;border-radius:8px;border:1px solid #333;}");
+    html.add(".clock-time{font-size:36px;font-family:monospace;color:#00ff88;letter-spacing:2px;}");
+    html.add(".clock-date{font-size:14px;color:#888;margin-top:4px;}");
+    html.add(".clock-label{font-size:11px;color:#666;margin-top:2px;}");
+    html.add(".info{margin:16px 0;background:#0d0d1a;border-radius:8px;border:1px solid #333;overflow:hidden;}");
+    html.add(".row{display:flex;justify-content:space-between;padding:10px 14px;border-bottom:1px solid #222;}");
+    html.add(".row:last-child{border-bottom:none;}");
+    html.add(".row:nth-child(even){background:#12122a;}");
+    html.add(".row span:first-child{color:#888;}");
+    html.add(".row span:last-child{color:#e0e0e0;font-family:monospace;}");
+    html.add(".ntp-info{text-align:center;margin:12px 0;padding:8px;background:#1a2a1a;border-radius:6px;border:1px solid #2a4a2a;font-size:12px;color:#88cc88;}");
+    html.add(".chart{margin:16px 0;background:#0d0d1a;border-radius:8px;border:1px solid #333;padding:12px;}");
+    html.add(".chart-title{font-size:13px;color:#888;text-align:center;margin-bottom:8px;}");
+    html.add(".chart-bars{display:flex;align-items:flex-end;height:50px;gap:1px;}");
+    html.add(".chart-bars div{flex:1;background:#00ff88;min-width:2px;border-radius:1px 1px 0 0;transition:height .3s;}");
+    html.add(".chart-stats{display:flex;justify-content:space-between;margin-top:8px;font-size:11px;color:#666;}");
+    html.add(".sync{text-align:center;margin:12px 0;}");
+    html.add(".sync-btns{display:flex;gap:8px;justify-content:center;margin-bottom:6px;}");
+    html.add("#syncbtn{flex:1;max-width:170px;padding:10px 8px;background:#00d4ff;color:#000;border:none;border-radius:6px;font-size:14px;font-weight:bold;cursor:pointer;}");
+    html.add("#syncbtn:disabled{background:#444;color:#888;cursor:default;}");
+    html.add("#trkbtn{flex:1;max-width:170px;padding:10px 8px;background:#ff9900;color:#000;border:none;border-radius:6px;font-size:14px;font-weight:bold;cursor:pointer;}");
+    html.add("#trkbtn:disabled{background:#444;color:#888;cursor:default;}");
+    html.add(".trkwarn{font-size:11px;color:#777;margin-top:3px;}");
+    html.add("#syncmsg{font-size:12px;color:#888;margin-top:6px;min-height:16px;}");
+    html.add(".adj{padding:1px 7px;margin:0 2px;background:#2a2a4a;color:#e0e0e0;border:1px solid #444;border-radius:4px;font-size:13px;cursor:pointer;}");
+    html.add(".adj:active{background:#3a3a5a;}");
+    html.add(".log{margin:16px 0;background:#0d0d1a;border-radius:8px;border:1px solid #333;padding:10px 12px;}");
+    html.add(".log-title{font-size:13px;color:#888;text-align:center;margin-bottom:6px;}");
+    html.add("#logtbl{width:100%;border-collapse:collapse;font-size:11px;font-family:monospace;}");
+    html.add("#logtbl th{color:#666;padding:3px 4px;border-bottom:1px solid #333;text-align:left;font-weight:normal;}");
+    html.add("#logtbl td{padding:2px 4px;border-bottom:1px solid #1a1a2a;}");
+    html.add("</style></head><body>");
 
     // Header
-    html += "<h1>WWVB Atomic Clock</h1>";
-    html += "<h2>Status Dashboard</h2>";
+    html.add("<h1>WWVB Atomic Clock</h1>");
+    html.add("<h2>Status Dashboard</h2>");
 
     // Local time clock
-    html += "<div class='clock'>";
-    html += "<div class='clock-time' id='local'>" + localStr + "</div>";
-    html += "<div class='clock-date' id='ldate'>" + localDate + "</div>";
-    html += "<div class='clock-label' id='tzlabel'>" + tzLabel + "</div>";
-    html += "</div>";
+    html.add("<div class='clock'>");
+    html.addf("<div class='clock-time' id='local'>%s</div>", localStr);
+    html.addf("<div class='clock-date' id='ldate'>%s</div>", localDate);
+    html.addf("<div class='clock-label' id='tzlabel'>%s</div>", tzLabel);
+    html.add("</div>");
 
     // UTC clock
-    html += "<div class='clock'>";
-    html += "<div class='clock-time' id='utc'>" + utcStr + "</div>";
-    html += "<div class='clock-date' id='udate'>" + utcDate + "</div>";
-    html += "<div class='clock-label'>UTC</div>";
-    html += "</div>";
+    html.add("<div class='clock'>");
+    html.addf("<div class='clock-time' id='utc'>%s</div>", utcStr);
+    html.addf("<div class='clock-date' id='udate'>%s</div>", utcDate);
+    html.add("<div class='clock-label'>UTC</div>");
+    html.add("</div>");
 
     // Info rows
-    html += "<div class='info'>";
-    html += "<div class='row'><span>Temperature</span><span id='temp'>--</span></div>";
-    html += "<div class='row'><span>Battery</span><span id='batt'>--</span></div>";
-    html += "<div class='row'><span>NTP Requests</span><span id='ntp'>--</span></div>";
-    html += "<div class='row'><span>Time Source</span><span id='src'>--</span></div>";
-    html += "<div class='row'><span>Last Sync</span><span id='sync'>--</span></div>";
-    html += "<div class='row'><span>ES100</span><span id='es100status'>--</span></div>";
-    html += "<div class='row'><span>UTC Offset</span><span>"
-            "<button class='adj' onclick='changeTz(-1)'>&#8722;</button>"
-            "<span id='tzoff' style='margin:0 4px'>--</span>"
-            "<button class='adj' onclick='changeTz(1)'>+</button>&nbsp;"
-            "<button class='adj' id='dstbtn' onclick='toggleDst()'>DST --</button>"
-            "</span></div>";
-    html += "<div class='row'><span>Leap Second</span><span id='lsw'>--</span></div>";
-    html += "<div class='row'><span>Antenna Successes</span><span id='ant'>--</span></div>";
-    html += "<div class='row'><span>Signal Quality</span><span id='sigq'>--</span></div>";
-    html += "</div>";
+    html.add("<div class='info'>");
+    html.add("<div class='row'><span>Temperature</span><span id='temp'>--</span></div>");
+    html.add("<div class='row'><span>Battery</span><span id='batt'>--</span></div>");
+    html.add("<div class='row'><span>NTP Requests</span><span id='ntp'>--</span></div>");
+    html.add("<div class='row'><span>Time Source</span><span id='src'>--</span></div>");
+    html.add("<div class='row'><span>Last Sync</span><span id='sync'>--</span></div>");
+    html.add("<div class='row'><span>ES100</span><span id='es100status'>--</span></div>");
+    html.add("<div class='row'><span>UTC Offset</span><span>"
+             "<button class='adj' onclick='changeTz(-1)'>&#8722;</button>"
+             "<span id='tzoff' style='margin:0 4px'>--</span>"
+             "<button class='adj' onclick='changeTz(1)'>+</button>&nbsp;"
+             "<button class='adj' id='dstbtn' onclick='toggleDst()'>DST --</button>"
+             "</span></div>");
+    html.add("<div class='row'><span>Leap Second</span><span id='lsw'>--</span></div>");
+    html.add("<div class='row'><span>Antenna Successes</span><span id='ant'>--</span></div>");
+    html.add("<div class='row'><span>Signal Quality</span><span id='sigq'>--</span></div>");
+    html.add("</div>");
 
     // Manual sync buttons
-    html += "<div class='sync'>";
-    html += "<div class='sync-btns'>";
-    html += "<button id='syncbtn' onclick='doSync()' disabled>Normal Sync</button>";
-    html += "<button id='trkbtn' onclick='doTrackingSync()' disabled>Tracking Sync</button>";
-    html += "</div>";
-    html += "<div class='trkwarn'>&#9888; Tracking must start at second :55 &mdash; waits up to 60s</div>";
-    html += "<div id='syncmsg'></div>";
-    html += "</div>";
+    html.add("<div class='sync'>");
+    html.add("<div class='sync-btns'>");
+    html.add("<button id='syncbtn' onclick='doSync()' disabled>Normal Sync</button>");
+    html.add("<button id='trkbtn' onclick='doTrackingSync()' disabled>Tracking Sync</button>");
+    html.add("</div>");
+    html.add("<div class='trkwarn'>&#9888; Tracking must start at second :55 &mdash; waits up to 60s</div>");
+    html.add("<div id='syncmsg'></div>");
+    html.add("</div>");
 
     // WWVB reception history chart
-    html += "<div class='chart'>";
-    html += "<div class='chart-title'>WWVB Reception History (48h)</div>";
-    html += "<div class='chart-bars' id='bars'>";
+    html.add("<div class='chart'>");
+    html.add("<div class='chart-title'>WWVB Reception History (48h)</div>");
+    html.add("<div class='chart-bars' id='bars'>");
     for (int i = 0; i < HISTORY_BUCKETS; i++) {
-        html += "<div style='height:0'></div>";
+        html.add("<div style='height:0'></div>");
     }
-    html += "</div>";
-    html += "<div class='chart-stats'>";
-    html += "<span id='wrate'>--% success</span>";
-    html += "<span id='wcount'>-- syncs / -- attempts</span>";
-    html += "</div>";
-    html += "</div>";
+    html.add("</div>");
+    html.add("<div class='chart-stats'>");
+    html.add("<span id='wrate'>--% success</span>");
+    html.add("<span id='wcount'>-- syncs / -- attempts</span>");
+    html.add("</div>");
+    html.add("</div>");
 
     // Reception log table
-    html += "<div class='log'>";
-    html += "<div class='log-title'>Sync Log (last 20)</div>";
-    html += "<table id='logtbl'><tr><th>Time (UTC)</th><th>Mode</th><th>Ant</th><th>Result</th></tr></table>";
-    html += "</div>";
+    html.add("<div class='log'>");
+    html.add("<div class='log-title'>Sync Log (last 20)</div>");
+    html.add("<table id='logtbl'><tr><th>Time (UTC)</th><th>Mode</th><th>Ant</th><th>Result</th></tr></table>");
+    html.add("</div>");
 
     // NTP server info
-    html += "<div class='ntp-info'>";
-    html += "NTP Server: " + WiFi.localIP().toString() + ":123";
-    html += " | Stratum 1 | Ref: WWVB";
-    html += "</div>";
+    html.add("<div class='ntp-info'>");
+    IPAddress ip = WiFi.localIP();
+    html.addf("NTP Server: %u.%u.%u.%u:123", ip[0], ip[1], ip[2], ip[3]);
+    html.add(" | Stratum 1 | Ref: WWVB");
+    html.add("</div>");
 
     // JavaScript: smooth local clock + periodic server data fetch
     // Clock display is driven by Date.now() locally (250 ms interval) so seconds
     // increment smoothly regardless of network jitter.  Non-clock data (battery,
     // temperature, sync status, chart) is refreshed from the server every 30 s.
-    html += "<script>";
-    html += "function pad(n){return n<10?'0'+n:n;}";
-    html += "function fmtd(d){return d.Y+'/'+pad(d.M)+'/'+pad(d.D);}";
-    html += "function ago(s){";
-    html += "if(s>=86400){var d=Math.floor(s/86400);return d+'d '+Math.floor((s%86400)/3600)+'h ago';}";
-    html += "if(s>=3600){return Math.floor(s/3600)+'h '+Math.floor((s%3600)/60)+'m ago';}";
-    html += "if(s>=60){return Math.floor(s/60)+'m '+s%60+'s ago';}";
-    html += "return s+'s ago';}";
+    html.add("<script>");
+    html.add("function pad(n){return n<10?'0'+n:n;}");
+    html.add("function fmtd(d){return d.Y+'/'+pad(d.M)+'/'+pad(d.D);}");
+    html.add("function ago(s){");
+    html.add("if(s>=86400){var d=Math.floor(s/86400);return d+'d '+Math.floor((s%86400)/3600)+'h ago';}");
+    html.add("if(s>=3600){return Math.floor(s/3600)+'h '+Math.floor((s%3600)/60)+'m ago';}");
+    html.add("if(s>=60){return Math.floor(s/60)+'m '+s%60+'s ago';}");
+    html.add("return s+'s ago';}");
     // Reference point updated on each server fetch
-    html += "var _ref=null;";
+    html.add("var _ref=null;");
     // Timezone state (updated from server; used by changeTz/toggleDst)
-    html += "var _tz=0,_dst=false;";
+    html.add("var _tz=0,_dst=false;");
     // Leap second label array
-    html += "var _lswLabels=['None','\u26a0\ufe0f Positive (+1s, end of month)','\u26a0\ufe0f Negative (-1s, end of month)'];";
+    html.add("var _lswLabels=['None','\u26a0\ufe0f Positive (+1s, end of month)','\u26a0\ufe0f Negative (-1s, end of month)'];");
     // Advance a {h,m,s} time by s seconds, handling midnight rollover
-    html += "function addSecs(t,s){";
-    html += "var tot=((t.h*3600+t.m*60+t.s+s)%86400+86400)%86400;";
-    html += "return{h:Math.floor(tot/3600),m:Math.floor((tot%3600)/60),s:tot%60};}";
+    html.add("function addSecs(t,s){");
+    html.add("var tot=((t.h*3600+t.m*60+t.s+s)%86400+86400)%86400;");
+    html.add("return{h:Math.floor(tot/3600),m:Math.floor((tot%3600)/60),s:tot%60};}");
     // Runs every 250 ms — updates only the clock digits from local time
-    html += "function clockTick(){";
-    html += "if(!_ref)return;";
-    html += "var s=Math.floor((Date.now()-_ref.at)/1000);";
-    html += "var u=addSecs(_ref.utc,s),l=addSecs(_ref.local,s);";
-    html += "document.getElementById('utc').textContent=pad(u.h)+':'+pad(u.m)+':'+pad(u.s);";
-    html += "document.getElementById('local').textContent=pad(l.h)+':'+pad(l.m)+':'+pad(l.s);}";
+    html.add("function clockTick(){");
+    html.add("if(!_ref)return;");
+    html.add("var s=Math.floor((Date.now()-_ref.at)/1000);");
+    html.add("var u=addSecs(_ref.utc,s),l=addSecs(_ref.local,s);");
+    html.add("document.getElementById('utc').textContent=pad(u.h)+':'+pad(u.m)+':'+pad(u.s);");
+    html.add("document.getElementById('local').textContent=pad(l.h)+':'+pad(l.m)+':'+pad(l.s);}");
     // Runs every 30 s — fetches all data and anchors the local clock reference
-    html += "function tick(){fetch('/api/status').then(r=>r.json()).then(d=>{";
-    html += "_ref={utc:d.utc,local:d.local,at:Date.now()};";
-    html += "document.getElementById('ldate').textContent=fmtd(d.local);";
-    html += "document.getElementById('udate').textContent=fmtd(d.utc);";
-    html += "document.getElementById('tzlabel').textContent='Local ('+d.tz.label+')';";
-    html += "document.getElementById('temp').textContent=d.temp.f.toFixed(1)+'\\u00B0F / '+d.temp.c.toFixed(1)+'\\u00B0C';";
-    html += "var b=d.batt;";
-    html += "document.getElementById('batt').textContent=b.pct+'% '+(b.mv/1000).toFixed(2)+'V'+(b.chg?' \\u26A1':'');";
-    html += "document.getElementById('ntp').textContent=d.ntp.req;";
-    html += "document.getElementById('src').textContent=d.sync.src;";
-    html += "document.getElementById('sync').textContent=d.sync.ago>0?ago(d.sync.ago)+(d.sync.time?' ('+d.sync.time+' UTC)':''):'Never';";
+    html.add("function tick(){fetch('/api/status').then(r=>r.json()).then(d=>{");
+    html.add("_ref={utc:d.utc,local:d.local,at:Date.now()};");
+    html.add("document.getElementById('ldate').textContent=fmtd(d.local);");
+    html.add("document.getElementById('udate').textContent=fmtd(d.utc);");
+    html.add("document.getElementById('tzlabel').textContent='Local ('+d.tz.label+')';");
+    html.add("document.getElementById('temp').textContent=d.temp.f.toFixed(1)+'\\u00B0F / '+d.temp.c.toFixed(1)+'\\u00B0C';");
+    html.add("var b=d.batt;");
+    html.add("document.getElementById('batt').textContent=b.pct+'% '+(b.mv/1000).toFixed(2)+'V'+(b.chg?' \\u26A1':'');");
+    html.add("document.getElementById('ntp').textContent=d.ntp.req;");
+    html.add("document.getElementById('src').textContent=d.sync.src;");
+    html.add("document.getElementById('sync').textContent=d.sync.ago>0?ago(d.sync.ago)+(d.sync.time?' ('+d.sync.time+' UTC)':''):'Never';");
     // Update reception history chart
-    html += "if(d.wwvb){";
-    html += "var bars=document.getElementById('bars').children;";
-    html += "var h=d.wwvb.h,mx=Math.max.apply(null,h)||1;";
-    html += "for(var i=0;i<h.length&&i<bars.length;i++){";
-    html += "bars[i].style.height=h[i]?Math.max(2,(h[i]/mx)*100)+'%':'0';}";
-    html += "document.getElementById('wrate').textContent=d.wwvb.rate+'% success';";
-    html += "document.getElementById('wcount').textContent=d.wwvb.ok+' syncs / '+d.wwvb.tries+' attempts';}";
+    html.add("if(d.wwvb){");
+    html.add("var bars=document.getElementById('bars').children;");
+    html.add("var h=d.wwvb.h,mx=Math.max.apply(null,h)||1;");
+    html.add("for(var i=0;i<h.length&&i<bars.length;i++){");
+    html.add("bars[i].style.height=h[i]?Math.max(2,(h[i]/mx)*100)+'%':'0';}");
+    html.add("document.getElementById('wrate').textContent=d.wwvb.rate+'% success';");
+    html.add("document.getElementById('wcount').textContent=d.wwvb.ok+' syncs / '+d.wwvb.tries+' attempts';}");
     // Update ES100 status row and sync buttons
-    html += "var es100El=document.getElementById('es100status');";
-    html += "var btn=document.getElementById('syncbtn');";
-    html += "var trkBtn=document.getElementById('trkbtn');";
-    html += "var busy=!d.es100avail||d.es100recv||d.es100pend;";
-    html += "if(es100El){";
-    html += "if(!d.es100avail){es100El.textContent='Not Available';}";
-    html += "else if(d.es100recv&&d.es100trk){es100El.textContent='Tracking\u2026';}";
-    html += "else if(d.es100recv){es100El.textContent='Receiving\u2026';}";
-    html += "else if(d.es100pend){es100El.textContent='Waiting for :55\u2026';}";
-    html += "else{es100El.textContent='Idle';}}";
-    html += "if(btn&&!btn._userDisabled){btn.disabled=busy;}";
-    html += "if(trkBtn&&!trkBtn._userDisabled){trkBtn.disabled=busy;}";
+    html.add("var es100El=document.getElementById('es100status');");
+    html.add("var btn=document.getElementById('syncbtn');");
+    html.add("var trkBtn=document.getElementById('trkbtn');");
+    html.add("var busy=!d.es100avail||d.es100recv||d.es100pend;");
+    html.add("if(es100El){");
+    html.add("if(!d.es100avail){es100El.textContent='Not Available';}");
+    html.add("else if(d.es100recv&&d.es100trk){es100El.textContent='Tracking\u2026';}");
+    html.add("else if(d.es100recv){es100El.textContent='Receiving\u2026';}");
+    html.add("else if(d.es100pend){es100El.textContent='Waiting for :55\u2026';}");
+    html.add("else{es100El.textContent='Idle';}}");
+    html.add("if(btn&&!btn._userDisabled){btn.disabled=busy;}");
+    html.add("if(trkBtn&&!trkBtn._userDisabled){trkBtn.disabled=busy;}");
     // Timezone controls
-    html += "_tz=d.tz.off;_dst=d.tz.dst;";
-    html += "var v=d.tz.off;document.getElementById('tzoff').textContent=(v>=0?'+':'')+v+'h';";
-    html += "document.getElementById('dstbtn').textContent='DST '+(_dst?'ON':'OFF');";
+    html.add("_tz=d.tz.off;_dst=d.tz.dst;");
+    html.add("var v=d.tz.off;document.getElementById('tzoff').textContent=(v>=0?'+':'')+v+'h';");
+    html.add("document.getElementById('dstbtn').textContent='DST '+(_dst?'ON':'OFF');");
     // Leap second
-    html += "document.getElementById('lsw').textContent=_lswLabels[d.lsw||0]||'None';";
+    html.add("document.getElementById('lsw').textContent=_lswLabels[d.lsw||0]||'None';");
     // Antenna successes
-    html += "document.getElementById('ant').textContent='Ant1: '+d.ant1+' / Ant2: '+d.ant2;";
+    html.add("document.getElementById('ant').textContent='Ant1: '+d.ant1+' / Ant2: '+d.ant2;");
     // Signal quality
-    html += "if(d.sigq){";
-    html += "var sqEl=document.getElementById('sigq');";
-    html += "sqEl.textContent=d.sigq+' | '+d.sigm+' | Ant: '+d.siga;";
-    html += "var sqColor={'STRONG':'#00ff88','GOOD':'#88cc88','FAIR':'#ffcc00','POOR':'#cc4444'};";
-    html += "sqEl.style.color=sqColor[d.sigq]||'#e0e0e0';}";
-    html += "}).catch(()=>{});}";
+    html.add("if(d.sigq){");
+    html.add("var sqEl=document.getElementById('sigq');");
+    html.add("sqEl.textContent=d.sigq+' | '+d.sigm+' | Ant: '+d.siga;");
+    html.add("var sqColor={'STRONG':'#00ff88','GOOD':'#88cc88','FAIR':'#ffcc00','POOR':'#cc4444'};");
+    html.add("sqEl.style.color=sqColor[d.sigq]||'#e0e0e0';}");
+    html.add("}).catch(()=>{});}");
     // Fetch sync log and rebuild table
-    html += "function fetchLog(){fetch('/api/log').then(r=>r.json()).then(rows=>{";
-    html += "var t=document.getElementById('logtbl');";
-    html += "while(t.rows.length>1)t.deleteRow(1);";
-    html += "if(!rows.length){var r=t.insertRow();r.insertCell().colSpan=4;r.cells[0].textContent='No syncs yet';r.cells[0].style.color='#666';return;}";
-    html += "rows.forEach(function(e){var r=t.insertRow();";
-    html += "r.insertCell().textContent=e.t;";
-    html += "r.insertCell().textContent=e.trk?'Tracking':'Normal';";
-    html += "r.insertCell().textContent=e.ant?'Ant'+e.ant:'?';";
-    html += "var rc=r.insertCell();rc.textContent=e.ok?'\u2713':'\u2717';rc.style.color=e.ok?'#88cc88':'#cc4444';";
-    html += "});}).catch(()=>{});}";
-    html += "function doSync(){";
-    html += "var btn=document.getElementById('syncbtn');";
-    html += "var msg=document.getElementById('syncmsg');";
-    html += "btn.disabled=true;btn._userDisabled=true;";
-    html += "msg.textContent='Requesting normal sync\u2026';";
-    html += "fetch('/api/sync',{method:'POST'}).then(r=>r.json())";
-    html += ".then(d=>{msg.textContent=d.status?'Normal sync started \u2014 listening for WWVB signal...':('Error: '+d.error);})";
-    html += ".catch(()=>{msg.textContent='Request failed';})";
-    html += ".finally(()=>{setTimeout(()=>{btn._userDisabled=false;},5000);});}";
-    html += "function doTrackingSync(){";
-    html += "var btn=document.getElementById('trkbtn');";
-    html += "var msg=document.getElementById('syncmsg');";
-    html += "btn.disabled=true;btn._userDisabled=true;";
-    html += "msg.textContent='Scheduling tracking sync\u2026 waiting for second :55';";
-    html += "fetch('/api/sync/tracking',{method:'POST'}).then(r=>r.json())";
-    html += ".then(d=>{";
-    html += "if(d.status){msg.textContent='Tracking sync scheduled \u2014 will start at second :55 (up to 60s wait)...';}";
-    html += "else{msg.textContent='Error: '+(d.error||'unknown');}";
-    html += "})";
-    html += ".catch(()=>{msg.textContent='Request failed';})";
-    html += ".finally(()=>{setTimeout(()=>{btn._userDisabled=false;},65000);});}";
-    html += "function changeTz(d){";
-    html += "var o=_tz+d;if(o<-12||o>14)return;_tz=o;";
-    html += "fetch('/api/settings',{method:'POST',headers:{'Content-Type':'application/x-www-form-urlencoded'},body:'off='+o+'&dst='+(_dst?1:0)})";
-    html += ".then(r=>r.json()).then(function(){";
-    html += "var v=_tz;document.getElementById('tzoff').textContent=(v>=0?'+':'')+v+'h';";
-    html += "}).catch(()=>{});}";
-    html += "function toggleDst(){_dst=!_dst;";
-    html += "fetch('/api/settings',{method:'POST',headers:{'Content-Type':'application/x-www-form-urlencoded'},body:'off='+_tz+'&dst='+(_dst?1:0)})";
-    html += ".then(r=>r.json()).then(function(){";
-    html += "document.getElementById('dstbtn').textContent='DST '+(_dst?'ON':'OFF');";
-    html += "}).catch(()=>{});}";
-    html += "setInterval(clockTick,250);setInterval(function(){tick();fetchLog();},30000);tick();fetchLog();";
-    html += "</script>";
-
-    html += "</body></html>";
-
-    return html;
+    html.add("function fetchLog(){fetch('/api/log').then(r=>r.json()).then(rows=>{");
+    html.add("var t=document.getElementById('logtbl');");
+    html.add("while(t.rows.length>1)t.deleteRow(1);");
+    html.add("if(!rows.length){var r=t.insertRow();r.insertCell().colSpan=4;r.cells[0].textContent='No syncs yet';r.cells[0].style.color='#666';return;}");
+    html.add("rows.forEach(function(e){var r=t.insertRow();");
+    html.add("r.insertCell().textContent=e.t;");
+    html.add("r.insertCell().textContent=e.trk?'Tracking':'Normal';");
+    html.add("r.insertCell().textContent=e.ant?'Ant'+e.ant:'?';");
+    html.add("var rc=r.insertCell();rc.textContent=e.ok?'\u2713':'\u2717';rc.style.color=e.ok?'#88cc88':'#cc4444';");
+    html.add("});}).catch(()=>{});}");
+    html.add("function doSync(){");
+    html.add("var btn=document.getElementById('syncbtn');");
+    html.add("var msg=document.getElementById('syncmsg');");
+    html.add("btn.disabled=true;btn._userDisabled=true;");
+    html.add("msg.textContent='Requesting normal sync\u2026';");
+    html.add("fetch('/api/sync',{method:'POST'}).then(r=>r.json())");
+    html.add(".then(d=>{msg.textContent=d.status?'Normal sync started \u2014 listening for WWVB signal...':('Error: '+d.error);})");
+    html.add(".catch(()=>{msg.textContent='Request failed';})");
+    html.add(".finally(()=>{setTimeout(()=>{btn._userDisabled=false;},5000);});}");
+    html.add("function doTrackingSync(){");
+    html.add("var btn=document.getElementById('trkbtn');");
+    html.add("var msg=document.getElementById('syncmsg');");
+    html.add("btn.disabled=true;btn._userDisabled=true;");
+    html.add("msg.textContent='Scheduling tracking sync\u2026 waiting for second :55';");
+    html.add("fetch('/api/sync/tracking',{method:'POST'}).then(r=>r.json())");
+    html.add(".then(d=>{");
+    html.add("if(d.status){msg.textContent='Tracking sync scheduled \u2014 will start at second :55 (up to 60s wait)...';}");
+    html.add("else{msg.textContent='Error: '+(d.error||'unknown');}");
+    html.add("})");
+    html.add(".catch(()=>{msg.textContent='Request failed';})");
+    html.add(".finally(()=>{setTimeout(()=>{btn._userDisabled=false;},65000);});}");
+    html.add("function changeTz(d){");
+    html.add("var o=_tz+d;if(o<-12||o>14)return;_tz=o;");
+    html.add("fetch('/api/settings',{method:'POST',headers:{'Content-Type':'application/x-www-form-urlencoded'},body:'off='+o+'&dst='+(_dst?1:0)})");
+    html.add(".then(r=>r.json()).then(function(){");
+    html.add("var v=_tz;document.getElementById('tzoff').textContent=(v>=0?'+':'')+v+'h';");
+    html.add("}).catch(()=>{});}");
+    html.add("function toggleDst(){_dst=!_dst;");
+    html.add("fetch('/api/settings',{method:'POST',headers:{'Content-Type':'application/x-www-form-urlencoded'},body:'off='+_tz+'&dst='+(_dst?1:0)})");
+    html.add(".then(r=>r.json()).then(function(){");
+    html.add("document.getElementById('dstbtn').textContent='DST '+(_dst?'ON':'OFF');");
+    html.add("}).catch(()=>{});}");
+    html.add("setInterval(clockTick,250);setInterval(function(){tick();fetchLog();},30000);tick();fetchLog();");
+    html.add("</script>");
+
+    html.add("</body></html>");
+    html.end();
 }
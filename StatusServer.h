@@ -3,7 +3,8 @@
  * @brief     Status web server for monitoring WWVB clock via browser
  * @details   Runs on port 80 in STA mode (when connected to WiFi).
  *            Serves a live dashboard showing time, temperature, battery,
- *            NTP stats, and sync information.
+ *            NTP stats, and sync information. Clock, receiver and power
+ *            state are read as State snapshots per request.
  */
 
 #ifndef STATUSSERVER_H
@@ -16,31 +17,19 @@
 #include "config.h"
 #include "TimeManager.h"
 #include "NTPServer.h"
+#include "PTPServer.h"
+#include "UsbRefclock.h"
+#include "EdgeCapture.h"
 #include "ReceptionHistory.h"
-
-/**
- * @brief Data snapshot for the status web page.
- *        Populated by the main sketch each loop iteration.
- */
-struct StatusData {
-    int8_t   utcOffset;          // Current UTC offset (hours)
-    bool     dstActive;          // DST currently applied
-    float    temperatureC;       // DS3231 temperature (Celsius)
-    uint16_t batteryMv;          // Battery voltage in millivolts
-    uint8_t  batteryPct;         // Battery percentage (LiPo curve, 0-100)
-    bool     batteryCharging;    // True if USB charging
-    uint8_t  timeSource;         // 0=None, 1=RTC, 2=NTP, 3=WWVB
-    unsigned long lastSyncMillis; // millis() of last time sync (0 = never)
-    bool     es100Available;        // ES100 hardware initialized
-    bool     es100Receiving;        // ES100 currently receiving WWVB signal
-    bool     es100Tracking;         // Current receive attempt is tracking mode (vs normal)
-    bool     es100PendingTracking;  // Waiting to write Control 0 at second :55
-    bool     es100TrackingReady;    // At least one normal-mode sync done; tracking mode available
-    char     lastSyncTimeStr[20];   // "YYYY-MM-DD HH:MM:SS" UTC of last sync, "" if never
-    uint8_t  leapSecondWarning;     // 0=none, 1=positive(+1s), 2=negative(-1s)
-    uint16_t ant1Successes;         // Lifetime Antenna 1 sync successes
-    uint16_t ant2Successes;         // Lifetime Antenna 2 sync successes
-};
+#include "WWVBValidator.h"
+#include "LatencyCalibrator.h"
+#include "PropagationModel.h"
+#include "SyncCadence.h"
+#include "ClockQuality.h"
+#include "ReceptionPolicy.h"
+#include "ClockDiscipline.h"
+#include "LatencyHistogram.h"
+#include "StateStore.h"
 
 // Maximum number of sync log entries kept in memory
 #define SYNC_LOG_SIZE 20
@@ -86,14 +75,64 @@ public:
     void setNTPServer(NTPServer* ntp);
 
     /**
-     * @brief Set pointer to status data struct (updated by caller)
+     * @brief Set reception history for WWVB sync chart
      */
-    void setStatusData(StatusData* data);
+    void setReceptionHistory(ReceptionHistory* rh);
 
     /**
-     * @brief Set reception history for WWVB sync chart
+     * @brief Set WWVB frame validator for accept/hold/reject statistics
      */
-    void setReceptionHistory(ReceptionHistory* rh);
+    void setWWVBValidator(const WWVBValidator* v);
+
+    /**
+     * @brief Set ES100 IRQ latency calibrator for per-mode/antenna estimates
+     */
+    void setLatencyCalibrator(const LatencyCalibrator* c);
+
+    /**
+     * @brief Set WWVB propagation model for path geometry and applied delay
+     */
+    void setPropagationModel(const PropagationModel* p);
+
+    /**
+     * @brief Set sync cadence for the measured clock drift and the budgets it sets
+     */
+    void setSyncCadence(const SyncCadence* c);
+
+    /**
+     * @brief Set clock-quality state machine for state, error bound and NTP header fields
+     */
+    void setClockQuality(const ClockQuality* q);
+
+    /**
+     * @brief Set reception policy for per-hour antenna odds and early-abort counters
+     */
+    void setReceptionPolicy(const ReceptionPolicy* p);
+
+    /**
+     * @brief Set clock discipline estimator for continuous-tracking phase/frequency
+     */
+    void setClockDiscipline(const ClockDiscipline* d);
+
+    /**
+     * @brief Set histogram of ES100 IRQ edge → clock-set latency
+     */
+    void setIRQLatencyHistogram(const LatencyHistogram* h);
+
+    /**
+     * @brief Set edge capture for ISR latency and SQW jitter (software vs hardware stamps)
+     */
+    void setEdgeCapture(const EdgeCapture* edges);
+
+    /**
+     * @brief Set PTP grandmaster for message counters and advertised clock class
+     */
+    void setPTPServer(const PTPServer* ptp);
+
+    /**
+     * @brief Set USB reference-clock link for its request counters
+     */
+    void setUsbRefclock(const UsbRefclock* usb);
 
     /**
      * @brief Set callback invoked when the browser requests a normal-mode WWVB sync
@@ -129,8 +168,18 @@ private:
     bool _running;
     TimeManager* _timeManager;
     NTPServer* _ntpServer;
-    StatusData* _statusData;
     ReceptionHistory* _receptionHistory;
+    const WWVBValidator* _wwvbValidator = nullptr;
+    const LatencyCalibrator* _latencyCalibrator = nullptr;
+    const PropagationModel* _propagation = nullptr;
+    const SyncCadence* _syncCadence = nullptr;
+    const ClockQuality* _clockQuality = nullptr;
+    const ReceptionPolicy* _receptionPolicy = nullptr;
+    const ClockDiscipline* _clockDiscipline = nullptr;
+    const LatencyHistogram* _irqLatency = nullptr;
+    const EdgeCapture* _edgeCapture = nullptr;
+    const PTPServer* _ptpServer = nullptr;
+    const UsbRefclock* _usbRefclock = nullptr;
 
     std::function<void()> _onSyncRequest;
     std::function<void()> _onTrackingRequest;
@@ -142,13 +191,24 @@ private:
 
     void handleRoot();
     void handleApiStatus();
+    void sendStatusCbor(uint32_t startUs);
     void handleApiSync();
     void handleApiTrackingSync();
     void handleApiSettings();
     void handleApiLog();
+    void handleApiClients();
+    void handleApiPcap();
+    void handleApiEvents();
+    void handleApiStall();
+    void handleApiHeap();
+    void handleApiEnergy();
     void handleNotFound();
     bool checkEs100Ready(bool checkPending);
-    String buildPage();
+    bool wantsCbor();
+    void sendTimed(const char* type, const uint8_t* body, size_t len, uint32_t startUs);
+    void signalQuality(const ReceiverState& rx, const char*& sigq, const char*& sigm,
+                       char* siga, size_t sigaLen);
+    void sendPage();
     const char* timeSourceName(uint8_t src);
 };
 
@@ -0,0 +1,139 @@
+/**
+ * @file      SyncCadence.cpp
+ * @brief     Drift-aware sync cadence implementation
+ */
+
+#include "SyncCadence.h"
+#include "CborWriter.h"
+#include <math.h>
+
+SyncCadence::SyncCadence() {
+    reset();
+}
+
+void SyncCadence::reset() {
+    _errSumMs = 0.0f;
+    _spanSumS = 0.0f;
+    _samples  = 0;
+    _rejects  = 0;
+}
+
+// ============================================================================
+// Persistence
+// ============================================================================
+void SyncCadence::load(Preferences& prefs) {
+    _errSumMs = prefs.getFloat("cadErr", 0.0f);
+    _spanSumS = prefs.getFloat("cadSpan", 0.0f);
+    _samples  = prefs.getUShort("cadN", 0);
+    // Sums that imply an impossible drift are from a corrupt or foreign record
+    if (!(_spanSumS > 0.0f) || fabsf(_errSumMs * 1000.0f / _spanSumS) > CADENCE_MAX_PPM) {
+        _errSumMs = 0.0f;
+        _spanSumS = 0.0f;
+        _samples  = 0;
+    }
+}
+
+void SyncCadence::save(Preferences& prefs) const {
+    prefs.putFloat("cadErr", _errSumMs);
+    prefs.putFloat("cadSpan", _spanSumS);
+    prefs.putUShort("cadN", _samples);
+}
+
+// ============================================================================
+// Estimation
+// ============================================================================
+bool SyncCadence::addCorrection(int32_t errorMs, uint32_t elapsedS) {
+    if (elapsedS < CADENCE_MIN_SAMPLE_S) return false;
+    // ms per s is ppm ÷ 1000
+    if (fabsf((float)errorMs * 1000.0f / (float)elapsedS) > CADENCE_MAX_PPM) {
+        _rejects++;
+        return false;
+    }
+
+    // Plain sums until CADENCE_AVG_DEPTH samples, then decay by 1/depth
+    if (_samples >= CADENCE_AVG_DEPTH) {
+        const float keep = 1.0f - 1.0f / CADENCE_AVG_DEPTH;
+        _errSumMs *= keep;
+        _spanSumS *= keep;
+    }
+    _errSumMs += (float)errorMs;
+    _spanSumS += (float)elapsedS;
+    if (_samples < 0xFFFF) _samples++;
+    return true;
+}
+
+bool SyncCadence::isMeasured() const {
+    return _samples >= CADENCE_MIN_SAMPLES && _spanSumS >= (float)CADENCE_MIN_SPAN_S;
+}
+
+float SyncCadence::getDriftPpm() const {
+    if (!isMeasured()) return 0.0f;
+    return _errSumMs * 1000.0f / _spanSumS;
+}
+
+float SyncCadence::getBudgetPpm() const {
+    float ppm = fabsf(getDriftPpm()) * CADENCE_DRIFT_SAFETY;
+    return ppm > CADENCE_MIN_DRIFT_PPM ? ppm : CADENCE_MIN_DRIFT_PPM;
+}
+
+uint32_t SyncCadence::budgetSeconds(uint32_t budgetMs, uint32_t limitS) const {
+    // budget ms at D ppm (µs/s) is reached after budget × 1000 / D seconds
+    float s = (float)budgetMs * 1000.0f / getBudgetPpm();
+    return s < (float)limitS ? (uint32_t)s : limitS;
+}
+
+uint32_t SyncCadence::getTrackingAgeS() const {
+    return budgetSeconds(CADENCE_TRACKING_BUDGET_MS, ES100_TRACKING_MAX_AGE_S);
+}
+
+uint32_t SyncCadence::getAnchorMs() const {
+    return budgetSeconds(CADENCE_ANCHOR_BUDGET_MS, NIGHTLY_NORMAL_SYNC_HOURS * 3600UL) * 1000UL;
+}
+
+uint32_t SyncCadence::getTrackingFallbackMs() const {
+    return budgetSeconds(CADENCE_ANCHOR_BUDGET_MS, ES100_TRACKING_FALLBACK_MS / 1000UL) * 1000UL;
+}
+
+uint32_t SyncCadence::limitInterval(uint32_t intervalMs) const {
+    uint32_t ms = budgetSeconds(CADENCE_HOLDOVER_BUDGET_MS, intervalMs / 1000UL) * 1000UL;
+    if (ms < CADENCE_MIN_INTERVAL_MS) ms = CADENCE_MIN_INTERVAL_MS;
+    return ms < intervalMs ? ms : intervalMs;
+}
+
+uint16_t SyncCadence::getSampleCount() const {
+    return _samples;
+}
+
+uint32_t SyncCadence::getRejectCount() const {
+    return _rejects;
+}
+
+// ============================================================================
+// Reporting
+// ============================================================================
+int SyncCadence::toJson(char* buf, size_t len) const {
+    int pos = snprintf(buf, len,
+        "{\"ppm\":%.2f,\"n\":%u,\"span\":%.1f,\"rej\":%lu,\"budget\":%.2f,"
+        "\"trk\":%lu,\"anchor\":%lu,\"fallback\":%lu,\"night\":%lu,\"day\":%lu}",
+        getDriftPpm(), _samples, _spanSumS / 3600.0f, (unsigned long)_rejects,
+        getBudgetPpm(), (unsigned long)getTrackingAgeS(),
+        (unsigned long)(getAnchorMs() / 1000UL),
+        (unsigned long)(getTrackingFallbackMs() / 1000UL),
+        (unsigned long)(limitInterval(SYNC_INTERVAL_NIGHT_MS) / 1000UL),
+        (unsigned long)(limitInterval(SYNC_INTERVAL_DAY_MS) / 1000UL));
+    return pos < (int)len ? pos : (int)len - 1;
+}
+
+void SyncCadence::toCbor(CborWriter& w) const {
+    w.beginMap(10);
+    w.kvFloat("ppm", getDriftPpm());
+    w.kv("n", _samples);
+    w.kvFloat("span", _spanSumS / 3600.0f);
+    w.kv("rej", _rejects);
+    w.kvFloat("budget", getBudgetPpm());
+    w.kv("trk", getTrackingAgeS());
+    w.kv("anchor", getAnchorMs() / 1000UL);
+    w.kv("fallback", getTrackingFallbackMs() / 1000UL);
+    w.kv("night", limitInterval(SYNC_INTERVAL_NIGHT_MS) / 1000UL);
+    w.kv("day", limitInterval(SYNC_INTERVAL_DAY_MS) / 1000UL);
+}
@@ -0,0 +1,121 @@
+/**
+ * @file      SyncCadence.h
+ * @brief     Clock drift estimate from WWVB corrections, and the sync budgets it sets
+ * @details   Each WWVB fix that steps the clock shows how far it had drifted
+ *            since the previous fix. The errors and the time spans they cover
+ *            are summed (with exponential decay), and their ratio is the drift
+ *            rate. Summing before dividing weights long holdovers over short
+ *            ones, whose few ms of ES100 timing noise would dominate.
+ *
+ *            The measured drift, times a safety factor and never below the
+ *            DS3231's 2 ppm, sets how long the clock may run between receptions:
+ *
+ *            - Tracking age: predicted error must stay inside
+ *              CADENCE_TRACKING_BUDGET_MS for the :55 tracking start.
+ *            - Anchor: drift since the last full-frame decode must stay inside
+ *              CADENCE_ANCHOR_BUDGET_MS. This caps NIGHTLY_NORMAL_SYNC_HOURS
+ *              and ES100_TRACKING_FALLBACK_MS.
+ *            - Sync interval: drift between attempts must stay inside
+ *              CADENCE_HOLDOVER_BUDGET_MS.
+ *
+ *            The fixed limits in config.h are ceilings, so a genuine DS3231
+ *            keeps the original schedule.
+ */
+
+#ifndef SYNCCADENCE_H
+#define SYNCCADENCE_H
+
+#include <Arduino.h>
+#include <Preferences.h>
+#include "config.h"
+
+class CborWriter;
+
+class SyncCadence {
+public:
+    SyncCadence();
+
+    /**
+     * @brief Restore the drift sums from NVS (caller has the namespace open)
+     */
+    void load(Preferences& prefs);
+
+    /**
+     * @brief Persist the drift sums to NVS (caller has the namespace open read-write)
+     */
+    void save(Preferences& prefs) const;
+
+    /**
+     * @brief Feed the clock error found by a WWVB fix
+     * @param errorMs  Clock minus WWVB just before the fix was applied (ms)
+     * @param elapsedS Time since the previous WWVB fix (s)
+     * @return true if the sample was used; false if too short or implausible
+     */
+    bool addCorrection(int32_t errorMs, uint32_t elapsedS);
+
+    /**
+     * @brief Forget all corrections and budget for CADENCE_MIN_DRIFT_PPM
+     */
+    void reset();
+
+    /**
+     * @brief True once enough corrections over a long enough span are held
+     */
+    bool isMeasured() const;
+
+    /**
+     * @brief Measured drift (ppm, positive = clock runs fast); 0 until measured
+     */
+    float getDriftPpm() const;
+
+    /**
+     * @brief Drift the budgets are sized for (ppm)
+     */
+    float getBudgetPpm() const;
+
+    /**
+     * @brief Longest time since sync at which tracking mode may start (s)
+     */
+    uint32_t getTrackingAgeS() const;
+
+    /**
+     * @brief Longest time between full-frame decodes at night (ms)
+     */
+    uint32_t getAnchorMs() const;
+
+    /**
+     * @brief Longest run of tracking mode before a forced normal sync (ms)
+     */
+    uint32_t getTrackingFallbackMs() const;
+
+    /**
+     * @brief Shorten a configured sync interval to keep within the holdover budget
+     * @param intervalMs SYNC_INTERVAL_NIGHT_MS or SYNC_INTERVAL_DAY_MS
+     */
+    uint32_t limitInterval(uint32_t intervalMs) const;
+
+    uint16_t getSampleCount() const;
+    uint32_t getRejectCount() const;
+
+    /**
+     * @brief Drift estimate and budgets as a JSON object
+     * @return Characters written (snprintf semantics, clipped to len)
+     */
+    int toJson(char* buf, size_t len) const;
+
+    /**
+     * @brief Encode the same object as toJson() as a CBOR map
+     */
+    void toCbor(CborWriter& w) const;
+
+private:
+    float    _errSumMs;          // Decayed Σ clock error at each fix
+    float    _spanSumS;          // Decayed Σ time since the previous fix
+    uint16_t _samples;
+    uint32_t _rejects;
+
+    // Seconds for the budgeted drift to reach budgetMs, capped at limitS
+    uint32_t budgetSeconds(uint32_t budgetMs, uint32_t limitS) const;
+};
+
+#endif // SYNCCADENCE_H
@@ -4,9 +4,11 @@
  */
 
 #include "TimeManager.h"
+#include "EventLog.h"
 
-// Days in each month (non-leap year)
-static const uint8_t DAYS_IN_MONTH[] = {
+// Days in each month (non-leap year).  DRAM so getUnixTime() can run from
+// IRAM without touching flash-mapped rodata.
+static const uint8_t DAYS_IN_MONTH[] DRAM_ATTR = {
     31, 28, 31, 30, 31, 30, 31, 31, 30, 31, 30, 31
 };
 
@@ -18,7 +20,8 @@ TimeManager::TimeManager()
       _hour(0), _minute(0), _second(0),
       _lastTickMillis(0), _syncMillis(0), 
       _timeSet(false), _accumMillis(0),
-      _rtcPhaseLocked(false), _rtcAnchorUnixSecond(0), _rtcAnchorMicros(0) {
+      _rtcPhaseLocked(false), _rtcAnchorUnixSecond(0), _rtcAnchorMicros(0),
+      _mux(portMUX_INITIALIZER_UNLOCKED) {
 }
 
 // ============================================================================
@@ -26,6 +29,7 @@ TimeManager::TimeManager()
 // ============================================================================
 void TimeManager::setTime(uint16_t year, uint8_t month, uint8_t day,
                           uint8_t hour, uint8_t minute, uint8_t second) {
+    portENTER_CRITICAL(&_mux);
     _year = year;
     _month = month;
     _day = day;
@@ -38,8 +42,9 @@ void TimeManager::setTime(uint16_t year, uint8_t month, uint8_t day,
     _accumMillis = 0;
     _rtcPhaseLocked = false;
     _timeSet = true;
+    portEXIT_CRITICAL(&_mux);
     
-    Serial.printf("TimeManager: Time set to %04d-%02d-%02d %02d:%02d:%02d UTC\n",
+    Log.event(LOG_SEV_INFO, "TimeManager: Time set to %04d-%02d-%02d %02d:%02d:%02d UTC",
                   _year, _month, _day, _hour, _minute, _second);
 }
 
@@ -82,8 +87,10 @@ void TimeManager::setUnixTime(uint32_t unixTime) {
 
 void TimeManager::setSubSecondOffset(uint16_t ms) {
     if (ms >= 1000) ms = ms % 1000;
+    portENTER_CRITICAL(&_mux);
     _accumMillis = ms;
     _rtcPhaseLocked = false;
+    portEXIT_CRITICAL(&_mux);
     // _lastTickMillis intentionally not touched — tick() will advance from here.
 }
 
@@ -105,24 +112,29 @@ void TimeManager::setUnixTimePreserveMillis(uint32_t unixTime) {
         seconds -= sim;
         month++;
     }
-    _year   = year;
-    _month  = month;
-    _day    = 1 + (seconds / 86400);
+    uint8_t day = 1 + (seconds / 86400);
     seconds %= 86400;
-    _hour   = seconds / 3600;
+    uint8_t hour = seconds / 3600;
     seconds %= 3600;
+    portENTER_CRITICAL(&_mux);
+    _year   = year;
+    _month  = month;
+    _day    = day;
+    _hour   = hour;
     _minute = seconds / 60;
     _second = seconds % 60;
     if (_rtcPhaseLocked) {
         uint32_t elapsedUs = micros() - _rtcAnchorMicros;
         _rtcAnchorUnixSecond = unixTime - (elapsedUs / 1000000UL);
     }
+    portEXIT_CRITICAL(&_mux);
     // _accumMillis and _lastTickMillis intentionally NOT touched —
     // sub-second phase is preserved from the last full sync.
 }
 
 void TimeManager::setRTCPhaseAnchor(uint32_t unixSecond, uint32_t edgeMicros) {
     ClockTime dt = unixToClockTime(unixSecond);
+    portENTER_CRITICAL(&_mux);
     _year   = dt.year;
     _month  = dt.month;
     _day    = dt.day;
@@ -134,18 +146,36 @@ void TimeManager::setRTCPhaseAnchor(uint32_t unixSecond, uint32_t edgeMicros) {
     _rtcAnchorMicros = edgeMicros;
     _rtcPhaseLocked = true;
     _timeSet = true;
+    portEXIT_CRITICAL(&_mux);
 }
 
 void TimeManager::clearRTCPhaseAnchor() {
+    portENTER_CRITICAL(&_mux);
     _rtcPhaseLocked = false;
     _lastTickMillis = millis();
     _accumMillis = 0;
+    portEXIT_CRITICAL(&_mux);
 }
 
 bool TimeManager::hasRTCPhaseAnchor() const {
     return _rtcPhaseLocked;
 }
 
+bool TimeManager::getRTCPhaseAt(uint32_t atMicros, int32_t& outOffsetUs,
+                                uint32_t* outSecond) const {
+    if (!_rtcPhaseLocked) return false;
+    // Signed difference so a timestamp just before the anchor edge is handled too
+    int32_t elapsed = (int32_t)(atMicros - _rtcAnchorMicros);
+    int32_t phase   = elapsed % 1000000L;
+    if (phase < 0) phase += 1000000L;
+    if (phase >= 500000L) phase -= 1000000L;
+    outOffsetUs = phase;
+    if (outSecond) {
+        *outSecond = _rtcAnchorUnixSecond + (uint32_t)((elapsed - phase) / 1000000L);
+    }
+    return true;
+}
+
 // ============================================================================
 // Time Retrieval
 // ============================================================================
@@ -245,7 +275,7 @@ ClockTime TimeManager::getLocalTime(int8_t utcOffset, bool dst) {
     return dt;
 }
 
-uint32_t TimeManager::getUnixTime() {
+uint32_t IRAM_ATTR TimeManager::getUnixTime() {
     if (_rtcPhaseLocked) {
         uint32_t elapsedUs = micros() - _rtcAnchorMicros;
         return _rtcAnchorUnixSecond + (elapsedUs / 1000000UL);
@@ -280,7 +310,7 @@ uint32_t TimeManager::getUnixTime() {
     return unixTime;
 }
 
-uint16_t TimeManager::getMilliseconds() {
+uint16_t IRAM_ATTR TimeManager::getMilliseconds() {
     if (!_timeSet) return 0;
     if (_rtcPhaseLocked) {
         uint32_t elapsedUs = micros() - _rtcAnchorMicros;
@@ -290,9 +320,13 @@ uint16_t TimeManager::getMilliseconds() {
     return (uint16_t)((_accumMillis + elapsed) % 1000);
 }
 
-void TimeManager::getTimeSnapshot(uint32_t& outUnixSeconds, uint16_t& outMillis) {
+void IRAM_ATTR TimeManager::getTimeSnapshot(uint32_t& outUnixSeconds, uint16_t& outMillis) {
     // Sample ms, then seconds. If ms wrapped downward between the two reads,
     // a second boundary passed — re-read seconds for a coherent pair.
+    // The lock keeps a writer on the other core (anchor update, tick) from
+    // landing between the field reads; the NTP server may call this from
+    // the lwIP thread.
+    portENTER_CRITICAL(&_mux);
     outMillis      = getMilliseconds();
     outUnixSeconds = getUnixTime();
     uint16_t ms2   = getMilliseconds();
@@ -300,9 +334,34 @@ void TimeManager::getTimeSnapshot(uint32_t& outUnixSeconds, uint16_t& outMillis)
         outUnixSeconds = getUnixTime();
         outMillis      = ms2;
     }
+    portEXIT_CRITICAL(&_mux);
 }
 
-bool TimeManager::isTimeSet() {
+void TimeManager::getTimeAtMicros(uint32_t atMicros, uint32_t& outUnixSeconds,
+                                  uint32_t& outMicros) {
+    int64_t us;  // Microseconds since the Unix epoch at atMicros
+    portENTER_CRITICAL(&_mux);
+    if (_rtcPhaseLocked) {
+        // Signed: atMicros may precede an anchor that was refreshed after capture
+        int32_t elapsed = (int32_t)(atMicros - _rtcAnchorMicros);
+        us = (int64_t)_rtcAnchorUnixSecond * 1000000LL + elapsed;
+    } else {
+        uint16_t ms    = getMilliseconds();
+        uint32_t sec   = getUnixTime();
+        uint16_t ms2   = getMilliseconds();
+        if (ms2 < ms) {
+            sec = getUnixTime();
+            ms  = ms2;
+        }
+        int32_t since = (int32_t)(micros() - atMicros);
+        us = (int64_t)sec * 1000000LL + (int64_t)ms * 1000LL - since;
+    }
+    portEXIT_CRITICAL(&_mux);
+    outUnixSeconds = (uint32_t)(us / 1000000LL);
+    outMicros      = (uint32_t)(us % 1000000LL);
+}
+
+bool IRAM_ATTR TimeManager::isTimeSet() {
     return _timeSet;
 }
 
@@ -318,6 +377,7 @@ void TimeManager::tick() {
     if (!_timeSet) return;
     if (_rtcPhaseLocked) return;
     
+    portENTER_CRITICAL(&_mux);
     unsigned long currentMillis = millis();
     unsigned long elapsed = currentMillis - _lastTickMillis;
     
@@ -330,6 +390,7 @@ void TimeManager::tick() {
         _accumMillis -= 1000;
         incrementSecond();
     }
+    portEXIT_CRITICAL(&_mux);
 }
 
 void TimeManager::incrementSecond() {
@@ -386,11 +447,11 @@ int TimeManager::calculateDayOfWeek(uint16_t year, uint8_t month, uint8_t day) {
     return dow;
 }
 
-bool TimeManager::isLeapYear(uint16_t year) {
+bool IRAM_ATTR TimeManager::isLeapYear(uint16_t year) {
     return ((year % 4 == 0) && (year % 100 != 0)) || (year % 400 == 0);
 }
 
-uint8_t TimeManager::daysInMonth(uint16_t year, uint8_t month) {
+uint8_t IRAM_ATTR TimeManager::daysInMonth(uint16_t year, uint8_t month) {
     if (month < 1 || month > 12) return 30;  // Invalid month, return safe default
     
     uint8_t days = DAYS_IN_MONTH[month - 1];
@@ -434,6 +495,21 @@ ClockTime TimeManager::unixToClockTime(uint32_t unixTime) {
     return dt;
 }
 
+uint32_t TimeManager::clockTimeToUnix(const ClockTime& dt) {
+    uint32_t unixTime = 0;
+    for (uint16_t y = 1970; y < dt.year; y++) {
+        unixTime += isLeapYear(y) ? 366UL * 86400UL : 365UL * 86400UL;
+    }
+    for (uint8_t m = 1; m < dt.month; m++) {
+        unixTime += (uint32_t)daysInMonth(dt.year, m) * 86400UL;
+    }
+    unixTime += (uint32_t)(dt.day - 1) * 86400UL;
+    unixTime += (uint32_t)dt.hour * 3600UL;
+    unixTime += (uint32_t)dt.minute * 60UL;
+    unixTime += dt.second;
+    return unixTime;
+}
+
 // ============================================================================
 // Private Helper Functions
 // ============================================================================
@@ -91,8 +91,20 @@ public:
      * @brief Get a coherent (seconds, milliseconds) pair, safe against second-boundary races.
      * @param outUnixSeconds  Output: current Unix timestamp (integer seconds)
      * @param outMillis       Output: milliseconds within the current second (0–999)
+     * @details IRAM-resident (with getUnixTime/getMilliseconds) for the NTP fast path.
      */
     void getTimeSnapshot(uint32_t& outUnixSeconds, uint16_t& outMillis);
+
+    /**
+     * @brief UTC time at a given micros() instant, at microsecond resolution
+     * @details Exact when phase-locked to the RTC SQW; otherwise derived from the
+     *          millisecond snapshot and backed off by the elapsed micros().
+     *          Used for PTP event timestamps captured around a send or receive.
+     * @param atMicros       micros() value to convert (may be slightly in the past)
+     * @param outUnixSeconds Output: Unix seconds
+     * @param outMicros      Output: microseconds within that second (0–999999)
+     */
+    void getTimeAtMicros(uint32_t atMicros, uint32_t& outUnixSeconds, uint32_t& outMicros);
     
     /**
      * @brief Set time from Unix timestamp
@@ -139,7 +151,16 @@ public:
      */
     bool hasRTCPhaseAnchor() const;
 
-    
+    /**
+     * @brief Offset of a micros() timestamp from the nearest RTC-anchored second boundary
+     * @param atMicros    micros() value to evaluate
+     * @param outOffsetUs Output: signed offset (-500000..499999 µs), positive if after the boundary
+     * @param outSecond   Optional output: Unix second of that nearest boundary
+     * @return false if the clock is not phase-locked to the RTC
+     */
+    bool getRTCPhaseAt(uint32_t atMicros, int32_t& outOffsetUs,
+                       uint32_t* outSecond = nullptr) const;
+
     /**
      * @brief Check if time has been set (synced at least once)
      * @return true if time has been set
@@ -176,6 +197,13 @@ public:
      */
     static uint8_t daysInMonth(uint16_t year, uint8_t month);
 
+    /**
+     * @brief Convert calendar fields to a Unix timestamp
+     * @param dt UTC date and time
+     * @return Seconds since Jan 1, 1970
+     */
+    static uint32_t clockTimeToUnix(const ClockTime& dt);
+
 private:
     // Internal time storage (UTC)
     uint16_t _year;
@@ -197,6 +225,10 @@ private:
     bool _rtcPhaseLocked;
     uint32_t _rtcAnchorUnixSecond;
     uint32_t _rtcAnchorMicros;
+
+    // Guards the fields above against a reader on the other core
+    // (getTimeSnapshot() from the NTP receive callback)
+    portMUX_TYPE _mux;
     
     /**
      * @brief Increment internal time by one second
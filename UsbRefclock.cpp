@@ -0,0 +1,150 @@
+/**
+ * @file      UsbRefclock.cpp
+ * @brief     USB CDC reference-clock protocol implementation
+ */
+
+#include "UsbRefclock.h"
+#include "EventLog.h"
+#include "StateStore.h"
+
+#define USB_REF_TYPE_REQ     0x01
+#define USB_REF_TYPE_RESP    0x81
+
+// micros() when the first bytes of the pending request arrived, written from
+// the CDC event task. Cleared once the request is answered.
+static volatile uint32_t s_rxMicros = 0;
+static volatile bool     s_rxStamped = false;
+
+#if ARDUINO_USB_CDC_ON_BOOT
+static void onCdcRx(void*, esp_event_base_t, int32_t, void*) {
+    if (!s_rxStamped) {
+        s_rxMicros = micros();
+        s_rxStamped = true;
+    }
+}
+#endif
+
+static void put64le(uint8_t* p, uint64_t v) {
+    for (uint8_t i = 0; i < 8; i++) p[i] = (uint8_t)(v >> (8 * i));
+}
+
+UsbRefclock::UsbRefclock()
+    : _timeManager(nullptr), _running(false), _len(0),
+      _requests(0), _bad(0), _skipped(0) {
+    memset(_buf, 0, sizeof(_buf));
+}
+
+void UsbRefclock::begin(TimeManager* tm) {
+    _timeManager = tm;
+    Serial.begin(DEBUG_BAUD_RATE);   // Baud is ignored by USB CDC
+    Serial.setDebugOutput(false);    // Keep core log_x() text off the link
+    Serial.setTxTimeoutMs(0);        // Never block loop() if the host stops reading
+#if ARDUINO_USB_CDC_ON_BOOT && ARDUINO_USB_MODE
+    Serial.onEvent(ARDUINO_HW_CDC_RX_EVENT, onCdcRx);
+#elif ARDUINO_USB_CDC_ON_BOOT
+    Serial.onEvent(ARDUINO_USB_CDC_RX_EVENT, onCdcRx);
+#endif
+    // Without a CDC receive event T2 falls back to the time service() runs
+    _running = tm != nullptr;
+    Log.event(LOG_SEV_NOTICE, "[USBREF] Reference clock protocol on USB CDC");
+}
+
+void UsbRefclock::service() {
+    if (!_running) return;
+
+    int n = Serial.available();
+    while (n-- > 0) {
+        int c = Serial.read();
+        if (c < 0) break;
+        _buf[_len++] = (uint8_t)c;
+
+        // Hunt for "WR"; anything else (ROM boot text, a torn frame) is skipped
+        while (_len > 0 && (_buf[0] != USB_REF_MAGIC0 ||
+                            (_len > 1 && _buf[1] != USB_REF_MAGIC1))) {
+            resync();
+        }
+        if (_len < USB_REF_REQ_LEN) continue;
+
+        uint32_t rxMicros = s_rxStamped ? s_rxMicros : micros();
+        uint16_t crc = (uint16_t)_buf[USB_REF_REQ_LEN - 2] |
+                       ((uint16_t)_buf[USB_REF_REQ_LEN - 1] << 8);
+        if (crc != crc16(_buf, USB_REF_REQ_LEN - 2) ||
+            _buf[2] != USB_REF_TYPE_REQ || _buf[3] != USB_REF_VERSION) {
+            _bad++;
+            resync();
+            continue;
+        }
+        answer(rxMicros);
+        s_rxStamped = false;
+        _len = 0;
+    }
+
+    // Nothing half-received: the next bytes to arrive start a new request
+    if (_len == 0 && Serial.available() == 0) s_rxStamped = false;
+}
+
+void UsbRefclock::resync() {
+    uint8_t i = 1;
+    while (i < _len && _buf[i] != USB_REF_MAGIC0) i++;
+    _skipped += i;
+    memmove(_buf, _buf + i, _len - i);
+    _len -= i;
+}
+
+void UsbRefclock::answer(uint32_t rxMicros) {
+    NtpRefState ref;
+    State.ntpRef.read(ref);
+
+    uint8_t flags = 0;
+    if (_timeManager->isTimeSet()) flags |= USB_REF_FLAG_TIME_SET;
+    if (_timeManager->hasRTCPhaseAnchor()) flags |= USB_REF_FLAG_PHASE_LOCKED;
+
+    uint8_t resp[USB_REF_RESP_LEN];
+    resp[0] = USB_REF_MAGIC0;
+    resp[1] = USB_REF_MAGIC1;
+    resp[2] = USB_REF_TYPE_RESP;
+    resp[3] = USB_REF_VERSION;
+    memcpy(&resp[4], &_buf[4], 12);          // seq and T1, echoed
+
+    uint32_t sec, us;
+    _timeManager->getTimeAtMicros(rxMicros, sec, us);
+    put64le(&resp[16], (uint64_t)sec * 1000000ULL + us);
+
+    // CRC the fields ahead of T3 now so only 14 bytes remain after the stamp
+    uint16_t crc = crc16(resp, 24);
+    resp[32] = ref.stratum;
+    resp[33] = ref.leapIndicator;
+    resp[34] = flags;
+    resp[35] = 0;
+
+    _timeManager->getTimeAtMicros(micros(), sec, us);
+    put64le(&resp[24], (uint64_t)sec * 1000000ULL + us);
+    crc = crc16(&resp[24], 12, crc);
+    resp[36] = (uint8_t)crc;
+    resp[37] = (uint8_t)(crc >> 8);
+
+    Serial.write(resp, USB_REF_RESP_LEN);
+    _requests++;
+}
+
+uint16_t UsbRefclock::crc16(const uint8_t* data, size_t len, uint16_t crc) {
+    while (len--) {
+        crc ^= (uint16_t)(*data++) << 8;
+        for (uint8_t b = 0; b < 8; b++) {
+            crc = (crc & 0x8000) ? (uint16_t)((crc << 1) ^ 0x1021) : (uint16_t)(crc << 1);
+        }
+    }
+    return crc;
+}
+
+uint32_t UsbRefclock::getRequestCount() const {
+    return _requests;
+}
+
+uint32_t UsbRefclock::getBadCount() const {
+    return _bad;
+}
+
+uint32_t UsbRefclock::getSkippedCount() const {
+    return _skipped;
+}
@@ -0,0 +1,80 @@
+/**
+ * @file      UsbRefclock.h
+ * @brief     Binary four-timestamp reference-clock protocol on USB CDC
+ * @details   For a clock plugged into a server by USB. The host daemon
+ *            (tools/usb_refclock.py) sends a request carrying its transmit
+ *            time T1; the clock answers with T1 echoed, its receive time T2 and
+ *            its transmit time T3, and the daemon stamps T4 on arrival. Offset
+ *            and delay follow as in NTP, without the WiFi hop.
+ *
+ *            T2 is taken in the HW CDC receive event when the request's bytes
+ *            land, not when loop() gets round to parsing them, so a long loop
+ *            pass only lengthens T3 - T2. Replies are stamped immediately
+ *            before the write.
+ *
+ *            Request (20 bytes) and response (38 bytes), little-endian:
+ *              0  'W' 'R'   magic
+ *              2  type      0x01 request, 0x81 response
+ *              3  version   USB_REF_VERSION
+ *              4  seq       u32, echoed
+ *              8  T1        u64 host time, opaque, echoed
+ *              request:  16 reserved u16, 18 CRC-16
+ *              response: 16 T2 i64 µs since the Unix epoch
+ *                        24 T3 i64 µs since the Unix epoch
+ *                        32 stratum, 33 leap (RFC 5905 LI), 34 flags,
+ *                        35 reserved, 36 CRC-16
+ *            CRC-16/CCITT-FALSE covers every byte before it.
+ */
+
+#ifndef USBREFCLOCK_H
+#define USBREFCLOCK_H
+
+#include <Arduino.h>
+#include "config.h"
+#include "TimeManager.h"
+
+#define USB_REF_REQ_LEN      20
+#define USB_REF_RESP_LEN     38
+
+// Response flags
+#define USB_REF_FLAG_TIME_SET     0x01   // Clock has been set since boot
+#define USB_REF_FLAG_PHASE_LOCKED 0x02   // Sub-second phase anchored to the DS3231 SQW
+
+class UsbRefclock {
+public:
+    UsbRefclock();
+
+    /**
+     * @brief Open the USB CDC port and hook its receive event (call from setup)
+     * @param tm TimeManager providing the timebase
+     */
+    void begin(TimeManager* tm);
+
+    /**
+     * @brief Parse received bytes and answer complete requests (call from loop)
+     */
+    void service();
+
+    uint32_t getRequestCount() const;    // Requests answered
+    uint32_t getBadCount() const;        // CRC failures and unknown frame types
+    uint32_t getSkippedCount() const;    // Bytes discarded while hunting for a frame
+
+    /**
+     * @brief CRC-16/CCITT-FALSE (poly 0x1021); pass a previous result to continue
+     */
+    static uint16_t crc16(const uint8_t* data, size_t len, uint16_t crc = 0xFFFF);
+
+private:
+    TimeManager* _timeManager;
+    bool     _running;
+    uint8_t  _buf[USB_REF_REQ_LEN];
+    uint8_t  _len;
+    uint32_t _requests;
+    uint32_t _bad;
+    uint32_t _skipped;
+
+    void resync();
+    void answer(uint32_t rxMicros);
+};
+
+#endif // USBREFCLOCK_H
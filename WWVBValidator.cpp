@@ -0,0 +1,153 @@
+/**
+ * @file      WWVBValidator.cpp
+ * @brief     WWVB Frame Plausibility and Voting Implementation
+ */
+
+#include "WWVBValidator.h"
+#include "TimeManager.h"
+
+WWVBValidator::WWVBValidator()
+    : _head(0), _filled(0),
+      _accepted(0), _pending(0), _rejected(0),
+      _rtcReader(nullptr) {
+    memset(_history, 0, sizeof(_history));
+    _lastReason[0] = '\0';
+}
+
+void WWVBValidator::setRTCReader(std::function<bool(uint32_t&)> reader) {
+    _rtcReader = reader;
+}
+
+// ============================================================================
+// Field Validation
+// ============================================================================
+bool WWVBValidator::fieldsValid(const ES100Time& t, char* reason, size_t len) {
+    if (t.year < WWVB_MIN_YEAR || t.year > WWVB_MAX_YEAR) {
+        snprintf(reason, len, "year %u out of range", t.year);
+        return false;
+    }
+    if (t.month < 1 || t.month > 12) {
+        snprintf(reason, len, "month %u invalid", t.month);
+        return false;
+    }
+    if (t.day < 1 || t.day > TimeManager::daysInMonth(t.year, t.month)) {
+        snprintf(reason, len, "day %u invalid for %04u-%02u", t.day, t.year, t.month);
+        return false;
+    }
+    if (t.hour > 23 || t.minute > 59 || t.second > 59) {
+        snprintf(reason, len, "time %02u:%02u:%02u invalid", t.hour, t.minute, t.second);
+        return false;
+    }
+    return true;
+}
+
+// ============================================================================
+// Voting
+// ============================================================================
+WWVBVerdict WWVBValidator::evaluate(uint32_t candidateUnix, uint32_t clockUnix,
+                                    bool clockTrusted, uint32_t clockBoundS,
+                                    char* reason, size_t len) {
+    // The clock may be off by as much as its own error bound; a bit error in the
+    // minutes field (60 s) must still fall outside the cap
+    uint32_t clockTol = WWVB_STEP_TOLERANCE_S +
+                        (clockBoundS < WWVB_STEP_TOLERANCE_MAX_S - WWVB_STEP_TOLERANCE_S
+                             ? clockBoundS : WWVB_STEP_TOLERANCE_MAX_S - WWVB_STEP_TOLERANCE_S);
+
+    // Fast path: a small correction to a clock that was set from a real reference.
+    // No DS3231 read and no history lookup — this is every routine sync.
+    if (clockTrusted && within(candidateUnix, clockUnix, clockTol)) {
+        _accepted++;
+        _filled = 0;  // Earlier unconfirmed candidates are moot once the clock agrees
+        snprintf(reason, len, "agrees with clock");
+        return WWVB_ACCEPT;
+    }
+
+    int32_t step  = (int32_t)(candidateUnix - clockUnix);
+    uint8_t votes = 1;  // This frame
+
+    // Second opinion from the DS3231 (survives reboots; the reader declines while
+    // the clock is phase-locked to it)
+    uint32_t rtcUnix = 0;
+    bool rtcRead   = _rtcReader && _rtcReader(rtcUnix);
+    if (rtcRead && within(candidateUnix, rtcUnix, WWVB_STEP_TOLERANCE_S)) {
+        votes++;
+    }
+
+    // Earlier decodes, projected forward by the millis() elapsed since they arrived
+    unsigned long now = millis();
+    for (uint8_t i = 0; i < _filled; i++) {
+        unsigned long age = now - _history[i].capturedMs;
+        if (age > WWVB_VOTE_MAX_AGE_MS) continue;
+        uint32_t projected = _history[i].unixTime + (uint32_t)((age + 500UL) / 1000UL);
+        if (within(candidateUnix, projected, WWVB_STEP_TOLERANCE_S)) {
+            votes++;
+        }
+    }
+
+    remember(candidateUnix);
+
+    if (votes >= WWVB_VOTES_REQUIRED) {
+        _accepted++;
+        _filled = 0;
+        snprintf(reason, len, "step %+lds confirmed by %u votes", (long)step, votes);
+        return WWVB_ACCEPT;
+    }
+
+    // A trusted clock and the DS3231 agreeing with each other outvote a lone frame
+    if (clockTrusted && rtcRead && within(rtcUnix, clockUnix, WWVB_STEP_TOLERANCE_S)) {
+        _rejected++;
+        snprintf(reason, len, "step %+lds contradicts clock and DS3231", (long)step);
+        strncpy(_lastReason, reason, sizeof(_lastReason) - 1);
+        _lastReason[sizeof(_lastReason) - 1] = '\0';
+        return WWVB_REJECT;
+    }
+
+    _pending++;
+    snprintf(reason, len, "unconfirmed step %+lds (%u/%u votes)",
+             (long)step, votes, (unsigned)WWVB_VOTES_REQUIRED);
+    strncpy(_lastReason, reason, sizeof(_lastReason) - 1);
+    _lastReason[sizeof(_lastReason) - 1] = '\0';
+    return WWVB_PENDING;
+}
+
+void WWVBValidator::noteRejected(const char* reason) {
+    _rejected++;
+    strncpy(_lastReason, reason, sizeof(_lastReason) - 1);
+    _lastReason[sizeof(_lastReason) - 1] = '\0';
+}
+
+void WWVBValidator::reset() {
+    _head   = 0;
+    _filled = 0;
+}
+
+void WWVBValidator::remember(uint32_t candidateUnix) {
+    _history[_head].unixTime   = candidateUnix;
+    _history[_head].capturedMs = millis();
+    _head = (_head + 1) % WWVB_VOTE_HISTORY;
+    if (_filled < WWVB_VOTE_HISTORY) _filled++;
+}
+
+bool WWVBValidator::within(uint32_t a, uint32_t b, uint32_t tol) {
+    int32_t d = (int32_t)(a - b);
+    return d >= -(int32_t)tol && d <= (int32_t)tol;
+}
+
+// ============================================================================
+// Statistics
+// ============================================================================
+uint32_t WWVBValidator::getAcceptCount() const {
+    return _accepted;
+}
+
+uint32_t WWVBValidator::getPendingCount() const {
+    return _pending;
+}
+
+uint32_t WWVBValidator::getRejectCount() const {
+    return _rejected;
+}
+
+const char* WWVBValidator::getLastReason() const {
+    return _lastReason;
+}
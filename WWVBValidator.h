@@ -0,0 +1,116 @@
+/**
+ * @file      WWVBValidator.h
+ * @brief     Plausibility checks and multi-frame voting for decoded WWVB frames
+ * @details   A single bit error in a decoded frame can step the clock by minutes
+ *            or years, and the error then propagates to the DS3231 and every NTP
+ *            client. Each candidate time is checked against the running clock, the
+ *            DS3231 and recent decodes before it is applied. Small corrections are
+ *            accepted immediately; large steps need agreement from more than one
+ *            independent source.
+ *
+ *            "Small" is WWVB_STEP_TOLERANCE_S plus the clock's own error bound
+ *            (last sync error + drift budget × time since), capped at
+ *            WWVB_STEP_TOLERANCE_MAX_S, so a drifting DS3231 that has missed
+ *            fixes is still corrected by a good frame. The DS3231 only votes
+ *            while the clock is not phase-locked to it; locked, it is the same
+ *            oscillator and would just repeat the clock's error.
+ */
+
+#ifndef WWVBVALIDATOR_H
+#define WWVBVALIDATOR_H
+
+#include <Arduino.h>
+#include <functional>
+#include "ES100.h"
+#include "config.h"
+
+// Number of recent candidate decodes remembered for voting
+#define WWVB_VOTE_HISTORY   4
+
+/**
+ * @brief Outcome of validating one decoded frame
+ */
+enum WWVBVerdict {
+    WWVB_ACCEPT,    // Apply the frame
+    WWVB_PENDING,   // Plausible but unconfirmed step — wait for another vote
+    WWVB_REJECT     // Implausible frame — discard
+};
+
+class WWVBValidator {
+public:
+    WWVBValidator();
+
+    /**
+     * @brief Set the callback used to read the DS3231 when a second opinion is needed
+     * @param reader Returns true and fills the Unix time if the RTC reading is valid.
+     *               Only invoked when a candidate disagrees with the running clock,
+     *               so the common path costs no extra I2C traffic. Must return
+     *               false while the running clock is phase-locked to the DS3231,
+     *               since the two are then not independent.
+     */
+    void setRTCReader(std::function<bool(uint32_t&)> reader);
+
+    /**
+     * @brief Range-check the calendar fields of a normal-mode frame
+     * @param t       Decoded frame
+     * @param reason  Output: human-readable reason when invalid
+     * @param len     Size of reason buffer
+     * @return true if every field is within its calendar range
+     */
+    static bool fieldsValid(const ES100Time& t, char* reason, size_t len);
+
+    /**
+     * @brief Decide whether a candidate time may be applied
+     * @param candidateUnix Unix time implied by the frame, referred to "now"
+     * @param clockUnix     Current Unix time of the running clock
+     * @param clockTrusted  True if the running clock was set from a real reference
+     * @param clockBoundS   Error bound of the running clock (s), 0 if unknown;
+     *                      widens the tolerance for agreeing with the clock
+     * @param reason        Output: reason for the verdict
+     * @param len           Size of reason buffer
+     * @return Verdict; every candidate is also remembered for later votes
+     */
+    WWVBVerdict evaluate(uint32_t candidateUnix, uint32_t clockUnix, bool clockTrusted,
+                         uint32_t clockBoundS, char* reason, size_t len);
+
+    /**
+     * @brief Record a frame rejected before evaluate() (e.g. invalid fields)
+     */
+    void noteRejected(const char* reason);
+
+    /**
+     * @brief Forget all remembered candidates
+     */
+    void reset();
+
+    uint32_t getAcceptCount() const;
+    uint32_t getPendingCount() const;
+    uint32_t getRejectCount() const;
+
+    /**
+     * @brief Reason string of the most recent pending/rejected frame ("" if none)
+     */
+    const char* getLastReason() const;
+
+private:
+    struct Candidate {
+        uint32_t      unixTime;     // Candidate Unix time when decoded
+        unsigned long capturedMs;   // millis() when decoded
+    };
+
+    Candidate _history[WWVB_VOTE_HISTORY];
+    uint8_t   _head;
+    uint8_t   _filled;
+
+    uint32_t _accepted;
+    uint32_t _pending;
+    uint32_t _rejected;
+    char     _lastReason[48];
+
+    std::function<bool(uint32_t&)> _rtcReader;
+
+    void remember(uint32_t candidateUnix);
+    static bool within(uint32_t a, uint32_t b, uint32_t tol);
+};
+
+#endif // WWVBVALIDATOR_H
@@ -39,6 +39,12 @@
 // Enable automatic DST handling based on ES100 data
 #define AUTO_DST_ENABLED      true
 
+// DST changes are armed as a one-shot timer. The final shot is armed once the
+// change is within this window (crystal error ≤ 72 ms at 20 ppm); before that
+// the timer only re-arms, at most this far apart.
+#define DST_TIMER_FINAL_WINDOW_S  3600UL
+#define DST_TIMER_MAX_ARM_S       86400UL
+
 // ============================================================================
 // SYNC CONFIGURATION
 // ============================================================================
@@ -134,6 +140,16 @@
 // NTP sub-second phase from the RTC. Leave at -1 to disable the feature.
 #define PIN_DS3231_SQW      39
 
+// Hardware edge timestamps.  SQW and the ES100 IRQ are routed to MCPWM capture
+// channels, which latch a free-running APB-clocked timer on the falling edge,
+// so ISR entry latency (WiFi, flash) no longer shifts the timestamps.
+// 0 = GPIO interrupts stamped with micros() on ISR entry.
+#define EDGE_CAPTURE_ENABLED 1
+
+// SQW interval changes larger than this are phase steps (DS3231 writes), not
+// jitter, and are left out of the jitter statistics.
+#define EDGE_JITTER_GATE_US 5000
+
 // ============================================================================
 // ES100 ANTENNA CONFIGURATION
 // ============================================================================
@@ -156,6 +172,10 @@
 // the tracking mode tolerance.
 #define ES100_TRACKING_FALLBACK_MS  604800000UL  // 7 days
 
+// Longest time since the last sync at which a tracking reception is scheduled.
+// DS3231 at 2 ppm drifts ~173 ms/day; 5 days = ~865 ms, inside the ±4 s window.
+#define ES100_TRACKING_MAX_AGE_S    432000UL     // 5 days
+
 // Hours between forced normal-mode syncs during the nighttime window (10 PM – 6 AM).
 // Tracking mode cannot self-correct errors larger than the ES100's ±4 s timing tolerance;
 // a nightly full-frame sync re-anchors absolute time and breaks any error cycle.
@@ -163,6 +183,205 @@
 // hour until it succeeds, then tracking resumes for the rest of the night.
 #define NIGHTLY_NORMAL_SYNC_HOURS   20UL
 
+// Attempts at the post-IRQ register burst (one per loop pass) before the
+// reception is abandoned
+#define ES100_FRAME_READ_RETRIES    3
+
+// ============================================================================
+// DRIFT-AWARE SYNC CADENCE
+// ============================================================================
+// The limits above assume a 2 ppm DS3231; clone modules drift 30-70 ppm. Clock
+// drift is measured from successive WWVB corrections, and the tracking age,
+// nightly anchor, tracking fallback and sync intervals are shortened so the
+// predicted error stays inside the budgets below. They are never lengthened.
+
+// Least drift ever budgeted for, and the assumption until drift is measured (ppm)
+#define CADENCE_MIN_DRIFT_PPM       2.0f
+
+// Margin on the measured drift for temperature swings
+#define CADENCE_DRIFT_SAFETY        1.5f
+
+// Predicted error allowed when a tracking reception is scheduled (ms); the
+// :55 start must fall well inside the ES100's ±4 s tracking window
+#define CADENCE_TRACKING_BUDGET_MS  1000UL
+
+// Drift allowed between full-frame decodes (ms), half the ±4 s window. Caps
+// NIGHTLY_NORMAL_SYNC_HOURS and ES100_TRACKING_FALLBACK_MS.
+#define CADENCE_ANCHOR_BUDGET_MS    2000UL
+
+// Holdover target: drift allowed between sync attempts (ms). Shortens
+// SYNC_INTERVAL_NIGHT_MS/SYNC_INTERVAL_DAY_MS, but not below the minimum.
+#define CADENCE_HOLDOVER_BUDGET_MS  50UL
+#define CADENCE_MIN_INTERVAL_MS     900000UL     // 15 minutes
+
+// A correction is a drift sample only this long after the previous WWVB fix (s);
+// ES100 timing noise of a few ms is then under 2 ppm
+#define CADENCE_MIN_SAMPLE_S        1800UL
+
+// Samples, and total time they span (s), before the measured drift is used
+#define CADENCE_MIN_SAMPLES         3
+#define CADENCE_MIN_SPAN_S          21600UL      // 6 hours
+
+// Error and span sums decay by 1/depth per sample after this many samples
+#define CADENCE_AVG_DEPTH           8
+
+// A correction implying more drift than this is a bad fix (ppm)
+#define CADENCE_MAX_PPM             500.0f
+
+// ============================================================================
+// ES100 EARLY ABORT
+// ============================================================================
+// A failed normal-mode cycle (IRQ_CYCLE_COMPLETE) is followed by another on the
+// other antenna until SYNC_TIMEOUT_NORMAL_MS. ReceptionPolicy learns the odds of
+// a cycle decoding per local hour and antenna, and ends the reception (or moves
+// it to the better antenna) when the next cycle cannot finish or is unlikely to.
+
+// 1 = act on the decisions; 0 = log them only ("shadow"), to compare
+// fixes per receiver-hour ("fph" in /api/status) with and without the policy
+#define RXP_EARLY_ABORT             1
+
+// Shortest cycle assumed able to decode until one is measured (ms): a full
+// minute frame. Measured decodes are clamped to the floor.
+#define RXP_MIN_OK_MS               60000UL
+#define RXP_MIN_OK_FLOOR_MS         30000UL
+
+// A slower decode raises the shortest-decode estimate by 1/RXP_MIN_OK_RELAX
+// of the difference
+#define RXP_MIN_OK_RELAX            16
+
+// A next cycle with learned odds below this is abandoned or switched
+#define RXP_MIN_ODDS                0.05f
+
+// Cycles an hour/antenna bucket needs before its odds are used
+#define RXP_MIN_SAMPLES             6
+
+// Bucket counts are halved when they reach this, so old seasons fade
+#define RXP_MAX_COUNT               64
+
+// Every Nth low-odds cycle runs anyway, so its bucket keeps learning
+#define RXP_PROBE_EVERY             8
+
+// ============================================================================
+// WWVB FRAME VALIDATION
+// ============================================================================
+
+// Maximum disagreement (seconds) between a decoded frame and the running clock
+// for the frame to be applied immediately. Larger steps must be confirmed by voting.
+#define WWVB_STEP_TOLERANCE_S       2
+
+// Most the tolerance against the running clock is widened by the clock's error
+// bound (drift budget × time since the last sync). Kept under the 60 s step a
+// minutes-field bit error produces.
+#define WWVB_STEP_TOLERANCE_MAX_S   30
+
+// Agreeing sources required before a large step is applied. Votes come from the
+// frame itself, the DS3231, and earlier decodes projected forward to "now".
+#define WWVB_VOTES_REQUIRED         2
+
+// Earlier decodes older than this no longer count as votes. At least one daytime
+// sync interval, so a held or rejected frame can still be confirmed by the next
+// scheduled reception (5 hours)
+#define WWVB_VOTE_MAX_AGE_MS        (SYNC_INTERVAL_DAY_MS + 3600000UL)
+
+// Delay before re-receiving to confirm an unconfirmed step
+#define WWVB_CONFIRM_RETRY_MS       5000UL
+
+// Plausible year range for decoded frames
+#define WWVB_MIN_YEAR               2025
+#define WWVB_MAX_YEAR               2099
+
+// ============================================================================
+// ES100 IRQ LATENCY CALIBRATION
+// ============================================================================
+
+// Delay from the second boundary reported by the ES100 to its IRQ edge (µs),
+// common to all modes and antennas. Self-calibration against the DS3231 cannot
+// observe this level, so measure it once against an external reference such as
+// a GPS PPS, less the propagation delay ("prop" in /api/status). Per-mode/antenna
+// differences are learned on top of it. At 0 (no measurement) the absolute
+// latency is NOT corrected; fixes are late by the receiver's real IRQ delay.
+#define ES100_IRQ_BASE_LATENCY_US   0
+
+// A WWVB fix is measured only if the DS3231 has held the previous WWVB fix's
+// phase for no longer than this (DS3231 drift of ±2 ppm adds up to ±7.8 ms)
+#define ES100_LATCAL_MAX_HOLD_MS    3900000UL
+
+// Averaging depth: running mean up to this many samples, then an EWMA of this depth
+#define ES100_LATCAL_AVG_DEPTH      16
+
+// Samples before the outlier gate is armed
+#define ES100_LATCAL_MIN_SAMPLES    4
+
+// Reject a sample further than this from its bucket's estimate (µs)
+#define ES100_LATCAL_GATE_US        20000L
+
+// Hard limit on any estimate's distance from the base latency (µs)
+#define ES100_LATCAL_MAX_US         150000L
+
+// ============================================================================
+// WWVB PROPAGATION DELAY
+// ============================================================================
+
+// Receiver location (decimal degrees, north and east positive). Leave both at
+// 0 to skip propagation compensation; fixes then land late by the path delay
+// (about 3.3 µs per km from Fort Collins).
+#define RECEIVER_LATITUDE_DEG       0.0
+#define RECEIVER_LONGITUDE_DEG      0.0
+
+// WWVB transmitter, Fort Collins, CO
+#define WWVB_TX_LATITUDE_DEG        40.6781
+#define WWVB_TX_LONGITUDE_DEG       -105.0472
+
+// Ground-wave speed as a fraction of c (60 kHz over average land)
+#define PROP_GROUND_VELOCITY        0.9990
+
+// Reflection height of the sky wave (km): D layer by day, E layer at night
+#define PROP_SKY_DAY_HEIGHT_KM      70.0
+#define PROP_SKY_NIGHT_HEIGHT_KM    90.0
+
+// By day the ground wave is used out to this distance, then the sky wave (km)
+#define PROP_DAY_GROUND_KM          2000.0
+
+// At night the sky wave is used beyond this distance (km)
+#define PROP_NIGHT_SKY_KM           500.0
+
+// Sun this far below the horizon at the path midpoint counts as full night;
+// day and night delays are blended between 0° and this (degrees)
+#define PROP_TWILIGHT_DEG           6.0
+
+// ============================================================================
+// CONTINUOUS TRACKING / CLOCK DISCIPLINE
+// ============================================================================
+
+// 1 = during the nighttime window, run tracking receptions back-to-back (one per
+// minute). Each result is a phase measurement of the DS3231 against WWVB and is
+// used to steer the DS3231 phase and aging offset instead of stepping the clock.
+// 0 = tracking is used only for the scheduled syncs.
+#define ES100_CONTINUOUS_TRACKING   0
+
+// Measurements in the least-squares window (one per minute)
+#define DISCIPLINE_WINDOW           64
+
+// Minimum window before the frequency estimate is used
+#define DISCIPLINE_MIN_POINTS       16
+#define DISCIPLINE_MIN_SPAN_S       3000UL
+
+// Restart the window if measurements stop for this long
+#define DISCIPLINE_MAX_GAP_MS       600000UL
+
+// Offsets beyond this are not measurements; the normal stepping path handles them (µs)
+#define DISCIPLINE_MAX_PHASE_US     100000L
+
+// Phase: ignore errors below the deadband, then correct 1/GAIN_DIV of the error per measurement
+#define DISCIPLINE_PHASE_DEADBAND_US 200L
+#define DISCIPLINE_PHASE_GAIN_DIV   4
+
+// Frequency: DS3231 aging register weight (~0.1 ppm/LSB at 25 °C), deadband and
+// the largest step applied at once
+#define DISCIPLINE_AGING_PPM_PER_LSB 0.1f
+#define DISCIPLINE_FREQ_DEADBAND_PPM 0.08f
+#define DISCIPLINE_MAX_AGING_STEP   5
+
 // ============================================================================
 // WATCHDOG CONFIGURATION
 // ============================================================================
@@ -172,12 +391,54 @@
 // longer than a single I2C transaction (~2 ms at 100 kHz).
 #define WATCHDOG_TIMEOUT_MS   15000
 
+// Stall forensics: loop stage, in-flight I2C transaction and the last
+// STALL_TRACE_SIZE trace events are kept in RTC memory and reported at the
+// next boot (/api/stall) after a watchdog or panic reset.  A loop() pass
+// slower than STALL_SLOW_PASS_MS is itself recorded as a trace event.
+#define STALL_TRACE_SIZE      24
+#define STALL_SLOW_PASS_MS    1000
+
+// ============================================================================
+// HEAP TELEMETRY
+// ============================================================================
+
+// Internal heap and PSRAM are sampled (free, largest free block, minimum
+// ever) every HEAP_SAMPLE_INTERVAL_MS; one sample per HEAP_HISTORY_INTERVAL_MS
+// is kept for /api/heap so fragmentation can be followed over days.
+#define HEAP_SAMPLE_INTERVAL_MS          10000UL
+#define HEAP_HISTORY_INTERVAL_MS         3600000UL   // Hourly points
+#define HEAP_HISTORY_SIZE                48          // 48 h of history
+
+// Warn once when the largest free internal block drops below this; re-armed
+// when it recovers to twice the threshold.
+#define HEAP_LOW_BLOCK_BYTES             16384
+
+// Count malloc/calloc/realloc per loop() stage (from the stall breadcrumbs)
+// and per other task.  Needs the linker to wrap the allocator, so it is
+// enabled only by the -heapsoak env in platformio.ini, never in production.
+#ifndef HEAP_ALLOC_TRACKING
+#define HEAP_ALLOC_TRACKING              0
+#endif
+
 // ============================================================================
 // DEBUG CONFIGURATION
 // ============================================================================
 
-// Enable serial debug output
-#define DEBUG_SERIAL          true
+// USB-CDC reference clock (see USB REFERENCE CLOCK below).  The port then
+// carries binary timestamp frames, so it cannot also carry debug text.
+#ifndef USB_REFCLOCK
+#define USB_REFCLOCK          0
+#endif
+
+// Enable serial debug output.  Production builds pass -DDEBUG_SERIAL=0
+// (see the -production env in platformio.ini): USB CDC is then never started
+// and log lines go only to the event ring / syslog collector.
+#ifndef DEBUG_SERIAL
+#define DEBUG_SERIAL          (!USB_REFCLOCK)
+#endif
+#if USB_REFCLOCK && DEBUG_SERIAL
+#error "USB_REFCLOCK needs the USB CDC port to itself; build with DEBUG_SERIAL=0"
+#endif
 
 // Serial baud rate
 #define DEBUG_BAUD_RATE       115200
@@ -185,6 +446,72 @@
 // Verbose I2C debugging
 #define DEBUG_I2C             false
 
+// ============================================================================
+// EVENT LOG / REMOTE SYSLOG
+// ============================================================================
+
+// Every log line is also kept as a structured event (uptime, severity, tag,
+// message) in a RAM ring and shipped to a syslog collector as RFC 5424 over
+// UDP (RFC 5426, one message per datagram).  Empty host disables shipping;
+// the ring still holds the latest events for /api/events.
+#define LOG_SYSLOG_HOST                  ""          // Collector IPv4, e.g. "192.168.1.10"
+#define LOG_SYSLOG_PORT                  514
+#define LOG_HOSTNAME                     "wwvb-clock"
+#define LOG_FACILITY                     16          // local0
+
+// Lowest-priority severity kept and shipped (3 err, 4 warning, 6 info, 7 debug).
+// Debug lines (per-request NTP logging) still reach Serial when it is enabled.
+#define LOG_SHIP_SEVERITY                6
+
+// Ring of pending/recent events (~150 B each).  Unshipped events that are
+// overwritten are counted as dropped.
+#define LOG_RING_SIZE                    48
+#define LOG_MSG_MAX                      120
+
+// Batching: ship when LOG_BATCH_MAX events are pending or the oldest has
+// waited LOG_BATCH_MS, and only while NTP has been quiet for NTP_FLASH_QUIET_MS
+// (at most LOG_MAX_DEFER_MS late).
+#define LOG_BATCH_MAX                    8
+#define LOG_BATCH_MS                     2000UL
+#define LOG_MAX_DEFER_MS                 10000UL
+
+// Datagram rate limit: token bucket of LOG_RATE_BURST, refilled LOG_RATE_PER_S per second.
+#define LOG_RATE_PER_S                   10
+#define LOG_RATE_BURST                   20
+
+// ============================================================================
+// MQTT TELEMETRY
+// ============================================================================
+
+// Publish-only MQTT 3.1.1 client for fleet dashboards.  State topics
+// (<prefix>/state/...) are retained and published only when their value
+// changes; counters and offset statistics go out as one JSON document on
+// <prefix>/metrics every MQTT_METRICS_INTERVAL_MS.  All traffic is sent from
+// loop() while NTP is quiet.  Empty broker disables the client.
+#define MQTT_ENABLED                     0
+#define MQTT_BROKER                      ""          // Hostname or IPv4, e.g. "192.168.1.10"
+#define MQTT_PORT                        1883
+#define MQTT_CLIENT_ID                   "wwvb-clock"
+#define MQTT_USER                        ""          // Empty = no authentication
+#define MQTT_PASS                        ""
+#define MQTT_TOPIC_PREFIX                "wwvb-clock"
+
+#define MQTT_KEEPALIVE_S                 60
+#define MQTT_METRICS_INTERVAL_MS         60000UL
+#define MQTT_CONNECT_TIMEOUT_MS          3000        // DNS + TCP connect + CONNACK, polled per pass
+#define MQTT_RECONNECT_MS                30000UL     // Back-off after a failed connect
+
+// Publishing waits for NTP_FLASH_QUIET_MS of NTP silence, at most MQTT_MAX_DEFER_MS
+#define MQTT_MAX_DEFER_MS                10000UL
+
+// Change thresholds for retained state (smaller changes are not published)
+#define MQTT_SYNC_AGE_STEP_S             60          // Sync age reported in whole minutes
+#define MQTT_BATTERY_STEP_PCT            2
+#define MQTT_TEMP_STEP_C                 0.5f
+
+// All packets pending in one service pass are coalesced into one TCP write
+#define MQTT_PACKET_MAX                  768
+
 // ============================================================================
 // WIFI CONFIGURATION
 // ============================================================================
@@ -196,6 +523,8 @@
 #define WIFI_SCAN_INTERVAL    30000   // Re-scan every 30s on WiFi page
 #define WIFI_MAX_NETWORKS     15      // Max networks to store from scan
 #define WIFI_MAX_VISIBLE      6       // Max networks visible at once in list
+#define WIFI_SSID_MAX         32      // 802.11 SSID limit (bytes)
+#define WIFI_PASS_MAX         63      // WPA2 passphrase limit
 
 // ============================================================================
 // NTP SERVER CONFIGURATION
@@ -257,6 +586,56 @@
 // Low battery serial warning interval (milliseconds)
 #define LOW_BATTERY_WARN_MS     60000
 
+// ============================================================================
+// ENERGY ACCOUNTING
+// ============================================================================
+// EnergyMonitor integrates per-subsystem on-times against the currents below
+// (battery side, mA) into mWh. The model is scaled by comparing it with the
+// charge the battery voltage says was used over a discharge, and predicts
+// runtime. The currents are datasheet-order starting points.
+
+// Battery capacity (mAh) and nominal voltage (mV); set to the fitted cell
+#define ENERGY_BATTERY_MAH          1000
+#define ENERGY_BATTERY_NOMINAL_MV   3700
+
+// Always-on board load: PMU, DS3231, LDO quiescent, PSRAM standby
+#define ENERGY_BASE_MA              5.0f
+
+// ESP32-S3 at 240 MHz: loop() running vs. waiting in its delay
+#define ENERGY_CPU_ACTIVE_MA        50.0f
+#define ENERGY_CPU_IDLE_MA          30.0f
+
+// Wi-Fi radio: STA with modem sleep (average), and AP (always listening)
+#define ENERGY_WIFI_STA_MA          20.0f
+#define ENERGY_WIFI_AP_MA           95.0f
+
+// ES100 with EN high
+#define ENERGY_ES100_MA             2.0f
+
+// AMOLED: panel driver while on, plus full-white at full brightness scaled
+// by brightness and the average picture level of the last frame
+#define ENERGY_DISPLAY_BASE_MA      10.0f
+#define ENERGY_DISPLAY_FULL_MA      120.0f
+
+// I2C transaction time: pull-ups and the addressed device
+#define ENERGY_I2C_MA               1.0f
+
+// One frame pixel in this many is read for the average picture level
+// (prime, so the samples do not line up with display columns)
+#define ENERGY_PIXEL_STRIDE         61
+
+// Calibration: a discharge window must drop this much charge (%) before the
+// model is compared with it; new scales are blended in by 1/ENERGY_CAL_DEPTH
+#define ENERGY_CAL_MIN_DROP_PCT     10.0f
+#define ENERGY_CAL_DEPTH            4
+#define ENERGY_SCALE_MIN            0.25f
+#define ENERGY_SCALE_MAX            4.0f
+
+// Time constants (s) for the battery-charge smoothing (voltage sags with
+// load) and the average power behind the runtime prediction
+#define ENERGY_PCT_TAU_S            300
+#define ENERGY_POWER_TAU_S          1800
+
 // ============================================================================
 // WWVB SYNC TRUST WINDOW
 // ============================================================================
@@ -269,9 +648,27 @@
 // NTP SERVER QUALITY PARAMETERS
 // ============================================================================
 
-// DS3231 maximum drift rate (ppm) — used to compute NTP Root Dispersion growth.
-// Datasheet spec is ±2 ppm; use 2 as the conservative drift rate.
-#define NTP_DS3231_DRIFT_PPM             2UL
+// Clock quality: one state machine (ClockQuality) sets stratum, LI, reference ID
+// and root dispersion for NTP, PTP and the USB reference clock. Its error bound is
+// the error at the last sync plus the SyncCadence drift budget times the age.
+
+// Error bound at a sync (µs): WWVB (IRQ timing, latency calibration, propagation
+// model), NTP (added to half the round trip), and the extra allowed after a reset
+// for a time restored from the DS3231
+#define CQ_WWVB_ERROR_US                 5000UL
+#define CQ_NTP_ERROR_US                  10000UL
+#define CQ_RESTORE_ERROR_US              5000UL
+
+// Highest error bound for each state (µs). Beyond the DEGRADED limit, or after
+// NTP_UNSYNC_STRATUM_THRESHOLD_S without a sync, the clock is FREERUN.
+#define CQ_LOCKED_MAX_US                 20000UL
+#define CQ_HOLDOVER_MAX_US               250000UL
+#define CQ_DEGRADED_MAX_US               1000000UL
+
+// Hysteresis: a better state is entered only once the bound is below this
+// fraction of its limit and the current state has been held for CQ_MIN_DWELL_MS
+#define CQ_RECOVER_FRACTION              0.5f
+#define CQ_MIN_DWELL_MS                  300000UL
 
 // Minimum root dispersion when clock was just synced (NTP fixed-point 16.16 seconds).
 // 0x000003E8 ≈ 0.015 s (15 ms) — reflects millis()-based timekeeping resolution.
@@ -281,9 +678,149 @@
 // 0x00010000 = 1.0 s — cap prevents dispersion from growing unreasonably large.
 #define NTP_MAX_DISPERSION               0x00010000UL
 
-// Seconds without any sync before the NTP server degrades to Stratum 16.
-// 48 hours: DS3231 at 2 ppm drifts ~345 ms/day — still within 1 s, but advertising
-// Stratum 1 beyond 48 h without a reference is misleading per RFC 5905.
+// Seconds without any sync before the clock is FREERUN (Stratum 16) whatever its
+// error bound. 48 hours: DS3231 at 2 ppm drifts ~345 ms/day — still within 1 s, but
+// advertising Stratum 1 beyond 48 h without a reference is misleading per RFC 5905.
 #define NTP_UNSYNC_STRATUM_THRESHOLD_S   172800UL
 
+// ============================================================================
+// NTP FAST PATH / FLASH WRITE DEFERRAL
+// ============================================================================
+
+// An NVS write disables the flash cache on both cores; anything running from
+// flash (lwIP, WiFiUDP, the loop) stalls until it finishes.  Routine time saves
+// are held until no NTP datagram has arrived for this long...
+#define NTP_FLASH_QUIET_MS               250UL
+
+// ...but never deferred longer than this, so a busy network still gets its
+// time persisted.
+#define NTP_FLASH_MAX_DEFER_MS           60000UL
+
+// Served-latency test: when non-zero, write a scratch NVS key at this interval
+// without waiting for a quiet window.  Compare the "ntplat" histogram in
+// /api/status with this on and off.  Keep 0 in normal builds (flash wear).
+#define NTP_FLASH_STRESS_INTERVAL_MS     0
+
+// 1 = answer NTP requests from a raw lwIP udp_pcb callback, rewriting the
+// received pbuf in place (no WiFiUDP staging copies or per-request cbuf).
+// 0 = the original WiFiUDP polling path; kept for benchmarking via "ntpcyc".
+#define NTP_USE_RAW_PBUF                 1
+
+// ============================================================================
+// NTP RECEIVE QUEUE / OVERLOAD
+// ============================================================================
+
+// Depth of lwIP's per-socket UDP receive mailbox (CONFIG_LWIP_UDP_RECVMBOX_SIZE
+// in the Arduino-ESP32 sdkconfig).  WiFiUDP path only: a drain that finds this
+// many datagrams means the mailbox was full and later arrivals were dropped.
+#define NTP_RECV_MBOX_SIZE               6
+
+// WiFiUDP path: when one pass finds more than this many datagrams queued, only
+// the newest are answered.  The older ones waited longest, so their receive
+// timestamp (taken when we read them) is the least accurate.
+#define NTP_SHED_THRESHOLD               3
+
+// Raw pbuf path: lwIP's tcpip mailbox can't be inspected.  A request that
+// reaches the callback within this many µs of the previous reply was queued
+// behind it; the run of such requests is reported as the queue depth.
+#define NTP_RAW_BACKLOG_GAP_US           50UL
+
+// Per-client token bucket: NTP_RATE_BURST requests, refilled one per
+// NTP_RATE_REFILL_MS.  8 covers an iburst start-up; 2 s matches its spacing,
+// and is far below any sane poll interval (16 s minimum).
+#define NTP_RATE_LIMIT_ENABLED           1
+#define NTP_RATE_TABLE_SIZE              16
+#define NTP_RATE_BURST                   8
+#define NTP_RATE_REFILL_MS               2000UL
+
+// A limited client gets at most one RATE kiss-o'-death per interval; other
+// over-limit requests are dropped silently.
+#define NTP_KOD_INTERVAL_MS              10000UL
+
+// ============================================================================
+// NTP CLIENT ANALYTICS
+// ============================================================================
+
+// Fixed-size sketches of the client population, fed from every accepted
+// request: distinct clients (HyperLogLog), heaviest clients (count-min) and
+// the poll-exponent / NTP-version mix.  Memory does not grow with the LAN.
+#define NTP_CLIENT_ANALYTICS_ENABLED     1
+
+// 2^10 one-byte registers: 1 KB, about 3% standard error on the distinct count.
+#define CLIENT_HLL_PRECISION             10
+
+// Count-min sketch: depth rows of width 32-bit counters (4 × 128 × 4 = 2 KB).
+// Over-estimates a client's count by at most ~2% of all requests (e/width).
+#define CLIENT_CMS_DEPTH                 4
+#define CLIENT_CMS_WIDTH                 128
+
+// Heavy-hitter candidates tracked alongside the sketch.
+#define CLIENT_TOPK                      8
+
+// Requests are handed from the lwIP thread to the loop task through a
+// lock-free ring of this many 8-byte samples (power of two), and folded into
+// the sketches there.  A full ring drops samples (reported as "lost").
+#define CLIENT_SAMPLE_RING               64
+#if (CLIENT_SAMPLE_RING & (CLIENT_SAMPLE_RING - 1)) != 0
+#error "CLIENT_SAMPLE_RING must be a power of two"
+#endif
+
+// ============================================================================
+// NTP PACKET CAPTURE
+// ============================================================================
+
+// Ring of recent request/response pairs in PSRAM, downloadable as a pcap
+// from /api/pcap.  Starts disarmed; arm it with POST /api/pcap?on=1.
+#define PCAP_ENABLED                     1
+
+// Exchanges kept (oldest overwritten).  Each slot holds two PCAP_SNAPLEN
+// payloads plus ~28 bytes of metadata: 512 × 124 B ≈ 62 KB of PSRAM.
+#define PCAP_RING_ENTRIES                512
+
+// Payload bytes kept per packet.  48 is the full NTP header; extension
+// fields beyond it are truncated (the pcap still records the original length).
+#define PCAP_SNAPLEN                     48
+
+// ============================================================================
+// PTP (IEEE 1588-2008) SOFTWARE GRANDMASTER
+// ============================================================================
+
+// Serve PTPv2 over UDP/IPv4 multicast (224.0.1.129, ports 319/320) alongside NTP.
+#define PTP_ENABLED                      1
+#define PTP_DOMAIN                       0
+
+// Message intervals as log2 seconds (0 = 1 s, 1 = 2 s).
+#define PTP_LOG_SYNC_INTERVAL            0
+#define PTP_LOG_ANNOUNCE_INTERVAL        1
+#define PTP_LOG_MIN_DELAY_REQ_INTERVAL   0
+#define PTP_ANNOUNCE_RECEIPT_TIMEOUT     3
+
+// BMCA priorities (lower wins); 128 is the default for an ordinary clock.
+#define PTP_PRIORITY1                    128
+#define PTP_PRIORITY2                    128
+
+// TAI − UTC in seconds (37 since 2017-01-01).  PTP runs on TAI; update this
+// if a leap second is ever inserted.
+#define PTP_TAI_UTC_OFFSET_S             37
+
+// Delay_Req messages are stamped in the lwIP receive callback and handed to
+// the loop task through a lock-free ring of this many entries (power of two).
+// A full ring drops requests (reported as "dlost").
+#define PTP_DELAY_REQ_RING               16
+#if (PTP_DELAY_REQ_RING & (PTP_DELAY_REQ_RING - 1)) != 0
+#error "PTP_DELAY_REQ_RING must be a power of two"
+#endif
+
+// ============================================================================
+// USB REFERENCE CLOCK
+// ============================================================================
+
+// With USB_REFCLOCK (the -refclock env in platformio.ini) the USB CDC port
+// answers four-timestamp requests from tools/usb_refclock.py, which feeds a
+// chrony SOCK refclock on the attached host.  Frames are little-endian and
+// CRC-16/CCITT checked; bytes outside a valid frame (ROM boot text) are skipped.
+#define USB_REF_MAGIC0                   0x57        // 'W'
+#define USB_REF_MAGIC1                   0x52        // 'R'
+#define USB_REF_VERSION                  1
+
 #endif // CONFIG_H
@@ -0,0 +1,82 @@
+/**
+ * @file      test_main.cpp
+ * @brief     WWVBValidator verdicts for drifted clocks, DS3231 votes and bit errors
+ * @details   Runs on the board: pio test -e lilygo-t-display-s3-amoled-test
+ */
+
+#include <Arduino.h>
+#include <unity.h>
+#include "WWVBValidator.h"
+
+static const uint32_t NOW = 1790000000UL;     // 2026-09-21, inside the valid year range
+
+static WWVBValidator v;
+static bool     rtcValid;
+static uint32_t rtcTime;
+static char     reason[64];
+
+void setUp() {
+    v = WWVBValidator();
+    rtcValid = false;
+    rtcTime  = 0;
+    v.setRTCReader([](uint32_t& t) -> bool {
+        t = rtcTime;
+        return rtcValid;
+    });
+}
+
+void tearDown() {}
+
+static WWVBVerdict eval(uint32_t candidate, uint32_t clock, uint32_t boundS) {
+    return v.evaluate(candidate, clock, true, boundS, reason, sizeof(reason));
+}
+
+// Routine sync: a small correction is applied without a second opinion
+static void test_small_correction_accepted() {
+    TEST_ASSERT_EQUAL(WWVB_ACCEPT, eval(NOW, NOW + 1, 0));
+}
+
+// Clock drifted 5 s, WWVB correct, and the error bound says 5 s is possible
+static void test_drift_within_bound_accepted() {
+    TEST_ASSERT_EQUAL(WWVB_ACCEPT, eval(NOW, NOW + 5, 6));
+}
+
+// Clock drifted 5 s, WWVB correct, bound not yet measured. The clock is
+// phase-locked to the DS3231, so the reader declines: the frame is held, not
+// rejected, and the confirming decode is applied.
+static void test_drift_phase_locked_confirmed() {
+    rtcValid = false;
+    TEST_ASSERT_EQUAL(WWVB_PENDING, eval(NOW, NOW + 5, 0));
+    TEST_ASSERT_EQUAL(WWVB_ACCEPT, eval(NOW, NOW + 5, 0));
+}
+
+// Clock and an independent DS3231 agree against a lone frame: rejected, but the
+// frame is remembered so a second agreeing decode is still applied
+static void test_rejected_frame_confirmed_by_second_decode() {
+    rtcValid = true;
+    rtcTime  = NOW + 5;
+    TEST_ASSERT_EQUAL(WWVB_REJECT, eval(NOW, NOW + 5, 0));
+    TEST_ASSERT_EQUAL(WWVB_ACCEPT, eval(NOW, NOW + 5, 0));
+}
+
+// A minutes-field bit error stays outside the widened tolerance however large
+// the bound, and the DS3231 vote goes with the clock
+static void test_minute_bit_error_not_accepted() {
+    rtcValid = true;
+    rtcTime  = NOW;
+    TEST_ASSERT_EQUAL(WWVB_REJECT, eval(NOW + 60, NOW, 1000));
+    TEST_ASSERT_EQUAL(WWVB_ACCEPT, eval(NOW, NOW, 1000));
+}
+
+void setup() {
+    delay(2000);    // Give the host time to open the port
+    UNITY_BEGIN();
+    RUN_TEST(test_small_correction_accepted);
+    RUN_TEST(test_drift_within_bound_accepted);
+    RUN_TEST(test_drift_phase_locked_confirmed);
+    RUN_TEST(test_rejected_frame_confirmed_by_second_decode);
+    RUN_TEST(test_minute_bit_error_not_accepted);
+    UNITY_END();
+}
+
+void loop() {}
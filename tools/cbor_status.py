@@ -0,0 +1,175 @@
+#!/usr/bin/env python3
+"""
+Decode the clock's CBOR status/log documents and compare them with JSON.
+
+  cbor_status.py decode FILE            Print a saved CBOR document as JSON
+  cbor_status.py get HOST [PATH]        Fetch PATH (default /api/status) as CBOR and print it
+  cbor_status.py compare HOST [-n N]    Fetch /api/status and /api/log N times in each
+                                        format; report body size, device build time
+                                        (X-Build-Us) and host parse time
+
+Standard library only. The decoder covers what CborWriter emits: integers,
+byte/text strings, definite and indefinite arrays/maps, simple values and
+float16/32/64.
+"""
+
+import argparse
+import json
+import struct
+import sys
+import time
+import urllib.request
+
+
+class _Break:
+    pass
+
+
+BREAK = _Break()
+
+
+def _arg(data, pos, info):
+    if info < 24:
+        return info, pos
+    if info == 24:
+        return data[pos], pos + 1
+    if info == 25:
+        return struct.unpack_from(">H", data, pos)[0], pos + 2
+    if info == 26:
+        return struct.unpack_from(">I", data, pos)[0], pos + 4
+    if info == 27:
+        return struct.unpack_from(">Q", data, pos)[0], pos + 8
+    if info == 31:
+        return None, pos
+    raise ValueError("reserved additional info %d at %d" % (info, pos - 1))
+
+
+def _item(data, pos):
+    ib = data[pos]
+    pos += 1
+    major, info = ib >> 5, ib & 0x1F
+    if ib == 0xFF:
+        return BREAK, pos
+    if major == 7:
+        if info == 20:
+            return False, pos
+        if info == 21:
+            return True, pos
+        if info in (22, 23):
+            return None, pos
+        if info == 25:
+            return struct.unpack_from(">e", data, pos)[0], pos + 2
+        if info == 26:
+            return struct.unpack_from(">f", data, pos)[0], pos + 4
+        if info == 27:
+            return struct.unpack_from(">d", data, pos)[0], pos + 8
+        v, pos = _arg(data, pos, info)
+        return ("simple", v), pos
+    n, pos = _arg(data, pos, info)
+    if major == 0:
+        return n, pos
+    if major == 1:
+        return -1 - n, pos
+    if major in (2, 3):
+        if n is None:
+            parts = []
+            while data[pos] != 0xFF:
+                part, pos = _item(data, pos)
+                parts.append(part)
+            pos += 1
+            joined = b"".join(parts) if major == 2 else "".join(parts)
+            return joined, pos
+        raw = bytes(data[pos:pos + n])
+        return (raw if major == 2 else raw.decode("utf-8")), pos + n
+    if major == 4:
+        out = []
+        while n is None or len(out) < n:
+            v, pos = _item(data, pos)
+            if v is BREAK:
+                break
+            out.append(v)
+        return out, pos
+    if major == 5:
+        out = {}
+        while n is None or len(out) < n:
+            k, pos = _item(data, pos)
+            if k is BREAK:
+                break
+            v, pos = _item(data, pos)
+            out[k] = v
+        return out, pos
+    if major == 6:
+        v, pos = _item(data, pos)
+        return v, pos   # Tags are not used by the clock; keep the content
+    raise ValueError("bad major type")
+
+
+def loads(data):
+    value, pos = _item(data, 0)
+    if pos != len(data):
+        raise ValueError("%d trailing bytes" % (len(data) - pos))
+    return value
+
+
+def to_json_compatible(v):
+    """Byte strings (the reception history) become integer lists, as in the JSON."""
+    if isinstance(v, (bytes, bytearray)):
+        return list(v)
+    if isinstance(v, list):
+        return [to_json_compatible(x) for x in v]
+    if isinstance(v, dict):
+        return {k: to_json_compatible(x) for k, x in v.items()}
+    return v
+
+
+def fetch(host, path, accept):
+    req = urllib.request.Request("http://%s%s" % (host, path), headers={"Accept": accept})
+    with urllib.request.urlopen(req, timeout=5) as r:
+        return r.read(), int(r.headers.get("X-Build-Us", "0"))
+
+
+def compare(host, n):
+    print("%-12s %-5s %8s %12s %12s" % ("path", "fmt", "bytes", "build us", "parse us"))
+    for path in ("/api/status", "/api/log"):
+        for fmt, accept, parse in (("json", "application/json", json.loads),
+                                   ("cbor", "application/cbor", loads)):
+            sizes, builds, parses = [], [], []
+            for _ in range(n):
+                body, build_us = fetch(host, path, accept)
+                t0 = time.perf_counter()
+                parse(body)
+                parses.append((time.perf_counter() - t0) * 1e6)
+                sizes.append(len(body))
+                builds.append(build_us)
+            print("%-12s %-5s %8.0f %12.0f %12.0f" % (
+                path, fmt, sum(sizes) / n, sum(builds) / n, sum(parses) / n))
+
+
+def main():
+    ap = argparse.ArgumentParser(description=__doc__, formatter_class=argparse.RawDescriptionHelpFormatter)
+    sub = ap.add_subparsers(dest="cmd", required=True)
+    d = sub.add_parser("decode")
+    d.add_argument("file")
+    g = sub.add_parser("get")
+    g.add_argument("host")
+    g.add_argument("path", nargs="?", default="/api/status")
+    c = sub.add_parser("compare")
+    c.add_argument("host")
+    c.add_argument("-n", type=int, default=20)
+    a = ap.parse_args()
+
+    if a.cmd == "decode":
+        with open(a.file, "rb") as f:
+            doc = loads(f.read())
+        json.dump(to_json_compatible(doc), sys.stdout, indent=2)
+        print()
+    elif a.cmd == "get":
+        body, _ = fetch(a.host, a.path, "application/cbor")
+        json.dump(to_json_compatible(loads(body)), sys.stdout, indent=2)
+        print()
+    else:
+        compare(a.host, a.n)
+
+
+if __name__ == "__main__":
+    main()
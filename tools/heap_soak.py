@@ -0,0 +1,138 @@
+#!/usr/bin/env python3
+"""
+Soak the clock's HTTP and NTP services and check that the heap stays flat.
+
+  heap_soak.py HOST [--weeks W] [--rate R] [--every N] [--ntp-per-round K]
+
+One round is what a dashboard left open does in 30 s: the status page, a JSON
+and a CBOR /api/status poll, /api/log, /api/events and /api/clients, plus K
+NTP queries. A week is 20160 rounds. Running rounds back to back at R per
+second compresses weeks into minutes (at the default rate one week takes
+about 17 minutes).
+
+Every N rounds /api/heap is read. At the end a least-squares line is fitted
+to free bytes and to the largest free block against simulated days. The run
+passes when neither trend loses more than --max-loss-pct per simulated week.
+Standard library only.
+"""
+
+import argparse
+import json
+import socket
+import sys
+import time
+import urllib.request
+
+ROUNDS_PER_WEEK = 7 * 24 * 3600 // 30
+PATHS = [
+    ("/", None),
+    ("/api/status", None),
+    ("/api/status", "application/cbor"),
+    ("/api/log", None),
+    ("/api/events", None),
+    ("/api/clients", None),
+]
+
+
+def fetch(host, path, accept=None, timeout=5.0):
+    req = urllib.request.Request("http://%s%s" % (host, path))
+    if accept:
+        req.add_header("Accept", accept)
+    with urllib.request.urlopen(req, timeout=timeout) as resp:
+        return resp.read()
+
+
+def ntp_query(host, timeout=1.0):
+    pkt = bytearray(48)
+    pkt[0] = 0x23  # LI=0, VN=4, mode 3 (client)
+    with socket.socket(socket.AF_INET, socket.SOCK_DGRAM) as s:
+        s.settimeout(timeout)
+        s.sendto(pkt, (host, 123))
+        try:
+            data, _ = s.recvfrom(512)
+            return len(data) >= 48
+        except socket.timeout:
+            return False
+
+
+def heap(host):
+    return json.loads(fetch(host, "/api/heap"))
+
+
+def slope(xs, ys):
+    n = len(xs)
+    mx, my = sum(xs) / n, sum(ys) / n
+    sxx = sum((x - mx) ** 2 for x in xs)
+    if sxx == 0:
+        return 0.0
+    return sum((x - mx) * (y - my) for x, y in zip(xs, ys)) / sxx
+
+
+def main():
+    ap = argparse.ArgumentParser(description=__doc__.split("\n")[1])
+    ap.add_argument("host")
+    ap.add_argument("--weeks", type=float, default=2.0, help="simulated weeks (default 2)")
+    ap.add_argument("--rate", type=float, default=20.0, help="rounds per second (default 20)")
+    ap.add_argument("--every", type=int, default=500, help="rounds between heap samples")
+    ap.add_argument("--ntp-per-round", type=int, default=2)
+    ap.add_argument("--max-loss-pct", type=float, default=1.0,
+                    help="allowed loss per simulated week, percent of the first sample")
+    args = ap.parse_args()
+
+    total = int(args.weeks * ROUNDS_PER_WEEK)
+    errors = 0
+    samples = []
+
+    def take(done):
+        h = heap(args.host)
+        i = h["int"]
+        day = done / (ROUNDS_PER_WEEK / 7.0)
+        samples.append((day, i["free"], i["big"], i["min"], i["frag"]))
+        print("day %6.2f  free %7d  big %7d  min %7d  frag %3d%%  errors %d"
+              % (day, i["free"], i["big"], i["min"], i["frag"], errors), flush=True)
+
+    take(0)
+    start = time.monotonic()
+    for done in range(1, total + 1):
+        for path, accept in PATHS:
+            try:
+                fetch(args.host, path, accept)
+            except Exception:
+                errors += 1
+        for _ in range(args.ntp_per_round):
+            if not ntp_query(args.host):
+                errors += 1
+        if done % args.every == 0 or done == total:
+            take(done)
+        # Pace to --rate; a slow device simply runs slower
+        lag = done / args.rate - (time.monotonic() - start)
+        if lag > 0:
+            time.sleep(lag)
+
+    if len(samples) < 3:
+        print("not enough samples")
+        return 2
+
+    # Skip the first sample: buffers that are allocated once (sockets, the
+    # WebServer's request state) appear during the first rounds
+    days = [s[0] for s in samples[1:]]
+    free_w = slope(days, [s[1] for s in samples[1:]]) * 7
+    big_w = slope(days, [s[2] for s in samples[1:]]) * 7
+    free0, big0 = samples[1][1], samples[1][2]
+    free_pct = 100.0 * free_w / free0 if free0 else 0.0
+    big_pct = 100.0 * big_w / big0 if big0 else 0.0
+
+    print()
+    print("simulated %.1f weeks, %d rounds, %d errors, %.0f s wall"
+          % (args.weeks, total, errors, time.monotonic() - start))
+    print("free bytes     %+9.0f per week (%+.2f%%)" % (free_w, free_pct))
+    print("largest block  %+9.0f per week (%+.2f%%)" % (big_w, big_pct))
+    print("low-water mark %d -> %d" % (samples[0][3], samples[-1][3]))
+
+    ok = free_pct > -args.max_loss_pct and big_pct > -args.max_loss_pct
+    print("PASS" if ok else "FAIL: heap trends down")
+    return 0 if ok else 1
+
+
+if __name__ == "__main__":
+    sys.exit(main())
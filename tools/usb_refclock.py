@@ -0,0 +1,250 @@
+#!/usr/bin/env python3
+"""
+Host daemon for the clock's USB-CDC reference-clock protocol.
+
+  usb_refclock.py /dev/ttyACM0 [--sock /run/chrony.wwvb.sock] [--poll 1] [--burst 4]
+  usb_refclock.py --simulate [--sim-offset-us 2500] [--sim-noise-us 20]
+
+Each poll sends --burst requests and keeps the one with the shortest round
+trip, as ntpd and chrony do for noisy paths. The offset is
+((T2 - T1) + (T3 - T4)) / 2, clock minus host. With --sock every kept sample
+goes to chrony's SOCK refclock. Add this to chrony.conf:
+
+  refclock SOCK /run/chrony.wwvb.sock refid WWVB poll 2 precision 1e-5
+
+Every --stats samples the mean offset, jitter (standard deviation of the
+offset), and minimum and mean round trip are printed in microseconds.
+Samples are skipped while the clock reports its time unset or LI=3.
+
+--simulate opens a pty pair and answers on the far end with a clock that runs
+--sim-offset-us ahead of the host, with Gaussian noise on T2/T3. This checks
+the framing, the arithmetic and the chrony path on any Linux box with no
+hardware attached. The frame layout is documented in UsbRefclock.h.
+Standard library only.
+"""
+
+import argparse
+import os
+import random
+import select
+import socket
+import statistics
+import struct
+import sys
+import termios
+import threading
+import time
+import tty
+
+MAGIC = b"WR"
+VERSION = 1
+TYPE_REQ = 0x01
+TYPE_RESP = 0x81
+REQ = struct.Struct("<2sBBIQH")            # magic, type, version, seq, T1, reserved
+RESP = struct.Struct("<2sBBIQqqBBBB")      # ... T2, T3, stratum, leap, flags, reserved
+REQ_LEN = REQ.size + 2
+RESP_LEN = RESP.size + 2
+FLAG_TIME_SET = 0x01
+FLAG_PHASE_LOCKED = 0x02
+CHRONY_SOCK_MAGIC = 0x534F434B
+
+
+def crc16(data, crc=0xFFFF):
+    """CRC-16/CCITT-FALSE, as UsbRefclock::crc16()."""
+    for b in data:
+        crc ^= b << 8
+        for _ in range(8):
+            crc = ((crc << 1) ^ 0x1021) if crc & 0x8000 else crc << 1
+            crc &= 0xFFFF
+    return crc
+
+
+def frame(body):
+    return body + struct.pack("<H", crc16(body))
+
+
+def now_ns():
+    return time.clock_gettime_ns(time.CLOCK_REALTIME)
+
+
+def open_tty(path):
+    fd = os.open(path, os.O_RDWR | os.O_NOCTTY)
+    tty.setraw(fd)
+    return fd
+
+
+class Link:
+    """One request/response exchange at a time over a raw tty fd."""
+
+    def __init__(self, fd, timeout):
+        self.fd = fd
+        self.timeout = timeout
+        self.seq = 0
+        self.buf = b""
+
+    def exchange(self):
+        self.seq = (self.seq + 1) & 0xFFFFFFFF
+        termios.tcflush(self.fd, termios.TCIFLUSH)
+        self.buf = b""
+        t1 = now_ns()
+        os.write(self.fd, frame(REQ.pack(MAGIC, TYPE_REQ, VERSION, self.seq, t1, 0)))
+        deadline = time.monotonic() + self.timeout
+        t4 = None
+        while True:
+            left = deadline - time.monotonic()
+            if left <= 0 or not select.select([self.fd], [], [], left)[0]:
+                return None
+            if t4 is None:
+                t4 = now_ns()              # First byte of the reply is readable
+            self.buf += os.read(self.fd, 256)
+            resp = self._take()
+            if resp is not None:
+                return resp, t1, t4
+
+    def _take(self):
+        while len(self.buf) >= RESP_LEN:
+            i = self.buf.find(MAGIC)
+            if i < 0:
+                self.buf = self.buf[-1:]
+                return None
+            self.buf = self.buf[i:]
+            if len(self.buf) < RESP_LEN:
+                return None
+            body, crc = self.buf[:RESP.size], self.buf[RESP.size:RESP_LEN]
+            if struct.unpack("<H", crc)[0] != crc16(body):
+                self.buf = self.buf[1:]
+                continue
+            f = RESP.unpack(body)
+            self.buf = self.buf[RESP_LEN:]
+            if f[1] == TYPE_RESP and f[2] == VERSION and f[3] == self.seq:
+                return f
+        return None
+
+
+def sample(link, burst):
+    """Best of a burst: (offset_us, delay_us, leap, flags, host_ns) or None."""
+    best = None
+    for _ in range(burst):
+        r = link.exchange()
+        if r is None:
+            continue
+        f, t1, t4 = r
+        t2, t3 = f[5], f[6]
+        t1_us, t4_us = t1 / 1000.0, t4 / 1000.0
+        delay = (t4_us - t1_us) - (t3 - t2)
+        offset = ((t2 - t1_us) + (t3 - t4_us)) / 2.0
+        if best is None or delay < best[1]:
+            best = (offset, delay, f[8], f[9], (t1 + t4) // 2)
+    return best
+
+
+class Chrony:
+    def __init__(self, path):
+        self.path = path
+        self.sock = socket.socket(socket.AF_UNIX, socket.SOCK_DGRAM)
+        self.warned = False
+
+    def send(self, host_ns, offset_us, leap):
+        sec, nsec = divmod(host_ns, 1000000000)
+        msg = struct.pack("@lldiiii", sec, nsec // 1000, offset_us / 1e6, 0, leap, 0,
+                          CHRONY_SOCK_MAGIC)
+        try:
+            self.sock.sendto(msg, self.path)
+            self.warned = False
+        except OSError as e:
+            if not self.warned:
+                print("chrony socket %s: %s" % (self.path, e), file=sys.stderr)
+                self.warned = True
+
+
+def simulate(fd, offset_us, noise_us):
+    """Answer requests on fd as the firmware would, offset_us ahead of the host."""
+    buf = b""
+    while True:
+        data = os.read(fd, 256)
+        rx = now_ns()
+        if not data:
+            return
+        buf += data
+        while len(buf) >= REQ_LEN:
+            i = buf.find(MAGIC)
+            if i < 0:
+                buf = buf[-1:]
+                break
+            buf = buf[i:]
+            if len(buf) < REQ_LEN:
+                break
+            body, crc = buf[:REQ.size], buf[REQ.size:REQ_LEN]
+            if struct.unpack("<H", crc)[0] != crc16(body):
+                buf = buf[1:]
+                continue
+            buf = buf[REQ_LEN:]
+            _, _, _, seq, t1, _ = REQ.unpack(body)
+            t2 = int(rx / 1000 + offset_us + random.gauss(0, noise_us))
+            t3 = int(now_ns() / 1000 + offset_us + random.gauss(0, noise_us))
+            os.write(fd, frame(RESP.pack(MAGIC, TYPE_RESP, VERSION, seq, t1, t2, t3,
+                                         1, 0, FLAG_TIME_SET | FLAG_PHASE_LOCKED, 0)))
+
+
+def main():
+    ap = argparse.ArgumentParser(description=__doc__.split("\n")[1])
+    ap.add_argument("device", nargs="?", help="CDC tty, e.g. /dev/ttyACM0")
+    ap.add_argument("--sock", help="chrony SOCK refclock path")
+    ap.add_argument("--poll", type=float, default=1.0, help="seconds between samples")
+    ap.add_argument("--burst", type=int, default=4, help="exchanges per sample")
+    ap.add_argument("--timeout", type=float, default=0.2, help="reply timeout (s)")
+    ap.add_argument("--stats", type=int, default=16, help="samples per statistics line")
+    ap.add_argument("--count", type=int, default=0, help="stop after this many samples")
+    ap.add_argument("--simulate", action="store_true", help="talk to a simulated clock on a pty")
+    ap.add_argument("--sim-offset-us", type=float, default=2500.0)
+    ap.add_argument("--sim-noise-us", type=float, default=20.0)
+    args = ap.parse_args()
+
+    if args.simulate:
+        master, slave = os.openpty()
+        tty.setraw(master)
+        path = os.ttyname(slave)
+        threading.Thread(target=simulate, args=(master, args.sim_offset_us, args.sim_noise_us),
+                         daemon=True).start()
+        print("simulated clock on %s, %+.1f µs" % (path, args.sim_offset_us))
+    elif args.device:
+        path = args.device
+    else:
+        ap.error("a device or --simulate is required")
+
+    link = Link(open_tty(path), args.timeout)
+    chrony = Chrony(args.sock) if args.sock else None
+    offsets, delays = [], []
+    taken = lost = unsynced = 0
+
+    while args.count == 0 or taken < args.count:
+        start = time.monotonic()
+        s = sample(link, args.burst)
+        if s is None:
+            lost += 1
+        else:
+            offset, delay, leap, flags, host_ns = s
+            if not flags & FLAG_TIME_SET or leap == 3:
+                unsynced += 1
+            else:
+                taken += 1
+                offsets.append(offset)
+                delays.append(delay)
+                if chrony:
+                    chrony.send(host_ns, offset, leap)
+        if len(offsets) >= args.stats or (args.count and taken >= args.count and offsets):
+            jitter = statistics.pstdev(offsets) if len(offsets) > 1 else 0.0
+            print("offset %+10.1f µs  jitter %7.1f µs  delay min %7.1f mean %7.1f µs"
+                  "  (n=%d lost=%d unsynced=%d)"
+                  % (statistics.fmean(offsets), jitter, min(delays), statistics.fmean(delays),
+                     len(offsets), lost, unsynced), flush=True)
+            offsets, delays = [], []
+        time.sleep(max(0.0, args.poll - (time.monotonic() - start)))
+    return 0
+
+
+if __name__ == "__main__":
+    try:
+        sys.exit(main())
+    except KeyboardInterrupt:
+        sys.exit(0)
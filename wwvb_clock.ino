@@ -24,6 +24,7 @@
 #include <RTClib.h>
 #include <esp_sleep.h>
 #include <esp_task_wdt.h>
+#include <esp_timer.h>
 #include <WiFi.h>
 #include <WiFiUdp.h>
 #include "LilyGo_AMOLED.h"
@@ -31,8 +32,25 @@
 #include "TimeManager.h"
 #include "ReceptionHistory.h"
 #include "NTPServer.h"
+#include "PTPServer.h"
+#include "UsbRefclock.h"
+#include "EdgeCapture.h"
+#include "EventLog.h"
+#include "Breadcrumbs.h"
+#include "HeapMonitor.h"
+#include "EnergyMonitor.h"
+#include "StateStore.h"
+#include "MqttPublisher.h"
 #include "CaptivePortal.h"
 #include "StatusServer.h"
+#include "WWVBValidator.h"
+#include "LatencyCalibrator.h"
+#include "PropagationModel.h"
+#include "SyncCadence.h"
+#include "ClockQuality.h"
+#include "ReceptionPolicy.h"
+#include "ClockDiscipline.h"
+#include "LatencyHistogram.h"
 #include "config.h"
 
 // ============================================================================
@@ -64,12 +82,23 @@ RTC_DS3231 rtc;
 TimeManager timeManager;
 ReceptionHistory receptionHistory;
 Preferences preferences;
+WWVBValidator wwvbValidator;
+LatencyCalibrator latencyCalibrator;
+PropagationModel propagation;
+SyncCadence syncCadence;
+ClockQuality clockQuality;                    // Stratum / LI / dispersion state machine
+ReceptionPolicy receptionPolicy;              // Early abort of failing normal-mode receptions
+ClockDiscipline clockDiscipline;
 
 // ============================================================================
 // State Variables
 // ============================================================================
 volatile bool es100InterruptFlag = false;
 volatile unsigned long es100IRQMillis = 0;   // millis() captured at ISR fire
+volatile uint32_t es100IRQMicros = 0;        // micros() captured at ISR fire (latency calibration)
+uint8_t es100FrameReadFailures = 0;           // Consecutive failed IRQ register bursts
+LatencyHistogram irqServiceLatency;           // ES100 IRQ edge → clock corrected (µs)
+EdgeCapture edgeCapture;                      // MCPWM hardware stamps for SQW / ES100 IRQ edges
 bool es100Receiving = false;
 bool es100Available = false;
 bool es100TrackingReady = false;        // True after a successful normal-mode decode
@@ -83,12 +112,32 @@ unsigned long lastSyncAttempt = 0;
 uint8_t daytimeFailures = 0;          // Consecutive daytime sync failures
 bool daytimeSkipActive = false;       // True when backed off until nighttime
 int8_t utcOffset = DEFAULT_UTC_OFFSET;
-bool dstActive = false;
-unsigned long lastDSTCheck = 0;  // millis() of last auto-DST computation
+bool dstActive = false;                 // Loop task only; the DST timer just raises dstTimerFired
+
+// Next DST transition (local wall-clock date/hour), from the ES100 NEXT_DST
+// registers or the US rule.  Armed as a one-shot esp_timer; no periodic polling.
+struct DSTTransition {
+    uint16_t year;
+    uint8_t  month;
+    uint8_t  day;
+    uint8_t  hour;          // Local wall-clock hour of the change
+    bool     toDst;         // dstActive after the change
+    bool     fromWWVB;      // Decoded from a WWVB frame (vs computed rule)
+    bool     valid;
+};
+DSTTransition nextDST = {};
+esp_timer_handle_t dstTimer = nullptr;
+volatile bool dstTimerFinal = false;    // Armed shot lands on the transition itself
+volatile bool dstTimerFired = false;    // Set by the timer callback, handled in loop()
 
 // Leap second warning decoded from WWVB frame (0=none, 1=positive, 2=negative)
 uint8_t wwvbLeapSecondWarning = 0;
 
+// Re-reception requested to confirm a held (unconfirmed) WWVB step
+bool wwvbConfirmPending = false;
+bool wwvbConfirmTracking = false;       // Confirm with tracking mode (vs normal)
+unsigned long wwvbConfirmAtMs = 0;      // millis() when the confirmation attempt may start
+
 // Per-antenna sync success counters (persisted in NVS)
 uint16_t ant1Successes = 0;
 uint16_t ant2Successes = 0;
@@ -115,6 +164,7 @@ unsigned long lastRtcSqwStatusLogMillis = 0;
 bool rtcWritePending = false;
 bool rtcWriteDonePending = false;   // true for one SQW edge after DS3231 write
 uint16_t rtcWriteSubsecMs = 0;     // milliseconds into current second at write time
+int32_t rtcPhaseTrimUs = 0;        // Discipline trim of the SQW phase anchor (µs, + = later)
 
 // Low battery tracking
 bool lowBatteryAlerted = false;         // True once 10% alert has been triggered
@@ -173,8 +223,9 @@ enum WiFiState {
 };
 
 WiFiState wifiState = WIFI_STATE_OFF;
-String wifiSSID, wifiPassword;
-String scannedSSIDs[WIFI_MAX_NETWORKS];
+char wifiSSID[WIFI_SSID_MAX + 1] = "";
+char wifiPassword[WIFI_PASS_MAX + 1] = "";
+char scannedSSIDs[WIFI_MAX_NETWORKS][WIFI_SSID_MAX + 1];
 int8_t scannedRSSI[WIFI_MAX_NETWORKS];
 bool scannedSecure[WIFI_MAX_NETWORKS];
 uint8_t scannedCount = 0;
@@ -186,13 +237,21 @@ unsigned long wifiDisconnectMillis = 0;  // millis() when disconnect was detecte
 unsigned long wifiIdleRetryMillis = 0;   // millis() for next IDLE retry attempt
 const unsigned long WIFI_RECONNECT_DELAY_MS = 5000;  // 5 second delay before reconnecting
 const unsigned long WIFI_IDLE_RETRY_INTERVAL_MS = 30000;  // Retry every 30s in IDLE with saved credentials
-String wifiErrorMsg = "";
+const char* wifiErrorMsg = "";
 
 NTPServer ntpServer;
+PTPServer ptpServer;
+#if USB_REFCLOCK
+UsbRefclock usbRefclock;                 // Timestamp frames to a host daemon over USB CDC
+#endif
+#if MQTT_ENABLED
+MqttPublisher mqttPublisher;             // Fleet telemetry (publish-only)
+#endif
 CaptivePortal captivePortal;
 StatusServer statusServer;
-StatusData statusData;
 bool portalCredsReceived = false;  // Flag: credentials arrived from captive portal, handle in loop
+bool prefsSavePending = false;           // Routine time save waiting for a quiet NTP window
+unsigned long prefsSaveRequestedMs = 0;  // millis() when the pending save was requested
 
 // ============================================================================
 // Forward Declarations
@@ -205,6 +264,7 @@ void startWWVBSyncTracking();
 void recordSyncFailure(bool wasTracking);
 void addSyncLogEntry(bool success, bool tracking, uint8_t antenna);
 void processDS3231SquareWave();
+void handleCycleComplete();
 
 // ============================================================================
 // On-Screen Keyboard State
@@ -241,16 +301,27 @@ static const char KB_ROW3_SYM[]   = ")-_+=[]";
 // ============================================================================
 // Interrupt Service Routine
 // ============================================================================
-void IRAM_ATTR es100ISR() {
-    es100IRQMillis = millis();    // Capture time at IRQ edge (IRAM-safe on ESP32)
+// Edge handlers take the edge time in micros(): the MCPWM capture stamp when
+// EdgeCapture is running, otherwise micros() on entry to the GPIO ISR below.
+void IRAM_ATTR es100Edge(uint32_t edgeMicros) {
+    es100IRQMicros = edgeMicros;
+    es100IRQMillis = millis();
     es100InterruptFlag = true;    // Set flag after timestamp for ordering guarantee
 }
 
-void IRAM_ATTR rtcSqwISR() {
-    rtcSqwEdgeMicros = micros();
+void IRAM_ATTR rtcSqwEdge(uint32_t edgeMicros) {
+    rtcSqwEdgeMicros = edgeMicros;
     rtcSqwInterruptFlag = true;
 }
 
+void IRAM_ATTR es100ISR() {
+    es100Edge(micros());          // Capture time at IRQ edge (IRAM-safe on ESP32)
+}
+
+void IRAM_ATTR rtcSqwISR() {
+    rtcSqwEdge(micros());
+}
+
 // ============================================================================
 // Battery Percentage (LiPo discharge curve)
 // ============================================================================
@@ -292,18 +363,18 @@ int lipoBatteryPercent(uint16_t mv) {
 // Display Functions
 // ============================================================================
 void initDisplay() {
-    Serial.println("[DISPLAY] Starting AMOLED initialization...");
+    Log.event(LOG_SEV_DEBUG, "[DISPLAY] Starting AMOLED initialization...");
 
     // Initialize LilyGo AMOLED - auto-detects board type
     if (!amoled.begin()) {
-        Serial.println("[DISPLAY] ERROR: AMOLED initialization failed!");
-        Serial.println("[DISPLAY] Check power connections and board selection");
+        Log.event(LOG_SEV_ERR, "[DISPLAY] ERROR: AMOLED initialization failed!");
+        Log.event(LOG_SEV_ERR, "[DISPLAY] Check power connections and board selection");
         while (1) {
             delay(1000);
-            Serial.println("[DISPLAY] HALTED - AMOLED init failed");
+            Log.event(LOG_SEV_ERR, "[DISPLAY] HALTED - AMOLED init failed");
         }
     }
-    Serial.println("[DISPLAY] AMOLED initialized successfully");
+    Log.event(LOG_SEV_INFO, "[DISPLAY] AMOLED initialized successfully");
 
     // IMPORTANT: Give the display time to fully initialize
     delay(100);
@@ -316,7 +387,7 @@ void initDisplay() {
     DISPLAY_WIDTH = amoled.width();
     DISPLAY_HEIGHT = amoled.height();
 
-    Serial.printf("Display initialized: %d x %d\n", DISPLAY_WIDTH, DISPLAY_HEIGHT);
+    Log.event(LOG_SEV_INFO, "Display initialized: %d x %d", DISPLAY_WIDTH, DISPLAY_HEIGHT);
 
     // Calculate layout positions dynamically based on display orientation
     // Different layouts for landscape vs portrait mode
@@ -342,7 +413,7 @@ void initDisplay() {
     utcOffset = preferences.getChar("utcOffset", DEFAULT_UTC_OFFSET);
     preferences.end();
     amoled.setBrightness(currentBrightness);
-    Serial.printf("[DISPLAY] Brightness set to %d\n", currentBrightness);
+    Log.event(LOG_SEV_DEBUG, "[DISPLAY] Brightness set to %d", currentBrightness);
 
     // Calculate slider geometry based on display dimensions
     sliderX = 40;
@@ -355,50 +426,53 @@ void initDisplay() {
 
     // Check PSRAM availability (warn but continue if not found)
     if (!psramFound()) {
-        Serial.println("WARNING: PSRAM not detected!");
-        Serial.println("Sprite creation may fail. Check platformio.ini PSRAM settings.");
+        Log.event(LOG_SEV_WARNING, "WARNING: PSRAM not detected!");
+        Log.event(LOG_SEV_WARNING, "Sprite creation may fail. Check platformio.ini PSRAM settings.");
     } else {
-        Serial.printf("PSRAM available: %d bytes free\n", ESP.getFreePsram());
+        Log.event(LOG_SEV_INFO, "PSRAM available: %d bytes free", ESP.getFreePsram());
     }
 
     // Create sprite for entire screen (double-buffering)
-    Serial.printf("[DISPLAY] Creating sprite: %d x %d (%lu bytes)\n",
+    Log.event(LOG_SEV_DEBUG, "[DISPLAY] Creating sprite: %d x %d (%lu bytes)",
                  DISPLAY_WIDTH, DISPLAY_HEIGHT,
                  (unsigned long)(DISPLAY_WIDTH * DISPLAY_HEIGHT * 2));
 
     void* spritePtr = sprite.createSprite(DISPLAY_WIDTH, DISPLAY_HEIGHT);
     if (spritePtr == nullptr) {
-        Serial.println("[DISPLAY] ERROR: Sprite creation failed - not enough memory!");
-        Serial.printf("[DISPLAY] Free heap: %d, Free PSRAM: %d\n",
+        Log.event(LOG_SEV_ERR, "[DISPLAY] ERROR: Sprite creation failed - not enough memory!");
+        Log.event(LOG_SEV_ERR, "[DISPLAY] Free heap: %d, Free PSRAM: %d",
                      ESP.getFreeHeap(), ESP.getFreePsram());
         while (1) {
             delay(1000);
-            Serial.println("[DISPLAY] HALTED - Sprite creation failed");
+            Log.event(LOG_SEV_ERR, "[DISPLAY] HALTED - Sprite creation failed");
         }
     }
-    Serial.println("[DISPLAY] Sprite created successfully");
+    Log.event(LOG_SEV_DEBUG, "[DISPLAY] Sprite created successfully");
 
     sprite.setSwapBytes(true);
-    Serial.println("[DISPLAY] Sprite configured (setSwapBytes)");
+    Log.event(LOG_SEV_DEBUG, "[DISPLAY] Sprite configured (setSwapBytes)");
 
     // Clear sprite
     sprite.fillSprite(COLOR_BACKGROUND);
-    Serial.println("[DISPLAY] Sprite cleared");
+    Log.event(LOG_SEV_DEBUG, "[DISPLAY] Sprite cleared");
 
     // Clear screen to black
-    Serial.println("[DISPLAY] Clearing screen to black...");
+    Log.event(LOG_SEV_DEBUG, "[DISPLAY] Clearing screen to black...");
     sprite.fillSprite(TFT_BLACK);
     amoled.pushColors(0, 0, DISPLAY_WIDTH, DISPLAY_HEIGHT, (uint16_t*)sprite.getPointer());
 
     // Give display time to update
     delay(50);
 
-    Serial.println("[DISPLAY] Display initialization complete!");
+    Log.event(LOG_SEV_INFO, "[DISPLAY] Display initialization complete!");
 }
 
 void pushDisplay() {
     // Push the sprite buffer to the AMOLED display
     amoled.pushColors(0, 0, DISPLAY_WIDTH, DISPLAY_HEIGHT, (uint16_t*)sprite.getPointer());
+    // AMOLED draw scales with how much of the frame is lit
+    Energy.noteFrame((const uint16_t*)sprite.getPointer(),
+                     (uint32_t)DISPLAY_WIDTH * DISPLAY_HEIGHT);
 }
 
 void drawCenteredText(const char* text, int y, uint16_t color, uint8_t textSize) {
@@ -949,7 +1023,7 @@ void drawShutdownOverlay(unsigned long holdDuration) {
 // Deep Sleep Shutdown
 // ============================================================================
 void performShutdown() {
-    Serial.println("[SHUTDOWN] Initiating deep sleep...");
+    Log.event(LOG_SEV_NOTICE, "[SHUTDOWN] Initiating deep sleep...");
 
     // Show shutdown message
     sprite.fillSprite(TFT_BLACK);
@@ -963,7 +1037,7 @@ void performShutdown() {
     preferences.begin("wwvb", false);
     preferences.putUChar("brightness", currentBrightness);
     preferences.end();
-    Serial.printf("[SHUTDOWN] Brightness %d saved\n", currentBrightness);
+    Log.event(LOG_SEV_DEBUG, "[SHUTDOWN] Brightness %d saved", currentBrightness);
 
     // Save current time
     saveTimeToPreferences();
@@ -975,8 +1049,8 @@ void performShutdown() {
 
     // Configure touch pin as wakeup source (touch press pulls IRQ low)
     esp_sleep_enable_ext0_wakeup(GPIO_NUM_21, 0);
-    Serial.println("[SHUTDOWN] Entering deep sleep (touch to wake)");
-    Serial.flush();
+    Log.event(LOG_SEV_NOTICE, "[SHUTDOWN] Entering deep sleep (touch to wake)");
+    Log.flush();
 
     esp_deep_sleep_start();
 }
@@ -1011,7 +1085,7 @@ void wifiScan() {
     delay(100);
 
     // Use synchronous scan — blocks ~2-4s but is reliable on ESP32-S3
-    Serial.println("[WIFI] Scan starting (synchronous)...");
+    Log.event(LOG_SEV_DEBUG, "[WIFI] Scan starting (synchronous)...");
     wifiState = WIFI_STATE_SCANNING;
     updateDisplay();  // Show "Scanning..." on screen immediately
 
@@ -1020,29 +1094,21 @@ void wifiScan() {
 
     if (result > 0) {
         scannedCount = min((int)result, (int)WIFI_MAX_NETWORKS);
+        captivePortal.clearNetworks();
         for (int i = 0; i < scannedCount; i++) {
-            scannedSSIDs[i] = WiFi.SSID(i);
+            strlcpy(scannedSSIDs[i], WiFi.SSID(i).c_str(), sizeof(scannedSSIDs[i]));
             scannedRSSI[i] = WiFi.RSSI(i);
             scannedSecure[i] = (WiFi.encryptionType(i) != WIFI_AUTH_OPEN);
-            Serial.printf("[WIFI]   %d: %s (%d dBm) %s\n", i,
-                         scannedSSIDs[i].c_str(), scannedRSSI[i],
+            captivePortal.addNetwork(scannedSSIDs[i], scannedRSSI[i], scannedSecure[i]);
+            Log.event(LOG_SEV_DEBUG, "[WIFI]   %d: %s (%d dBm) %s", i,
+                         scannedSSIDs[i], scannedRSSI[i],
                          scannedSecure[i] ? "secured" : "open");
         }
-        Serial.printf("[WIFI] Scan complete: %d networks found\n", scannedCount);
-
-        // Build HTML options for captive portal
-        String htmlOptions = "";
-        for (int i = 0; i < scannedCount; i++) {
-            htmlOptions += "<option value='" + scannedSSIDs[i] + "'>" + scannedSSIDs[i];
-            htmlOptions += " (" + String(scannedRSSI[i]) + " dBm)";
-            if (scannedSecure[i]) htmlOptions += " secured";
-            htmlOptions += "</option>";
-        }
-        captivePortal.setNetworkList(htmlOptions);
+        Log.event(LOG_SEV_INFO, "[WIFI] Scan complete: %d networks found", scannedCount);
         WiFi.scanDelete();
     } else {
         scannedCount = 0;
-        Serial.printf("[WIFI] Scan returned %d (0=none found, -1=running, -2=failed)\n", result);
+        Log.event(LOG_SEV_WARNING, "[WIFI] Scan returned %d (0=none found, -1=running, -2=failed)", result);
     }
 
     wifiState = WIFI_STATE_IDLE;
@@ -1055,21 +1121,22 @@ void wifiCheckScanResults() {
     // Synchronous scan handles results inline in wifiScan()
 }
 
-void wifiConnect(const String& ssid, const String& password) {
-    wifiSSID = ssid;
-    wifiPassword = password;
+void wifiConnect(const char* ssid, const char* password) {
+    // Callers often pass the saved credentials themselves
+    if (ssid != wifiSSID) strlcpy(wifiSSID, ssid, sizeof(wifiSSID));
+    if (password != wifiPassword) strlcpy(wifiPassword, password, sizeof(wifiPassword));
     wifiErrorMsg = "";
 
     WiFi.mode(WIFI_STA);
     WiFi.setMinSecurity(WIFI_AUTH_WEP);  // Allow all security types including WPA/mixed
     delay(100);
 
-    WiFi.begin(ssid.c_str(), password.c_str());
+    WiFi.begin(wifiSSID, wifiPassword);
     wifiConnectStart = millis();
     wifiState = WIFI_STATE_CONNECTING;
 
-    Serial.printf("[WIFI] Connecting to: %s (mode=%d, pw_len=%d)\n",
-                  ssid.c_str(), WiFi.getMode(), password.length());
+    Log.event(LOG_SEV_INFO, "[WIFI] Connecting to: %s (mode=%d, pw_len=%u)",
+                  wifiSSID, WiFi.getMode(), (unsigned)strlen(wifiPassword));
 }
 
 void wifiCheckConnection() {
@@ -1078,26 +1145,50 @@ void wifiCheckConnection() {
         wifiDisconnectMillis = 0;  // Clear disconnect tracking on successful reconnect
         wifiIdleRetryMillis = 0;   // Clear idle retry tracking
         wifiErrorMsg = "";
-        Serial.printf("[WIFI] Connected! IP: %s\n", WiFi.localIP().toString().c_str());
+        Log.event(LOG_SEV_NOTICE, "[WIFI] Connected! IP: %s", WiFi.localIP().toString().c_str());
 
-        // Save credentials
+        // Save credentials — only when they changed, so routine reconnects
+        // don't issue flash writes while the NTP server is answering clients
         preferences.begin("wifi", false);
-        preferences.putString("ssid", wifiSSID);
-        preferences.putString("pass", wifiPassword);
+        char savedSSID[WIFI_SSID_MAX + 1] = "";
+        char savedPass[WIFI_PASS_MAX + 1] = "";
+        preferences.getString("ssid", savedSSID, sizeof(savedSSID));
+        preferences.getString("pass", savedPass, sizeof(savedPass));
+        if (strcmp(savedSSID, wifiSSID) != 0 || strcmp(savedPass, wifiPassword) != 0) {
+            preferences.putString("ssid", wifiSSID);
+            preferences.putString("pass", wifiPassword);
+            Log.event(LOG_SEV_INFO, "[WIFI] Credentials saved");
+        }
         preferences.end();
-        Serial.println("[WIFI] Credentials saved");
 
         // Start NTP server on the local network
         if (!ntpServer.isRunning()) {
             ntpServer.begin(&timeManager);
         }
+#if PTP_ENABLED
+        if (!ptpServer.isRunning()) {
+            ptpServer.begin(&timeManager);
+        }
+#endif
 
         // Start status web server on the local network
         if (!statusServer.isRunning()) {
             statusServer.setTimeManager(&timeManager);
             statusServer.setNTPServer(&ntpServer);
-            statusServer.setStatusData(&statusData);
+            statusServer.setPTPServer(&ptpServer);
+#if USB_REFCLOCK
+            statusServer.setUsbRefclock(&usbRefclock);
+#endif
             statusServer.setReceptionHistory(&receptionHistory);
+            statusServer.setWWVBValidator(&wwvbValidator);
+            statusServer.setLatencyCalibrator(&latencyCalibrator);
+            statusServer.setPropagationModel(&propagation);
+            statusServer.setSyncCadence(&syncCadence);
+            statusServer.setClockQuality(&clockQuality);
+            statusServer.setReceptionPolicy(&receptionPolicy);
+            statusServer.setClockDiscipline(&clockDiscipline);
+            statusServer.setIRQLatencyHistogram(&irqServiceLatency);
+            statusServer.setEdgeCapture(&edgeCapture);
             statusServer.setOnSyncRequest([]() {
                 daytimeSkipActive = false;
                 daytimeFailures = 0;
@@ -1115,8 +1206,8 @@ void wifiCheckConnection() {
                 preferences.putChar("utcOffset", utcOffset);
                 preferences.putBool("dst", dstActive);
                 preferences.end();
-                captivePortal.setTimezone(utcOffset, dstActive);
-                Serial.printf("[SETTINGS] UTC offset=%+d DST=%s (via web)\n",
+                armDSTTimer();  // Transition instant is local time; offset changed
+                Log.event(LOG_SEV_NOTICE, "[SETTINGS] UTC offset=%+d DST=%s (via web)",
                               utcOffset, dstActive ? "on" : "off");
             });
             statusServer.setSyncLog(syncLog, &syncLogHead, &syncLogFilled);
@@ -1136,20 +1227,20 @@ void wifiCheckConnection() {
         }
         // TIME_SRC_WWVB: never — preserves Stratum 1
         if (shouldNtpSync) {
-            Serial.println("[WIFI] Auto-syncing time from NTP...");
+            Log.event(LOG_SEV_INFO, "[WIFI] Auto-syncing time from NTP...");
             ntpClientSync();
         }
     } else if (millis() - wifiConnectStart > WIFI_CONNECT_TIMEOUT) {
         wifiState = WIFI_STATE_IDLE;
         wifiErrorMsg = "Connection failed";
         WiFi.disconnect();
-        Serial.println("[WIFI] Connection timeout");
+        Log.event(LOG_SEV_WARNING, "[WIFI] Connection timeout");
     }
 }
 
 void wifiStartAP() {
-    Serial.println("[WIFI] Starting AP mode...");
-    Serial.flush();
+    Log.event(LOG_SEV_INFO, "[WIFI] Starting AP mode...");
+    Log.flush();
 
     // Clean up any prior STA state before switching to AP
     WiFi.scanDelete();
@@ -1160,21 +1251,21 @@ void wifiStartAP() {
     // as the ESP32-S3 WiFi driver crashes on OFF→AP transitions
     bool apOk = WiFi.softAP(WIFI_AP_SSID);  // softAP() handles mode switch internally
     if (!apOk) {
-        Serial.println("[WIFI] softAP failed!");
+        Log.event(LOG_SEV_ERR, "[WIFI] softAP failed!");
         wifiErrorMsg = "AP start failed";
         wifiState = WIFI_STATE_IDLE;
         return;
     }
     delay(500);  // Let AP fully stabilize before starting servers
 
-    Serial.printf("[WIFI] AP started: %s  IP: %s\n",
+    Log.event(LOG_SEV_NOTICE, "[WIFI] AP started: %s  IP: %s",
                  WIFI_AP_SSID, WiFi.softAPIP().toString().c_str());
-    Serial.flush();
+    Log.flush();
 
-    captivePortal.setOnCredentials([](const String& ssid, const String& password) {
-        Serial.printf("[PORTAL] Got credentials for: %s\n", ssid.c_str());
-        wifiSSID = ssid;
-        wifiPassword = password;
+    captivePortal.setOnCredentials([](const char* ssid, const char* password) {
+        Log.event(LOG_SEV_NOTICE, "[PORTAL] Got credentials for: %s", ssid);
+        strlcpy(wifiSSID, ssid, sizeof(wifiSSID));
+        strlcpy(wifiPassword, password, sizeof(wifiPassword));
         // Don't stop AP or connect here — we're inside the HTTP handler.
         // Tearing down WiFi from within its own callback crashes the driver.
         // Set a flag and handle the AP→STA transition in wifiLoop().
@@ -1184,49 +1275,56 @@ void wifiStartAP() {
     // Start NTP server on AP so connected clients can get time
     if (!ntpServer.isRunning()) {
         ntpServer.begin(&timeManager);
-        Serial.println("[WIFI] NTP server started on AP");
+        Log.event(LOG_SEV_INFO, "[WIFI] NTP server started on AP");
     }
 
     // Give captive portal access to time for the clock display
     captivePortal.setTimeManager(&timeManager);
-    captivePortal.setTimezone(utcOffset, dstActive);
-    captivePortal.setTimeSource((uint8_t)lastTimeSource);
 
     // Start DNS + HTTP servers on the AP
-    Serial.println("[WIFI] Starting portal servers...");
-    Serial.flush();
+    Log.event(LOG_SEV_DEBUG, "[WIFI] Starting portal servers...");
+    Log.flush();
     captivePortal.begin();
     wifiState = WIFI_STATE_AP_MODE;
-    Serial.println("[WIFI] AP mode fully started");
+    Log.event(LOG_SEV_INFO, "[WIFI] AP mode fully started");
 }
 
 void wifiStopAP() {
     ntpServer.stop();
+    ptpServer.stop();
     statusServer.stop();
     captivePortal.stop();
     WiFi.softAPdisconnect(false);  // Stop AP but don't deinit WiFi driver
     WiFi.mode(WIFI_STA);           // Back to STA mode
     wifiState = WIFI_STATE_OFF;
-    Serial.println("[WIFI] AP mode stopped");
+    Log.event(LOG_SEV_INFO, "[WIFI] AP mode stopped");
 }
 
 bool wifiLoadCredentials() {
     preferences.begin("wifi", true);
     bool hasSSID = preferences.isKey("ssid");
     if (hasSSID) {
-        wifiSSID = preferences.getString("ssid", "");
-        wifiPassword = preferences.getString("pass", "");
+        wifiSSID[0] = wifiPassword[0] = '\0';
+        preferences.getString("ssid", wifiSSID, sizeof(wifiSSID));
+        preferences.getString("pass", wifiPassword, sizeof(wifiPassword));
     }
     preferences.end();
 
-    if (hasSSID && wifiSSID.length() > 0) {
-        Serial.printf("[WIFI] Loaded credentials for: %s\n", wifiSSID.c_str());
+    if (hasSSID && wifiSSID[0] != '\0') {
+        Log.event(LOG_SEV_INFO, "[WIFI] Loaded credentials for: %s", wifiSSID);
         return true;
     }
     return false;
 }
 
 void wifiLoop() {
+    // Transitions happen in many places; record them once per pass here
+    static WiFiState crumbState = WIFI_STATE_OFF;
+    if (wifiState != crumbState) {
+        crumbState = wifiState;
+        Crumbs.trace(CRUMB_WIFI_STATE, wifiState);
+    }
+
     switch (wifiState) {
         case WIFI_STATE_SCANNING:
             wifiCheckScanResults();
@@ -1239,16 +1337,20 @@ void wifiLoop() {
             if (WiFi.status() != WL_CONNECTED) {
                 if (wifiDisconnectMillis == 0) {
                     // First detection of disconnect
-                    Serial.println("[WIFI] Connection lost, scheduling reconnect...");
+                    Log.event(LOG_SEV_WARNING, "[WIFI] Connection lost, scheduling reconnect...");
                     ntpServer.stop();
+                    ptpServer.stop();
                     statusServer.stop();
+#if MQTT_ENABLED
+                    mqttPublisher.stop();
+#endif
                     wifiDisconnectMillis = millis();
                 }
 
                 // Wait for reconnect delay before attempting to reconnect
                 if (millis() - wifiDisconnectMillis >= WIFI_RECONNECT_DELAY_MS) {
                     wifiDisconnectMillis = 0;  // Reset for next disconnect
-                    if (wifiSSID.length() > 0) {
+                    if (wifiSSID[0] != '\0') {
                         wifiConnect(wifiSSID, wifiPassword);
                     } else {
                         wifiState = WIFI_STATE_IDLE;
@@ -1258,10 +1360,10 @@ void wifiLoop() {
             break;
         case WIFI_STATE_IDLE:
             // Periodically retry connection if credentials are saved
-            if (wifiSSID.length() > 0) {
+            if (wifiSSID[0] != '\0') {
                 if (wifiIdleRetryMillis == 0 || millis() - wifiIdleRetryMillis >= WIFI_IDLE_RETRY_INTERVAL_MS) {
                     wifiIdleRetryMillis = millis();
-                    Serial.println("[WIFI] Attempting reconnect from IDLE with saved credentials...");
+                    Log.event(LOG_SEV_INFO, "[WIFI] Attempting reconnect from IDLE with saved credentials...");
                     wifiConnect(wifiSSID, wifiPassword);
                 }
             }
@@ -1270,7 +1372,7 @@ void wifiLoop() {
             // Check if captive portal received credentials
             if (portalCredsReceived) {
                 portalCredsReceived = false;
-                Serial.println("[WIFI] Portal credentials received, shutting down AP...");
+                Log.event(LOG_SEV_INFO, "[WIFI] Portal credentials received, shutting down AP...");
                 // 1. Stop HTTP/DNS servers (WiFi untouched)
                 captivePortal.stop();
                 delay(100);
@@ -1467,10 +1569,8 @@ void processKeyboardInput(char key) {
     } else if (key == '\n') {
         // Connect button pressed
         if (selectedNetwork >= 0 && selectedNetwork < scannedCount) {
-            String ssid = scannedSSIDs[selectedNetwork];
-            String pass = String(passwordBuffer);
             kbMode = KB_HIDDEN;
-            wifiConnect(ssid, pass);
+            wifiConnect(scannedSSIDs[selectedNetwork], passwordBuffer);
         }
     } else if (key == ' ' || (key >= 32 && key <= 126)) {
         // Regular character
@@ -1551,7 +1651,7 @@ void drawWiFiPageStatus() {
         sprite.drawString(rssiStr, DISPLAY_WIDTH - 10, 30);
 
         sprite.setTextDatum(TL_DATUM);
-        sprite.drawString(wifiSSID.c_str(), 10, 55);
+        sprite.drawString(wifiSSID, 10, 55);
     } else if (wifiState == WIFI_STATE_SCANNING) {
         sprite.setTextColor(COLOR_SYNC_PENDING, COLOR_BACKGROUND);
         sprite.drawString("Scanning...", DISPLAY_WIDTH - 10, 5);
@@ -1570,10 +1670,10 @@ void drawWiFiPageStatus() {
     }
 
     // Error message
-    if (wifiErrorMsg.length() > 0) {
+    if (wifiErrorMsg[0] != '\0') {
         sprite.setTextDatum(TC_DATUM);
         sprite.setTextColor(COLOR_SYNC_FAIL, COLOR_BACKGROUND);
-        sprite.drawString(wifiErrorMsg.c_str(), DISPLAY_WIDTH / 2, 32);
+        sprite.drawString(wifiErrorMsg, DISPLAY_WIDTH / 2, 32);
     }
 }
 
@@ -1603,7 +1703,7 @@ void drawWiFiNetworkList() {
         }
 
         // Connected indicator
-        if (wifiState == WIFI_STATE_CONNECTED && scannedSSIDs[idx] == wifiSSID) {
+        if (wifiState == WIFI_STATE_CONNECTED && strcmp(scannedSSIDs[idx], wifiSSID) == 0) {
             sprite.setTextColor(COLOR_SYNC_OK, (idx == selectedNetwork) ? 0x2104 : COLOR_BACKGROUND);
             sprite.setTextDatum(TL_DATUM);
             sprite.setTextSize(1);
@@ -1617,11 +1717,13 @@ void drawWiFiNetworkList() {
         sprite.setTextSize(1);
 
         // Truncate long SSIDs
-        String displaySSID = scannedSSIDs[idx];
-        if (displaySSID.length() > 28) {
-            displaySSID = displaySSID.substring(0, 25) + "...";
+        char displaySSID[29];
+        if (strlen(scannedSSIDs[idx]) > 28) {
+            snprintf(displaySSID, sizeof(displaySSID), "%.25s...", scannedSSIDs[idx]);
+        } else {
+            strlcpy(displaySSID, scannedSSIDs[idx], sizeof(displaySSID));
         }
-        sprite.drawString(displaySSID.c_str(), 14, rowTop + 6);
+        sprite.drawString(displaySSID, 14, rowTop + 6);
 
         // Signal bars
         drawSignalBars(DISPLAY_WIDTH - 60, rowTop + 4, scannedRSSI[idx]);
@@ -1654,8 +1756,9 @@ void drawWiFiPage() {
         sprite.setTextColor(COLOR_TIME, COLOR_BACKGROUND);
         sprite.setTextDatum(TL_DATUM);
         if (selectedNetwork >= 0 && selectedNetwork < scannedCount) {
-            String title = "Connect to: " + scannedSSIDs[selectedNetwork];
-            sprite.drawString(title.c_str(), 10, 5);
+            char title[WIFI_SSID_MAX + 16];
+            snprintf(title, sizeof(title), "Connect to: %s", scannedSSIDs[selectedNetwork]);
+            sprite.drawString(title, 10, 5);
         }
         drawKeyboard();
     } else if (wifiState == WIFI_STATE_CONNECTING) {
@@ -1739,7 +1842,7 @@ void handleWiFiTap(int16_t x, int16_t y) {
             WiFi.disconnect();
             wifiState = WIFI_STATE_IDLE;
             wifiErrorMsg = "Cancelled";
-            Serial.println("[WIFI] Connection cancelled");
+            Log.event(LOG_SEV_INFO, "[WIFI] Connection cancelled");
         }
         return;
     }
@@ -1763,7 +1866,7 @@ void handleWiFiTap(int16_t x, int16_t y) {
         // Sync NTP button (center, only when connected)
         if (wifiState == WIFI_STATE_CONNECTED &&
             x >= DISPLAY_WIDTH / 2 - 55 && x <= DISPLAY_WIDTH / 2 + 55) {
-            Serial.println("[WIFI] Sync NTP button pressed");
+            Log.event(LOG_SEV_INFO, "[WIFI] Sync NTP button pressed");
             ntpClientSync();
             return;
         }
@@ -1780,7 +1883,7 @@ void handleWiFiTap(int16_t x, int16_t y) {
         int tapIdx = (y - listY) / rowH + listScrollOffset;
         if (tapIdx >= 0 && tapIdx < scannedCount) {
             selectedNetwork = tapIdx;
-            Serial.printf("[WIFI] Selected network: %s\n", scannedSSIDs[tapIdx].c_str());
+            Log.event(LOG_SEV_INFO, "[WIFI] Selected network: %s", scannedSSIDs[tapIdx]);
 
             if (scannedSecure[tapIdx]) {
                 // Open keyboard for password entry
@@ -1855,16 +1958,16 @@ void handleTouch() {
             preferences.begin("wwvb", false);
             preferences.putUChar("brightness", currentBrightness);
             preferences.end();
-            Serial.printf("[TOUCH] Brightness saved: %d\n", currentBrightness);
+            Log.event(LOG_SEV_DEBUG, "[TOUCH] Brightness saved: %d", currentBrightness);
         }
         // Swipe detection (disabled when keyboard is visible)
         else if (kbMode == KB_HIDDEN && abs(deltaX) > SWIPE_THRESHOLD_PX && holdDuration < 1000) {
             if (deltaX < -SWIPE_THRESHOLD_PX && currentPage < PAGE_WIFI) {
                 currentPage = (DisplayPage)(currentPage + 1);
-                Serial.printf("[TOUCH] Swipe left -> page %d\n", currentPage);
+                Log.event(LOG_SEV_DEBUG, "[TOUCH] Swipe left -> page %d", currentPage);
             } else if (deltaX > SWIPE_THRESHOLD_PX && currentPage > PAGE_CLOCK) {
                 currentPage = (DisplayPage)(currentPage - 1);
-                Serial.printf("[TOUCH] Swipe right -> page %d\n", currentPage);
+                Log.event(LOG_SEV_DEBUG, "[TOUCH] Swipe right -> page %d", currentPage);
                 // Hide keyboard when leaving WiFi page
                 if (currentPage != PAGE_WIFI) {
                     kbMode = KB_HIDDEN;
@@ -1890,6 +1993,7 @@ void handleTouch() {
                 if (wifiState != WIFI_STATE_OFF) {
                     // Disable WiFi
                     ntpServer.stop();
+                    ptpServer.stop();
                     statusServer.stop();
                     captivePortal.stop();
                     WiFi.disconnect();
@@ -1897,11 +2001,11 @@ void handleTouch() {
                     WiFi.mode(WIFI_OFF);
                     wifiState = WIFI_STATE_OFF;
                     scannedCount = 0;
-                    Serial.println("[WIFI] Radio disabled from settings");
+                    Log.event(LOG_SEV_NOTICE, "[WIFI] Radio disabled from settings");
                 } else {
                     // Enable WiFi — scan for networks
                     wifiScan();
-                    Serial.println("[WIFI] Radio enabled from settings");
+                    Log.event(LOG_SEV_NOTICE, "[WIFI] Radio enabled from settings");
                 }
             } else {
                 // UTC offset +/- button hit test (bottom-right, matches drawSettingsPage)
@@ -1918,15 +2022,15 @@ void handleTouch() {
                         preferences.begin("wwvb", false);
                         preferences.putChar("utcOffset", utcOffset);
                         preferences.end();
-                        captivePortal.setTimezone(utcOffset, dstActive);
-                        Serial.printf("[SETTINGS] UTC offset: %+d\n", utcOffset);
+                        armDSTTimer();
+                        Log.event(LOG_SEV_NOTICE, "[SETTINGS] UTC offset: %+d", utcOffset);
                     } else if (touchStartX >= utcPlusX && touchStartX <= utcPlusX + utcBtnW && utcOffset < 14) {
                         utcOffset++;
                         preferences.begin("wwvb", false);
                         preferences.putChar("utcOffset", utcOffset);
                         preferences.end();
-                        captivePortal.setTimezone(utcOffset, dstActive);
-                        Serial.printf("[SETTINGS] UTC offset: %+d\n", utcOffset);
+                        armDSTTimer();
+                        Log.event(LOG_SEV_NOTICE, "[SETTINGS] UTC offset: %+d", utcOffset);
                     }
                 } else {
                     // Slider tap
@@ -1936,7 +2040,7 @@ void handleTouch() {
                         preferences.begin("wwvb", false);
                         preferences.putUChar("brightness", currentBrightness);
                         preferences.end();
-                        Serial.printf("[TOUCH] Brightness tapped: %d\n", currentBrightness);
+                        Log.event(LOG_SEV_DEBUG, "[TOUCH] Brightness tapped: %d", currentBrightness);
                     }
                 }
             }
@@ -1954,7 +2058,7 @@ void handleTouch() {
 void updateDisplay() {
     static bool firstRun = true;
     if (firstRun) {
-        Serial.println("updateDisplay() called for first time");
+        Log.event(LOG_SEV_DEBUG, "updateDisplay() called for first time");
         firstRun = false;
     }
 
@@ -1994,6 +2098,7 @@ void updateDisplay() {
 // Time Persistence Functions
 // ============================================================================
 void saveTimeToPreferences() {
+    Crumbs.trace(CRUMB_NVS_SAVE);
     preferences.begin("wwvb", false);  // Open in read-write mode
 
     ClockTime utc = timeManager.getUTCTime();
@@ -2006,7 +2111,7 @@ void saveTimeToPreferences() {
     preferences.putBool("dst", dstActive);
     preferences.putULong("saveMillis", millis());
 
-    // Persist tracking state so the 7-day window survives reboots.
+    // Persist tracking state so the tracking fallback window survives reboots.
     // Save the elapsed age (ms since tracking was established); restored on load
     // by reconstructing the reference point with unsigned arithmetic.
     preferences.putBool("trkReady", es100TrackingReady);
@@ -2017,8 +2122,104 @@ void saveTimeToPreferences() {
     preferences.putUShort("ant1ok", ant1Successes);
     preferences.putUShort("ant2ok", ant2Successes);
 
+    // Persist ES100 IRQ latency estimates, the measured clock drift, reception odds
+    // and the energy-model calibration
+    latencyCalibrator.save(preferences);
+    syncCadence.save(preferences);
+    clockQuality.save(preferences);
+    receptionPolicy.save(preferences);
+    Energy.save(preferences);
+
+    // Persist the next DST transition so a reboot re-arms the same schedule
+    saveDSTSchedule();
+
+    preferences.end();
+    Log.event(LOG_SEV_DEBUG, "Time saved to preferences");
+}
+
+/**
+ * @brief Queue a routine saveTimeToPreferences() for the next quiet NTP window
+ * @details NVS writes disable the flash cache; see servicePendingTimeSave().
+ */
+void requestTimeSave() {
+    if (!prefsSavePending) prefsSaveRequestedMs = millis();
+    prefsSavePending = true;
+}
+
+/**
+ * @brief Run a queued time save once NTP clients have gone quiet
+ * @details Waits for NTP_FLASH_QUIET_MS without a datagram, capped at
+ *          NTP_FLASH_MAX_DEFER_MS.  Shutdown saves bypass this and write at once.
+ */
+void servicePendingTimeSave() {
+    if (!prefsSavePending) return;
+    unsigned long now = millis();
+    bool quiet = !ntpServer.isRunning() ||
+                 (now - ntpServer.getLastRequestMillis()) >= NTP_FLASH_QUIET_MS;
+    if (!quiet && (now - prefsSaveRequestedMs) < NTP_FLASH_MAX_DEFER_MS) return;
+    prefsSavePending = false;
+    saveTimeToPreferences();
+}
+
+/**
+ * @brief Wall clock for syslog timestamps
+ * @return false until the time has been set from any source
+ */
+bool logClock(uint32_t& unixSec, uint16_t& ms) {
+    if (!timeManager.isTimeSet()) return false;
+    timeManager.getTimeSnapshot(unixSec, ms);
+    return true;
+}
+
+#if NTP_FLASH_STRESS_INTERVAL_MS > 0
+/**
+ * @brief Served-latency test load: periodic NVS writes regardless of NTP traffic
+ * @details Logs each write's duration with the requests served since the last
+ *          one. Requests held in lwIP during a write are not in ntplat, which
+ *          starts at receive; compare the write time with client-side delay.
+ */
+void runFlashStress() {
+    static unsigned long lastWrite = 0;
+    static uint32_t counter = 0;
+    static uint32_t lastServed = 0;
+    if (millis() - lastWrite < NTP_FLASH_STRESS_INTERVAL_MS) return;
+    lastWrite = millis();
+    uint32_t t0 = micros();
+    preferences.begin("wwvb", false);
+    preferences.putULong("stress", ++counter);
+    preferences.end();
+    uint32_t writeUs = micros() - t0;
+    uint32_t served = ntpServer.getRequestCount();
+    const LatencyHistogram& lat = ntpServer.getServedLatency();
+    Log.event(LOG_SEV_INFO, "[NTP] Flash stress #%lu: write %lu us, %lu served since last, ntplat last %lu max %lu us",
+              (unsigned long)counter, (unsigned long)writeUs, (unsigned long)(served - lastServed),
+              (unsigned long)lat.getLastUs(), (unsigned long)lat.getMaxUs());
+    lastServed = served;
+}
+#endif
+
+/**
+ * @brief Restore persisted sync state that is needed whatever the time source
+ * @details Called at boot before the time is loaded; loadTimeFromPreferences()
+ *          is skipped when the DS3231 already supplied the time.
+ */
+void loadSyncStateFromPreferences() {
+    preferences.begin("wwvb", true);
+    latencyCalibrator.load(preferences);
+    syncCadence.load(preferences);
+    clockQuality.load(preferences);
+    receptionPolicy.load(preferences);
+    Energy.load(preferences);
+    nextDST.valid = preferences.getBool("dstValid", false);
+    if (nextDST.valid) {
+        nextDST.year     = preferences.getUShort("dstYear", 0);
+        nextDST.month    = preferences.getUChar("dstMonth", 0);
+        nextDST.day      = preferences.getUChar("dstDay", 0);
+        nextDST.hour     = preferences.getUChar("dstHour", 0);
+        nextDST.toDst    = preferences.getBool("dstOn", false);
+        nextDST.fromWWVB = preferences.getBool("dstWWVB", false);
+    }
     preferences.end();
-    Serial.println("Time saved to preferences");
 }
 
 bool loadTimeFromPreferences() {
@@ -2027,7 +2228,7 @@ bool loadTimeFromPreferences() {
     // Check if we have saved time data
     if (!preferences.isKey("year")) {
         preferences.end();
-        Serial.println("No saved time found in preferences");
+        Log.event(LOG_SEV_INFO, "No saved time found in preferences");
         return false;
     }
 
@@ -2046,13 +2247,14 @@ bool loadTimeFromPreferences() {
 
     preferences.end();
 
-    // Restore tracking state if it was active and the 7-day window hasn't expired.
+    // Restore tracking state if it was active and the fallback window hasn't expired.
     // Unsigned subtraction reconstructs the original reference point correctly.
-    if (savedTrkReady && savedTrkAge < ES100_TRACKING_FALLBACK_MS) {
+    unsigned long trkFallbackMs = syncCadence.getTrackingFallbackMs();
+    if (savedTrkReady && savedTrkAge < trkFallbackMs) {
         es100TrackingReady = true;
         es100TrackingReadySinceMs = millis() - savedTrkAge;
-        Serial.printf("Tracking state restored (age: %lu ms, %lu ms remaining)\n",
-                     savedTrkAge, ES100_TRACKING_FALLBACK_MS - savedTrkAge);
+        Log.event(LOG_SEV_INFO, "Tracking state restored (age: %lu ms, %lu ms remaining)",
+                     savedTrkAge, trkFallbackMs - savedTrkAge);
     }
 
     // Set the time
@@ -2064,16 +2266,16 @@ bool loadTimeFromPreferences() {
     // Only apply if less than 1 hour (avoids millis() wrap issues)
     if (elapsedMillis < 3600000UL) {  // 3600000ms = 1 hour
         unsigned long elapsedSeconds = elapsedMillis / 1000;
-        Serial.printf("Adjusting time forward by %lu seconds\n", elapsedSeconds);
+        Log.event(LOG_SEV_INFO, "Adjusting time forward by %lu seconds", elapsedSeconds);
         // Manually tick forward the time by elapsed seconds
         for (unsigned long i = 0; i < elapsedSeconds; i++) {
             timeManager.tick();
         }
     } else {
-        Serial.println("Elapsed time too large or millis() wrapped - not adjusting");
+        Log.event(LOG_SEV_WARNING, "Elapsed time too large or millis() wrapped - not adjusting");
     }
 
-    Serial.printf("Loaded time from preferences: %04d-%02d-%02d %02d-%02d:%02d (DST: %s)\n",
+    Log.event(LOG_SEV_INFO, "Loaded time from preferences: %04d-%02d-%02d %02d-%02d:%02d (DST: %s)",
                  year, month, day, hour, minute, second, dstActive ? "Yes" : "No");
     return true;
 }
@@ -2081,58 +2283,84 @@ bool loadTimeFromPreferences() {
 // ============================================================================
 // DS3231 RTC Functions
 // ============================================================================
+
+/**
+ * @brief rtc.now() with the transaction marked for stall forensics
+ */
+DateTime ds3231Now() {
+    I2CCrumb crumb(0, 0x68, 0x00);
+    return rtc.now();
+}
+
+/**
+ * @brief rtc.adjust() with the transaction marked for stall forensics
+ */
+void ds3231Adjust(const DateTime& dt) {
+    Crumbs.trace(CRUMB_RTC_WRITE);
+    I2CCrumb crumb(0, 0x68, 0x00);
+    rtc.adjust(dt);
+}
+
 bool initializeDS3231() {
-    Serial.println("Attempting DS3231 RTC initialization...");
+    Log.event(LOG_SEV_DEBUG, "Attempting DS3231 RTC initialization...");
 
     // First verify a device responds at DS3231 address (0x68)
     Wire.beginTransmission(0x68);
     uint8_t i2cError = Wire.endTransmission();
     if (i2cError != 0) {
-        Serial.printf("DS3231 not found at I2C address 0x68 (error: %d)\n", i2cError);
+        Log.event(LOG_SEV_ERR, "DS3231 not found at I2C address 0x68 (error: %d)", i2cError);
         rtcAvailable = false;
         return false;
     }
 
     if (!rtc.begin(&Wire)) {
-        Serial.println("DS3231 library initialization failed");
+        Log.event(LOG_SEV_ERR, "DS3231 library initialization failed");
         rtcAvailable = false;
         return false;
     }
 
-    Serial.println("DS3231 RTC initialized successfully");
+    Log.event(LOG_SEV_INFO, "DS3231 RTC initialized successfully");
 
     // Check if RTC lost power and needs to be reset
     if (rtc.lostPower()) {
-        Serial.println("WARNING: DS3231 lost power, time may be invalid");
+        Log.event(LOG_SEV_WARNING, "WARNING: DS3231 lost power, time may be invalid");
         // Don't set a default time - wait for ES100 sync
     }
 
     rtc.disable32K();
     rtc.writeSqwPinMode(DS3231_SquareWave1Hz);
 #if PIN_DS3231_SQW >= 0
-    pinMode(PIN_DS3231_SQW, INPUT_PULLUP);
     rtcSqwInterruptFlag = false;
-    attachInterrupt(digitalPinToInterrupt(PIN_DS3231_SQW), rtcSqwISR, FALLING);
-    Serial.printf("DS3231 1Hz SQW enabled on GPIO%d\n", PIN_DS3231_SQW);
+    if (!edgeCapture.isRunning()) {
+        pinMode(PIN_DS3231_SQW, INPUT_PULLUP);
+        attachInterrupt(digitalPinToInterrupt(PIN_DS3231_SQW), rtcSqwISR, FALLING);
+    }
+    Log.event(LOG_SEV_INFO, "DS3231 1Hz SQW enabled on GPIO%d", PIN_DS3231_SQW);
 #else
-    Serial.println("DS3231 1Hz SQW support compiled in but disabled (PIN_DS3231_SQW = -1)");
+    Log.event(LOG_SEV_INFO, "DS3231 1Hz SQW support compiled in but disabled (PIN_DS3231_SQW = -1)");
 #endif
 
+    int8_t aging = 0;
+    if (readDS3231Aging(aging)) {
+        clockDiscipline.setAgingOffset(aging);
+        Log.event(LOG_SEV_INFO, "DS3231 aging offset: %d", aging);
+    }
+
     rtcAvailable = true;
     return true;
 }
 
 bool loadTimeFromDS3231() {
     if (!rtcAvailable) {
-        Serial.println("DS3231 not available");
+        Log.event(LOG_SEV_WARNING, "DS3231 not available");
         return false;
     }
 
-    DateTime now = rtc.now();
+    DateTime now = ds3231Now();
 
     // Sanity check - year should be reasonable
     if (now.year() < 2025 || now.year() > 2100) {
-        Serial.printf("DS3231 time appears invalid: %04d-%02d-%02d\n",
+        Log.event(LOG_SEV_WARNING, "DS3231 time appears invalid: %04d-%02d-%02d",
                      now.year(), now.month(), now.day());
         return false;
     }
@@ -2141,7 +2369,7 @@ bool loadTimeFromDS3231() {
     timeManager.setTime(now.year(), now.month(), now.day(),
                        now.hour(), now.minute(), now.second());
 
-    Serial.printf("Loaded time from DS3231: %04d-%02d-%02d %02d:%02d:%02d UTC\n",
+    Log.event(LOG_SEV_INFO, "Loaded time from DS3231: %04d-%02d-%02d %02d:%02d:%02d UTC",
                  now.year(), now.month(), now.day(),
                  now.hour(), now.minute(), now.second());
 
@@ -2150,7 +2378,6 @@ bool loadTimeFromDS3231() {
         lastTimeSource = TIME_SRC_RTC;
         lastTimeSyncMillis = millis();
         snapshotSyncTime();
-        captivePortal.setTimeSource((uint8_t)lastTimeSource);
     }
 
     return true;
@@ -2163,18 +2390,56 @@ void saveTimeToDS3231() {
 
 #if PIN_DS3231_SQW >= 0
     rtcWritePending = true;
-    Serial.println("Queued DS3231 update for next 1Hz boundary");
+    Log.event(LOG_SEV_DEBUG, "Queued DS3231 update for next 1Hz boundary");
 #else
     ClockTime utc = timeManager.getUTCTime();
-    rtc.adjust(DateTime(utc.year, utc.month, utc.day,
-                       utc.hour, utc.minute, utc.second));
+    ds3231Adjust(DateTime(utc.year, utc.month, utc.day,
+                          utc.hour, utc.minute, utc.second));
 
-    Serial.printf("Saved time to DS3231: %04d-%02d-%02d %02d:%02d:%02d UTC\n",
+    Log.event(LOG_SEV_INFO, "Saved time to DS3231: %04d-%02d-%02d %02d:%02d:%02d UTC",
                  utc.year, utc.month, utc.day,
                  utc.hour, utc.minute, utc.second);
 #endif
 }
 
+/**
+ * @brief Read the DS3231 aging offset register (0x10)
+ * @param aging Output: signed offset; each LSB is ~0.1 ppm, positive slows the oscillator
+ */
+bool readDS3231Aging(int8_t& aging) {
+    I2CCrumb crumb(0, 0x68, 0x10);
+    Wire.beginTransmission(0x68);
+    Wire.write(0x10);
+    if (Wire.endTransmission(false) != 0) return false;
+    if (Wire.requestFrom((uint8_t)0x68, (uint8_t)1) != 1) return false;
+    aging = (int8_t)Wire.read();
+    return true;
+}
+
+/**
+ * @brief Write the DS3231 aging offset register and start a temperature conversion
+ * @details The new offset only takes effect at the next TCXO update; setting CONV
+ *          applies it now instead of up to 64 s later.
+ */
+bool writeDS3231Aging(int8_t aging) {
+    I2CCrumb crumb(0, 0x68, 0x10);
+    Wire.beginTransmission(0x68);
+    Wire.write(0x10);
+    Wire.write((uint8_t)aging);
+    if (Wire.endTransmission() != 0) return false;
+
+    Wire.beginTransmission(0x68);
+    Wire.write(0x0E);
+    if (Wire.endTransmission(false) != 0) return true;
+    if (Wire.requestFrom((uint8_t)0x68, (uint8_t)1) != 1) return true;
+    uint8_t control = Wire.read();
+    Wire.beginTransmission(0x68);
+    Wire.write(0x0E);
+    Wire.write(control | 0x20);  // CONV
+    Wire.endTransmission();
+    return true;
+}
+
 void syncFromDS3231() {
     if (!rtcAvailable) {
         return;
@@ -2190,7 +2455,7 @@ void syncFromDS3231() {
 
     // Read DS3231 as the authoritative time source every call
     // The DS3231 TCXO is ±2 ppm vs ESP32 crystal at ±20 ppm
-    DateTime rtcTime = rtc.now();
+    DateTime rtcTime = ds3231Now();
 
     // Sanity check
     if (rtcTime.year() < 2025 || rtcTime.year() > 2100) {
@@ -2221,7 +2486,7 @@ void processDS3231SquareWave() {
             lastRtcSqwSeenMillis > 0 &&
             (millis() - lastRtcSqwSeenMillis) > 2500UL) {
             timeManager.clearRTCPhaseAnchor();
-            Serial.println("[RTC-SQW] lost lock");
+            Log.event(LOG_SEV_WARNING, "[RTC-SQW] lost lock");
             lastRtcSqwStatusLogMillis = 0;
         }
         return;
@@ -2238,6 +2503,10 @@ void processDS3231SquareWave() {
     if (rtcWritePending) {
         anchorUnix = timeManager.getUnixTime();
         rtcWriteSubsecMs = timeManager.getMilliseconds();  // save phase for next edge
+        // A write carries the phase of the sync that requested it; discipline
+        // measurements taken against the old phase no longer apply.
+        rtcPhaseTrimUs = 0;
+        clockDiscipline.reset();
         // Write the current integer second to DS3231.  The DS3231 oscillator resets
         // at the write moment; the next SQW edge fires ~1 s later at anchorUnix+1,
         // offset by rtcWriteSubsecMs from the true second boundary.  We correct for
@@ -2268,11 +2537,11 @@ void processDS3231SquareWave() {
             utc.minute = seconds / 60UL;
             utc.second = seconds % 60UL;
         }
-        rtc.adjust(DateTime(utc.year, utc.month, utc.day,
-                           utc.hour, utc.minute, utc.second));
+        ds3231Adjust(DateTime(utc.year, utc.month, utc.day,
+                              utc.hour, utc.minute, utc.second));
         rtcWritePending = false;
         rtcWriteDonePending = true;  // next edge uses phase-corrected anchor
-        Serial.printf("Saved time to DS3231 on 1Hz boundary: %04d-%02d-%02d %02d:%02d:%02d UTC (subsec=%ums)\n",
+        Log.event(LOG_SEV_INFO, "Saved time to DS3231 on 1Hz boundary: %04d-%02d-%02d %02d:%02d:%02d UTC (subsec=%ums)",
                      utc.year, utc.month, utc.day,
                      utc.hour, utc.minute, utc.second, rtcWriteSubsecMs);
         return;
@@ -2284,13 +2553,14 @@ void processDS3231SquareWave() {
         // the TimeManager's sub-second phase from the WWVB sync that triggered the write.
         rtcWriteDonePending = false;
         if (!rtcAvailable) return;
-        DateTime rtcTime = rtc.now();
+        DateTime rtcTime = ds3231Now();
         if (rtcTime.year() < 2025 || rtcTime.year() > 2100) return;
         anchorUnix = rtcTime.unixtime();
         timeManager.setRTCPhaseAnchor(anchorUnix,
-                                      edgeMicros - (uint32_t)rtcWriteSubsecMs * 1000UL);
+                                      edgeMicros - (uint32_t)rtcWriteSubsecMs * 1000UL
+                                                 + (uint32_t)rtcPhaseTrimUs);
         lastRtcSqwSeenMillis = millis();
-        Serial.printf("[RTC-SQW] write-edge re-lock: unix=%lu subsec=%ums anchor_micros=%lu\n",
+        Log.event(LOG_SEV_INFO, "[RTC-SQW] write-edge re-lock: unix=%lu subsec=%ums anchor_micros=%lu",
                      (unsigned long)anchorUnix, rtcWriteSubsecMs,
                      (unsigned long)(edgeMicros - (uint32_t)rtcWriteSubsecMs * 1000UL));
         return;
@@ -2299,7 +2569,7 @@ void processDS3231SquareWave() {
             return;
         }
 
-        DateTime rtcTime = rtc.now();
+        DateTime rtcTime = ds3231Now();
         if (rtcTime.year() < 2025 || rtcTime.year() > 2100) {
             return;
         }
@@ -2310,16 +2580,18 @@ void processDS3231SquareWave() {
     // reset at write time, so every SQW edge fires rtcWriteSubsecMs ms after the true
     // second boundary until the next write.  Without this correction the phase established
     // by the write-done handler is overwritten on E2 and all subsequent edges.
-    uint32_t correctedMicros = edgeMicros - (uint32_t)rtcWriteSubsecMs * 1000UL;
+    // rtcPhaseTrimUs adds the slow phase steering from continuous tracking (0 otherwise).
+    uint32_t correctedMicros = edgeMicros - (uint32_t)rtcWriteSubsecMs * 1000UL
+                                          + (uint32_t)rtcPhaseTrimUs;
     timeManager.setRTCPhaseAnchor(anchorUnix, correctedMicros);
     lastRtcSqwSeenMillis = millis();
     if (!wasLocked) {
-        Serial.printf("[RTC-SQW] lock acquired: unix=%lu micros=%lu (subsec=%ums)\n",
+        Log.event(LOG_SEV_NOTICE, "[RTC-SQW] lock acquired: unix=%lu micros=%lu (subsec=%ums)",
                       (unsigned long)anchorUnix,
                       (unsigned long)correctedMicros, rtcWriteSubsecMs);
         lastRtcSqwStatusLogMillis = lastRtcSqwSeenMillis;
     } else if ((lastRtcSqwSeenMillis - lastRtcSqwStatusLogMillis) >= 60000UL) {
-        Serial.printf("[RTC-SQW] edge ok: unix=%lu micros=%lu (subsec=%ums)\n",
+        Log.event(LOG_SEV_DEBUG, "[RTC-SQW] edge ok: unix=%lu micros=%lu (subsec=%ums)",
                       (unsigned long)anchorUnix,
                       (unsigned long)correctedMicros, rtcWriteSubsecMs);
         lastRtcSqwStatusLogMillis = lastRtcSqwSeenMillis;
@@ -2328,12 +2600,14 @@ void processDS3231SquareWave() {
 }
 
 void readDS3231Temperature() {
-    if (!rtcAvailable) {
+    if (rtcAvailable) {
+        I2CCrumb crumb(0, 0x68, 0x11);
+        rtcTemperature = rtc.getTemperature();
+    } else {
         rtcTemperature = 0.0;
-        return;
     }
-
-    rtcTemperature = rtc.getTemperature();
+    State.power.edit().temperatureC = rtcTemperature;
+    State.power.commit();
 }
 
 // ============================================================================
@@ -2341,23 +2615,24 @@ void readDS3231Temperature() {
 // ============================================================================
 bool ntpClientSync() {
     if (WiFi.status() != WL_CONNECTED) {
-        Serial.println("[NTP-CLIENT] Not connected to WiFi");
+        Log.event(LOG_SEV_WARNING, "[NTP-CLIENT] Not connected to WiFi");
         return false;
     }
 
-    Serial.printf("[NTP-CLIENT] Querying %s...\n", NTP_FALLBACK_HOST);
+    Crumbs.stage(STAGE_NTP_CLIENT);  // DNS and the 2 s reply wait block here
+    Log.event(LOG_SEV_INFO, "[NTP-CLIENT] Querying %s...", NTP_FALLBACK_HOST);
 
     // Resolve DNS first so we can store the upstream IP for Stratum 2 refId
     IPAddress ntpServerIP;
     if (WiFi.hostByName(NTP_FALLBACK_HOST, ntpServerIP) != 1) {
-        Serial.printf("[NTP-CLIENT] DNS resolution failed for %s\n", NTP_FALLBACK_HOST);
+        Log.event(LOG_SEV_WARNING, "[NTP-CLIENT] DNS resolution failed for %s", NTP_FALLBACK_HOST);
         return false;
     }
-    Serial.printf("[NTP-CLIENT] Resolved %s → %s\n", NTP_FALLBACK_HOST, ntpServerIP.toString().c_str());
+    Log.event(LOG_SEV_DEBUG, "[NTP-CLIENT] Resolved %s → %s", NTP_FALLBACK_HOST, ntpServerIP.toString().c_str());
 
     WiFiUDP udp;
     if (!udp.begin(0)) {  // Ephemeral local port
-        Serial.println("[NTP-CLIENT] Failed to open UDP socket");
+        Log.event(LOG_SEV_ERR, "[NTP-CLIENT] Failed to open UDP socket");
         return false;
     }
 
@@ -2368,26 +2643,28 @@ bool ntpClientSync() {
 
     // Send to resolved IP
     if (!udp.beginPacket(ntpServerIP, 123)) {
-        Serial.println("[NTP-CLIENT] beginPacket failed");
+        Log.event(LOG_SEV_ERR, "[NTP-CLIENT] beginPacket failed");
         udp.stop();
         return false;
     }
     udp.write(packet, 48);
     udp.endPacket();
     unsigned long t1 = millis();  // T1: approximate send time (just after endPacket)
+    Crumbs.trace(CRUMB_NTP_QUERY);
 
     // Wait for response (up to 2 seconds)
     unsigned long start = millis();
     int cb = 0;
     while ((cb = udp.parsePacket()) < 48) {
         if (millis() - start > 2000) {
-            Serial.println("[NTP-CLIENT] Timeout waiting for response");
+            Log.event(LOG_SEV_WARNING, "[NTP-CLIENT] Timeout waiting for response");
             udp.stop();
             return false;
         }
         delay(10);
     }
     unsigned long t4 = millis();  // T4: response received
+    Crumbs.trace(CRUMB_NTP_REPLY, (uint16_t)(t4 - t1));
 
     // Read response
     udp.read(packet, 48);
@@ -2400,7 +2677,7 @@ bool ntpClientSync() {
                       (uint32_t)packet[43];
 
     if (t3_ntp == 0) {
-        Serial.println("[NTP-CLIENT] Invalid response (zero timestamp)");
+        Log.event(LOG_SEV_WARNING, "[NTP-CLIENT] Invalid response (zero timestamp)");
         return false;
     }
 
@@ -2426,7 +2703,7 @@ bool ntpClientSync() {
     // timestamps are stable between polls (same fix as WWVB tracking path).
     timeManager.setSubSecondOffset(subSecOffsetMs);
 
-    Serial.printf("[NTP-CLIENT] RTT=%lums, T3_ms=%u, totalMs=%lu (+%lus + %ums sub-sec)\n",
+    Log.event(LOG_SEV_INFO, "[NTP-CLIENT] RTT=%lums, T3_ms=%u, totalMs=%lu (+%lus + %ums sub-sec)",
                   (unsigned long)rttMs, t3_ms, (unsigned long)totalMs,
                   (unsigned long)(totalMs / 1000), subSecOffsetMs);
     saveTimeToDS3231();
@@ -2436,29 +2713,70 @@ bool ntpClientSync() {
     lastTimeSource = TIME_SRC_NTP;
     lastTimeSyncMillis = millis();
     snapshotSyncTime();
-    ntpServer.setStratum(2, ntpServerIP);
-    ntpServer.setLastSyncTime(timeManager.getUnixTime());
-    ntpServer.setLeapIndicator(0);  // Clear any alarm state from prior stratum-16 period
-    captivePortal.setTimeSource((uint8_t)lastTimeSource);
+    {
+        // Error left: half the round trip, the upstream's own root dispersion
+        // (bytes 8-11, 16.16 s) and our millisecond timekeeping
+        uint32_t upstreamDisp = ((uint32_t)packet[8] << 24) | ((uint32_t)packet[9] << 16) |
+                                ((uint32_t)packet[10] << 8) | (uint32_t)packet[11];
+        uint32_t errorUs = (uint32_t)(rttMs * 500UL) + CQ_NTP_ERROR_US +
+                           (uint32_t)((uint64_t)upstreamDisp * 1000000ULL / 65536ULL);
+        uint8_t refId[4];
+        for (uint8_t i = 0; i < 4; i++) refId[i] = ntpServerIP[i];
+        clockQuality.noteSync(2, refId, timeManager.getUnixTime(), errorUs);
+    }
 
     // Recompute DST from calendar after NTP time update
     if (AUTO_DST_ENABLED) {
         dstActive = computeUSDST();
-        Serial.printf("[DST] Auto-DST after NTP sync: %s\n", dstActive ? "active" : "inactive");
+        Log.event(LOG_SEV_INFO, "[DST] Auto-DST after NTP sync: %s", dstActive ? "active" : "inactive");
+        armDSTTimer();  // Clock may have stepped
     }
 
-    Serial.printf("[NTP-CLIENT] Synced: Unix=%lu\n", (unsigned long)unixTime);
+    Log.event(LOG_SEV_NOTICE, "[NTP-CLIENT] Synced: Unix=%lu", (unsigned long)unixTime);
     return true;
 }
 
+// ============================================================================
+// Published State
+// ============================================================================
+/**
+ * @brief Commit the loop-owned clock and receiver globals to the state store
+ * @details Called once at the end of every loop() pass (and at the end of
+ *          setup()), so everything a pass changed is published together and
+ *          readers see it one pass later at most. A commit with no changed
+ *          field is a memcmp and leaves the generation alone. The NTP
+ *          reference and power slices are committed where they are set.
+ */
+void commitLoopState() {
+    ClockState& clk = State.clock.edit();
+    clk.timeSource        = (uint8_t)lastTimeSource;
+    clk.lastSyncMillis    = lastTimeSyncMillis;
+    clk.utcOffset         = utcOffset;
+    clk.dstActive         = dstActive;
+    clk.leapSecondWarning = wwvbLeapSecondWarning;
+    State.clock.commit();
+
+    ReceiverState& rx = State.receiver.edit();
+    rx.available       = es100Available;
+    rx.receiving       = es100Receiving;
+    rx.tracking        = es100UsingTracking;
+    rx.pendingTracking = pendingTrackingStart;
+    rx.trackingReady   = es100TrackingReady;
+    rx.ant1Successes   = ant1Successes;
+    rx.ant2Successes   = ant2Successes;
+    State.receiver.commit();
+}
+
 // ============================================================================
 // Sync Time Snapshot
 // ============================================================================
-// Records the current UTC time as a formatted string in statusData.lastSyncTimeStr.
+// Records the current UTC time as a formatted string in the clock slice's
+// lastSyncTimeStr (published with the other clock fields at the end of loop()).
 // Call immediately after setting lastTimeSyncMillis at each sync point.
 void snapshotSyncTime() {
     ClockTime utc = timeManager.getUTCTime();
-    snprintf(statusData.lastSyncTimeStr, sizeof(statusData.lastSyncTimeStr),
+    ClockState& clk = State.clock.edit();
+    snprintf(clk.lastSyncTimeStr, sizeof(clk.lastSyncTimeStr),
              "%04d-%02d-%02d %02d:%02d:%02d",
              utc.year, utc.month, utc.day, utc.hour, utc.minute, utc.second);
 }
@@ -2467,15 +2785,15 @@ void snapshotSyncTime() {
 // ES100 Initialization Functions
 // ============================================================================
 bool initializeES100() {
-    Serial.println("Attempting ES100 initialization...");
+    Log.event(LOG_SEV_DEBUG, "Attempting ES100 initialization...");
 
     if (es100.begin(&Wire1, ES100_SDA_PIN, ES100_SCL_PIN)) {
-        Serial.println("ES100 initialized successfully");
+        Log.event(LOG_SEV_INFO, "ES100 initialized successfully");
         es100Available = true;
         es100InitRetries = 0;  // Reset retry counter on success
         return true;
     } else {
-        Serial.printf("ES100 initialization failed (attempt %d, will retry)\n",
+        Log.event(LOG_SEV_ERR, "ES100 initialization failed (attempt %d, will retry)",
                      es100InitRetries + 1);
         es100Available = false;
         return false;
@@ -2496,7 +2814,7 @@ bool retryES100Initialization() {
         es100InitRetries++;
 
         if (initializeES100()) {
-            Serial.println("ES100 recovery successful!");
+            Log.event(LOG_SEV_NOTICE, "ES100 recovery successful!");
             return true;
         }
     }
@@ -2508,6 +2826,24 @@ bool retryES100Initialization() {
 // WWVB Sync Schedule — time-aware with daytime backoff
 // ============================================================================
 
+/**
+ * @brief Local hour of day for the reception odds, or -1 before the time is set
+ */
+int8_t receptionHour() {
+    if (!timeManager.isTimeSet()) return -1;
+    return (int8_t)timeManager.getLocalTime(utcOffset, dstActive).hour;
+}
+
+/**
+ * @brief Antenna to start a reception on (1 or 2)
+ * @details The better of the two at this hour once both have learned odds,
+ *          otherwise the one with more lifetime successes.
+ */
+uint8_t preferredAntenna() {
+    return receptionPolicy.preferredAntenna(receptionHour(),
+                                            (ant2Successes > ant1Successes) ? 2 : 1);
+}
+
 /**
  * @brief Check if current local time is within the nighttime reception window
  * @return true if local hour is between SYNC_NIGHT_START_HOUR and SYNC_NIGHT_END_HOUR
@@ -2553,8 +2889,194 @@ bool computeUSDST() {
            (local.day == firstSunday && local.hour < 2);
 }
 
+// ============================================================================
+// DST Transition Scheduling
+// ============================================================================
+
+/**
+ * @brief UTC instant of a scheduled DST change
+ * @details The change happens at the given local wall-clock hour, which is still
+ *          on the pre-transition offset (US: 2:00 standard in March, 2:00 daylight
+ *          in November).
+ */
+uint32_t dstTransitionUnix(const DSTTransition& t) {
+    ClockTime local = { t.year, t.month, t.day, t.hour, 0, 0 };
+    int32_t offsetHours = utcOffset + (t.toDst ? 0 : 1);
+    return TimeManager::clockTimeToUnix(local) - (uint32_t)(offsetHours * 3600L);
+}
+
+/**
+ * @brief Next transition from the US rule (2nd Sunday of March / 1st Sunday of November)
+ */
+DSTTransition computeNextUSDSTTransition() {
+    ClockTime local = timeManager.getLocalTime(utcOffset, dstActive);
+    uint32_t now = timeManager.getUnixTime();
+
+    for (uint16_t year = local.year; year <= local.year + 1; year++) {
+        int dowMar = TimeManager::calculateDayOfWeek(year, 3, 1);
+        int dowNov = TimeManager::calculateDayOfWeek(year, 11, 1);
+        DSTTransition candidates[2] = {
+            { year, 3,  (uint8_t)((1 + (7 - dowMar) % 7) + 7), 2, true,  false, true },
+            { year, 11, (uint8_t)(1 + (7 - dowNov) % 7),       2, false, false, true },
+        };
+        for (const DSTTransition& c : candidates) {
+            if (dstTransitionUnix(c) > now) return c;
+        }
+    }
+    return DSTTransition{};
+}
+
+void saveDSTSchedule() {
+    preferences.putBool("dstValid", nextDST.valid);
+    if (!nextDST.valid) return;
+    preferences.putUShort("dstYear", nextDST.year);
+    preferences.putUChar("dstMonth", nextDST.month);
+    preferences.putUChar("dstDay", nextDST.day);
+    preferences.putUChar("dstHour", nextDST.hour);
+    preferences.putBool("dstOn", nextDST.toDst);
+    preferences.putBool("dstWWVB", nextDST.fromWWVB);
+}
+
+void dstTimerCallback(void* arg) {
+    // Runs in the esp_timer task.  nextDST and dstActive belong to the loop
+    // task, so the change itself is applied by handleDSTTimer().
+    dstTimerFired = true;
+}
+
+/**
+ * @brief (Re-)arm the one-shot timer for nextDST
+ * @details The esp_timer runs on the ESP32 crystal (±20 ppm), which could be off
+ *          by minutes over months.  Only a transition within DST_TIMER_FINAL_WINDOW_S
+ *          gets the final shot; further away, the timer wakes up at most every
+ *          DST_TIMER_MAX_ARM_S to re-measure against the disciplined clock.
+ */
+void armDSTTimer() {
+    if (!dstTimer) {
+        esp_timer_create_args_t args = {};
+        args.callback = &dstTimerCallback;
+        args.name     = "dst";
+        if (esp_timer_create(&args, &dstTimer) != ESP_OK) {
+            Log.event(LOG_SEV_ERR, "[DST] Timer create failed");
+            return;
+        }
+    }
+    esp_timer_stop(dstTimer);
+    if (!nextDST.valid || !timeManager.isTimeSet()) return;
+
+    uint32_t nowSec;
+    uint16_t nowMs;
+    timeManager.getTimeSnapshot(nowSec, nowMs);
+    uint32_t at = dstTransitionUnix(nextDST);
+    int64_t delayUs = ((int64_t)at - (int64_t)nowSec) * 1000000LL - (int64_t)nowMs * 1000LL;
+    if (delayUs < 1000) delayUs = 1000;  // Already due — fire now
+
+    const int64_t finalWindowUs = (int64_t)DST_TIMER_FINAL_WINDOW_S * 1000000LL;
+    const int64_t maxArmUs      = (int64_t)DST_TIMER_MAX_ARM_S * 1000000LL;
+    dstTimerFinal = delayUs <= finalWindowUs;
+    int64_t shotUs = delayUs;
+    if (!dstTimerFinal) {
+        // Land inside the final window, never further out than maxArmUs
+        shotUs = delayUs - finalWindowUs / 2;
+        if (shotUs > maxArmUs) shotUs = maxArmUs;
+    }
+    esp_timer_start_once(dstTimer, (uint64_t)shotUs);
+
+    Log.event(LOG_SEV_INFO, "[DST] Next change %04u-%02u-%02u %02u:00 local -> DST %s (%s), in %lus%s",
+                  nextDST.year, nextDST.month, nextDST.day, nextDST.hour,
+                  nextDST.toDst ? "on" : "off", nextDST.fromWWVB ? "WWVB" : "rule",
+                  (unsigned long)(delayUs / 1000000LL), dstTimerFinal ? "" : " (re-arm first)");
+}
+
+/**
+ * @brief Replace the schedule with the computed US rule and arm it
+ */
+void scheduleRuleDST() {
+    nextDST = computeNextUSDSTTransition();
+    armDSTTimer();
+}
+
+/**
+ * @brief Adopt the next transition broadcast in a normal-mode frame
+ * @details The registers carry month/day/hour only, taken as this local year.
+ *          A date already past is stale: moving it to next year would keep the
+ *          day of month but not the weekday, so it is ignored and the current
+ *          schedule kept until the ES100 reports the next transition.
+ *          The direction comes from the month (spring forward, fall back).
+ */
+void scheduleWWVBDST(const ES100NextDST& nd) {
+    if (nd.special != 0) {
+        Log.event(LOG_SEV_INFO, "[DST] WWVB next-DST special code %u — keeping %s schedule",
+                      nd.special, nextDST.fromWWVB ? "WWVB" : "rule");
+        return;
+    }
+
+    // Direction from the month of the change (spring forward, fall back), not
+    // from dstActive: on the day itself the frame already reads "DST begins
+    // today" or "ends today" before the change has happened
+    ClockTime local = timeManager.getLocalTime(utcOffset, dstActive);
+    bool toDst = nd.month < 7;
+    DSTTransition t = { local.year, nd.month, nd.day, nd.hour, toDst, true, true };
+    if (nd.day > TimeManager::daysInMonth(t.year, nd.month)) return;
+
+    uint32_t now = timeManager.getUnixTime();
+    uint32_t at  = dstTransitionUnix(t);
+    if (at <= now) {
+        Log.event(LOG_SEV_DEBUG, "[DST] WWVB next-DST %02u-%02u %02u:00 already past — ignored",
+                  nd.month, nd.day, nd.hour);
+        return;
+    }
+    if (at - now < 86400UL) {
+        // Today's change is still ahead: keep the old offset until the timer
+        dstActive = !toDst;
+    }
+
+    bool changed = !nextDST.valid || nextDST.year != t.year || nextDST.month != t.month ||
+                   nextDST.day != t.day || nextDST.hour != t.hour ||
+                   nextDST.toDst != t.toDst || !nextDST.fromWWVB;
+    nextDST = t;
+    armDSTTimer();  // Re-arm even if unchanged: the clock was just corrected
+    if (changed) {
+        Log.event(LOG_SEV_INFO, "[DST] Schedule updated from WWVB frame");
+    }
+}
+
+/**
+ * @brief Loop-side half of the DST timer: apply a due change, or re-arm
+ * @details The flag may come from a shot armed before nextDST was replaced,
+ *          or land a few ms early on the crystal, so the change is applied
+ *          only once the disciplined clock has reached it.
+ */
+void handleDSTTimer() {
+    dstTimerFired = false;
+    if (!nextDST.valid) return;
+
+    uint32_t nowSec;
+    uint16_t nowMs;
+    timeManager.getTimeSnapshot(nowSec, nowMs);
+    int64_t remainingMs = ((int64_t)dstTransitionUnix(nextDST) - (int64_t)nowSec) * 1000LL -
+                          (int64_t)nowMs;
+    if (!dstTimerFinal || remainingMs > 0) {
+        armDSTTimer();
+        return;
+    }
+
+    dstActive = nextDST.toDst;
+    Log.event(LOG_SEV_NOTICE, "[DST] Transition: DST now %s", dstActive ? "active" : "inactive");
+    preferences.begin("wwvb", false);
+    preferences.putBool("dst", dstActive);
+    preferences.end();
+
+    // The next WWVB normal frame replaces this with the broadcast schedule
+    scheduleRuleDST();
+    preferences.begin("wwvb", false);
+    saveDSTSchedule();
+    preferences.end();
+}
+
 /**
  * @brief Get the appropriate sync interval based on time of day and failure history
+ * @details The night and day intervals are shortened when the measured clock drift
+ *          would exceed the holdover budget between attempts.
  * @return Interval in milliseconds until next sync attempt
  */
 unsigned long getSyncInterval() {
@@ -2567,7 +3089,7 @@ unsigned long getSyncInterval() {
         // Nighttime: best propagation, sync every hour
         daytimeFailures = 0;
         daytimeSkipActive = false;
-        return SYNC_INTERVAL_NIGHT_MS;
+        return syncCadence.limitInterval(SYNC_INTERVAL_NIGHT_MS);
     }
 
     // Daytime: backed off after repeated failures — wait for nighttime
@@ -2577,8 +3099,8 @@ unsigned long getSyncInterval() {
         return SYNC_INTERVAL_DAY_MS;
     }
 
-    // Daytime: normal 4-hour interval
-    return SYNC_INTERVAL_DAY_MS;
+    // Daytime: normal 4-hour interval, shorter for a drifting RTC
+    return syncCadence.limitInterval(SYNC_INTERVAL_DAY_MS);
 }
 
 /**
@@ -2592,7 +3114,7 @@ void recordSyncFailure(bool wasTracking = false) {
         daytimeFailures++;
         if (daytimeFailures >= threshold) {
             daytimeSkipActive = true;
-            Serial.printf("[SYNC] %d consecutive daytime %s failures — skipping until nighttime\n",
+            Log.event(LOG_SEV_WARNING, "[SYNC] %d consecutive daytime %s failures — skipping until nighttime",
                          daytimeFailures, wasTracking ? "tracking" : "normal");
         }
     }
@@ -2641,7 +3163,7 @@ void startWWVBSync(bool forceNormal = false) {
     if (pendingTrackingStart) {
         pendingTrackingStart = false;
         if (es100.isPoweredOn()) es100.powerOff();
-        Serial.println("[WWVB] Pending tracking start cancelled");
+        Log.event(LOG_SEV_INFO, "[WWVB] Pending tracking start cancelled");
     }
 
     if (!es100Available) {
@@ -2656,27 +3178,28 @@ void startWWVBSync(bool forceNormal = false) {
     // self-correct errors larger than the ES100's ±4 s timing tolerance; once the clock
     // drifts outside that window, every tracking sync perpetuates the error.  One
     // successful full-frame decode per night re-anchors absolute time and breaks the cycle.
+    // A drifting RTC is re-anchored sooner (SyncCadence anchor budget).
     if (!forceNormal && isNighttimeWindow()) {
         bool needsAnchor = (lastNormalSuccessMillis == 0) ||
-                           (millis() - lastNormalSuccessMillis >=
-                            NIGHTLY_NORMAL_SYNC_HOURS * 3600000UL);
+                           (millis() - lastNormalSuccessMillis >= syncCadence.getAnchorMs());
         if (needsAnchor) {
             forceNormal = true;
             unsigned long hoursAgo = lastNormalSuccessMillis == 0 ? 999UL
                                      : (millis() - lastNormalSuccessMillis) / 3600000UL;
-            Serial.printf("[WWVB] Nightly anchor required (%luh since last full sync) — forcing normal mode\n",
+            Log.event(LOG_SEV_INFO, "[WWVB] Nightly anchor required (%luh since last full sync) — forcing normal mode",
                           hoursAgo);
         }
     }
 
     // Only use tracking mode if the clock is fresh enough that second :55 scheduling
-    // is accurate. DS3231 at 2 ppm drifts ~173 ms/day; 5 days = ~865 ms worst case,
-    // still within the ±4s tolerance of tracking mode.
+    // is accurate: at most ES100_TRACKING_MAX_AGE_S (5 days at 2 ppm), less for a
+    // drifting RTC so the predicted error stays within the tracking budget.
     bool clockFreshEnoughForTracking =
-        (timeManager.getSecondsSinceSync() < 432000UL);  // 5 days
+        (timeManager.getSecondsSinceSync() < syncCadence.getTrackingAgeS());
     if (!forceNormal && ES100_USE_TRACKING && es100TrackingReady && clockFreshEnoughForTracking) {
-        if (millis() - es100TrackingReadySinceMs >= ES100_TRACKING_FALLBACK_MS) {
-            Serial.println("[WWVB] Tracking mode expired (7 days), switching to normal mode");
+        if (millis() - es100TrackingReadySinceMs >= syncCadence.getTrackingFallbackMs()) {
+            Log.event(LOG_SEV_INFO, "[WWVB] Tracking mode expired (%luh), switching to normal mode",
+                          (unsigned long)(syncCadence.getTrackingFallbackMs() / 3600000UL));
             es100TrackingReady = false;
         } else {
             // Tracking reception MUST start (Control 0 write) at second :55.
@@ -2696,23 +3219,25 @@ void startWWVBSync(bool forceNormal = false) {
             // If msUntil55 is 0 (exactly at :55), the loop fires it immediately.
             pendingTrackingStart = true;
             trackingStartAtMs = millis() + msUntil55;
-            Serial.printf("[WWVB] Tracking scheduled in %lus (current second: %02d)\n",
+            Log.event(LOG_SEV_INFO, "[WWVB] Tracking scheduled in %lus (current second: %02d)",
                           msUntil55 / 1000UL, sec);
             return;
         }
     }
 
-    // Normal mode — start with historically better antenna (toggles if it fails)
-    uint8_t ctrl = (ant2Successes > ant1Successes) ? ES100_CTRL0_NORMAL_ANT2
-                                                   : ES100_CTRL0_NORMAL;
-    Serial.printf("[WWVB] Starting normal mode sync (prefer Ant%d, successes: Ant1=%d Ant2=%d)...\n",
-                  (ant2Successes > ant1Successes) ? 2 : 1, ant1Successes, ant2Successes);
+    // Normal mode — start with the antenna that decodes best at this hour, else
+    // the historically better one (toggles if it fails)
+    uint8_t ant = preferredAntenna();
+    uint8_t ctrl = (ant == 2) ? ES100_CTRL0_NORMAL_ANT2 : ES100_CTRL0_NORMAL;
+    Log.event(LOG_SEV_INFO, "[WWVB] Starting normal mode sync (prefer Ant%d, successes: Ant1=%d Ant2=%d)...",
+                  ant, ant1Successes, ant2Successes);
     es100InterruptFlag = false;
     if (es100.startReception(ctrl)) {
         es100Receiving = true;
         lastSyncAttempt = millis();
+        receptionPolicy.beginAttempt(ctrl, receptionHour(), lastSyncAttempt);
     } else {
-        Serial.println("[WWVB] Failed to start normal reception");
+        Log.event(LOG_SEV_ERR, "[WWVB] Failed to start normal reception");
         recordSyncFailure();
     }
 }
@@ -2720,7 +3245,177 @@ void startWWVBSync(bool forceNormal = false) {
 void stopWWVBSync() {
     es100.stopReception();
     es100Receiving = false;
-    Serial.println("WWVB sync stopped");
+    receptionPolicy.endAttempt(millis(), -1, false);  // Cut short: no cycle outcome
+    Log.event(LOG_SEV_INFO, "WWVB sync stopped");
+}
+
+/**
+ * @brief Time elapsed since the second boundary reported by the ES100
+ * @param irqMicros     micros() captured in es100ISR()
+ * @param tracking      True for a tracking-mode fix
+ * @param ant2          True if antenna 2 produced the fix
+ * @param irqDelayMs    millis()-based processing delay (fallback)
+ * @return Milliseconds from the transmitted second to now: processing delay plus
+ *         the calibrated IRQ latency for this mode and antenna plus the
+ *         propagation delay from Fort Collins
+ */
+uint32_t sinceWWVBSecondMs(uint32_t irqMicros, bool tracking, bool ant2,
+                           unsigned long irqDelayMs) {
+    int64_t sinceUs = (int64_t)(uint32_t)(micros() - irqMicros);
+    if (sinceUs > 10000000LL) sinceUs = (int64_t)irqDelayMs * 1000LL;  // stale capture
+    sinceUs += latencyCalibrator.getCorrectionUs(tracking, ant2);
+    sinceUs += propagation.getDelayUs(timeManager.isTimeSet() ? timeManager.getUnixTime() : 0);
+    if (sinceUs < 0) sinceUs = 0;
+    return (uint32_t)((sinceUs + 500LL) / 1000LL);
+}
+
+/**
+ * @brief Feed the IRQ phase of an applied fix to the latency calibrator
+ * @details Only valid while the DS3231 still carries the phase of the previous
+ *          WWVB fix: the SQW anchor must be locked, no RTC write may be in flight,
+ *          and the hold must be short enough that DS3231 drift stays small.
+ *          The held second is the transmitted one, so the propagation delay
+ *          of this fix is removed before the phase counts as IRQ latency.
+ */
+void calibrateIRQLatency(bool tracking, bool ant2, bool phaseOk, int32_t phaseUs) {
+    if (!phaseOk || rtcWritePending || rtcWriteDonePending) return;
+    if (lastTimeSource != TIME_SRC_WWVB || lastWWVBSyncMillis == 0) return;
+    if ((millis() - lastWWVBSyncMillis) > ES100_LATCAL_MAX_HOLD_MS) return;
+
+    phaseUs -= propagation.getLastDelayUs();
+
+    uint8_t bucket = (tracking ? 2 : 0) + (ant2 ? 1 : 0);
+    bool used = latencyCalibrator.addSample(tracking, ant2, phaseUs);
+    Log.event(LOG_SEV_INFO, "[LATCAL] %s IRQ phase %+ldus -> est %+ldus (n=%u)%s",
+                  LatencyCalibrator::bucketName(bucket), (long)phaseUs,
+                  (long)latencyCalibrator.getEstimateUs(bucket),
+                  latencyCalibrator.getSampleCount(bucket),
+                  used ? "" : " [outlier]");
+}
+
+/**
+ * @brief Error of the running clock against a WWVB fix about to be applied
+ * @param wwvbSecond  Unix second the fix sets
+ * @param subSecondMs Milliseconds into that second
+ * @return Clock minus WWVB (ms), positive if the clock is ahead
+ */
+int32_t clockErrorAgainstMs(uint32_t wwvbSecond, uint16_t subSecondMs) {
+    uint32_t sec, us;
+    timeManager.getTimeAtMicros(micros(), sec, us);
+    return (int32_t)(sec - wwvbSecond) * 1000L + (int32_t)(us / 1000UL) - (int32_t)subSecondMs;
+}
+
+/**
+ * @brief Feed the error a WWVB fix corrected to the drift estimator
+ * @details Only a clock that has run free since the previous WWVB fix measures
+ *          drift; a step from the DS3231, NTP or a reboot in between does not.
+ *          Call before lastTimeSource/lastWWVBSyncMillis are updated.
+ */
+void measureClockDrift(int32_t clockErrorMs) {
+    if (lastTimeSource != TIME_SRC_WWVB || lastWWVBSyncMillis == 0) return;
+    uint32_t elapsedS = (millis() - lastWWVBSyncMillis) / 1000UL;
+    if (!syncCadence.addCorrection(clockErrorMs, elapsedS)) return;
+    Log.event(LOG_SEV_INFO, "[CADENCE] error %+ldms over %lus -> drift %+.2fppm (n=%u), budget %.1fppm: "
+              "tracking %luh, anchor %luh, interval night %lumin day %lumin",
+              (long)clockErrorMs, (unsigned long)elapsedS, syncCadence.getDriftPpm(),
+              syncCadence.getSampleCount(), syncCadence.getBudgetPpm(),
+              (unsigned long)(syncCadence.getTrackingAgeS() / 3600UL),
+              (unsigned long)(syncCadence.getAnchorMs() / 3600000UL),
+              (unsigned long)(syncCadence.limitInterval(SYNC_INTERVAL_NIGHT_MS) / 60000UL),
+              (unsigned long)(syncCadence.limitInterval(SYNC_INTERVAL_DAY_MS) / 60000UL));
+}
+
+/**
+ * @brief True while tracking receptions should run back-to-back as phase measurements
+ * @details Requires ES100_CONTINUOUS_TRACKING, the nighttime window, and a clock that
+ *          was set from WWVB and is phase-locked to the DS3231 SQW edge.
+ */
+bool continuousTrackingActive() {
+#if ES100_CONTINUOUS_TRACKING
+    return es100TrackingReady && isNighttimeWindow() &&
+           timeManager.hasRTCPhaseAnchor() && lastTimeSource == TIME_SRC_WWVB;
+#else
+    return false;
+#endif
+}
+
+/**
+ * @brief Use a tracking result as a phase measurement instead of a clock step
+ * @param wwvbSecond Unix second reported by the ES100
+ * @param phaseOk    True if irqPhaseUs/irqSecond are valid (SQW locked at IRQ)
+ * @param irqPhaseUs Offset of the IRQ edge from the nearest SQW-held second
+ * @param irqSecond  Unix second of that nearest SQW-held boundary
+ * @param ant2       True if antenna 2 produced the result
+ * @return true if the result was consumed as a measurement; false if it should
+ *         take the normal stepping path
+ */
+bool recordPhaseMeasurement(uint32_t wwvbSecond, bool phaseOk, int32_t irqPhaseUs,
+                            uint32_t irqSecond, bool ant2) {
+    if (!continuousTrackingActive() || !phaseOk) return false;
+    if (rtcWritePending || rtcWriteDonePending) return false;
+
+    // IRQ = WWVB boundary + propagation + latency, so the local clock is ahead
+    // by (phase - propagation - latency).
+    int32_t offsetUs = irqPhaseUs - propagation.getLastDelayUs() -
+                       latencyCalibrator.getCorrectionUs(true, ant2);
+    if (irqSecond != wwvbSecond ||
+        offsetUs > DISCIPLINE_MAX_PHASE_US || offsetUs < -DISCIPLINE_MAX_PHASE_US) {
+        return false;
+    }
+
+    clockDiscipline.addMeasurement(millis(), offsetUs);
+    int32_t trimUs = clockDiscipline.takePhaseCorrectionUs();
+    rtcPhaseTrimUs += trimUs;
+
+    Log.event(LOG_SEV_INFO, "[DISC] offset %+ldus, fit %+ldus %+.3fppm (n=%u), trim %+ldus",
+                  (long)offsetUs, (long)clockDiscipline.getPhaseUs(),
+                  clockDiscipline.getFrequencyPpm(), clockDiscipline.getCount(),
+                  (long)trimUs);
+
+    int8_t aging;
+    float ppm = clockDiscipline.getFrequencyPpm();
+    if (clockDiscipline.takeAgingUpdate(aging)) {
+        if (writeDS3231Aging(aging)) {
+            Log.event(LOG_SEV_NOTICE, "[DISC] DS3231 %+.3fppm -> aging offset %d", ppm, aging);
+        } else {
+            Log.event(LOG_SEV_ERR, "[DISC] DS3231 aging write failed");
+        }
+    }
+    return true;
+}
+
+/**
+ * @brief Run a decoded WWVB candidate through the plausibility and voting stage
+ * @param candidate Unix time implied by the frame, referred to "now"
+ * @param tracking  True for a tracking-mode result
+ * @param reason    Output: reason for the verdict
+ * @param len       Size of reason buffer
+ * @return true if the candidate may be applied to the clock
+ * @details Accepted frames are not logged here so the caller can apply the
+ *          correction before any Serial output.  Held and rejected frames
+ *          schedule a prompt re-reception so the step can be confirmed or
+ *          refuted by a second decode.
+ */
+bool validateWWVBCandidate(uint32_t candidate, bool tracking, char* reason, size_t len) {
+    bool clockTrusted = timeManager.isTimeSet() && lastTimeSource != TIME_SRC_NONE;
+    uint32_t clockUnix = timeManager.getUnixTime();
+    uint32_t boundUs   = clockQuality.getErrorBoundUs(clockUnix);
+    uint32_t boundS    = boundUs == 0xFFFFFFFFUL ? 0 : (boundUs + 999999UL) / 1000000UL;
+    WWVBVerdict verdict = wwvbValidator.evaluate(candidate, clockUnix, clockTrusted, boundS,
+                                                 reason, len);
+    if (verdict == WWVB_ACCEPT) {
+        wwvbConfirmPending = false;
+        return true;
+    }
+
+    Log.event(LOG_SEV_WARNING, "[WWVB] %s frame %s: %s", tracking ? "Tracking" : "Normal",
+                  verdict == WWVB_PENDING ? "held" : "rejected", reason);
+    // Re-receive either way: a rejected frame is remembered, so a second decode
+    // that agrees with it still outvotes a clock that has drifted
+    wwvbConfirmPending  = true;
+    wwvbConfirmTracking = tracking;
+    wwvbConfirmAtMs     = millis() + WWVB_CONFIRM_RETRY_MS;
+    return false;
 }
 
 void handleES100Interrupt() {
@@ -2728,31 +3423,65 @@ void handleES100Interrupt() {
 
     es100InterruptFlag = false;
     unsigned long irqFiredAt         = es100IRQMillis;
+    uint32_t      irqMicros          = es100IRQMicros;
     unsigned long irqProcessingDelay = millis() - irqFiredAt;
     // Clamp: defend against millis() wrap or a stale IRQMillis from a prior cycle
     if (irqProcessingDelay > 10000UL) irqProcessingDelay = 0UL;
 
-    uint8_t irqStatus = es100.readIRQStatus();
-    Serial.printf("ES100 IRQ Status: 0x%02X\n", irqStatus);
-    
+    // Where the IRQ landed relative to the second held by the DS3231.  Read now,
+    // before a fix re-phases the clock and drops the SQW anchor.
+    int32_t  irqPhaseUs = 0;
+    uint32_t irqSecond  = 0;
+    bool     irqPhaseOk = timeManager.getRTCPhaseAt(irqMicros, irqPhaseUs, &irqSecond);
+
+    // One burst read of registers 0x02–0x09 (IRQ status, Status 0, time) instead of
+    // separate transactions.  Nothing is logged until the clock has been corrected.
+    ES100Frame frame;
+    if (!es100.readFrame(&frame)) {
+        // IRQ- stays asserted until IRQ_STATUS is read; retry on the next loop pass.
+        // The ISR timestamps are kept, so the retry costs nothing in accuracy.
+        if (++es100FrameReadFailures < ES100_FRAME_READ_RETRIES) {
+            es100InterruptFlag = true;
+            return;
+        }
+        es100FrameReadFailures = 0;
+        Log.event(LOG_SEV_ERR, "[WWVB] ES100 register read failed — abandoning reception");
+        bool wasTracking = es100UsingTracking;
+        stopWWVBSync();
+        es100UsingTracking = false;
+        addSyncLogEntry(false, wasTracking, 0);
+        recordSyncFailure(wasTracking);
+        return;
+    }
+    es100FrameReadFailures = 0;
+    uint8_t irqStatus = frame.irqStatus;
+    Crumbs.trace(CRUMB_ES100_IRQ, irqStatus);
+
     if (irqStatus & ES100_IRQ_RX_COMPLETE) {
-        uint8_t status0 = es100.readStatus0();
+        uint8_t status0 = frame.status0;
+        // Normal-mode cycle outcome for the per-hour/antenna odds (the radio's
+        // verdict, before frame validation)
+        receptionPolicy.endAttempt(millis(), (status0 & ES100_STATUS_RX_OK) ? 1 : 0,
+                                   (status0 & ES100_STATUS_ANT) != 0);
 
         if (status0 & ES100_STATUS_RX_OK) {
             bool usedTracking = (status0 & ES100_STATUS_TRACKING) != 0;
-            Serial.printf("WWVB reception successful! (%s mode)\n",
-                         usedTracking ? "tracking" : "normal");
 
-            bool syncOk  = false;
-            bool ant2Used = false;  // antenna used this reception (shared by both branches)
+            bool syncOk    = false;
+            bool measured  = false;  // tracking result used as a discipline measurement
+            bool frameHeld = false;  // decoded but not applied (pending or rejected by validation)
+            bool ant2Used  = false;  // antenna used this reception (shared by both branches)
+            char verdictReason[48] = "";
+            int32_t clockErrorMs = 0;  // Clock minus WWVB just before a fix steps it
 
             if (usedTracking) {
                 // Tracking mode: only register 0x09 (Second) is valid.
                 // Year/Month/Day/Hour/Minute are cleared to 0x00 by the START write
                 // and must NOT be used — doing so would corrupt the RTC with year 2000.
                 // Instead, back-compute the correct Unix second from the IRQ timestamp.
-                uint8_t wwvbSecond;
-                if (es100.readTrackingResult(&wwvbSecond, &ant2Used, status0)) {
+                uint8_t wwvbSecond = ES100::decodeSecond(frame);
+                ant2Used = (status0 & ES100_STATUS_ANT) != 0;
+                if (wwvbSecond <= 59) {
                     // Apply correction FIRST to minimise IRQ→setTime latency.
                     // Back-compute time at IRQ fire moment, then patch WWVB second.
                     uint32_t timeAtIRQ  = timeManager.getUnixTime()
@@ -2771,7 +3500,7 @@ void handleES100Interrupt() {
                     if (trackingWriteUnixTime > 0) {
                         int32_t elapsed = (int32_t)(corrected - trackingWriteUnixTime);
                         if (elapsed < 10 || elapsed > 35) {
-                            Serial.printf("[WWVB] Tracking sanity FAIL: elapsed=%ds from :55 write (expected 10-35) — rejected\n",
+                            Log.event(LOG_SEV_WARNING, "[WWVB] Tracking sanity FAIL: elapsed=%ds from :55 write (expected 10-35) — rejected",
                                           elapsed);
                             sanityOk = false;
                         }
@@ -2782,45 +3511,75 @@ void handleES100Interrupt() {
                         // clock lands at corrected + irqProcessingDelay, matching true time.
                         // Without this, a 3–4 s main-loop stall (NTP traffic, display) drops
                         // the whole-second part and leaves the clock 3–4 s behind.
-                        uint32_t delaySeconds = irqProcessingDelay / 1000UL;
-                        timeManager.setUnixTime(corrected + delaySeconds);
-                        timeManager.setSubSecondOffset((uint16_t)(irqProcessingDelay % 1000));
-                        syncOk = true;
+                        uint32_t sinceSecondMs = sinceWWVBSecondMs(irqMicros, true, ant2Used,
+                                                                   irqProcessingDelay);
+                        uint32_t delaySeconds  = sinceSecondMs / 1000UL;
+                        uint32_t candidate     = corrected + delaySeconds;
+                        if (recordPhaseMeasurement(corrected, irqPhaseOk, irqPhaseUs,
+                                                   irqSecond, ant2Used)) {
+                            measured = true;
+                            irqServiceLatency.add(micros() - irqMicros);
+                        } else if (validateWWVBCandidate(candidate, true, verdictReason,
+                                                         sizeof(verdictReason))) {
+                            clockErrorMs = clockErrorAgainstMs(candidate, sinceSecondMs % 1000);
+                            timeManager.setUnixTime(candidate);
+                            timeManager.setSubSecondOffset((uint16_t)(sinceSecondMs % 1000));
+                            irqServiceLatency.add(micros() - irqMicros);
+                            syncOk = true;
+                        } else {
+                            frameHeld = true;
+                        }
                     }
 
                     // Log AFTER correction so timestamp in message is accurate
                     ClockTime cur = timeManager.getUTCTime();
-                    Serial.printf("Tracking snap: IRQ delay=%lums, corrected to "
-                                  "%04d-%02d-%02d %02d:%02d:%02d UTC, "
-                                  "WWVB second=%02d (Ant%d)\n",
-                                  irqProcessingDelay,
-                                  cur.year, cur.month, cur.day,
-                                  cur.hour, cur.minute, cur.second,
-                                  wwvbSecond, ant2Used ? 2 : 1);
+                    if (!measured) {
+                        Log.event(LOG_SEV_INFO, "Tracking snap: IRQ delay=%lums, corrected to "
+                                      "%04d-%02d-%02d %02d:%02d:%02d UTC, "
+                                      "WWVB second=%02d (Ant%d)",
+                                      irqProcessingDelay,
+                                      cur.year, cur.month, cur.day,
+                                      cur.hour, cur.minute, cur.second,
+                                      wwvbSecond, ant2Used ? 2 : 1);
+                    }
+                    if (syncOk) Log.event(LOG_SEV_NOTICE, "[WWVB] Tracking frame accepted: %s", verdictReason);
                 } else {
-                    Serial.println("Failed to read tracking result");
+                    Log.event(LOG_SEV_WARNING, "Invalid tracking second register 0x%02X", frame.time[5]);
                 }
             } else {
                 // Normal 1-minute frame: all time registers are valid
                 ES100Time rxTime;
-                if (es100.readDateTime(&rxTime)) {
-                    // Apply correction FIRST (before any Serial output) to minimise
-                    // the gap between irqFiredAt and when the clock is actually set.
-                    timeManager.setTime(rxTime.year, rxTime.month, rxTime.day,
-                                       rxTime.hour, rxTime.minute, rxTime.second);
-                    // Compensate for measured IRQ→processing delay.
-                    // Use floor division so delaySeconds and setSubSecondOffset partition
-                    // irqProcessingDelay without overlap.  The previous round-to-nearest
-                    // formula caused a +1 s set-point error whenever irqProcessingDelay
-                    // was ≥ 500 ms (e.g. main loop busy with NTP traffic): delaySeconds
-                    // rounded up by 1, then setSubSecondOffset added the full fractional
-                    // part again, applying 1000 + frac ms instead of just frac ms.
-                    uint32_t delaySeconds = irqProcessingDelay / 1000UL;
-                    if (delaySeconds > 0)
-                        timeManager.setUnixTime(timeManager.getUnixTime() + delaySeconds);
-                    // Sub-second accumulator: remainder after removing whole seconds.
-                    timeManager.setSubSecondOffset((uint16_t)(irqProcessingDelay % 1000));
+                ES100::decodeDateTime(frame, &rxTime);
+                // Candidate "now" = decoded second at IRQ + whole seconds of processing
+                // delay.  Use floor division so delaySeconds and setSubSecondOffset
+                // partition irqProcessingDelay without overlap.  The previous
+                // round-to-nearest formula caused a +1 s set-point error whenever
+                // irqProcessingDelay was ≥ 500 ms (e.g. main loop busy with NTP traffic).
+                uint32_t sinceSecondMs = sinceWWVBSecondMs(irqMicros, false, rxTime.antenna2Used,
+                                                           irqProcessingDelay);
+                uint32_t delaySeconds  = sinceSecondMs / 1000UL;
+                bool accepted = false;
+                if (!WWVBValidator::fieldsValid(rxTime, verdictReason, sizeof(verdictReason))) {
+                    wwvbValidator.noteRejected(verdictReason);
+                    Log.event(LOG_SEV_WARNING, "[WWVB] Normal frame rejected: %s", verdictReason);
+                } else {
+                    ClockTime rxClock = { rxTime.year, rxTime.month, rxTime.day,
+                                          rxTime.hour, rxTime.minute, rxTime.second };
+                    uint32_t candidate = TimeManager::clockTimeToUnix(rxClock) + delaySeconds;
+                    accepted = validateWWVBCandidate(candidate, false, verdictReason,
+                                                     sizeof(verdictReason));
+                    if (accepted) {
+                        // Apply correction FIRST (before any Serial output) to minimise
+                        // the gap between irqFiredAt and when the clock is actually set.
+                        clockErrorMs = clockErrorAgainstMs(candidate, sinceSecondMs % 1000);
+                        timeManager.setUnixTime(candidate);
+                        // Sub-second accumulator: remainder after removing whole seconds.
+                        timeManager.setSubSecondOffset((uint16_t)(sinceSecondMs % 1000));
+                        irqServiceLatency.add(micros() - irqMicros);
+                    }
+                }
 
+                if (accepted) {
                     // DST only comes from normal mode (tracking does not provide it)
                     uint8_t dstBits = (status0 >> 5) & 0x03;
                     dstActive = (dstBits >= 2);
@@ -2829,35 +3588,73 @@ void handleES100Interrupt() {
                     uint8_t lsw = (status0 & ES100_STATUS_LSW_MASK) >> 3;
                     if (lsw != wwvbLeapSecondWarning) {
                         wwvbLeapSecondWarning = lsw;
-                        ntpServer.setLeapIndicator(lsw);  // propagate to NTP (RFC 5905)
-                        if (lsw) Serial.printf("[WWVB] Leap second warning: %s\n",
+                        clockQuality.setLeapIndicator(lsw);  // propagate to NTP (RFC 5905)
+                        if (lsw) Log.event(LOG_SEV_NOTICE, "[WWVB] Leap second warning: %s",
                                                lsw == 1 ? "+1s end of month" : "-1s end of month");
                     }
 
                     ant2Used = rxTime.antenna2Used;
                     syncOk = true;
 
+                    // Next DST change from the frame (not time-critical; clock already set)
+                    if (AUTO_DST_ENABLED) {
+                        ES100NextDST nd;
+                        if (es100.readNextDST(&nd)) scheduleWWVBDST(nd);
+                    }
+
                     // Log AFTER correction so timestamp in message is accurate
-                    Serial.printf("Normal sync: IRQ delay=%lums, set to %04d-%02d-%02d "
-                                  "%02d:%02d:%02d UTC (Ant%d)\n",
+                    Log.event(LOG_SEV_INFO, "Normal sync: IRQ delay=%lums, set to %04d-%02d-%02d "
+                                  "%02d:%02d:%02d UTC (Ant%d) — %s",
                                   irqProcessingDelay,
                                   rxTime.year, rxTime.month, rxTime.day,
                                   rxTime.hour, rxTime.minute, rxTime.second,
-                                  rxTime.antenna2Used ? 2 : 1);
+                                  rxTime.antenna2Used ? 2 : 1, verdictReason);
                 } else {
-                    Serial.println("Failed to read time data");
+                    ant2Used  = rxTime.antenna2Used;
+                    frameHeld = true;
                 }
             }
 
-            if (syncOk) {
+            // Only an applied frame is a successful reception; a held or
+            // rejected one says why it was not used.
+            if (syncOk || measured) {
+                Log.event(LOG_SEV_NOTICE, "WWVB reception successful! (%s mode, IRQ 0x%02X, Status0 0x%02X)",
+                              usedTracking ? "tracking" : "normal", irqStatus, status0);
+                Log.event(LOG_SEV_INFO, "[WWVB] IRQ->clock latency %luus",
+                              (unsigned long)irqServiceLatency.getLastUs());
+            } else {
+                Log.event(LOG_SEV_WARNING, "WWVB frame received but not applied (%s mode, IRQ 0x%02X, "
+                              "Status0 0x%02X): %s",
+                              usedTracking ? "tracking" : "normal", irqStatus, status0,
+                              verdictReason[0] ? verdictReason : "invalid time registers");
+            }
+
+            if (measured) {
+                // The clock already agreed with WWVB; it was steered, not stepped.
+                // No NVS or DS3231 write — this path runs once a minute all night.
+                // A phase measurement is not a time-frame decode, so it stays out
+                // of the reception history, the antenna counts and the sync log;
+                // ClockDiscipline already holds it.
+                lastTimeSyncMillis = millis();
+                lastWWVBSyncMillis = millis();
+                snapshotSyncTime();
+                clockQuality.noteSync(1, (const uint8_t*)"WWVB", timeManager.getUnixTime(),
+                                      CQ_WWVB_ERROR_US);
+                daytimeFailures = 0;
+                daytimeSkipActive = false;
+            } else if (syncOk) {
                 receptionHistory.recordAttempt(true);
+                calibrateIRQLatency(usedTracking, ant2Used, irqPhaseOk, irqPhaseUs);
 
                 // Track per-antenna successes and log the event
                 if (ant2Used) ant2Successes++; else ant1Successes++;
                 addSyncLogEntry(true, usedTracking, ant2Used ? 2 : 1);
 
-                // Save time to persistent storage
-                saveTimeToPreferences();
+                measureClockDrift(clockErrorMs);
+                clockQuality.checkCorrection(clockErrorMs * 1000L, timeManager.getUnixTime());
+
+                // Persist once NTP traffic is quiet (flash writes stall the cache)
+                requestTimeSave();
                 saveTimeToDS3231();  // Also update RTC
 
                 // Track time source
@@ -2866,10 +3663,8 @@ void handleES100Interrupt() {
                 lastWWVBSyncMillis = millis();
                 if (!usedTracking) lastNormalSuccessMillis = millis();
                 snapshotSyncTime();
-                ntpServer.setStratum(1, "WWVB");
-                ntpServer.setLastSyncTime(timeManager.getUnixTime());
-                if (!wwvbLeapSecondWarning) ntpServer.setLeapIndicator(0);
-                captivePortal.setTimeSource((uint8_t)lastTimeSource);
+                clockQuality.noteSync(1, (const uint8_t*)"WWVB", timeManager.getUnixTime(),
+                                      CQ_WWVB_ERROR_US);
 
                 // Enable tracking mode for subsequent syncs
                 es100TrackingReady = true;
@@ -2879,18 +3674,26 @@ void handleES100Interrupt() {
                 daytimeFailures = 0;
                 daytimeSkipActive = false;
 
-                Serial.println("Time synchronized!");
+                Log.event(LOG_SEV_NOTICE, "Time synchronized!");
+            } else if (frameHeld) {
+                // The radio worked but the frame was not applied.  Count it in the
+                // history without feeding the daytime back-off — a confirmation
+                // attempt may already be scheduled.
+                receptionHistory.recordAttempt(false);
+                addSyncLogEntry(false, usedTracking, ant2Used ? 2 : 1);
             } else {
                 addSyncLogEntry(false, usedTracking, (status0 & ES100_STATUS_ANT) ? 2 : 1);
                 recordSyncFailure(usedTracking);
             }
         } else {
             // Reception complete but decode failed
+            Log.event(LOG_SEV_DEBUG, "ES100 IRQ Status: 0x%02X, Status0: 0x%02X", irqStatus, status0);
             if (es100UsingTracking) {
                 // Tracking decode failed — poor signal conditions make normal mode (~134 s)
                 // equally unlikely to succeed. Retry tracking on the next scheduled sync.
-                // startWWVBSync() will fall back to normal mode after ES100_TRACKING_FALLBACK_MS.
-                Serial.println("Tracking mode failed, will retry tracking on next scheduled sync");
+                // startWWVBSync() will fall back to normal mode after the tracking
+                // fallback window (SyncCadence::getTrackingFallbackMs()).
+                Log.event(LOG_SEV_WARNING, "Tracking mode failed, will retry tracking on next scheduled sync");
                 es100Receiving = false;
                 es100UsingTracking = false;
                 es100.stopReception();
@@ -2898,7 +3701,7 @@ void handleES100Interrupt() {
                 recordSyncFailure(true);
                 return;
             }
-            Serial.println("RX_OK not set despite RX_COMPLETE");
+            Log.event(LOG_SEV_WARNING, "RX_OK not set despite RX_COMPLETE");
             addSyncLogEntry(false, false, (status0 & ES100_STATUS_ANT) ? 2 : 1);
             recordSyncFailure();
         }
@@ -2908,27 +3711,62 @@ void handleES100Interrupt() {
         es100.stopReception();
 
     } else if (irqStatus & ES100_IRQ_CYCLE_COMPLETE) {
-        Serial.println("Reception cycle failed, ES100 retrying...");
+        Log.event(LOG_SEV_INFO, "ES100 IRQ Status: 0x%02X — reception cycle failed, ES100 retrying...",
+                      irqStatus);
+        handleCycleComplete();
     }
 }
 
+/**
+ * @brief Act on a failed normal-mode cycle: let the ES100 retry, move the retry
+ *        to the other antenna, or power the receiver down before the timeout
+ * @details The learned odds and the time left are weighed in ReceptionPolicy.
+ *          An abandoned attempt counts as a normal-mode failure.
+ */
+void handleCycleComplete() {
+    if (!receptionPolicy.isActive()) return;
+    uint8_t failedAnt = receptionPolicy.getCycleAntenna();
+    RxDecision d = receptionPolicy.onCycleComplete(millis(), SYNC_TIMEOUT_NORMAL_MS);
+
+    if (d == RXP_SWITCH) {
+        es100InterruptFlag = false;
+        if (es100.startReception(receptionPolicy.getSwitchCtrl())) return;
+        Log.event(LOG_SEV_ERR, "[WWVB] Antenna switch failed — abandoning reception");
+    } else if (d != RXP_ABORT) {
+        return;
+    }
+
+    stopWWVBSync();
+    es100UsingTracking = false;
+    addSyncLogEntry(false, false, failedAnt);
+    recordSyncFailure();
+}
+
 // ============================================================================
 // Setup
 // ============================================================================
 void setup() {
-    Serial.begin(115200);
+    Log.begin(DEBUG_BAUD_RATE);
+    Log.setClock(logClock);
+#if USB_REFCLOCK
+    // The CDC port carries reference-clock frames instead of log text
+    usbRefclock.begin(&timeManager);
+#endif
     delay(2000);
 
     // Force serial output to flush
-    Serial.flush();
+    Log.flush();
+
+    Log.event(LOG_SEV_DEBUG, "\n\n\n========================================");
+    Log.event(LOG_SEV_NOTICE, "  WWVB Atomic Clock - ESP32-S3");
+    Log.event(LOG_SEV_DEBUG, "  ES100 WWVB Receiver");
+    Log.event(LOG_SEV_DEBUG, "  Display: LilyGo-AMOLED-Series");
+    Log.event(LOG_SEV_DEBUG, "========================================");
+    Log.event(LOG_SEV_INFO, "Boot time: %lu ms", millis());
+    Log.event(LOG_SEV_DEBUG, "========================================");
 
-    Serial.println("\n\n\n========================================");
-    Serial.println("  WWVB Atomic Clock - ESP32-S3");
-    Serial.println("  ES100 WWVB Receiver");
-    Serial.println("  Display: LilyGo-AMOLED-Series");
-    Serial.println("========================================");
-    Serial.printf("Boot time: %lu ms\n", millis());
-    Serial.println("========================================\n");
+    // Keep (and report) where the previous boot was if a watchdog reset it
+    Crumbs.begin();
 
     // Configure task watchdog timer — auto-resets on I2C lockup or infinite loop
 #if ESP_IDF_VERSION >= ESP_IDF_VERSION_VAL(5, 0, 0)
@@ -2942,59 +3780,66 @@ void setup() {
     esp_task_wdt_init(WATCHDOG_TIMEOUT_MS / 1000, true);
 #endif
     esp_task_wdt_add(NULL);
-    Serial.printf("[WDT] Watchdog configured: %ds timeout\n", WATCHDOG_TIMEOUT_MS / 1000);
+    Log.event(LOG_SEV_INFO, "[WDT] Watchdog configured: %ds timeout", WATCHDOG_TIMEOUT_MS / 1000);
 
-    Serial.println("[BOOT] Starting initialization...");
-    Serial.printf("[BOOT] Free heap: %d bytes\n", ESP.getFreeHeap());
-    Serial.printf("[BOOT] PSRAM: %s\n", psramFound() ? "Found" : "Not found");
+    Log.event(LOG_SEV_DEBUG, "[BOOT] Starting initialization...");
+    Log.event(LOG_SEV_INFO, "[BOOT] Free heap: %d bytes", ESP.getFreeHeap());
+    Log.event(LOG_SEV_INFO, "[BOOT] PSRAM: %s", psramFound() ? "Found" : "Not found");
 
     // Initialize I2C bus 0 (touch, PMU, DS3231) - 400kHz fast mode
-    Serial.println("[BOOT] Initializing I2C...");
+    Log.event(LOG_SEV_DEBUG, "[BOOT] Initializing I2C...");
     Wire.begin(I2C_SDA_PIN, I2C_SCL_PIN);
     Wire.setClock(400000);
-    Serial.println("[BOOT] Wire initialized (400kHz) - touch, PMU, DS3231 on GPIO 2/3");
+    Log.event(LOG_SEV_DEBUG, "[BOOT] Wire initialized (400kHz) - touch, PMU, DS3231 on GPIO 2/3");
 
     // Initialize I2C bus 1 (ES100 isolated) - 100kHz standard mode
     Wire1.begin(ES100_SDA_PIN, ES100_SCL_PIN);
     Wire1.setClock(100000);
-    Serial.println("[BOOT] Wire1 initialized (100kHz) - ES100 on GPIO 15/16 (isolated)");
+    Log.event(LOG_SEV_DEBUG, "[BOOT] Wire1 initialized (100kHz) - ES100 on GPIO 15/16 (isolated)");
 
     // I2C bus scan on both buses
     // Note: ES100 (0x32) will NOT appear here — it only responds when EN is HIGH,
     // and EN is not driven until initializeES100() is called later in the main loop.
-    Serial.println("[BOOT] Scanning Wire for devices...");
+    Log.event(LOG_SEV_DEBUG, "[BOOT] Scanning Wire for devices...");
     for (uint8_t addr = 1; addr < 127; addr++) {
         Wire.beginTransmission(addr);
         if (Wire.endTransmission() == 0) {
-            Serial.printf("[BOOT] Wire found device at 0x%02X\n", addr);
+            Log.event(LOG_SEV_DEBUG, "[BOOT] Wire found device at 0x%02X", addr);
         }
     }
-    Serial.println("[BOOT] Scanning Wire1 for devices...");
+    Log.event(LOG_SEV_DEBUG, "[BOOT] Scanning Wire1 for devices...");
     for (uint8_t addr = 1; addr < 127; addr++) {
         Wire1.beginTransmission(addr);
         if (Wire1.endTransmission() == 0) {
-            Serial.printf("[BOOT] Wire1 found device at 0x%02X\n", addr);
+            Log.event(LOG_SEV_DEBUG, "[BOOT] Wire1 found device at 0x%02X", addr);
         }
     }
-    Serial.println("[BOOT] I2C scan complete");
+    Log.event(LOG_SEV_DEBUG, "[BOOT] I2C scan complete");
+
+#if EDGE_CAPTURE_ENABLED
+    // Hardware edge stamps; the GPIO interrupts below are the fallback
+    edgeCapture.setHandler(EDGE_SQW, rtcSqwEdge);
+    edgeCapture.setHandler(EDGE_ES100_IRQ, es100Edge);
+    edgeCapture.begin(PIN_DS3231_SQW, ES100_IRQ_PIN);
+#endif
 
     // Initialize DS3231 RTC
-    Serial.println("[BOOT] Initializing DS3231 RTC...");
+    Log.event(LOG_SEV_DEBUG, "[BOOT] Initializing DS3231 RTC...");
     initializeDS3231();
     readDS3231Temperature();  // Get initial temperature reading
 
     // Initialize display (amoled.begin() re-initializes Wire internally for touch/PMU)
-    Serial.println("[BOOT] Initializing display...");
+    Log.event(LOG_SEV_DEBUG, "[BOOT] Initializing display...");
     initDisplay();
-    Serial.println("[BOOT] Display initialization complete");
-    Serial.flush();  // Ensure all display messages are sent
+    Log.event(LOG_SEV_DEBUG, "[BOOT] Display initialization complete");
+    Log.flush();  // Ensure all display messages are sent
 
     // Re-apply Wire clock after amoled.begin() which may reset it
     Wire.setClock(400000);
-    Serial.println("[BOOT] Wire clock re-applied (400kHz)");
+    Log.event(LOG_SEV_DEBUG, "[BOOT] Wire clock re-applied (400kHz)");
 
     // Show startup message
-    Serial.println("[BOOT] Drawing startup message...");
+    Log.event(LOG_SEV_DEBUG, "[BOOT] Drawing startup message...");
     sprite.fillSprite(TFT_BLACK);
 
     // Explicitly set font to built-in Font 4
@@ -3005,9 +3850,9 @@ void setup() {
     sprite.setTextDatum(MC_DATUM);
     sprite.drawString("WWVB Clock", DISPLAY_WIDTH/2, DISPLAY_HEIGHT/2 - 20);
     sprite.drawString("Starting...", DISPLAY_WIDTH/2, DISPLAY_HEIGHT/2 + 20);
-    Serial.println("[BOOT] Pushing startup message to display...");
+    Log.event(LOG_SEV_DEBUG, "[BOOT] Pushing startup message to display...");
     amoled.pushColors(0, 0, DISPLAY_WIDTH, DISPLAY_HEIGHT, (uint16_t*)sprite.getPointer());
-    Serial.println("[BOOT] Startup message displayed");
+    Log.event(LOG_SEV_DEBUG, "[BOOT] Startup message displayed");
     delay(2000);
     
     // Initialize ES100 with retry tracking
@@ -3025,7 +3870,7 @@ void setup() {
     } else {
         sprite.setTextColor(COLOR_SYNC_PENDING, TFT_BLACK);
         sprite.drawString("ES100: Initializing...", DISPLAY_WIDTH/2, DISPLAY_HEIGHT/2);
-        Serial.println("ES100 will retry initialization in background");
+        Log.event(LOG_SEV_WARNING, "ES100 will retry initialization in background");
     }
     pushDisplay();
     delay(1000);
@@ -3047,67 +3892,110 @@ void setup() {
     delay(1000);
 
     // Attach interrupt
-    Serial.println("Attaching ES100 interrupt...");
-    attachInterrupt(digitalPinToInterrupt(ES100_IRQ_PIN), es100ISR, FALLING);
-    Serial.println("Interrupt attached");
+    if (!edgeCapture.isRunning()) {
+        Log.event(LOG_SEV_DEBUG, "Attaching ES100 interrupt...");
+        attachInterrupt(digitalPinToInterrupt(ES100_IRQ_PIN), es100ISR, FALLING);
+        Log.event(LOG_SEV_DEBUG, "Interrupt attached");
+    }
+
+    loadSyncStateFromPreferences();
+    propagation.begin(RECEIVER_LATITUDE_DEG, RECEIVER_LONGITUDE_DEG);
+#if ES100_IRQ_BASE_LATENCY_US == 0
+    Log.event(LOG_SEV_WARNING, "[LATCAL] ES100_IRQ_BASE_LATENCY_US not set, absolute IRQ latency not corrected");
+#endif
 
     // Try to load time - priority: DS3231 > Preferences > Default
-    Serial.println("Loading time...");
+    Log.event(LOG_SEV_DEBUG, "Loading time...");
     bool timeLoaded = false;
 
     if (rtcAvailable) {
-        Serial.println("Trying to load time from DS3231...");
+        Log.event(LOG_SEV_DEBUG, "Trying to load time from DS3231...");
         timeLoaded = loadTimeFromDS3231();
     }
 
+    // Only the DS3231 keeps time through a reset; from anywhere else the saved
+    // sync record no longer bounds the error
+    clockQuality.begin(&syncCadence);
+    if (!timeLoaded) clockQuality.invalidate();
+
     if (!timeLoaded) {
-        Serial.println("Trying to load time from preferences...");
+        Log.event(LOG_SEV_DEBUG, "Trying to load time from preferences...");
         timeLoaded = loadTimeFromPreferences();
     }
 
     if (!timeLoaded) {
         // No saved time, use default
-        Serial.println("Using default time: 2025-01-01 00:00:00 UTC");
+        Log.event(LOG_SEV_WARNING, "Using default time: 2025-01-01 00:00:00 UTC");
         timeManager.setTime(2025, 1, 1, 0, 0, 0);
     }
-    Serial.println("Time initialization complete");
+    Log.event(LOG_SEV_DEBUG, "Time initialization complete");
+    clockQuality.update(timeManager.getUnixTime());
 
     // Compute DST from calendar (overrides persisted value when no WWVB)
     if (AUTO_DST_ENABLED) {
         bool prevDST = dstActive;
         dstActive = computeUSDST();
-        Serial.printf("[DST] Auto-DST: %s (was %s)\n",
+        Log.event(LOG_SEV_INFO, "[DST] Auto-DST: %s (was %s)",
                      dstActive ? "active" : "inactive",
                      prevDST ? "active" : "inactive");
+
+        // Keep a persisted WWVB schedule if it is still ahead; otherwise use the rule
+        if (!nextDST.valid || dstTransitionUnix(nextDST) <= timeManager.getUnixTime()) {
+            scheduleRuleDST();
+        } else {
+            armDSTTimer();
+        }
     }
 
+    // DS3231 second opinion for WWVB frame voting (read only when a frame disagrees)
+    wwvbValidator.setRTCReader([](uint32_t& rtcUnix) -> bool {
+        if (!rtcAvailable) return false;
+        // Phase-locked to the SQW the clock is the DS3231: no second opinion
+        if (timeManager.hasRTCPhaseAnchor()) return false;
+        DateTime now = ds3231Now();
+        if (now.year() < WWVB_MIN_YEAR || now.year() > WWVB_MAX_YEAR) return false;
+        rtcUnix = now.unixtime();
+        return true;
+    });
+
     // Initialize reception history
-    Serial.println("Initializing reception history...");
+    Log.event(LOG_SEV_DEBUG, "Initializing reception history...");
     receptionHistory.begin();
-    Serial.println("Reception history initialized");
+    Log.event(LOG_SEV_DEBUG, "Reception history initialized");
+
+#if MQTT_ENABLED
+    mqttPublisher.begin();
+    mqttPublisher.setNTPServer(&ntpServer);
+    mqttPublisher.setReceptionHistory(&receptionHistory);
+    mqttPublisher.setClockDiscipline(&clockDiscipline);
+#endif
 
     delay(2000);
 
     // Disable touch auto-sleep so touch stays responsive
     amoled.disableAutoSleep();
-    Serial.println("[BOOT] Touch screen enabled");
+    Log.event(LOG_SEV_DEBUG, "[BOOT] Touch screen enabled");
 
     // Try auto-connect WiFi with saved credentials
     if (wifiLoadCredentials()) {
-        Serial.printf("[BOOT] Saved WiFi: %s — connecting...\n", wifiSSID.c_str());
+        Log.event(LOG_SEV_INFO, "[BOOT] Saved WiFi: %s — connecting...", wifiSSID);
         wifiConnect(wifiSSID, wifiPassword);
     }
 
     // Start main display
-    Serial.println("Calling updateDisplay() for first time...");
+    Log.event(LOG_SEV_DEBUG, "Calling updateDisplay() for first time...");
     updateDisplay();
-    Serial.println("updateDisplay() completed");
+    Log.event(LOG_SEV_DEBUG, "updateDisplay() completed");
 
     // Start first sync attempt
-    Serial.println("Starting initial WWVB sync...");
+    Log.event(LOG_SEV_INFO, "Starting initial WWVB sync...");
     startWWVBSync();
+    commitLoopState();
+
+    // Baseline after every boot-time allocation is done
+    Heap.begin();
 
-    Serial.println("Setup complete! Entering main loop...");
+    Log.event(LOG_SEV_NOTICE, "Setup complete! Entering main loop...");
 }
 
 // ============================================================================
@@ -3115,21 +4003,59 @@ void setup() {
 // ============================================================================
 void loop() {
     esp_task_wdt_reset();  // Feed watchdog — resets if loop hangs >15s
+    Crumbs.loopTop();      // Stage marks below survive a watchdog reset
 
     static bool firstLoop = true;
     if (firstLoop) {
-        Serial.println("*** ENTERED MAIN LOOP ***");
+        Log.event(LOG_SEV_DEBUG, "*** ENTERED MAIN LOOP ***");
         firstLoop = false;
     }
 
+    // Service the ES100 IRQ first: the correction is computed from the ISR
+    // timestamp, but a shorter wait keeps the IRQ→clock-set latency small.
+    Crumbs.stage(STAGE_SQW);
+    processDS3231SquareWave();
+    edgeCapture.service();
+    if (es100InterruptFlag) {
+        Crumbs.stage(STAGE_ES100_IRQ);
+        handleES100Interrupt();
+    }
+
     // Handle touch input (high frequency for responsive gestures)
+    Crumbs.stage(STAGE_TOUCH);
     handleTouch();
 
     // WiFi state machine and services
+    Crumbs.stage(STAGE_WIFI);
     wifiLoop();
+    Crumbs.stage(STAGE_NTP);
     if (ntpServer.isRunning()) ntpServer.handleClient();
+#if USB_REFCLOCK
+    Crumbs.stage(STAGE_USB_REF);
+    usbRefclock.service();
+#endif
+    Crumbs.stage(STAGE_PTP);
+    if (ptpServer.isRunning()) ptpServer.handleClient();
+    Crumbs.stage(STAGE_STATUS_HTTP);
     if (statusServer.isRunning()) statusServer.handleClient();
+    Crumbs.stage(STAGE_PORTAL);
     if (captivePortal.isRunning()) captivePortal.handleClient();
+    Crumbs.stage(STAGE_TIME_SAVE);
+    servicePendingTimeSave();
+    // Syslog shipping waits for the same NTP quiet window as flash writes
+    Crumbs.stage(STAGE_LOG_SHIP);
+    Log.service(ntpServer.isRunning() &&
+                (millis() - ntpServer.getLastRequestMillis()) < NTP_FLASH_QUIET_MS);
+#if MQTT_ENABLED
+    Crumbs.stage(STAGE_MQTT);
+    if (wifiState == WIFI_STATE_CONNECTED) {
+        mqttPublisher.service(ntpServer.isRunning() &&
+                              (millis() - ntpServer.getLastRequestMillis()) < NTP_FLASH_QUIET_MS);
+    }
+#endif
+#if NTP_FLASH_STRESS_INTERVAL_MS > 0
+    runFlashStress();
+#endif
 
     // Force display refresh during shutdown countdown for smooth progress bar
     if (shutdownCountdownActive) {
@@ -3137,64 +4063,46 @@ void loop() {
     }
 
     // Retry ES100 initialization if needed
+    Crumbs.stage(STAGE_ES100_INIT);
     if (retryES100Initialization()) {
         updateDisplay();  // Update display to show ES100 is now available
     }
 
-    processDS3231SquareWave();
-
-    // Handle ES100 interrupts
-    if (es100InterruptFlag) {
-        handleES100Interrupt();
-    }
-
     // Update display every second
     if (millis() - lastDisplayUpdate >= 1000) {
         lastDisplayUpdate = millis();
 
+        Crumbs.stage(STAGE_TICK);
         timeManager.tick();
         syncFromDS3231();  // Read DS3231 as authoritative time source
 
-        // Degrade NTP stratum to 16 if too long without any sync (RFC 5905 §7.3).
-        // LI=3 (alarm) is required by RFC 5905 when the server is unsynchronized.
-        if (timeManager.isTimeSet() &&
-            timeManager.getSecondsSinceSync() > NTP_UNSYNC_STRATUM_THRESHOLD_S) {
-            if (ntpServer.isRunning()) {
-                ntpServer.setStratum(16, "LOCL");
-                ntpServer.setLeapIndicator(3);  // RFC 5905: LI=3 when unsynchronized
-            }
-        }
+        // Walk LOCKED → HOLDOVER → DEGRADED → FREERUN as the error bound grows;
+        // FREERUN advertises Stratum 16, LI=3 and "LOCL" (RFC 5905 §7.3)
+        clockQuality.update(timeManager.getUnixTime());
 
         // Read DS3231 temperature every 64 seconds (matches sensor update rate)
         if (millis() - lastTempRead >= 64000) {
             readDS3231Temperature();
             lastTempRead = millis();
         }
-        // Update status data for web server
-        statusData.utcOffset = utcOffset;
-        statusData.dstActive = dstActive;
-        statusData.temperatureC = rtcTemperature;
-        statusData.batteryMv = amoled.getBattVoltage();
-        statusData.batteryPct = lipoBatteryPercent(statusData.batteryMv);
-        statusData.batteryCharging = amoled.isCharging();
-        statusData.timeSource = (uint8_t)lastTimeSource;
-        statusData.lastSyncMillis = lastTimeSyncMillis;
-        statusData.es100Available        = es100Available;
-        statusData.es100Receiving        = es100Receiving;
-        statusData.es100Tracking         = es100UsingTracking;
-        statusData.es100PendingTracking  = pendingTrackingStart;
-        statusData.es100TrackingReady    = es100TrackingReady;
-        statusData.leapSecondWarning     = wwvbLeapSecondWarning;
-        statusData.ant1Successes         = ant1Successes;
-        statusData.ant2Successes         = ant2Successes;
+        Heap.service();
+        // Sample the battery into the power slice
+        PowerState& pwr = State.power.edit();
+        pwr.batteryMv = amoled.getBattVoltage();
+        pwr.batteryPct = lipoBatteryPercent(pwr.batteryMv);
+        pwr.batteryCharging = amoled.isCharging();
+        State.power.commit();
+        uint16_t battMv = pwr.batteryMv;
+        uint8_t battPct = pwr.batteryPct;
+        bool battCharging = pwr.batteryCharging;
+        Energy.service(currentBrightness, battMv, battPct, battCharging);
 
         // Critical battery — force deep sleep after 3 consecutive readings to protect NVS
-        if (statusData.batteryPct <= CRITICAL_BATTERY_THRESHOLD &&
-            !statusData.batteryCharging && statusData.batteryMv > 0) {
+        if (battPct <= CRITICAL_BATTERY_THRESHOLD && !battCharging && battMv > 0) {
             critBattCount++;
             if (critBattCount >= 3) {
-                Serial.printf("[BATT] CRITICAL %d%% (%.2fV) — forcing deep sleep to protect NVS\n",
-                             statusData.batteryPct, statusData.batteryMv / 1000.0);
+                Log.event(LOG_SEV_ERR, "[BATT] CRITICAL %d%% (%.2fV) — forcing deep sleep to protect NVS",
+                             battPct, battMv / 1000.0);
                 performShutdown();
             }
         } else {
@@ -3202,39 +4110,35 @@ void loop() {
         }
 
         // Low battery alert at threshold
-        if (statusData.batteryPct <= LOW_BATTERY_THRESHOLD &&
-            !statusData.batteryCharging && statusData.batteryMv > 0) {
+        if (battPct <= LOW_BATTERY_THRESHOLD && !battCharging && battMv > 0) {
             if (!lowBatteryAlerted) {
                 lowBatteryAlerted = true;
-                Serial.printf("[BATT] LOW BATTERY ALERT: %d%% (%.2fV)\n",
-                             statusData.batteryPct, statusData.batteryMv / 1000.0);
+                Log.event(LOG_SEV_WARNING, "[BATT] LOW BATTERY ALERT: %d%% (%.2fV)",
+                             battPct, battMv / 1000.0);
             }
             // Periodic reminder every 60 seconds
             if (millis() - lastLowBattWarn >= LOW_BATTERY_WARN_MS) {
                 lastLowBattWarn = millis();
-                Serial.printf("[BATT] Warning: %d%% (%.2fV) — connect charger\n",
-                             statusData.batteryPct, statusData.batteryMv / 1000.0);
+                Log.event(LOG_SEV_WARNING, "[BATT] Warning: %d%% (%.2fV) — connect charger",
+                             battPct, battMv / 1000.0);
             }
-        } else if (statusData.batteryPct > LOW_BATTERY_THRESHOLD + 5) {
+        } else if (battPct > LOW_BATTERY_THRESHOLD + 5) {
             // Clear alert with 5% hysteresis to prevent flapping
             lowBatteryAlerted = false;
         }
 
-        // Auto-DST check every 60 seconds (catches transitions without WWVB)
-        if (AUTO_DST_ENABLED && millis() - lastDSTCheck >= 60000) {
-            lastDSTCheck = millis();
-            bool newDST = computeUSDST();
-            if (newDST != dstActive) {
-                dstActive = newDST;
-                Serial.printf("[DST] Transition detected: DST now %s\n",
-                             dstActive ? "active" : "inactive");
-            }
-        }
-
+        Crumbs.stage(STAGE_DISPLAY);
         updateDisplay();
         receptionHistory.hourlyTick();
     }
     
+    Crumbs.stage(STAGE_SYNC_SCHED);
+
+    // DST timer: apply a due change and re-arm, or re-arm a long-range shot
+    if (dstTimerFired) {
+        handleDSTTimer();
+    }
+
     // Pending tracking start: fire Control 0 write at second :55
     // (tracking reception requires the write to happen at exactly :55 ± drift tolerance)
     if (pendingTrackingStart && !es100Receiving) {
@@ -3242,7 +4146,7 @@ void loop() {
 
         // Abort if we've waited longer than the maximum allowed pending time
         if (now > trackingStartAtMs + TRACKING_PENDING_TIMEOUT_MS) {
-            Serial.println("[WWVB] Pending tracking start timed out — aborting");
+            Log.event(LOG_SEV_WARNING, "[WWVB] Pending tracking start timed out — aborting");
             pendingTrackingStart = false;
             if (es100.isPoweredOn()) es100.powerOff();
             es100UsingTracking = false;
@@ -3255,16 +4159,16 @@ void loop() {
         // Write Control 0 at the :55 boundary
         else if (now >= trackingStartAtMs) {
             pendingTrackingStart = false;
-            uint8_t trkCtrl = (ant2Successes > ant1Successes) ? ES100_CTRL0_TRACK_ANT2
-                                                              : ES100_CTRL0_TRACK_ANT1;
+            uint8_t trkAnt = preferredAntenna();
+            uint8_t trkCtrl = (trkAnt == 2) ? ES100_CTRL0_TRACK_ANT2 : ES100_CTRL0_TRACK_ANT1;
             if (es100.startReception(trkCtrl)) {
                 es100Receiving = true;
                 lastSyncAttempt = millis();  // Reset timeout clock from actual start, not schedule time
                 trackingWriteUnixTime = timeManager.getUnixTime();  // Anchor for sanity check
-                Serial.printf("[WWVB] Tracking mode sync started at :55 (Ant%d, successes: Ant1=%d Ant2=%d)\n",
-                              (ant2Successes > ant1Successes) ? 2 : 1, ant1Successes, ant2Successes);
+                Log.event(LOG_SEV_INFO, "[WWVB] Tracking mode sync started at :55 (Ant%d, successes: Ant1=%d Ant2=%d)",
+                              trkAnt, ant1Successes, ant2Successes);
             } else {
-                Serial.println("[WWVB] Failed to start tracking reception at :55");
+                Log.event(LOG_SEV_ERR, "[WWVB] Failed to start tracking reception at :55");
                 if (es100.isPoweredOn()) es100.powerOff();
                 es100UsingTracking = false;
                 recordSyncFailure(true);
@@ -3272,6 +4176,16 @@ void loop() {
         }
     }
 
+    // Confirm a held WWVB step promptly instead of waiting for the next scheduled sync
+    if (wwvbConfirmPending && !es100Receiving && !pendingTrackingStart &&
+        (long)(millis() - wwvbConfirmAtMs) >= 0) {
+        wwvbConfirmPending = false;
+        Log.event(LOG_SEV_INFO, "[WWVB] Re-receiving (%s) to confirm held frame",
+                      wwvbConfirmTracking ? "tracking" : "normal");
+        if (wwvbConfirmTracking) startWWVBSyncTracking();
+        else                     startWWVBSync(true);
+    }
+
     // Periodic sync attempts — time-aware schedule with daytime backoff
     if (!es100Receiving && !pendingTrackingStart) {
         unsigned long timeSinceLastAttempt = millis() - lastSyncAttempt;
@@ -3280,7 +4194,7 @@ void loop() {
         // Skip daytime attempts entirely after too many consecutive failures
         bool skip = daytimeSkipActive && !isNighttimeWindow();
 
-        if (!skip && timeSinceLastAttempt >= interval) {
+        if (!skip && (timeSinceLastAttempt >= interval || continuousTrackingActive())) {
             startWWVBSync();
         }
     }
@@ -3291,17 +4205,19 @@ void loop() {
         if (es100UsingTracking) {
             // Tracking timed out — poor signal; normal mode would also fail.
             // Retry tracking on the next scheduled sync.
-            // startWWVBSync() falls back to normal mode after ES100_TRACKING_FALLBACK_MS.
-            Serial.println("Tracking mode timeout, will retry tracking on next scheduled sync");
+            // startWWVBSync() falls back to normal mode after the tracking fallback
+            // window (SyncCadence::getTrackingFallbackMs()).
+            Log.event(LOG_SEV_WARNING, "Tracking mode timeout, will retry tracking on next scheduled sync");
             stopWWVBSync();
             es100UsingTracking = false;
             recordSyncFailure(true);
         } else {
-            Serial.println("Reception timeout - stopping");
+            Log.event(LOG_SEV_WARNING, "Reception timeout - stopping");
             stopWWVBSync();
             recordSyncFailure();
         }
     }
-    
-    delay(10);
+
+    commitLoopState();
+    Energy.idleDelay(10);  // Counted as CPU idle for energy accounting
 }